@@ -0,0 +1,394 @@
+#ifndef OCCLUSION_BUFFER_H
+#define OCCLUSION_BUFFER_H
+
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OCCLUSION_BUFFER_SSE2
+#endif
+
+#include "glm/glm.hpp"
+
+#include "ThreadPool.h"
+
+/* Result of testing a box against the occlusion buffer */
+enum class Box_visibility {
+	VISIBLE,
+	/* Completely outside the screen */
+	OFF_SCREEN,
+	/* Behind the occluders at every texel it covers */
+	OCCLUDED
+};
+
+/* Occlusion culling against a small depth buffer rasterized on the CPU.
+Render() picks the occluders that cover the most of the screen, at most MaxOccluders, and
+rasterizes the front faces of their boxes. The buffer is cut into TileSize square tiles, the
+triangles are binned to the tiles they touch and the tiles are rasterized on the thread pool,
+4 pixels at a time with SSE2. Every tile then reduces its depth to a pyramid, each texel keeping
+the farthest of the 2x2 texels below it, the levels above the tiles are reduced at the end.
+Test() projects a bounding box, goes up the pyramid until the box spans at most 2x2 texels and
+compares its nearest depth with the farthest occluder depth there.
+The depth is the NDC z and the coverage is sampled at the centers of the low resolution pixels,
+Test() widens the boxes by one pixel for the occluder silhouettes falling between two centers.
+Occluders crossing the near plane are skipped, boxes crossing it are always visible */
+class OcclusionBuffer
+{
+public:
+	/* Tiles rasterized by one task, a power of two so the pyramid levels of a tile stay inside it */
+	static const int TileSize = 32;
+
+	/* Constructor. The size is rounded up to whole tiles */
+	OcclusionBuffer(int width, int height);
+
+	/* Select the occluders among the candidates, unit cubes placed by their model matrices, and rasterize them */
+	void Render(ThreadPool& pool, const glm::mat4& viewProjection, const std::vector<glm::mat4>& candidates);
+	/* Test a world space bounding box against the occluders of the last Render(), safe from several threads */
+	Box_visibility Test(const glm::vec3& boundsMin, const glm::vec3& boundsMax) const;
+
+	/* Get functions */
+	int Width() const noexcept;
+	int Height() const noexcept;
+	int LevelCount() const noexcept;
+
+public:
+	/* Occluders rasterized per frame, the ones covering the most of the screen */
+	unsigned int MaxOccluders;
+	/* Statistics of the last Render() */
+	double RasterMs;
+	unsigned int Occluders;
+	/* Front facing triangles binned to the tiles */
+	unsigned int Triangles;
+
+private:
+	/* Edge functions and depth plane of a triangle in pixel coordinates, positive inside */
+	struct Raster_triangle {
+		float edgeA[3], edgeB[3], edgeC[3];
+		float depthX, depthY, depthC;
+		int minX, minY, maxX, maxY;
+	};
+
+	/* Helper functions */
+	/* Project the corners of the candidate, its screen area is its score, 0 when it can't occlude */
+	float projectCandidate(const glm::mat4& viewProjection, const glm::mat4& model, glm::vec3* corners) const;
+	void setupTriangles(const glm::vec3* corners);
+	void rasterizeTile(int tileX, int tileY);
+	void reduceTile(int tileX, int tileY);
+	void reduceLevel(int level);
+private:
+	int width, height;
+	int tilesX, tilesY;
+	/* Levels of the pyramid a tile reduces by itself, log2(TileSize) */
+	int tileLevels;
+	std::vector<std::vector<float>> levels;
+	std::vector<int> levelWidths, levelHeights;
+	glm::mat4 viewProjection;
+	/* 8 screen space corners per candidate, x and y in pixels and the NDC depth */
+	std::vector<glm::vec3> projected;
+	std::vector<float> scores;
+	std::vector<unsigned int> selected;
+	std::vector<Raster_triangle> triangles;
+	/* Triangles touching each tile */
+	std::vector<std::vector<unsigned int>> bins;
+};
+
+
+/* Corners of the unit cube are indexed by their x, y and z bits, the triangles are counter clockwise from outside */
+static const int occluderBoxTriangles[36] = {
+	1, 0, 2, 2, 3, 1,
+	4, 5, 7, 7, 6, 4,
+	5, 1, 3, 3, 7, 5,
+	0, 4, 6, 6, 2, 0,
+	6, 7, 3, 3, 2, 6,
+	0, 1, 5, 5, 4, 0
+};
+
+OcclusionBuffer::OcclusionBuffer(int width = 256, int height = 192)
+	: MaxOccluders(64), RasterMs(0.0), Occluders(0), Triangles(0), viewProjection(1.0f)
+{
+	tilesX = std::max(1, (width + TileSize - 1) / TileSize);
+	tilesY = std::max(1, (height + TileSize - 1) / TileSize);
+	this->width = tilesX * TileSize;
+	this->height = tilesY * TileSize;
+	tileLevels = 0;
+	while ((1 << tileLevels) < TileSize)
+		tileLevels++;
+
+	/* Halved down to one texel, the levels above the tiles round up */
+	int levelWidth = this->width, levelHeight = this->height;
+	while (true) {
+		levelWidths.push_back(levelWidth);
+		levelHeights.push_back(levelHeight);
+		levels.emplace_back((size_t)levelWidth * levelHeight, 1.0f);
+		if (levelWidth == 1 && levelHeight == 1)
+			break;
+		levelWidth = (levelWidth + 1) / 2;
+		levelHeight = (levelHeight + 1) / 2;
+	}
+	bins.resize(tilesX * tilesY);
+}
+
+void OcclusionBuffer::Render(ThreadPool& pool, const glm::mat4& viewProjection, const std::vector<glm::mat4>& candidates)
+{
+	auto start = std::chrono::steady_clock::now();
+	this->viewProjection = viewProjection;
+
+	/* Project every candidate, keep the ones covering the most pixels */
+	projected.resize(candidates.size() * 8);
+	scores.resize(candidates.size());
+	pool.ParallelFor((unsigned int)candidates.size(), [&](unsigned int begin, unsigned int end) {
+		for (unsigned int i = begin; i < end; i++)
+			scores[i] = projectCandidate(viewProjection, candidates[i], &projected[i * 8]);
+	});
+	selected.clear();
+	for (unsigned int i = 0; i < candidates.size(); i++)
+		if (scores[i] > 0.0f)
+			selected.push_back(i);
+	if (selected.size() > MaxOccluders) {
+		std::nth_element(selected.begin(), selected.begin() + MaxOccluders, selected.end(),
+			[this](unsigned int a, unsigned int b) { return scores[a] > scores[b]; });
+		selected.resize(MaxOccluders);
+	}
+	Occluders = (unsigned int)selected.size();
+
+	/* A few hundred triangles, set up and binned on this thread */
+	triangles.clear();
+	for (unsigned int i : selected)
+		setupTriangles(&projected[i * 8]);
+	Triangles = (unsigned int)triangles.size();
+	for (std::vector<unsigned int>& bin : bins)
+		bin.clear();
+	for (unsigned int i = 0; i < triangles.size(); i++) {
+		const Raster_triangle& triangle = triangles[i];
+		for (int tileY = triangle.minY / TileSize; tileY <= triangle.maxY / TileSize; tileY++)
+			for (int tileX = triangle.minX / TileSize; tileX <= triangle.maxX / TileSize; tileX++)
+				bins[tileY * tilesX + tileX].push_back(i);
+	}
+
+	/* Tiles don't share pixels, nor pyramid texels up to tileLevels */
+	pool.ParallelFor((unsigned int)bins.size(), [&](unsigned int begin, unsigned int end) {
+		for (unsigned int tile = begin; tile < end; tile++) {
+			rasterizeTile(tile % tilesX, tile / tilesX);
+			reduceTile(tile % tilesX, tile / tilesX);
+		}
+	});
+	for (int level = tileLevels + 1; level < LevelCount(); level++)
+		reduceLevel(level);
+
+	RasterMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+Box_visibility OcclusionBuffer::Test(const glm::vec3& boundsMin, const glm::vec3& boundsMax) const
+{
+	glm::vec3 ndcMin(1e30f), ndcMax(-1e30f);
+	for (int corner = 0; corner < 8; corner++) {
+		glm::vec4 clip = viewProjection * glm::vec4(corner & 1 ? boundsMax.x : boundsMin.x,
+			corner & 2 ? boundsMax.y : boundsMin.y, corner & 4 ? boundsMax.z : boundsMin.z, 1.0f);
+		/* In front of the near plane the projection flips, nothing can be said */
+		if (clip.z < -clip.w || clip.w <= 0.0f)
+			return Box_visibility::VISIBLE;
+		glm::vec3 ndc = glm::vec3(clip) / clip.w;
+		ndcMin = glm::min(ndcMin, ndc);
+		ndcMax = glm::max(ndcMax, ndc);
+	}
+	if (ndcMax.x < -1.0f || ndcMin.x > 1.0f || ndcMax.y < -1.0f || ndcMin.y > 1.0f || ndcMin.z > 1.0f)
+		return Box_visibility::OFF_SCREEN;
+
+	/* Pixels touched by the bounds and a margin of one, an occluder edge passing between the
+	centers of two pixels still leaves the next pixel uncovered */
+	ndcMin = glm::max(ndcMin, glm::vec3(-1.0f));
+	ndcMax = glm::min(ndcMax, glm::vec3(1.0f));
+	int minX = std::max(0, (int)std::floor((ndcMin.x * 0.5f + 0.5f) * width) - 1);
+	int minY = std::max(0, (int)std::floor((ndcMin.y * 0.5f + 0.5f) * height) - 1);
+	int maxX = std::min(width - 1, (int)std::floor((ndcMax.x * 0.5f + 0.5f) * width) + 1);
+	int maxY = std::min(height - 1, (int)std::floor((ndcMax.y * 0.5f + 0.5f) * height) + 1);
+
+	/* A texel of a level covers 2^level pixels per side */
+	int level = 0;
+	while (level < LevelCount() - 1 && ((maxX >> level) - (minX >> level) > 1 || (maxY >> level) - (minY >> level) > 1))
+		level++;
+
+	const std::vector<float>& depth = levels[level];
+	int levelWidth = levelWidths[level];
+	float farthest = -1.0f;
+	for (int y = minY >> level; y <= maxY >> level; y++)
+		for (int x = minX >> level; x <= maxX >> level; x++)
+			farthest = std::max(farthest, depth[y * levelWidth + x]);
+	return ndcMin.z > farthest ? Box_visibility::OCCLUDED : Box_visibility::VISIBLE;
+}
+
+inline int OcclusionBuffer::Width() const noexcept
+{
+	return width;
+}
+
+inline int OcclusionBuffer::Height() const noexcept
+{
+	return height;
+}
+
+inline int OcclusionBuffer::LevelCount() const noexcept
+{
+	return (int)levels.size();
+}
+
+float OcclusionBuffer::projectCandidate(const glm::mat4& viewProjection, const glm::mat4& model, glm::vec3* corners) const
+{
+	/* Occluders reaching farther out than this many screens are skipped */
+	const float guardBand = 1000.0f;
+	glm::mat4 transform = viewProjection * model;
+	glm::vec2 screenMin(1e30f), screenMax(-1e30f);
+	for (int corner = 0; corner < 8; corner++) {
+		glm::vec4 clip = transform * glm::vec4(corner & 1 ? 0.5f : -0.5f, corner & 2 ? 0.5f : -0.5f, corner & 4 ? 0.5f : -0.5f, 1.0f);
+		/* Clipping the occluders isn't worth it, skipping them only culls less */
+		if (clip.z < -clip.w || clip.w <= 0.0f)
+			return 0.0f;
+		/* Far outside the screen the float setup would lose precision */
+		if (std::abs(clip.x) > guardBand * clip.w || std::abs(clip.y) > guardBand * clip.w)
+			return 0.0f;
+		corners[corner] = glm::vec3((clip.x / clip.w * 0.5f + 0.5f) * width, (clip.y / clip.w * 0.5f + 0.5f) * height, clip.z / clip.w);
+		screenMin = glm::min(screenMin, glm::vec2(corners[corner]));
+		screenMax = glm::max(screenMax, glm::vec2(corners[corner]));
+	}
+	/* Area of the screen rectangle the box covers */
+	screenMin = glm::max(screenMin, glm::vec2(0.0f));
+	screenMax = glm::min(screenMax, glm::vec2((float)width, (float)height));
+	if (screenMax.x <= screenMin.x || screenMax.y <= screenMin.y)
+		return 0.0f;
+	return (screenMax.x - screenMin.x) * (screenMax.y - screenMin.y);
+}
+
+void OcclusionBuffer::setupTriangles(const glm::vec3* corners)
+{
+	for (int i = 0; i < 36; i += 3) {
+		const glm::vec3& v0 = corners[occluderBoxTriangles[i]];
+		const glm::vec3& v1 = corners[occluderBoxTriangles[i + 1]];
+		const glm::vec3& v2 = corners[occluderBoxTriangles[i + 2]];
+		/* Twice the signed area, the back faces are hidden by the front ones */
+		float area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+		if (area <= 1e-6f)
+			continue;
+
+		/* Pixels whose centers can be inside, clamped before the conversion */
+		Raster_triangle triangle;
+		triangle.minX = (int)std::ceil(std::max(std::min({ v0.x, v1.x, v2.x }), 0.0f) - 0.5f);
+		triangle.minY = (int)std::ceil(std::max(std::min({ v0.y, v1.y, v2.y }), 0.0f) - 0.5f);
+		triangle.maxX = (int)std::floor(std::min(std::max({ v0.x, v1.x, v2.x }), (float)width) - 0.5f);
+		triangle.maxY = (int)std::floor(std::min(std::max({ v0.y, v1.y, v2.y }), (float)height) - 0.5f);
+		if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+			continue;
+
+		const glm::vec3* vertices[3] = { &v0, &v1, &v2 };
+		for (int edge = 0; edge < 3; edge++) {
+			const glm::vec3& a = *vertices[edge];
+			const glm::vec3& b = *vertices[(edge + 1) % 3];
+			triangle.edgeA[edge] = a.y - b.y;
+			triangle.edgeB[edge] = b.x - a.x;
+			/* From the terms of one vertex, a.x * b.y - a.y * b.x would cancel badly off screen */
+			triangle.edgeC[edge] = -(triangle.edgeA[edge] * a.x + triangle.edgeB[edge] * a.y);
+		}
+		/* The NDC depth is linear in screen space */
+		triangle.depthX = ((v1.z - v0.z) * (v2.y - v0.y) - (v2.z - v0.z) * (v1.y - v0.y)) / area;
+		triangle.depthY = ((v2.z - v0.z) * (v1.x - v0.x) - (v1.z - v0.z) * (v2.x - v0.x)) / area;
+		triangle.depthC = v0.z - triangle.depthX * v0.x - triangle.depthY * v0.y;
+		triangles.push_back(triangle);
+	}
+}
+
+void OcclusionBuffer::rasterizeTile(int tileX, int tileY)
+{
+	std::vector<float>& depth = levels[0];
+	int tileMinX = tileX * TileSize, tileMinY = tileY * TileSize;
+	for (int y = tileMinY; y < tileMinY + TileSize; y++)
+		std::fill_n(&depth[y * width + tileMinX], TileSize, 1.0f);
+
+	for (unsigned int index : bins[tileY * tilesX + tileX]) {
+		const Raster_triangle& triangle = triangles[index];
+		/* Whole groups of 4 pixels, the tiles start at multiples of 4 */
+		int minX = std::max(triangle.minX, tileMinX) & ~3;
+		int maxX = std::min(triangle.maxX, tileMinX + TileSize - 1);
+		int minY = std::max(triangle.minY, tileMinY);
+		int maxY = std::min(triangle.maxY, tileMinY + TileSize - 1);
+
+#if defined(OCCLUSION_BUFFER_SSE2)
+		__m128 edgeA[3], edgeB[3], edgeC[3];
+		for (int edge = 0; edge < 3; edge++) {
+			edgeA[edge] = _mm_set1_ps(triangle.edgeA[edge]);
+			edgeB[edge] = _mm_set1_ps(triangle.edgeB[edge]);
+			edgeC[edge] = _mm_set1_ps(triangle.edgeC[edge]);
+		}
+		__m128 depthX = _mm_set1_ps(triangle.depthX), depthY = _mm_set1_ps(triangle.depthY), depthC = _mm_set1_ps(triangle.depthC);
+		__m128 laneOffsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f), zero = _mm_setzero_ps();
+		for (int y = minY; y <= maxY; y++) {
+			__m128 centerY = _mm_set1_ps(y + 0.5f);
+			/* The parts of the edge functions and the depth constant along the row */
+			__m128 rowEdge[3];
+			for (int edge = 0; edge < 3; edge++)
+				rowEdge[edge] = _mm_add_ps(_mm_mul_ps(edgeB[edge], centerY), edgeC[edge]);
+			__m128 rowDepth = _mm_add_ps(_mm_mul_ps(depthY, centerY), depthC);
+			float* row = &depth[y * width];
+			for (int x = minX; x <= maxX; x += 4) {
+				__m128 centerX = _mm_add_ps(_mm_set1_ps((float)x), laneOffsets);
+				__m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA[0], centerX), rowEdge[0]), zero);
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA[1], centerX), rowEdge[1]), zero));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA[2], centerX), rowEdge[2]), zero));
+				if (_mm_movemask_ps(inside) == 0)
+					continue;
+				__m128 previous = _mm_loadu_ps(row + x);
+				__m128 nearest = _mm_min_ps(previous, _mm_add_ps(_mm_mul_ps(depthX, centerX), rowDepth));
+				_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, previous)));
+			}
+		}
+#else
+		for (int y = minY; y <= maxY; y++) {
+			float centerY = y + 0.5f;
+			float* row = &depth[y * width];
+			for (int x = minX; x <= maxX; x++) {
+				float centerX = x + 0.5f;
+				bool inside = true;
+				for (int edge = 0; edge < 3; edge++)
+					inside = inside && triangle.edgeA[edge] * centerX + triangle.edgeB[edge] * centerY + triangle.edgeC[edge] >= 0.0f;
+				if (inside)
+					row[x] = std::min(row[x], triangle.depthX * centerX + triangle.depthY * centerY + triangle.depthC);
+			}
+		}
+#endif
+	}
+}
+
+void OcclusionBuffer::reduceTile(int tileX, int tileY)
+{
+	for (int level = 1; level <= tileLevels; level++) {
+		int size = TileSize >> level;
+		int minX = tileX * size, minY = tileY * size;
+		const std::vector<float>& below = levels[level - 1];
+		std::vector<float>& above = levels[level];
+		int belowWidth = levelWidths[level - 1], aboveWidth = levelWidths[level];
+		for (int y = minY; y < minY + size; y++)
+			for (int x = minX; x < minX + size; x++) {
+				const float* texels = &below[2 * y * belowWidth + 2 * x];
+				above[y * aboveWidth + x] = std::max(std::max(texels[0], texels[1]), std::max(texels[belowWidth], texels[belowWidth + 1]));
+			}
+	}
+}
+
+void OcclusionBuffer::reduceLevel(int level)
+{
+	const std::vector<float>& below = levels[level - 1];
+	std::vector<float>& above = levels[level];
+	int belowWidth = levelWidths[level - 1], belowHeight = levelHeights[level - 1];
+	for (int y = 0; y < levelHeights[level]; y++)
+		for (int x = 0; x < levelWidths[level]; x++) {
+			/* An odd row or column has no second texel */
+			float farthest = -1.0f;
+			for (int belowY = 2 * y; belowY < std::min(2 * y + 2, belowHeight); belowY++)
+				for (int belowX = 2 * x; belowX < std::min(2 * x + 2, belowWidth); belowX++)
+					farthest = std::max(farthest, below[belowY * belowWidth + belowX]);
+			above[y * levelWidths[level] + x] = farthest;
+		}
+}
+
+#endif
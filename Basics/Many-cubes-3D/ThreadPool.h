@@ -0,0 +1,155 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <vector>
+#include <queue>
+#include <algorithm>
+
+/* Fixed size pool of worker threads executing queued tasks in FIFO order */
+class ThreadPool
+{
+public:
+	/* Constructor and destructor */
+	explicit ThreadPool(unsigned int threadCount);
+	~ThreadPool() noexcept;
+
+	/* Queue a task, it will run on one of the workers */
+	void Submit(std::function<void()> task);
+	/* Block until the queue is empty and no task is running */
+	void WaitIdle();
+	/* Drop the queued tasks which didn't start yet */
+	void CancelPending();
+	/* Split [0, count) into chunks, run body(begin, end) on the workers and wait for all of them.
+	Don't call it from a task of the same pool, the waiting worker could starve it */
+	void ParallelFor(unsigned int count, const std::function<void(unsigned int, unsigned int)>& body);
+
+	/* Get functions */
+	unsigned int ThreadCount() const noexcept;
+	/* Number of threads worth spawning for background work, leaves one core for the GL thread */
+	static unsigned int DefaultThreadCount() noexcept;
+
+private:
+	/* Worker loop */
+	void work();
+private:
+	std::vector<std::thread> workers;
+	std::queue<std::function<void()>> tasks;
+	std::mutex mutex;
+	std::condition_variable taskAvailable;
+	std::condition_variable tasksFinished;
+	unsigned int busyWorkers;
+	bool stopping;
+};
+
+
+ThreadPool::ThreadPool(unsigned int threadCount) : busyWorkers(0), stopping(false)
+{
+	if (threadCount == 0)
+		threadCount = 1;
+	for (unsigned int i = 0; i < threadCount; i++)
+		workers.emplace_back(&ThreadPool::work, this);
+}
+
+ThreadPool::~ThreadPool() noexcept
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	taskAvailable.notify_all();
+	for (std::thread& worker : workers)
+		worker.join();
+}
+
+void ThreadPool::Submit(std::function<void()> task)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		tasks.push(std::move(task));
+	}
+	taskAvailable.notify_one();
+}
+
+void ThreadPool::WaitIdle()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	tasksFinished.wait(lock, [this] { return tasks.empty() && busyWorkers == 0; });
+}
+
+void ThreadPool::CancelPending()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	std::queue<std::function<void()>>().swap(tasks);
+	if (busyWorkers == 0)
+		tasksFinished.notify_all();
+}
+
+void ThreadPool::ParallelFor(unsigned int count, const std::function<void(unsigned int, unsigned int)>& body)
+{
+	if (count == 0)
+		return;
+
+	/* A few chunks per worker keep them busy when the chunks take uneven time */
+	unsigned int chunks = std::min(count, ThreadCount() * 4);
+	unsigned int remaining = chunks;
+	std::mutex doneMutex;
+	std::condition_variable done;
+
+	for (unsigned int chunk = 0; chunk < chunks; chunk++) {
+		unsigned int begin = (unsigned int)((unsigned long long)count * chunk / chunks);
+		unsigned int end = (unsigned int)((unsigned long long)count * (chunk + 1) / chunks);
+		Submit([&, begin, end] {
+			body(begin, end);
+			std::lock_guard<std::mutex> lock(doneMutex);
+			if (--remaining == 0)
+				done.notify_one();
+		});
+	}
+
+	std::unique_lock<std::mutex> lock(doneMutex);
+	done.wait(lock, [&remaining] { return remaining == 0; });
+}
+
+inline unsigned int ThreadPool::ThreadCount() const noexcept
+{
+	return (unsigned int)workers.size();
+}
+
+inline unsigned int ThreadPool::DefaultThreadCount() noexcept
+{
+	unsigned int cores = std::thread::hardware_concurrency();
+	return cores > 1 ? cores - 1 : 1;
+}
+
+void ThreadPool::work()
+{
+	while (true) {
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			taskAvailable.wait(lock, [this] { return stopping || !tasks.empty(); });
+			/* Drop the remaining tasks on shutdown */
+			if (stopping)
+				return;
+
+			task = std::move(tasks.front());
+			tasks.pop();
+			busyWorkers++;
+		}
+
+		task();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			busyWorkers--;
+			if (tasks.empty() && busyWorkers == 0)
+				tasksFinished.notify_all();
+		}
+	}
+}
+
+#endif
@@ -1,246 +1,382 @@
-#include "glad/glad.h"
-#include "GLFW/glfw3.h"
-#include "stb_image.h"
-#include "glm/glm.hpp"
-#include "glm/gtc/matrix_transform.hpp"
-#include "glm/gtc/type_ptr.hpp"
-
-#include <iostream>
-
-#include "Shader.h"
-
-void fixFrameBufferResize(GLFWwindow* window, int width, int height);
-void processInput(GLFWwindow* window);
-
-
-const int winWidth = 800;
-const int winHeight = 600;
-
-
-int main()
-{
-	/********************************** Initialization ***********************************/
-	glfwInit();
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-	GLFWwindow* window = glfwCreateWindow(winWidth, winHeight, "Colorful triangle", NULL, NULL);
-	if (window == NULL) {
-		std::cout << "ERROR::GLFW::Initialization_failed" << std::endl;
-		glfwTerminate();
-		return -1;
-	}
-	glfwMakeContextCurrent(window);
-
-	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
-		std::cout << "ERROR::GLAD::Initialization_failed" << std::endl;
-		glfwTerminate();
-		return -1;
-	}
-	glViewport(0, 0, winWidth, winHeight);
-	glfwSetFramebufferSizeCallback(window, fixFrameBufferResize);
-
-	Shader shader("shaders/shader.vs", "shaders/shader.fs");
-
-	/********************************** Buffers ***********************************/
-	/* Vertices of the cube */
-	float vertices[] = {
-		/*		Positions	Texture coords*/
-		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f,
-		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,
-		 0.5f,  0.5f, -0.5f,  1.0f,  1.0f,
-		 0.5f,  0.5f, -0.5f,  1.0f,  1.0f,
-		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,
-		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f,
-
-		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,
-		 0.5f, -0.5f,  0.5f,  1.0f,  0.0f,
-		 0.5f,  0.5f,  0.5f,  1.0f,  1.0f,
-		 0.5f,  0.5f,  0.5f,  1.0f,  1.0f,
-		-0.5f,  0.5f,  0.5f,  0.0f,  1.0f,
-		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,
-
-		-0.5f,  0.5f,  0.5f,  1.0f,  0.0f,
-		-0.5f,  0.5f, -0.5f,  1.0f,  1.0f,
-		-0.5f, -0.5f, -0.5f,  0.0f,  1.0f,
-		-0.5f, -0.5f, -0.5f,  0.0f,  1.0f,
-		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,
-		-0.5f,  0.5f,  0.5f,  1.0f,  0.0f,
-
-		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,
-		 0.5f,  0.5f, -0.5f,  1.0f,  1.0f,
-		 0.5f, -0.5f, -0.5f,  0.0f,  1.0f,
-		 0.5f, -0.5f, -0.5f,  0.0f,  1.0f,
-		 0.5f, -0.5f,  0.5f,  0.0f,  0.0f,
-		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,
-
-		-0.5f, -0.5f, -0.5f,  0.0f,  1.0f,
-		 0.5f, -0.5f, -0.5f,  1.0f,  1.0f,
-		 0.5f, -0.5f,  0.5f,  1.0f,  0.0f,
-		 0.5f, -0.5f,  0.5f,  1.0f,  0.0f,
-		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,
-		-0.5f, -0.5f, -0.5f,  0.0f,  1.0f,
-
-		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,
-		 0.5f,  0.5f, -0.5f,  1.0f,  1.0f,
-		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,
-		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,
-		-0.5f,  0.5f,  0.5f,  0.0f,  0.0f,
-		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f
-	};
-
-	/* Positions of the cubes in the world space */
-	glm::vec3 cubePositions[] = {
-		glm::vec3( 0.0f,   0.0f,   0.0f),
-		glm::vec3( 2.0f,   5.0f, -15.0f),
-		glm::vec3(-1.5f,  -2.2f,  -2.5f),
-		glm::vec3(-3.8f,  -2.0f, -12.3f),
-		glm::vec3( 2.4f,  -0.4f,  -3.5f),
-		glm::vec3(-1.7f,   3.0f,  -7.5f),
-		glm::vec3( 1.3f,  -2.0f,  -2.5f),
-		glm::vec3( 1.5f,   2.0f,  -2.5f),
-		glm::vec3( 1.5f,   0.2f,  -1.5f),
-		glm::vec3(-1.3f,   1.0f,  -1.5f)
-	};
-
-	unsigned int VAO, VBO;
-	glGenVertexArrays(1, &VAO);
-	glGenBuffers(1, &VBO);
-
-	glBindVertexArray(VAO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-	/* Position attrib */
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-	/* Color attrib */
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
-	/* Texture position attrib */
-
-	/********************************** Texture ***********************************/
-
-	/* First texture */
-	unsigned int texture1;
-	glGenTextures(1, &texture1);
-	glBindTexture(GL_TEXTURE_2D, texture1);
-	
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-	int width, height, nrChannels;
-	unsigned char* data = stbi_load("textures/container.jpg", &width, &height, &nrChannels, 0);
-
-	stbi_set_flip_vertically_on_load(true);
-
-	if (data) {
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else
-		std::cout << "Failed to load the texture" << std::endl;
-	stbi_image_free(data);
-
-	/* Second texture */
-	unsigned int texture2;
-	glGenTextures(1, &texture2);
-	glBindTexture(GL_TEXTURE_2D, texture2);
-
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-	data = stbi_load("textures/awesomeface.png", &width, &height, &nrChannels, 0);
-	if (data) {
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else
-		std::cout << "Failed to load the texture" << std::endl;
-	stbi_image_free(data);
-
-	shader.use();
-	shader.setInt("texture1", 0);
-	shader.setInt("texture2", 1);
-
-	/******************************** 3D matrixes ***********************************/
-	/* View matrix (moves the scene).
-	Moves the scene forward, so the object is further away, the Z-axis is in the reverse direction */
-	glm::mat4 view = glm::mat4(1.0f);
-	view = glm::translate(view, glm::vec3(0.0f, 0.0f, -3.0f));
-
-	/* Projection matrix (sets the projection style, look)
-	Makes the perspective like real (45 deg), uses screen sizes dividing them to set the size,
-	the near plane is at 0.1 location, the further plane is at 100.0 location */
-	glm::mat4 projection = glm::mat4(1.0f);
-	projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f);
-
-	/* Gets the location of the uniforms */
-	int modelLoc = glGetUniformLocation(shader.ID, "model");
-	int viewLoc = glGetUniformLocation(shader.ID, "view");
-	int projectionLoc = glGetUniformLocation(shader.ID, "projection");
-
-	/* Enables depth test - OpenGL function, that helps with drawing things in front of the others */
-	glEnable(GL_DEPTH_TEST);
-
-	/******************************** Program loop ***********************************/
-	while (!glfwWindowShouldClose(window)) {
-		processInput(window);
-
-		glClearColor(0.2f, 0.2f, 0.3f, 1.0f);
-		/* Clear the color and buffer bit, to not stack them from the previous draw */
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, texture1);
-
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, texture2);
-
-		shader.use();
-
-		glBindVertexArray(VAO);
-		/* Repeat 10 times */
-		for (unsigned int i = 0; i < 10; i++) {
-			/* Translate the model matrix to the given world positions */
-			glm::mat4 model = glm::mat4(1.0f);
-			model = glm::translate(model, cubePositions[i]);
-			float angle = 20.0f * i;
-			/* Rotate the 1.0 X, 0.3 Y, 0.5 Z axes by 20 * $i degrees */
-			model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
-			shader.setMat4("model", model);
-
-			/* Draw the given cube */
-			glDrawArrays(GL_TRIANGLES, 0, 36);
-		}
-		glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-		glUniformMatrix4fv(projectionLoc, 1, GL_FALSE, glm::value_ptr(projection));
-
-		
-		glDrawArrays(GL_TRIANGLES, 0, 36);
-
-		glfwSwapBuffers(window);
-		glfwPollEvents();
-	}
-
-	glDeleteBuffers(1, &VBO);
-	glDeleteBuffers(1, &VAO);
-	glfwTerminate();
-}
-
-
-void fixFrameBufferResize(GLFWwindow* window, int width, int height)
-{
-	glViewport(0, 0, width, height);
-}
-
-void processInput(GLFWwindow* window)
-{
-	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-		glfwSetWindowShouldClose(window, true);
+#include "glad/glad.h"
+#include "GLFW/glfw3.h"
+#include "stb_image.h"
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include "glm/gtc/type_ptr.hpp"
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cmath>
+
+#include "Shader.h"
+#include "ThreadPool.h"
+#include "OcclusionBuffer.h"
+
+/* Ways to pick the cubes to draw */
+enum class Cull_mode {
+	/* Every cube, the depth test hides the ones behind */
+	NONE,
+	/* Only the cubes the walls don't hide in the CPU occlusion buffer */
+	OCCLUSION
+};
+
+void fixFrameBufferResize(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow* window);
+void keyPress(GLFWwindow* window, int key, int scancode, int action, int mods);
+const char* modeName(Cull_mode mode);
+
+
+const int winWidth = 800;
+const int winHeight = 600;
+
+/******************************** Culling ***********************************/
+/* Switched with the 1 and 2 keys */
+Cull_mode cullMode = Cull_mode::OCCLUSION;
+
+/******************************** Scene ***********************************/
+/* Small cubes on a grid of this many per side and this spacing, walls on a coarser grid between them */
+const int cubesPerSide = 40;
+const float cubeSpacing = 3.0f;
+const int wallsPerSide = 6;
+const float wallSpacing = 20.0f;
+const glm::vec3 wallSize(9.0f, 5.0f, 0.6f);
+/* The camera circles the center at eye height */
+const float orbitRadius = 35.0f;
+const float orbitSpeed = 0.15f;
+
+
+int main()
+{
+	/********************************** Initialization ***********************************/
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	GLFWwindow* window = glfwCreateWindow(winWidth, winHeight, "Colorful triangle", NULL, NULL);
+	if (window == NULL) {
+		std::cout << "ERROR::GLFW::Initialization_failed" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		std::cout << "ERROR::GLAD::Initialization_failed" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glViewport(0, 0, winWidth, winHeight);
+	glfwSetFramebufferSizeCallback(window, fixFrameBufferResize);
+	glfwSetKeyCallback(window, keyPress);
+	/* Measure the frames, not the refresh rate */
+	glfwSwapInterval(0);
+
+	Shader shader("shaders/shader.vs", "shaders/shader.fs");
+
+	/********************************** Buffers ***********************************/
+	/* Vertices of the cube */
+	float vertices[] = {
+		/*		Positions	Texture coords*/
+		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f,  1.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f,  1.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f,
+
+		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f,  1.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f,  1.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f,  1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,
+
+		-0.5f,  0.5f,  0.5f,  1.0f,  0.0f,
+		-0.5f,  0.5f, -0.5f,  1.0f,  1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f,  1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f,  1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,
+		-0.5f,  0.5f,  0.5f,  1.0f,  0.0f,
+
+		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f,  1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f,  1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f,  1.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,
+
+		-0.5f, -0.5f, -0.5f,  0.0f,  1.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f,  1.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f,  0.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f,  0.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f,  1.0f,
+
+		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f,  1.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f,  0.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f
+	};
+
+	/* Model matrices and world space bounds of the cubes, a grid with random heights */
+	std::vector<glm::mat4> cubeModels;
+	std::vector<glm::vec3> cubeMins, cubeMaxs;
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> cubeHeight(-1.5f, 1.5f);
+	for (int z = 0; z < cubesPerSide; z++)
+		for (int x = 0; x < cubesPerSide; x++) {
+			glm::vec3 position((x - (cubesPerSide - 1) * 0.5f) * cubeSpacing, cubeHeight(random), (z - (cubesPerSide - 1) * 0.5f) * cubeSpacing);
+			glm::mat4 model = glm::mat4(1.0f);
+			model = glm::translate(model, position);
+			/* Rotate the 1.0 X, 0.3 Y, 0.5 Z axes by 20 * $i degrees */
+			float angle = 20.0f * cubeModels.size();
+			model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
+			cubeModels.push_back(model);
+
+			/* The rotated unit cube reaches half of each column's length along each axis */
+			glm::vec3 extent = 0.5f * (glm::abs(glm::vec3(model[0])) + glm::abs(glm::vec3(model[1])) + glm::abs(glm::vec3(model[2])));
+			cubeMins.push_back(position - extent);
+			cubeMaxs.push_back(position + extent);
+		}
+
+	/* Stretched cubes standing between them, the occluders. Every other one turned by 90 degrees */
+	std::vector<glm::mat4> wallModels;
+	for (int z = 0; z < wallsPerSide; z++)
+		for (int x = 0; x < wallsPerSide; x++) {
+			glm::mat4 model = glm::mat4(1.0f);
+			model = glm::translate(model, glm::vec3((x - (wallsPerSide - 1) * 0.5f) * wallSpacing, 0.0f, (z - (wallsPerSide - 1) * 0.5f) * wallSpacing));
+			if ((x + z) % 2)
+				model = glm::rotate(model, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+			model = glm::scale(model, wallSize);
+			wallModels.push_back(model);
+		}
+
+	unsigned int VAO, VBO;
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &VBO);
+
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+	/* Position attrib */
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+	/* Color attrib */
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+	glEnableVertexAttribArray(1);
+	/* Texture position attrib */
+
+	/********************************** Texture ***********************************/
+
+	/* First texture */
+	unsigned int texture1;
+	glGenTextures(1, &texture1);
+	glBindTexture(GL_TEXTURE_2D, texture1);
+	
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	int width, height, nrChannels;
+	unsigned char* data = stbi_load("textures/container.jpg", &width, &height, &nrChannels, 0);
+
+	stbi_set_flip_vertically_on_load(true);
+
+	if (data) {
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	else
+		std::cout << "Failed to load the texture" << std::endl;
+	stbi_image_free(data);
+
+	/* Second texture */
+	unsigned int texture2;
+	glGenTextures(1, &texture2);
+	glBindTexture(GL_TEXTURE_2D, texture2);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	data = stbi_load("textures/awesomeface.png", &width, &height, &nrChannels, 0);
+	if (data) {
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	else
+		std::cout << "Failed to load the texture" << std::endl;
+	stbi_image_free(data);
+
+	shader.use();
+	shader.setInt("texture1", 0);
+	shader.setInt("texture2", 1);
+
+	/******************************** 3D matrixes ***********************************/
+	/* View matrix (moves the scene), follows the camera every frame */
+	glm::mat4 view = glm::mat4(1.0f);
+
+	/* Projection matrix (sets the projection style, look)
+	Makes the perspective like real (45 deg), uses screen sizes dividing them to set the size,
+	the near plane is at 0.1 location, the further plane is at 200.0 location */
+	glm::mat4 projection = glm::mat4(1.0f);
+	projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 200.0f);
+
+	/* Gets the location of the uniforms */
+	int viewLoc = glGetUniformLocation(shader.ID, "view");
+	int projectionLoc = glGetUniformLocation(shader.ID, "projection");
+
+	/* Enables depth test - OpenGL function, that helps with drawing things in front of the others */
+	glEnable(GL_DEPTH_TEST);
+
+	/******************************** Occlusion culling ***********************************/
+	/* 256 x 192 pixels on the CPU, the walls are rasterized into it and the cubes tested against it */
+	ThreadPool pool(ThreadPool::DefaultThreadCount());
+	OcclusionBuffer occlusion(256, 192);
+	std::vector<Box_visibility> visibility(cubeModels.size(), Box_visibility::VISIBLE);
+	std::cout << cubeModels.size() << " cubes behind " << wallModels.size() << " walls, the occlusion buffer is " << occlusion.Width() << " x "
+		<< occlusion.Height() << " in " << occlusion.LevelCount() << " levels on " << pool.ThreadCount() << " threads. 1 - no culling, 2 - occlusion culling" << std::endl;
+
+	/* Statistics, averaged over two seconds */
+	size_t cubesDrawn = 0, cubesOccluded = 0, cubesOffScreen = 0, occluders = 0, triangles = 0;
+	double rasterMs = 0.0, testMs = 0.0;
+	Cull_mode measuredMode = cullMode;
+	unsigned int measuredFrames = 0;
+	double measureStart = glfwGetTime();
+
+	/******************************** Program loop ***********************************/
+	while (!glfwWindowShouldClose(window)) {
+		processInput(window);
+
+		/* Circle the center, looking at it */
+		float time = (float)glfwGetTime();
+		glm::vec3 cameraPos(sin(time * orbitSpeed) * orbitRadius, 1.0f, cos(time * orbitSpeed) * orbitRadius);
+		view = glm::lookAt(cameraPos, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+		/* Find the hidden cubes before submitting any of them */
+		if (cullMode == Cull_mode::OCCLUSION) {
+			occlusion.Render(pool, projection * view, wallModels);
+			auto testStart = std::chrono::steady_clock::now();
+			pool.ParallelFor((unsigned int)cubeModels.size(), [&](unsigned int begin, unsigned int end) {
+				for (unsigned int i = begin; i < end; i++)
+					visibility[i] = occlusion.Test(cubeMins[i], cubeMaxs[i]);
+			});
+			testMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - testStart).count();
+			rasterMs += occlusion.RasterMs;
+			occluders += occlusion.Occluders;
+			triangles += occlusion.Triangles;
+		}
+
+		glClearColor(0.2f, 0.2f, 0.3f, 1.0f);
+		/* Clear the color and buffer bit, to not stack them from the previous draw */
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, texture1);
+
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, texture2);
+
+		shader.use();
+		glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
+		glUniformMatrix4fv(projectionLoc, 1, GL_FALSE, glm::value_ptr(projection));
+
+		glBindVertexArray(VAO);
+		/* The walls first, they hide most of what comes after */
+		for (const glm::mat4& model : wallModels) {
+			shader.setMat4("model", model);
+			glDrawArrays(GL_TRIANGLES, 0, 36);
+		}
+		for (unsigned int i = 0; i < cubeModels.size(); i++) {
+			if (cullMode == Cull_mode::OCCLUSION && visibility[i] != Box_visibility::VISIBLE) {
+				if (visibility[i] == Box_visibility::OCCLUDED)
+					cubesOccluded++;
+				else
+					cubesOffScreen++;
+				continue;
+			}
+			shader.setMat4("model", cubeModels[i]);
+
+			/* Draw the given cube */
+			glDrawArrays(GL_TRIANGLES, 0, 36);
+			cubesDrawn++;
+		}
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+
+		/* Averages over two seconds, restarted when the mode is switched */
+		measuredFrames++;
+		double measured = glfwGetTime() - measureStart;
+		bool toggled = measuredMode != cullMode;
+		if (toggled || measured >= 2.0) {
+			if (!toggled) {
+				std::cout << modeName(cullMode) << ": " << measured * 1000.0 / measuredFrames << " ms per frame, " << cubesDrawn / measuredFrames
+					<< " of " << cubeModels.size() << " cubes drawn";
+				if (cullMode == Cull_mode::OCCLUSION) {
+					double total = (double)cubeModels.size() * measuredFrames;
+					std::cout << ", culled " << 100.0 * (cubesOccluded + cubesOffScreen) / total << "% (" << 100.0 * cubesOccluded / total
+						<< "% occluded, " << 100.0 * cubesOffScreen / total << "% off screen), rasterizer " << rasterMs / measuredFrames
+						<< " ms CPU for " << occluders / measuredFrames << " occluders, " << triangles / measuredFrames << " triangles, test "
+						<< testMs / measuredFrames << " ms CPU";
+				}
+				std::cout << std::endl;
+			}
+			measuredMode = cullMode;
+			measuredFrames = 0;
+			cubesDrawn = 0;
+			cubesOccluded = 0;
+			cubesOffScreen = 0;
+			occluders = 0;
+			triangles = 0;
+			rasterMs = 0.0;
+			testMs = 0.0;
+			measureStart = glfwGetTime();
+		}
+	}
+
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &VAO);
+	glfwTerminate();
+}
+
+
+void fixFrameBufferResize(GLFWwindow* window, int width, int height)
+{
+	glViewport(0, 0, width, height);
+}
+
+void processInput(GLFWwindow* window)
+{
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, true);
+}
+
+void keyPress(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	if (action != GLFW_PRESS)
+		return;
+	if (key == GLFW_KEY_1)
+		cullMode = Cull_mode::NONE;
+	else if (key == GLFW_KEY_2)
+		cullMode = Cull_mode::OCCLUSION;
+}
+
+const char* modeName(Cull_mode mode)
+{
+	switch (mode) {
+	case Cull_mode::NONE:
+		return "No culling";
+	default:
+		return "Occlusion culling";
+	}
 }
\ No newline at end of file
@@ -0,0 +1,226 @@
+#ifndef CASCADED_SHADOW_MAP_H
+#define CASCADED_SHADOW_MAP_H
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+#include "Camera.h"
+
+/* Bounding sphere of a shadow caster */
+struct Caster_bounds {
+	glm::vec3 center;
+	float radius;
+};
+
+/* Shadow map of a directional light in cascades along the camera view.
+The view distance between the camera near and far planes is split with the practical split
+scheme, a blend of logarithmic and uniform splits, and every slice of the view frustum gets a
+layer of a depth texture array fitted around it. The fit is a sphere so its size stays the same
+when the camera turns, and its center moves in whole texels of the light space so the shadow
+edges don't shimmer when the camera moves. Each cascade only draws the casters inside its
+light space bounds, picked on the CPU */
+class CascadedShadowMap
+{
+public:
+	/* The shaders declare their arrays with this size */
+	static const int MaxCascades = 4;
+
+	/* Constructor and destructor */
+	CascadedShadowMap(int cascades, int size, float splitLambda);
+	~CascadedShadowMap() noexcept;
+
+	/* Fit the cascades to the camera for a light shining along lightDirection */
+	void Update(const Camera& camera, float aspect, const glm::vec3& lightDirection);
+	/* Pick the casters of every cascade and pull the cascade depth range towards the light to
+	include them. With culling off every cascade takes all casters */
+	void Cull(const std::vector<Caster_bounds>& casters, bool culling);
+	/* Render into the layer of the cascade, sets the viewport */
+	void BindForWriting(int cascade) const;
+	void Bind(int unit) const;
+
+	/* Get functions */
+	/* Indices into the casters of the last Cull() that the cascade draws */
+	const std::vector<unsigned int>& Casters(int cascade) const;
+	const glm::mat4& LightSpace(int cascade) const;
+	/* Distance along the view direction where the cascade ends */
+	float SplitDistance(int cascade) const;
+
+public:
+	const int Cascades;
+	const int Size;
+	/* 0 gives uniform splits, 1 logarithmic ones */
+	float SplitLambda;
+
+private:
+	struct Cascade {
+		/* Bounding sphere of the frustum slice, the center in light view space and snapped to texels */
+		glm::vec3 center;
+		float radius;
+		float splitDistance;
+		glm::mat4 lightSpace;
+		std::vector<unsigned int> casters;
+	};
+private:
+	unsigned int texture;
+	/* One per layer */
+	std::vector<unsigned int> framebuffers;
+	glm::mat4 lightView;
+	std::vector<Cascade> cascades;
+};
+
+
+CascadedShadowMap::CascadedShadowMap(int cascades = MaxCascades, int size = 2048, float splitLambda = 0.75f)
+	: Cascades(std::min(std::max(cascades, 1), MaxCascades)), Size(size), SplitLambda(splitLambda), lightView(1.0f), cascades(Cascades)
+{
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, Size, Size, Cascades, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+	/* Depth comparison in the sampler, linear filtering then blends four comparisons */
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	/* Everything outside a cascade is lit */
+	const float border[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+	glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, border);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	for (int layer = 0; layer < Cascades; layer++) {
+		unsigned int framebuffer;
+		glGenFramebuffers(1, &framebuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, texture, 0, layer);
+		/* Depth only */
+		glDrawBuffer(GL_NONE);
+		glReadBuffer(GL_NONE);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+			std::cout << "ERROR::CASCADED_SHADOW_MAP::FRAMEBUFFER_INCOMPLETE" << std::endl;
+		framebuffers.push_back(framebuffer);
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+CascadedShadowMap::~CascadedShadowMap() noexcept
+{
+	glDeleteFramebuffers((GLsizei)framebuffers.size(), framebuffers.data());
+	glDeleteTextures(1, &texture);
+}
+
+void CascadedShadowMap::Update(const Camera& camera, float aspect, const glm::vec3& lightDirection)
+{
+	glm::vec3 forward = glm::normalize(lightDirection);
+	/* Any up vector that isn't parallel to the light */
+	glm::vec3 up = std::abs(forward.y) > 0.99f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+	/* Through the world origin instead of the camera, so the texel grid stays in place */
+	lightView = glm::lookAt(glm::vec3(0.0f), forward, up);
+
+	float nearPlane = camera.NearPlane, farPlane = camera.FarPlane;
+	float tanY = std::tan(glm::radians(camera.Zoom) / 2.0f), tanX = tanY * aspect;
+	float previous = nearPlane;
+	for (int i = 0; i < Cascades; i++) {
+		float ratio = (float)(i + 1) / Cascades;
+		float logSplit = nearPlane * std::pow(farPlane / nearPlane, ratio);
+		float uniformSplit = nearPlane + (farPlane - nearPlane) * ratio;
+		float split = SplitLambda * logSplit + (1.0f - SplitLambda) * uniformSplit;
+
+		/* Corners of the frustum slice */
+		glm::vec3 corners[8];
+		int corner = 0;
+		for (float distance : { previous, split }) {
+			glm::vec3 middle = camera.Position + camera.Front * distance;
+			glm::vec3 right = camera.Right * tanX * distance, top = camera.Up * tanY * distance;
+			corners[corner++] = middle - right - top;
+			corners[corner++] = middle + right - top;
+			corners[corner++] = middle - right + top;
+			corners[corner++] = middle + right + top;
+		}
+		glm::vec3 sliceCenter(0.0f);
+		for (const glm::vec3& point : corners)
+			sliceCenter += point / 8.0f;
+		float radius = 0.0f;
+		for (const glm::vec3& point : corners)
+			radius = std::max(radius, glm::length(point - sliceCenter));
+		/* Rounded up, float noise would change the texel size from frame to frame */
+		radius = std::ceil(radius * 16.0f) / 16.0f;
+
+		Cascade& cascade = cascades[i];
+		cascade.center = glm::vec3(lightView * glm::vec4(sliceCenter, 1.0f));
+		float texel = 2.0f * radius / Size;
+		cascade.center.x = std::floor(cascade.center.x / texel) * texel;
+		cascade.center.y = std::floor(cascade.center.y / texel) * texel;
+		cascade.radius = radius;
+		cascade.splitDistance = split;
+		previous = split;
+	}
+}
+
+void CascadedShadowMap::Cull(const std::vector<Caster_bounds>& casters, bool culling = true)
+{
+	/* Light view space, the light looks down -z */
+	std::vector<glm::vec4> lightCasters;
+	lightCasters.reserve(casters.size());
+	for (const Caster_bounds& caster : casters)
+		lightCasters.push_back(glm::vec4(glm::vec3(lightView * glm::vec4(caster.center, 1.0f)), caster.radius));
+
+	for (Cascade& cascade : cascades) {
+		cascade.casters.clear();
+		/* Nearest to the light, the receivers at least */
+		float nearest = cascade.center.z + cascade.radius;
+		float farthest = cascade.center.z - cascade.radius;
+		for (unsigned int i = 0; i < lightCasters.size(); i++) {
+			const glm::vec4& caster = lightCasters[i];
+			if (culling) {
+				/* Outside the cascade seen from the light */
+				float reach = cascade.radius + caster.w;
+				if (std::abs(caster.x - cascade.center.x) > reach || std::abs(caster.y - cascade.center.y) > reach)
+					continue;
+				/* Behind everything the cascade shades */
+				if (caster.z + caster.w < farthest)
+					continue;
+			}
+			nearest = std::max(nearest, caster.z + caster.w);
+			cascade.casters.push_back(i);
+		}
+
+		glm::mat4 projection = glm::ortho(cascade.center.x - cascade.radius, cascade.center.x + cascade.radius,
+			cascade.center.y - cascade.radius, cascade.center.y + cascade.radius, -nearest, -farthest);
+		cascade.lightSpace = projection * lightView;
+	}
+}
+
+void CascadedShadowMap::BindForWriting(int cascade) const
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffers[cascade]);
+	glViewport(0, 0, Size, Size);
+}
+
+void CascadedShadowMap::Bind(int unit) const
+{
+	glActiveTexture(GL_TEXTURE0 + unit);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+}
+
+inline const std::vector<unsigned int>& CascadedShadowMap::Casters(int cascade) const
+{
+	return cascades[cascade].casters;
+}
+
+inline const glm::mat4& CascadedShadowMap::LightSpace(int cascade) const
+{
+	return cascades[cascade].lightSpace;
+}
+
+inline float CascadedShadowMap::SplitDistance(int cascade) const
+{
+	return cascades[cascade].splitDistance;
+}
+
+#endif
@@ -0,0 +1,442 @@
+#include "glad/glad.h"
+#include "GLFW/glfw3.h"
+
+#include "stb_image.h"
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+#include "Shader.h"
+#include "Camera.h"
+#include "CascadedShadowMap.h"
+#include "GpuTimer.h"
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <chrono>
+#include <string>
+#include <algorithm>
+
+
+void processInput(GLFWwindow* window);
+void frameBufferResize_callback(GLFWwindow* window, int width, int height);
+void mouseMovement_callback(GLFWwindow* window, double xPos, double yPos);
+void mouseScroll_callback(GLFWwindow* window, double xOffset, double yOffset);
+void keyPress_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+
+unsigned int loadTexture(const char* path);
+void bindInstances(size_t firstInstance);
+glm::vec3 sunDirection(float angle);
+
+
+const int winWidth = 800;
+const int winHeight = 600;
+
+/************************************ CAMERA ************************************/
+Camera camera({ 0.0f, 6.0f, 0.0f });
+
+float lastX = winWidth / 2;
+float lastY = winHeight / 2;
+bool firstMouseMove = true;
+
+/************************************ FRAMES ************************************/
+float deltaTime = 0.0f;
+float lastFrame = 0.0f;
+
+/************************************ SHADOWS ************************************/
+/* K turns the sun a step around the vertical */
+float sunAngle = 0.6f;
+/* V tints the cascades */
+bool showCascades = false;
+/* N toggles the per cascade caster culling, without it every cascade draws every caster */
+bool casterCulling = true;
+
+/************************************ SCENE ************************************/
+/* Boxes scattered over a square field of this half size */
+const float fieldSize = 200.0f;
+const unsigned int boxCount = 4000;
+
+
+int main()
+{
+	/************************************ INITIALIZATION ************************************/
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+	GLFWwindow* window = glfwCreateWindow(winWidth, winHeight, "Cascaded shadow maps", NULL, NULL);
+	if (window == NULL) {
+		std::cout << "ERROR::GLFW::INITIALIZATION_FAILED" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		std::cout << "ERROR::GLAD::INITIALIZATION_FAILED" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glViewport(0, 0, winWidth, winHeight);
+	/* Measure the shadows, not the display refresh */
+	glfwSwapInterval(0);
+
+	glfwSetFramebufferSizeCallback(window, frameBufferResize_callback);
+	glfwSetCursorPosCallback(window, mouseMovement_callback);
+	glfwSetScrollCallback(window, mouseScroll_callback);
+	glfwSetKeyCallback(window, keyPress_callback);
+
+	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+	/* Outdoors, walking at box speed would take forever */
+	camera.MoveSpeed = 15.0f;
+	camera.FarPlane = 250.0f;
+
+	/************************************ POSITIONS ************************************/
+	float cubeVertices[] = {
+		/*	  Positions			Normals		  TextureCoords	*/
+		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
+
+		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
+
+		-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+		-0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
+		-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
+		-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+
+		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+
+		-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  1.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  0.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
+
+		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  1.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  0.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f
+	};
+
+	/************************************ OBJECTS ************************************/
+	/* Positions, sizes and turns of the boxes, like the cubePositions of the basic demos */
+	std::vector<glm::vec3> cubePositions, cubeSizes;
+	std::vector<float> cubeAngles;
+	std::mt19937 random(17);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	for (unsigned int i = 0; i < boxCount; i++) {
+		glm::vec3 size(1.0f + 3.0f * unit(random), 1.0f + 11.0f * unit(random) * unit(random), 1.0f + 3.0f * unit(random));
+		cubeSizes.push_back(size);
+		cubePositions.push_back(glm::vec3((unit(random) * 2.0f - 1.0f) * fieldSize, size.y / 2.0f, (unit(random) * 2.0f - 1.0f) * fieldSize));
+		cubeAngles.push_back(unit(random) * 90.0f);
+	}
+
+	/* The ground only receives shadows, it is the first instance and not a caster */
+	std::vector<glm::mat4> boxes;
+	boxes.push_back(glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -0.5f, 0.0f)), glm::vec3(fieldSize * 2.0f, 1.0f, fieldSize * 2.0f)));
+	std::vector<Caster_bounds> casterBounds;
+	for (unsigned int i = 0; i < boxCount; i++) {
+		glm::mat4 model = glm::translate(glm::mat4(1.0f), cubePositions[i]);
+		model = glm::rotate(model, glm::radians(cubeAngles[i]), glm::vec3(0.0f, 1.0f, 0.0f));
+		boxes.push_back(glm::scale(model, cubeSizes[i]));
+		casterBounds.push_back(Caster_bounds{ cubePositions[i], glm::length(cubeSizes[i]) / 2.0f });
+	}
+
+	/************************************ BUFFERS ************************************/
+	unsigned int VBO, boxVBO, casterVBO;
+	glGenBuffers(1, &VBO);
+	glGenBuffers(1, &boxVBO);
+	glGenBuffers(1, &casterVBO);
+
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), cubeVertices, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, boxVBO);
+	glBufferData(GL_ARRAY_BUFFER, boxes.size() * sizeof(glm::mat4), boxes.data(), GL_STATIC_DRAW);
+
+	/* Every box for the camera */
+	unsigned int boxVAO;
+	glGenVertexArrays(1, &boxVAO);
+	glBindVertexArray(boxVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+	glEnableVertexAttribArray(2);
+	glBindBuffer(GL_ARRAY_BUFFER, boxVBO);
+	bindInstances(0);
+
+	/* The casters of all cascades one after the other, refilled every frame */
+	unsigned int casterVAO;
+	glGenVertexArrays(1, &casterVAO);
+	glBindVertexArray(casterVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, casterVBO);
+	bindInstances(0);
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	/************************************ TEXTURES ************************************/
+	unsigned int diffuseMap = loadTexture("textures/container2.png");
+	unsigned int specularMap = loadTexture("textures/container2_specular.png");
+
+	/************************************ SHADOW MAP ************************************/
+	CascadedShadowMap shadowMap(4, 2048, 0.75f);
+
+	/************************************ SHADERS ************************************/
+	Shader objectShader("shaders/shader.vs", "shaders/shader.fs");
+	Shader depthShader("shaders/shadowDepth.vs", "shaders/shadowDepth.fs");
+	objectShader.use();
+	objectShader.setInt("material.diffuse", 0);
+	objectShader.setInt("material.specular", 1);
+	objectShader.setFloat("material.shininess", 32.0f);
+	objectShader.setInt("shadowMap", 2);
+	objectShader.setInt("cascadeCount", shadowMap.Cascades);
+	objectShader.setVec3("sun.ambient", 0.15f, 0.15f, 0.18f);
+	objectShader.setVec3("sun.diffuse", 0.8f, 0.75f, 0.7f);
+	objectShader.setVec3("sun.specular", 0.3f, 0.3f, 0.3f);
+
+	/************************************ RENDER LOOP ************************************/
+	glEnable(GL_DEPTH_TEST);
+	std::cout << boxes.size() - 1 << " boxes on a " << fieldSize * 2.0f << " wide field, " << shadowMap.Cascades
+		<< " cascades. V shows the cascades, N toggles the caster culling, K turns the sun" << std::endl;
+
+	GpuTimer shadowTimer;
+	std::vector<glm::mat4> casterInstances;
+	std::vector<size_t> castersDrawn(shadowMap.Cascades, 0);
+	double cullMs = 0.0;
+	bool measuredCulling = casterCulling;
+	unsigned int measuredFrames = 0;
+	double measureStart = glfwGetTime();
+	lastFrame = glfwGetTime();
+	while (!glfwWindowShouldClose(window)) {
+		float currentFrame = glfwGetTime();
+		deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+
+		processInput(window);
+
+		/* Fit the cascades and pick their casters */
+		int width, height;
+		glfwGetFramebufferSize(window, &width, &height);
+		float aspect = (float)width / std::max(height, 1);
+		auto cullStart = std::chrono::steady_clock::now();
+		shadowMap.Update(camera, aspect, sunDirection(sunAngle));
+		shadowMap.Cull(casterBounds, casterCulling);
+		casterInstances.clear();
+		for (int cascade = 0; cascade < shadowMap.Cascades; cascade++) {
+			/* Caster i is box i + 1, after the ground */
+			for (unsigned int caster : shadowMap.Casters(cascade))
+				casterInstances.push_back(boxes[caster + 1]);
+			castersDrawn[cascade] += shadowMap.Casters(cascade).size();
+		}
+		cullMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - cullStart).count();
+
+		glBindBuffer(GL_ARRAY_BUFFER, casterVBO);
+		glBufferData(GL_ARRAY_BUFFER, casterInstances.size() * sizeof(glm::mat4), casterInstances.data(), GL_STREAM_DRAW);
+
+		/* Cascades */
+		shadowTimer.Begin();
+		depthShader.use();
+		glBindVertexArray(casterVAO);
+		size_t firstInstance = 0;
+		for (int cascade = 0; cascade < shadowMap.Cascades; cascade++) {
+			shadowMap.BindForWriting(cascade);
+			glClear(GL_DEPTH_BUFFER_BIT);
+			depthShader.setMat4f("lightSpace", shadowMap.LightSpace(cascade));
+			/* GL 3.3 has no base instance, the instance attributes start at the cascade's casters instead */
+			bindInstances(firstInstance);
+			glDrawArraysInstanced(GL_TRIANGLES, 0, 36, (GLsizei)shadowMap.Casters(cascade).size());
+			firstInstance += shadowMap.Casters(cascade).size();
+		}
+		shadowTimer.End();
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		/* Scene */
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glViewport(0, 0, width, height);
+		glClearColor(0.5f, 0.65f, 0.8f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		objectShader.use();
+		objectShader.setMat4f("view", camera.GetViewMatrix());
+		objectShader.setMat4f("projection", camera.GetProjectionMatrix(aspect));
+		objectShader.setVec3("viewPos", camera.Position);
+		objectShader.setVec3("viewFront", camera.Front);
+		objectShader.setVec3("sun.direction", sunDirection(sunAngle));
+		objectShader.setBool("showCascades", showCascades);
+		for (int cascade = 0; cascade < shadowMap.Cascades; cascade++) {
+			objectShader.setFloat("cascadeSplits[" + std::to_string(cascade) + "]", shadowMap.SplitDistance(cascade));
+			objectShader.setMat4f("lightSpaces[" + std::to_string(cascade) + "]", shadowMap.LightSpace(cascade));
+		}
+
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, diffuseMap);
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, specularMap);
+		shadowMap.Bind(2);
+
+		glBindVertexArray(boxVAO);
+		glDrawArraysInstanced(GL_TRIANGLES, 0, 36, (GLsizei)boxes.size());
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+
+		/* Averages over two seconds, restarted when the culling is toggled */
+		measuredFrames++;
+		double measured = glfwGetTime() - measureStart;
+		if (measuredCulling != casterCulling || measured >= 2.0) {
+			if (measuredCulling == casterCulling) {
+				std::cout << (casterCulling ? "Culled" : "All") << " casters: " << measured * 1000.0 / measuredFrames << " ms per frame, "
+					<< shadowTimer.AverageMs() << " ms GPU for the cascades, " << cullMs / measuredFrames << " ms CPU fitting and culling" << std::endl;
+				for (int cascade = 0; cascade < shadowMap.Cascades; cascade++)
+					std::cout << "  cascade " << cascade << " to " << shadowMap.SplitDistance(cascade) << ": "
+						<< castersDrawn[cascade] / measuredFrames << " of " << casterBounds.size() << " casters drawn" << std::endl;
+			}
+			measuredCulling = casterCulling;
+			measuredFrames = 0;
+			cullMs = 0.0;
+			std::fill(castersDrawn.begin(), castersDrawn.end(), 0);
+			shadowTimer.Reset();
+			measureStart = glfwGetTime();
+		}
+	}
+
+	glDeleteVertexArrays(1, &boxVAO);
+	glDeleteVertexArrays(1, &casterVAO);
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &boxVBO);
+	glDeleteBuffers(1, &casterVBO);
+	glDeleteTextures(1, &diffuseMap);
+	glDeleteTextures(1, &specularMap);
+	glfwTerminate();
+}
+
+
+void processInput(GLFWwindow* window)
+{
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, true);
+	if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
+		deltaTime *= 2;
+	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::FORWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::BACKWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::LEFT, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::RIGHT, deltaTime);
+}
+
+void keyPress_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	if (action != GLFW_PRESS)
+		return;
+	if (key == GLFW_KEY_V)
+		showCascades = !showCascades;
+	else if (key == GLFW_KEY_N)
+		casterCulling = !casterCulling;
+	else if (key == GLFW_KEY_K)
+		sunAngle += 0.2f;
+}
+
+void frameBufferResize_callback(GLFWwindow* window, int width, int height)
+{
+	glViewport(0, 0, width, height);
+}
+
+void mouseMovement_callback(GLFWwindow* window, double xPos, double yPos)
+{
+	if (firstMouseMove) {
+		lastX = xPos;
+		lastY = yPos;
+		firstMouseMove = false;
+	}
+
+	float xOffset = (float)xPos - lastX;
+	float yOffset = lastY - (float)yPos;
+	lastX = xPos;
+	lastY = yPos;
+
+	camera.ProcessMouseMovement(xOffset, yOffset);
+}
+
+void mouseScroll_callback(GLFWwindow* window, double xOffset, double yOffset)
+{
+	camera.ProcessMouseScroll(yOffset);
+}
+
+unsigned int loadTexture(const char* path)
+{
+	unsigned int textureID;
+	glGenTextures(1, &textureID);
+
+	int width, height, nrComponents;
+	unsigned char* data = stbi_load(path, &width, &height, &nrComponents, 0);
+	if (data) {
+		/* See which color format the texture uses */
+		GLenum format;
+		if (nrComponents == 1)
+			format = GL_RED;
+		else if (nrComponents == 3)
+			format = GL_RGB;
+		else if (nrComponents == 4)
+			format = GL_RGBA;
+
+		glBindTexture(GL_TEXTURE_2D, textureID);
+		glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+		glGenerateMipmap(GL_TEXTURE_2D);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	}
+	else
+		std::cout << "Texture failed to load at path: " << path << std::endl;
+	stbi_image_free(data);
+
+	return textureID;
+}
+void bindInstances(size_t firstInstance)
+{
+	/* Model matrix per instance as 4 column attributes, from the bound array buffer */
+	for (unsigned int column = 0; column < 4; column++) {
+		glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(firstInstance * sizeof(glm::mat4) + column * sizeof(glm::vec4)));
+		glEnableVertexAttribArray(3 + column);
+		glVertexAttribDivisor(3 + column, 1);
+	}
+}
+
+glm::vec3 sunDirection(float angle)
+{
+	return glm::vec3(std::cos(angle) * 0.6f, -1.0f, std::sin(angle) * 0.6f);
+}
@@ -0,0 +1,88 @@
+#version 330 core
+// CascadedShadowMap::MaxCascades
+#define MAX_CASCADES 4
+
+struct Material {
+  sampler2D diffuse;
+  sampler2D specular;
+  float shininess;
+};
+
+struct DirLight {
+  vec3 direction;
+
+  vec3 ambient;
+  vec3 diffuse;
+  vec3 specular;
+};
+
+out vec4 fragColor;
+
+in vec3 Normal;
+in vec3 fragPos;
+in vec2 texCoords;
+
+uniform vec3 viewPos;
+// camera direction, the cascades are split along it
+uniform vec3 viewFront;
+uniform Material material;
+uniform DirLight sun;
+
+uniform int cascadeCount;
+uniform float cascadeSplits[MAX_CASCADES];
+uniform mat4 lightSpaces[MAX_CASCADES];
+uniform sampler2DArrayShadow shadowMap;
+// tints every cascade in its own color
+uniform bool showCascades;
+
+int findCascade()
+{
+  float depth = dot(fragPos - viewPos, viewFront);
+  for (int i = 0; i < cascadeCount - 1; i++)
+    if (depth < cascadeSplits[i])
+      return i;
+  return cascadeCount - 1;
+}
+
+// share of the fragment the sun reaches, 3x3 taps of the filtered comparison
+float sunShadow(int cascade, vec3 norm, vec3 lightDir)
+{
+  vec4 lightCoords = lightSpaces[cascade] * vec4(fragPos, 1.0);
+  vec3 coords = lightCoords.xyz / lightCoords.w * 0.5 + 0.5;
+  if (coords.z > 1.0)
+    return 1.0;
+  // farther cascades have bigger texels and need more bias
+  float bias = max(0.002 * (1.0 - dot(norm, lightDir)), 0.0005) * (1.0 + cascade);
+  vec2 texel = 1.0 / vec2(textureSize(shadowMap, 0));
+  float lit = 0.0;
+  for (int x = -1; x <= 1; x++)
+    for (int y = -1; y <= 1; y++)
+      lit += texture(shadowMap, vec4(coords.xy + vec2(x, y) * texel, cascade, coords.z - bias));
+  return lit / 9.0;
+}
+
+void main()
+{
+  vec3 norm = normalize(Normal);
+  vec3 lightDir = normalize(-sun.direction);
+  vec3 viewDir = normalize(viewPos - fragPos);
+  vec3 diffuseColor = vec3(texture(material.diffuse, texCoords));
+
+  // ambient same as diffuse
+  vec3 ambient = sun.ambient * diffuseColor;
+
+  float diff = max(dot(norm, lightDir), 0.0);
+  vec3 diffuse = sun.diffuse * diff * diffuseColor;
+
+  vec3 reflectDir = reflect(-lightDir, norm);
+  float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+  vec3 specular = sun.specular * spec * vec3(texture(material.specular, texCoords));
+
+  int cascade = findCascade();
+  vec3 result = ambient + sunShadow(cascade, norm, lightDir) * (diffuse + specular);
+  if (showCascades) {
+    const vec3 tints[MAX_CASCADES] = vec3[](vec3(1.0, 0.4, 0.4), vec3(0.4, 1.0, 0.4), vec3(0.4, 0.4, 1.0), vec3(1.0, 1.0, 0.4));
+    result *= tints[cascade];
+  }
+  fragColor = vec4(result, 1.0);
+}
@@ -0,0 +1,6 @@
+#version 330 core
+
+// the sun shadow map keeps the rasterized depth
+void main()
+{
+}
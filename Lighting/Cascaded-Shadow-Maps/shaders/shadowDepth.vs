@@ -0,0 +1,12 @@
+#version 330 core
+layout (location = 0) in vec3 aPosition;
+// per instance
+layout (location = 3) in mat4 aModel;
+
+// projection and view of the cascade
+uniform mat4 lightSpace;
+
+void main()
+{
+  gl_Position = lightSpace * aModel * vec4(aPosition, 1.0);
+}
@@ -0,0 +1,140 @@
+#ifndef MATERIAL_LIBRARY_H
+#define MATERIAL_LIBRARY_H
+
+#include <iostream>
+#include <vector>
+
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+
+/* Phong material */
+struct Material {
+	glm::vec3 ambient;
+	glm::vec3 diffuse;
+	glm::vec3 specular;
+	float shininess;
+};
+
+/* Materials in one uniform buffer.
+Every material owns a range of the buffer, written when the material is added or edited and
+not in between. A draw binds the range of its material to the Material block (see
+shaders/object.fs) with glBindBufferRange instead of setting four uniforms. Nothing else
+may bind a buffer to the library's binding point, Bind() skips ranges it bound last */
+class MaterialLibrary
+{
+public:
+	/* Constructor and destructor */
+	MaterialLibrary(unsigned int capacity, unsigned int binding);
+	~MaterialLibrary() noexcept;
+
+	/* Store the material, returns its index or -1 when the capacity is used */
+	int Add(const Material& material);
+	/* Replace the material at the index and rewrite its range */
+	void Set(unsigned int index, const Material& material);
+	/* Bind the range of the material at the index for the next draws */
+	void Bind(unsigned int index);
+
+	/* Get functions */
+	const Material& Get(unsigned int index) const;
+	unsigned int Count() const noexcept;
+
+public:
+	/* Uniform buffer binding point of the Material block */
+	const unsigned int Binding;
+	const unsigned int Capacity;
+	/* Bytes between two materials, the block size rounded up to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT */
+	GLintptr Stride;
+	/* Statistics */
+	unsigned int Uploads;
+	unsigned int Binds;
+
+private:
+	/* std140 layout of the Material block */
+	struct Gpu_material {
+		glm::vec4 ambient;
+		glm::vec4 diffuse;
+		/* xyz specular, w shininess */
+		glm::vec4 specular;
+	};
+
+	/* Helper functions */
+	void upload(unsigned int index);
+private:
+	std::vector<Material> materials;
+	unsigned int buffer;
+	/* Index of the bound range, -1 before the first Bind() */
+	int bound;
+};
+
+
+MaterialLibrary::MaterialLibrary(unsigned int capacity, unsigned int binding = 0)
+	: Binding(binding), Capacity(capacity), Stride(sizeof(Gpu_material)), Uploads(0), Binds(0), bound(-1)
+{
+	/* Range offsets have to be multiples of the alignment, 256 bytes on most desktop drivers */
+	GLint alignment = 1;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	Stride = (Stride + alignment - 1) / alignment * alignment;
+
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+	glBufferData(GL_UNIFORM_BUFFER, Stride * capacity, NULL, GL_STATIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	materials.reserve(capacity);
+}
+
+MaterialLibrary::~MaterialLibrary() noexcept
+{
+	glDeleteBuffers(1, &buffer);
+}
+
+int MaterialLibrary::Add(const Material& material)
+{
+	if (materials.size() >= Capacity) {
+		std::cout << "ERROR::MATERIAL_LIBRARY::FULL\n" << Capacity << " materials" << std::endl;
+		return -1;
+	}
+	materials.push_back(material);
+	upload((unsigned int)materials.size() - 1);
+	return (int)materials.size() - 1;
+}
+
+inline void MaterialLibrary::Set(unsigned int index, const Material& material)
+{
+	materials[index] = material;
+	upload(index);
+}
+
+inline void MaterialLibrary::Bind(unsigned int index)
+{
+	if ((int)index == bound)
+		return;
+	glBindBufferRange(GL_UNIFORM_BUFFER, Binding, buffer, Stride * index, sizeof(Gpu_material));
+	bound = (int)index;
+	Binds++;
+}
+
+inline const Material& MaterialLibrary::Get(unsigned int index) const
+{
+	return materials[index];
+}
+
+inline unsigned int MaterialLibrary::Count() const noexcept
+{
+	return (unsigned int)materials.size();
+}
+
+void MaterialLibrary::upload(unsigned int index)
+{
+	const Material& material = materials[index];
+	Gpu_material packed;
+	packed.ambient = glm::vec4(material.ambient, 0.0f);
+	packed.diffuse = glm::vec4(material.diffuse, 0.0f);
+	packed.specular = glm::vec4(material.specular, material.shininess);
+
+	glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+	glBufferSubData(GL_UNIFORM_BUFFER, Stride * index, sizeof(Gpu_material), &packed);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	Uploads++;
+}
+
+#endif
@@ -25,6 +25,7 @@ public:
 	void setMat4(const std::string& name, const glm::mat4& val) const;
 	void setVec3(const std::string& name, const glm::vec3& val) const;
 	void setVec3(const std::string& name, float x, float y, float z) const;
+	void setUniformBlock(const std::string& name, unsigned int binding) const;
 private:
 	unsigned int ID;
 };
@@ -137,4 +138,11 @@ inline void Shader::setVec3(const std::string& name, float x, float y, float z)
 	glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
 }
 
+inline void Shader::setUniformBlock(const std::string& name, unsigned int binding) const
+{
+	unsigned int index = glGetUniformBlockIndex(ID, name.c_str());
+	if (index != GL_INVALID_INDEX)
+		glUniformBlockBinding(ID, index, binding);
+}
+
 #endif
\ No newline at end of file
@@ -8,8 +8,11 @@
 
 #include "Shader.h"
 #include "Camera.h"
+#include "MaterialLibrary.h"
 
 #include <iostream>
+#include <vector>
+#include <cmath>
 
 /************************************** WINDOW VARIABLES **************************************/
 const int winWidth = 800;
@@ -28,6 +31,25 @@ float lastFrame = 0.0f;
 /************************************** LIGHT **************************************/
 glm::vec3 lightPos(1.2f, 1.0f, 2.0f);
 
+/************************************** MATERIALS **************************************/
+/* Binding point of the Material block */
+const unsigned int materialBinding = 0;
+/* Coral in the middle, the classic metals and gems around it */
+const Material materialTable[] = {
+	{ { 1.0f, 0.5f, 0.31f }, { 1.0f, 0.5f, 0.31f }, { 0.5f, 0.5f, 0.5f }, 32.0f },
+	{ { 0.0215f, 0.1745f, 0.0215f }, { 0.07568f, 0.61424f, 0.07568f }, { 0.633f, 0.727811f, 0.633f }, 0.6f * 128.0f },
+	{ { 0.135f, 0.2225f, 0.1575f }, { 0.54f, 0.89f, 0.63f }, { 0.316228f, 0.316228f, 0.316228f }, 0.1f * 128.0f },
+	{ { 0.05375f, 0.05f, 0.06625f }, { 0.18275f, 0.17f, 0.22525f }, { 0.332741f, 0.328634f, 0.346435f }, 0.3f * 128.0f },
+	{ { 0.25f, 0.20725f, 0.20725f }, { 1.0f, 0.829f, 0.829f }, { 0.296648f, 0.296648f, 0.296648f }, 0.088f * 128.0f },
+	{ { 0.1745f, 0.01175f, 0.01175f }, { 0.61424f, 0.04136f, 0.04136f }, { 0.727811f, 0.626959f, 0.626959f }, 0.6f * 128.0f },
+	{ { 0.24725f, 0.1995f, 0.0745f }, { 0.75164f, 0.60648f, 0.22648f }, { 0.628281f, 0.555802f, 0.366065f }, 0.4f * 128.0f },
+	{ { 0.0f, 0.1f, 0.06f }, { 0.0f, 0.50980392f, 0.50980392f }, { 0.50196078f, 0.50196078f, 0.50196078f }, 0.25f * 128.0f }
+};
+const unsigned int materialCount = sizeof(materialTable) / sizeof(materialTable[0]);
+/* Edited with M, the edit rewrites its range once */
+int coralMaterial = -1;
+MaterialLibrary* materials = nullptr;
+
 /************************************** PROCESS FUNCTIONS **************************************/
 void processInput(GLFWwindow* window);
 
@@ -35,6 +57,7 @@ void processInput(GLFWwindow* window);
 void frameBufferResize_callback(GLFWwindow* window, int width, int height);
 void mouseMovement_callback(GLFWwindow* window, double xPos, double yPos);
 void mouseScroll_callback(GLFWwindow* window, double xOffset, double yOffset);
+void keyPress_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
 
 
 int main()
@@ -62,6 +85,7 @@ int main()
 	glfwSetFramebufferSizeCallback(window, frameBufferResize_callback);
 	glfwSetCursorPosCallback(window, mouseMovement_callback);
 	glfwSetScrollCallback(window, mouseScroll_callback);
+	glfwSetKeyCallback(window, keyPress_callback);
 
 	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
@@ -136,6 +160,17 @@ int main()
 	/************************************** SHADERS **************************************/
 	Shader objectShader("shaders/object.vs", "shaders/object.fs");
 	Shader lightShader("shaders/lightSource.vs", "shaders/lightSource.fs");
+	objectShader.setUniformBlock("Material", materialBinding);
+
+	/************************************** MATERIALS **************************************/
+	/* Written once here, the draws only bind their ranges */
+	MaterialLibrary materialLibrary(materialCount, materialBinding);
+	materials = &materialLibrary;
+	std::vector<int> cubeMaterials;
+	for (const Material& material : materialTable)
+		cubeMaterials.push_back(materialLibrary.Add(material));
+	coralMaterial = cubeMaterials[0];
+	std::cout << materialLibrary.Count() << " materials in one uniform buffer, " << materialLibrary.Stride << " bytes apart" << std::endl;
 
 	/************************************** RENDER LOOP **************************************/
 	glEnable(GL_DEPTH_TEST);
@@ -162,29 +197,32 @@ int main()
 		glm::vec3 ambientColor = lightColor * glm::vec3(0.2f);
 		glm::vec3 diffuseColor = lightColor * glm::vec3(0.5f);
 
-		/* Object uniforms */
+		/* Object uniforms, the same for every cube */
 		objectShader.use();
-		objectShader.setVec3("material.ambient", 1.0f, 0.5f, 0.31f);
-		objectShader.setVec3("material.diffuse", 1.0f, 0.5f, 0.31f);
-		objectShader.setVec3("material.specular", 0.5f, 0.5f, 0.5f);
-		objectShader.setFloat("material.shininess", 32.0f);
 		objectShader.setVec3("light.ambient", ambientColor);
 		objectShader.setVec3("light.diffuse", diffuseColor);
 		objectShader.setVec3("light.specular", 1.0f, 1.0f, 1.0f);
 		objectShader.setVec3("light.position", lightPos);
 		objectShader.setVec3("viewPos", camera.Position);
-		glm::mat4 model = glm::mat4(1.0f);
-		objectShader.setMat4("model", model);
 		objectShader.setMat4("view", view);
 		objectShader.setMat4("projection", projection);
-		/* Render the object */
+		/* Render the objects, the coral one in the middle and the others on a ring behind it */
 		glBindVertexArray(VAO);
-		glDrawArrays(GL_TRIANGLES, 0, 36);
+		for (unsigned int i = 0; i < cubeMaterials.size(); i++) {
+			glm::mat4 model = glm::mat4(1.0f);
+			if (i > 0) {
+				float angle = glm::radians(360.0f * (i - 1) / (cubeMaterials.size() - 1));
+				model = glm::translate(model, glm::vec3(std::cos(angle) * 2.5f, std::sin(angle) * 1.5f, -2.0f));
+			}
+			objectShader.setMat4("model", model);
+			materialLibrary.Bind(cubeMaterials[i]);
+			glDrawArrays(GL_TRIANGLES, 0, 36);
+		}
 
 		/* Light uniforms */
 		lightShader.use();
 		lightShader.setVec3("lightColor", lightColor);
-		model = glm::mat4(1.0f);
+		glm::mat4 model = glm::mat4(1.0f);
 		model = glm::translate(model, lightPos);
 		model = glm::scale(model, glm::vec3(0.2f));
 		lightShader.setMat4("model", model);
@@ -207,6 +245,7 @@ int main()
 	glDeleteVertexArrays(1, &VAO);
 	glDeleteVertexArrays(1, &lightVAO);
 	glDeleteBuffers(1, &VBO);
+	materials = nullptr;
 	glfwTerminate();
 }
 
@@ -254,4 +293,19 @@ void mouseMovement_callback(GLFWwindow* window, double xPos, double yPos)
 void mouseScroll_callback(GLFWwindow* window, double xOffset, double yOffset)
 {
 	camera.ProcessMouseScroll(yOffset);
-}
\ No newline at end of file
+}
+
+void keyPress_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	if (action != GLFW_PRESS || !materials)
+		return;
+
+	if (key == GLFW_KEY_M) {
+		/* Cycle the coral's shininess, the only upload after the start */
+		Material coral = materials->Get(coralMaterial);
+		coral.shininess = coral.shininess >= 256.0f ? 2.0f : coral.shininess * 2.0f;
+		materials->Set(coralMaterial, coral);
+		std::cout << "Coral shininess " << coral.shininess << ", " << materials->Uploads << " material uploads, "
+			<< materials->Binds << " range binds so far" << std::endl;
+	}
+}
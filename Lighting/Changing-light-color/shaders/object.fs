@@ -1,13 +1,6 @@
 #version 330 core
 
 // structs
-struct Material {
-  vec3 ambient;
-  vec3 diffuse;
-  vec3 specular;
-  float shininess;
-};
-
 struct Light {
   vec3 position;
 
@@ -25,9 +18,16 @@ in vec3 fragPos;
 
 // uniforms
 uniform vec3 viewPos;
-uniform Material material;
 uniform Light light;
 
+// the range of the drawn material in the MaterialLibrary buffer
+layout (std140) uniform Material {
+  vec3 ambient;
+  vec3 diffuse;
+  vec3 specular;
+  float shininess;
+} material;
+
 void main()
 {
   // ambient
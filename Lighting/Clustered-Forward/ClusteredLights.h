@@ -0,0 +1,364 @@
+#ifndef CLUSTERED_LIGHTS_H
+#define CLUSTERED_LIGHTS_H
+
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CLUSTERED_LIGHTS_SSE2
+#endif
+
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+
+#include "LightSystem.h"
+#include "ThreadPool.h"
+
+/* Light lists per froxel for clustered forward shading.
+The view frustum is cut into TilesX x TilesY screen tiles and Slices depth slices, spaced
+exponentially so the froxels stay about as deep as they are wide. Assign() tests the range
+sphere of every point and spot light against the view space bounding box of each froxel and
+stores the hits as one index list per froxel, the fragment shader then only evaluates the lights
+of its froxel. Directional lights reach everything, they are kept apart and go to every fragment.
+The data reaches the shaders through three texture buffers, see shaders/shader.fs */
+class ClusteredLights
+{
+public:
+	/* Lights per froxel, the rest is dropped and counted in Overflows */
+	static const unsigned int MaxLightsPerCluster = 256;
+
+	/* Constructor and destructor */
+	ClusteredLights(int tilesX, int tilesY, int slices, ThreadPool* pool);
+	~ClusteredLights() noexcept;
+
+	/* Only pack the lights for the shaders, enough when they loop over all of them */
+	void PackLights(const std::vector<Light>& lights);
+	/* Pack the lights and build the froxel light lists for the camera. fovY in degrees */
+	void Assign(const std::vector<Light>& lights, const glm::mat4& view, float fovY, float aspect, float zNear, float zFar);
+	/* Upload the lights and lists of the last Assign() */
+	void Upload();
+	/* Bind the light, cluster and index buffers to the texture units */
+	void Bind(int lightsUnit, int clustersUnit, int indicesUnit) const;
+
+	/* Get functions */
+	unsigned int ClusterCount() const noexcept;
+	/* Directional lights come first in the light buffer */
+	unsigned int DirectionalCount() const noexcept;
+	unsigned int LightCount() const noexcept;
+	/* Factors turning the view depth into the slice, slice = log(depth) * scale + bias */
+	float SliceScale() const noexcept;
+	float SliceBias() const noexcept;
+
+public:
+	const int TilesX;
+	const int TilesY;
+	const int Slices;
+	/* Statistics of the last Assign() */
+	double AssignMs;
+	/* Entries of all index lists */
+	unsigned int IndexCount;
+	unsigned int Overflows;
+
+private:
+	/* Bounds of the froxels of one slice, structure of arrays padded to a multiple of 4 for SSE */
+	struct Slice_bounds {
+		std::vector<float> minX, minY, maxX, maxY;
+		float minZ, maxZ;
+	};
+
+	/* Helper functions */
+	/* Recompute the froxel bounds when the projection changed */
+	void updateBounds(float fovY, float aspect, float zNear, float zFar);
+	/* Fill the lists of the froxels of one slice */
+	void assignSlice(int slice);
+	void createBuffer(unsigned int& buffer, unsigned int& texture, GLenum format);
+private:
+	ThreadPool* pool;
+	std::vector<Slice_bounds> bounds;
+	float fovY, aspect, zNear, zFar;
+	/* View space spheres of the point and spot lights, structure of arrays */
+	std::vector<float> centerX, centerY, centerZ, radius;
+	/* Index in the light buffer of each sphere */
+	std::vector<unsigned short> sphereLight;
+	/* The light of each sphere in the vector given to PackLights */
+	std::vector<unsigned int> sphereSource;
+	/* Per froxel, MaxLightsPerCluster slots each while assigning */
+	std::vector<unsigned short> slots;
+	std::vector<unsigned int> slotCounts;
+	/* Uploaded data - 4 texels per light, offset and count per froxel, the index lists */
+	std::vector<glm::vec4> lightData;
+	std::vector<unsigned int> clusterData;
+	std::vector<unsigned short> indices;
+	unsigned int directionalCount;
+	unsigned int lightBuffer, clusterBuffer, indexBuffer;
+	unsigned int lightTexture, clusterTexture, indexTexture;
+};
+
+
+ClusteredLights::ClusteredLights(int tilesX = 16, int tilesY = 9, int slices = 24, ThreadPool* pool = nullptr)
+	: TilesX(tilesX), TilesY(tilesY), Slices(slices), AssignMs(0.0), IndexCount(0), Overflows(0), pool(pool), fovY(0.0f),
+	aspect(0.0f), zNear(0.0f), zFar(0.0f), directionalCount(0)
+{
+	createBuffer(lightBuffer, lightTexture, GL_RGBA32F);
+	createBuffer(clusterBuffer, clusterTexture, GL_RG32UI);
+	createBuffer(indexBuffer, indexTexture, GL_R16UI);
+	slots.resize((size_t)ClusterCount() * MaxLightsPerCluster);
+	slotCounts.resize(ClusterCount());
+}
+
+ClusteredLights::~ClusteredLights() noexcept
+{
+	unsigned int buffers[] = { lightBuffer, clusterBuffer, indexBuffer };
+	unsigned int textures[] = { lightTexture, clusterTexture, indexTexture };
+	glDeleteBuffers(3, buffers);
+	glDeleteTextures(3, textures);
+}
+
+void ClusteredLights::PackLights(const std::vector<Light>& lights)
+{
+	/* Directional lights first, the shader applies them without a list */
+	lightData.clear();
+	sphereLight.clear();
+	sphereSource.clear();
+	directionalCount = 0;
+	for (int pass = 0; pass < 2; pass++) {
+		for (size_t i = 0; i < lights.size(); i++) {
+			const Light& light = lights[i];
+			if ((light.type == Light_type::DIRECTIONAL) != (pass == 0))
+				continue;
+			if (pass == 0)
+				directionalCount++;
+			else {
+				sphereLight.push_back((unsigned short)(lightData.size() / 4));
+				sphereSource.push_back((unsigned int)i);
+			}
+
+			/* Same packing as the Light block of LightSystem */
+			glm::vec3 direction = glm::length(light.direction) > 0.0f ? glm::normalize(light.direction) : glm::vec3(0.0f, -1.0f, 0.0f);
+			lightData.push_back(glm::vec4(light.position, light.range));
+			lightData.push_back(glm::vec4(direction, std::cos(glm::radians(light.outerCutoff))));
+			lightData.push_back(glm::vec4(light.color, std::cos(glm::radians(light.innerCutoff))));
+			lightData.push_back(glm::vec4((float)light.type, 0.0f, 0.0f, 0.0f));
+		}
+	}
+}
+
+void ClusteredLights::Assign(const std::vector<Light>& lights, const glm::mat4& view, float fovY, float aspect, float zNear, float zFar)
+{
+	auto start = std::chrono::steady_clock::now();
+	updateBounds(fovY, aspect, zNear, zFar);
+	PackLights(lights);
+
+	/* The spot cones fit into their range spheres, good enough for froxels */
+	size_t sphereCount = sphereSource.size();
+	centerX.resize(sphereCount);
+	centerY.resize(sphereCount);
+	centerZ.resize(sphereCount);
+	radius.resize(sphereCount);
+	for (size_t sphere = 0; sphere < sphereCount; sphere++) {
+		const Light& light = lights[sphereSource[sphere]];
+		glm::vec3 center = glm::vec3(view * glm::vec4(light.position, 1.0f));
+		centerX[sphere] = center.x;
+		centerY[sphere] = center.y;
+		centerZ[sphere] = center.z;
+		radius[sphere] = light.range;
+	}
+
+	/* Slices are independent, every one writes only the slots of its froxels */
+	if (pool)
+		pool->ParallelFor((unsigned int)Slices, [this](unsigned int begin, unsigned int end) {
+			for (unsigned int slice = begin; slice < end; slice++)
+				assignSlice((int)slice);
+		});
+	else
+		for (int slice = 0; slice < Slices; slice++)
+			assignSlice(slice);
+
+	/* Pack the slots into one list */
+	clusterData.resize((size_t)ClusterCount() * 2);
+	indices.clear();
+	Overflows = 0;
+	for (unsigned int cluster = 0; cluster < ClusterCount(); cluster++) {
+		unsigned int count = std::min(slotCounts[cluster], MaxLightsPerCluster);
+		if (slotCounts[cluster] > MaxLightsPerCluster)
+			Overflows++;
+		clusterData[cluster * 2] = (unsigned int)indices.size();
+		clusterData[cluster * 2 + 1] = count;
+		const unsigned short* first = &slots[(size_t)cluster * MaxLightsPerCluster];
+		indices.insert(indices.end(), first, first + count);
+	}
+	IndexCount = (unsigned int)indices.size();
+
+	AssignMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ClusteredLights::Upload()
+{
+	/* Orphan and refill, the buffers change every frame. Empty ones keep a few bytes, the textures need storage */
+	glBindBuffer(GL_TEXTURE_BUFFER, lightBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, std::max<size_t>(lightData.size() * sizeof(glm::vec4), 16), lightData.data(), GL_STREAM_DRAW);
+	/* Unchanged since the last Assign() when only the lights were packed */
+	if (!clusterData.empty()) {
+		glBindBuffer(GL_TEXTURE_BUFFER, clusterBuffer);
+		glBufferData(GL_TEXTURE_BUFFER, clusterData.size() * sizeof(unsigned int), clusterData.data(), GL_STREAM_DRAW);
+		glBindBuffer(GL_TEXTURE_BUFFER, indexBuffer);
+		glBufferData(GL_TEXTURE_BUFFER, std::max<size_t>(indices.size() * sizeof(unsigned short), 16), indices.empty() ? NULL : indices.data(),
+			GL_STREAM_DRAW);
+		clusterData.clear();
+	}
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void ClusteredLights::Bind(int lightsUnit, int clustersUnit, int indicesUnit) const
+{
+	glActiveTexture(GL_TEXTURE0 + lightsUnit);
+	glBindTexture(GL_TEXTURE_BUFFER, lightTexture);
+	glActiveTexture(GL_TEXTURE0 + clustersUnit);
+	glBindTexture(GL_TEXTURE_BUFFER, clusterTexture);
+	glActiveTexture(GL_TEXTURE0 + indicesUnit);
+	glBindTexture(GL_TEXTURE_BUFFER, indexTexture);
+}
+
+inline unsigned int ClusteredLights::ClusterCount() const noexcept
+{
+	return (unsigned int)(TilesX * TilesY * Slices);
+}
+
+inline unsigned int ClusteredLights::DirectionalCount() const noexcept
+{
+	return directionalCount;
+}
+
+inline unsigned int ClusteredLights::LightCount() const noexcept
+{
+	return (unsigned int)(lightData.size() / 4);
+}
+
+inline float ClusteredLights::SliceScale() const noexcept
+{
+	return Slices / std::log(zFar / zNear);
+}
+
+inline float ClusteredLights::SliceBias() const noexcept
+{
+	return -Slices * std::log(zNear) / std::log(zFar / zNear);
+}
+
+void ClusteredLights::updateBounds(float fovY, float aspect, float zNear, float zFar)
+{
+	if (fovY == this->fovY && aspect == this->aspect && zNear == this->zNear && zFar == this->zFar)
+		return;
+	this->fovY = fovY;
+	this->aspect = aspect;
+	this->zNear = zNear;
+	this->zFar = zFar;
+
+	/* Half extents of the view plane at depth 1 */
+	float halfHeight = std::tan(glm::radians(fovY) / 2.0f);
+	float halfWidth = halfHeight * aspect;
+	int tiles = TilesX * TilesY;
+	int padded = (tiles + 3) / 4 * 4;
+
+	bounds.assign(Slices, Slice_bounds());
+	for (int slice = 0; slice < Slices; slice++) {
+		Slice_bounds& slab = bounds[slice];
+		float nearDepth = zNear * std::pow(zFar / zNear, (float)slice / Slices);
+		float farDepth = zNear * std::pow(zFar / zNear, (float)(slice + 1) / Slices);
+		/* The camera looks down -z */
+		slab.minZ = -farDepth;
+		slab.maxZ = -nearDepth;
+		/* Padding boxes are empty, nothing hits them */
+		slab.minX.assign(padded, 1e30f);
+		slab.minY.assign(padded, 1e30f);
+		slab.maxX.assign(padded, -1e30f);
+		slab.maxY.assign(padded, -1e30f);
+
+		for (int y = 0; y < TilesY; y++) {
+			for (int x = 0; x < TilesX; x++) {
+				/* The tile edges on the view plane, scaled to both ends of the slice */
+				float left = (-1.0f + 2.0f * x / TilesX) * halfWidth, right = (-1.0f + 2.0f * (x + 1) / TilesX) * halfWidth;
+				float bottom = (-1.0f + 2.0f * y / TilesY) * halfHeight, top = (-1.0f + 2.0f * (y + 1) / TilesY) * halfHeight;
+				int tile = y * TilesX + x;
+				slab.minX[tile] = std::min(left * nearDepth, left * farDepth);
+				slab.maxX[tile] = std::max(right * nearDepth, right * farDepth);
+				slab.minY[tile] = std::min(bottom * nearDepth, bottom * farDepth);
+				slab.maxY[tile] = std::max(top * nearDepth, top * farDepth);
+			}
+		}
+	}
+}
+
+void ClusteredLights::assignSlice(int slice)
+{
+	const Slice_bounds& slab = bounds[slice];
+	int tiles = TilesX * TilesY;
+	unsigned int firstCluster = (unsigned int)(slice * tiles);
+	std::fill(slotCounts.begin() + firstCluster, slotCounts.begin() + firstCluster + tiles, 0u);
+
+	for (size_t light = 0; light < radius.size(); light++) {
+		float cx = centerX[light], cy = centerY[light], cz = centerZ[light], r = radius[light];
+		/* Depth is the same for the whole slice */
+		float dz = std::max(slab.minZ - cz, 0.0f) + std::max(cz - slab.maxZ, 0.0f);
+		float rest = r * r - dz * dz;
+		if (rest < 0.0f)
+			continue;
+		unsigned short index = sphereLight[light];
+
+		int tile = 0;
+#if defined(CLUSTERED_LIGHTS_SSE2)
+		/* Squared distance from the sphere center to 4 boxes at once */
+		__m128 x = _mm_set1_ps(cx), y = _mm_set1_ps(cy), limit = _mm_set1_ps(rest), zero = _mm_setzero_ps();
+		for (; tile < tiles; tile += 4) {
+			__m128 dx = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&slab.minX[tile]), x), zero),
+				_mm_max_ps(_mm_sub_ps(x, _mm_loadu_ps(&slab.maxX[tile])), zero));
+			__m128 dy = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&slab.minY[tile]), y), zero),
+				_mm_max_ps(_mm_sub_ps(y, _mm_loadu_ps(&slab.maxY[tile])), zero));
+			__m128 distance = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+			int hits = _mm_movemask_ps(_mm_cmple_ps(distance, limit));
+			while (hits) {
+				int lane = 0;
+				while (!(hits & (1 << lane)))
+					lane++;
+				hits &= ~(1 << lane);
+				/* Padding lanes never hit, their boxes are empty */
+				unsigned int cluster = firstCluster + tile + lane;
+				unsigned int& count = slotCounts[cluster];
+				if (count < MaxLightsPerCluster)
+					slots[(size_t)cluster * MaxLightsPerCluster + count] = index;
+				count++;
+			}
+		}
+#else
+		for (; tile < tiles; tile++) {
+			float dx = std::max(slab.minX[tile] - cx, 0.0f) + std::max(cx - slab.maxX[tile], 0.0f);
+			float dy = std::max(slab.minY[tile] - cy, 0.0f) + std::max(cy - slab.maxY[tile], 0.0f);
+			if (dx * dx + dy * dy > rest)
+				continue;
+			unsigned int cluster = firstCluster + tile;
+			unsigned int& count = slotCounts[cluster];
+			if (count < MaxLightsPerCluster)
+				slots[(size_t)cluster * MaxLightsPerCluster + count] = index;
+			count++;
+		}
+#endif
+	}
+}
+
+void ClusteredLights::createBuffer(unsigned int& buffer, unsigned int& texture, GLenum format)
+{
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+	glBufferData(GL_TEXTURE_BUFFER, 16, NULL, GL_STREAM_DRAW);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	/* The texture views the buffer, refilling the buffer updates it */
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_BUFFER, texture);
+	glTexBuffer(GL_TEXTURE_BUFFER, format, buffer);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+#endif
@@ -0,0 +1,183 @@
+#ifndef LIGHT_SYSTEM_H
+#define LIGHT_SYSTEM_H
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <algorithm>
+
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+
+/* Light kinds, the values are what the shaders switch on */
+enum class Light_type {
+	DIRECTIONAL = 0,
+	POINT = 1,
+	SPOT = 2
+};
+
+/* One light of the scene */
+struct Light {
+	Light_type type;
+	/* Point and spot */
+	glm::vec3 position;
+	/* Directional and spot, points away from the light */
+	glm::vec3 direction;
+	glm::vec3 color;
+	/* Point and spot, the light fades out to nothing at this distance */
+	float range;
+	/* Spot, cone angles in degrees */
+	float innerCutoff;
+	float outerCutoff;
+};
+
+/* Scene lights in a uniform buffer.
+Every shader that declares the Lights block (see shaders/shader.fs) reads all lights from
+the same buffer, so a light is set once and not as separate uniforms per program. The
+buffer is rewritten with a single call in Upload(), and only in frames where a light
+changed */
+class LightSystem
+{
+public:
+	/* 64 bytes per light, 256 lights fill the 16384 bytes GL guarantees for GL_MAX_UNIFORM_BLOCK_SIZE.
+	The light count rides in the first light, see Gpu_light. The Lights block of the shaders has to match */
+	static const unsigned int MaxLights = 256;
+
+	/* Constructor and destructor */
+	LightSystem(unsigned int binding);
+	~LightSystem() noexcept;
+
+	/* Append the light, returns its index or -1 when MaxLights are used */
+	int Add(const Light& light);
+	/* Replace the light at the index */
+	void Set(unsigned int index, const Light& light);
+	void Clear();
+	/* Upload the lights if any changed since the last call, true if it did */
+	bool Upload();
+
+	/* Get functions */
+	const Light& Get(unsigned int index) const;
+	unsigned int Count() const noexcept;
+
+public:
+	/* Uniform buffer binding point of the Lights block */
+	const unsigned int Binding;
+	/* Statistics */
+	unsigned int Uploads;
+	size_t UploadedBytes;
+
+private:
+	/* std140 layout of the Light struct of the Lights block */
+	struct Gpu_light {
+		/* xyz position, w range */
+		glm::vec4 position;
+		/* xyz direction, w cosine of the outer cutoff */
+		glm::vec4 direction;
+		/* rgb color, w cosine of the inner cutoff */
+		glm::vec4 color;
+		/* x type. y of the first light is the light count, a separate count would push the block past 16 KB */
+		glm::ivec4 type;
+	};
+	/* The whole Lights block */
+	struct Gpu_lights {
+		Gpu_light lights[MaxLights];
+	};
+
+	/* Helper functions */
+	static Gpu_light pack(const Light& light);
+private:
+	std::vector<Light> lights;
+	std::unique_ptr<Gpu_lights> staging;
+	unsigned int buffer;
+	bool dirty;
+};
+
+
+LightSystem::LightSystem(unsigned int binding = 0)
+	: Binding(binding), Uploads(0), UploadedBytes(0), staging(new Gpu_lights()), dirty(true)
+{
+	/* GL 3.3 only guarantees 16 KB per block, desktop drivers give 64 KB */
+	GLint maxBlockSize = 0;
+	glGetIntegerv(GL_MAX_UNIFORM_BLOCK_SIZE, &maxBlockSize);
+	if ((size_t)maxBlockSize < sizeof(Gpu_lights))
+		std::cout << "ERROR::LIGHT_SYSTEM::BLOCK_TOO_LARGE\n" << sizeof(Gpu_lights) << " bytes, the limit is " << maxBlockSize << std::endl;
+
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(Gpu_lights), NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, Binding, buffer);
+	lights.reserve(MaxLights);
+}
+
+LightSystem::~LightSystem() noexcept
+{
+	glDeleteBuffers(1, &buffer);
+}
+
+int LightSystem::Add(const Light& light)
+{
+	if (lights.size() >= MaxLights)
+		return -1;
+	lights.push_back(light);
+	dirty = true;
+	return (int)lights.size() - 1;
+}
+
+inline void LightSystem::Set(unsigned int index, const Light& light)
+{
+	lights[index] = light;
+	dirty = true;
+}
+
+inline void LightSystem::Clear()
+{
+	lights.clear();
+	dirty = true;
+}
+
+bool LightSystem::Upload()
+{
+	if (!dirty)
+		return false;
+
+	for (size_t i = 0; i < lights.size(); i++)
+		staging->lights[i] = pack(lights[i]);
+	staging->lights[0].type.y = (int)lights.size();
+
+	/* Only the used part, the shaders never read past the count. The first light goes even without lights, it holds the count */
+	size_t bytes = std::max(lights.size(), (size_t)1) * sizeof(Gpu_light);
+	glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, bytes, staging.get());
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	Uploads++;
+	UploadedBytes += bytes;
+	dirty = false;
+	return true;
+}
+
+inline const Light& LightSystem::Get(unsigned int index) const
+{
+	return lights[index];
+}
+
+inline unsigned int LightSystem::Count() const noexcept
+{
+	return (unsigned int)lights.size();
+}
+
+LightSystem::Gpu_light LightSystem::pack(const Light& light)
+{
+	Gpu_light gpu;
+	gpu.position = glm::vec4(light.position, light.range);
+	/* Point lights may leave the direction zero */
+	glm::vec3 direction = glm::length(light.direction) > 0.0f ? glm::normalize(light.direction) : glm::vec3(0.0f, -1.0f, 0.0f);
+	gpu.direction = glm::vec4(direction, std::cos(glm::radians(light.outerCutoff)));
+	gpu.color = glm::vec4(light.color, std::cos(glm::radians(light.innerCutoff)));
+	gpu.type = glm::ivec4((int)light.type, 0, 0, 0);
+	return gpu;
+}
+
+#endif
@@ -0,0 +1,508 @@
+#include "glad/glad.h"
+#include "GLFW/glfw3.h"
+
+#include "stb_image.h"
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+#include "Shader.h"
+#include "Camera.h"
+#include "ClusteredLights.h"
+#include "GpuTimer.h"
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+
+/* Circle a light moves on */
+struct Light_motion {
+	glm::vec3 center;
+	float radius;
+	/* Radians per second */
+	float speed;
+	float phase;
+};
+
+/* One measured configuration of the sweep */
+struct Benchmark_step {
+	unsigned int lightCount;
+	bool clustered;
+	/* Results */
+	double frameMs;
+	double assignMs;
+	double shadingMs;
+	float lightsPerCluster;
+};
+
+void processInput(GLFWwindow* window);
+void frameBufferResize_callback(GLFWwindow* window, int width, int height);
+void mouseMovement_callback(GLFWwindow* window, double xPos, double yPos);
+void mouseScroll_callback(GLFWwindow* window, double xOffset, double yOffset);
+void keyPress_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+
+unsigned int loadTexture(const char* path);
+void makeLights(unsigned int count, float extent, std::vector<Light>& lights, std::vector<Light_motion>& motions);
+void moveLights(std::vector<Light>& lights, const std::vector<Light_motion>& motions, float time);
+
+
+const int winWidth = 800;
+const int winHeight = 600;
+
+/************************************ CAMERA ************************************/
+Camera camera({ 0.0f, 12.0f, 50.0f });
+
+float lastX = winWidth / 2;
+float lastY = winHeight / 2;
+bool firstMouseMove = true;
+
+/************************************ FRAMES ************************************/
+float deltaTime = 0.0f;
+float lastFrame = 0.0f;
+
+/************************************ LIGHTING ************************************/
+/* Switched with the 1 (brute force) and 2 (clustered) keys */
+bool clusteredShading = true;
+/* Point and spot lights besides the moon, switched with the 3, 4 and 5 keys */
+unsigned int lightCount = 256;
+/* Every fourth light is a spot */
+const unsigned int spotEvery = 4;
+const float lightRange = 5.0f;
+/* Froxel grid, 16:9 tiles and exponential slices */
+const int clusterTilesX = 16;
+const int clusterTilesY = 9;
+const int clusterSlices = 24;
+const float zNear = 0.1f;
+const float zFar = 200.0f;
+
+/************************************ BENCHMARK ************************************/
+/* Measure brute force and clustered shading at 16, 256 and 4096 lights on startup, then print a table */
+const bool benchmarkSweep = true;
+/* Seconds per configuration, the first half second is not measured */
+const double benchmarkStepTime = 2.5;
+
+/************************************ SCENE ************************************/
+const int gridSize = 32;
+const float gridSpacing = 2.6f;
+
+
+int main()
+{
+	/************************************ INITIALIZATION ************************************/
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+	GLFWwindow* window = glfwCreateWindow(winWidth, winHeight, "Clustered forward", NULL, NULL);
+	if (window == NULL) {
+		std::cout << "ERROR::GLFW::INITIALIZATION_FAILED" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		std::cout << "ERROR::GLAD::INITIALIZATION_FAILED" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glViewport(0, 0, winWidth, winHeight);
+	/* Measure the lighting, not the display refresh */
+	glfwSwapInterval(0);
+
+	glfwSetFramebufferSizeCallback(window, frameBufferResize_callback);
+	glfwSetCursorPosCallback(window, mouseMovement_callback);
+	glfwSetScrollCallback(window, mouseScroll_callback);
+	glfwSetKeyCallback(window, keyPress_callback);
+
+	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+	/************************************ POSITIONS ************************************/
+	float cubeVertices[] = {
+		/*	  Positions			Normals		  TextureCoords	*/
+		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
+
+		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
+
+		-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+		-0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
+		-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
+		-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+
+		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+
+		-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  1.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  0.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
+
+		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  1.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  0.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f
+	};
+
+	/************************************ OBJECTS ************************************/
+	/* A floor and a grid of boxes of random height */
+	std::vector<glm::mat4> boxes;
+	float extent = gridSize * gridSpacing;
+	boxes.push_back(glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -0.25f, 0.0f)), glm::vec3(extent, 0.5f, extent)));
+	std::mt19937 random(11);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	for (int z = 0; z < gridSize; z++) {
+		for (int x = 0; x < gridSize; x++) {
+			float height = 0.5f + 2.5f * unit(random);
+			glm::vec3 position((x - (gridSize - 1) / 2.0f) * gridSpacing, height / 2.0f, (z - (gridSize - 1) / 2.0f) * gridSpacing);
+			boxes.push_back(glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(1.0f, height, 1.0f)));
+		}
+	}
+
+	/************************************ BUFFERS ************************************/
+	unsigned int cubeVAO, VBO, boxVBO;
+	glGenVertexArrays(1, &cubeVAO);
+	glGenBuffers(1, &VBO);
+	glGenBuffers(1, &boxVBO);
+
+	glBindVertexArray(cubeVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), cubeVertices, GL_STATIC_DRAW);
+
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+	glEnableVertexAttribArray(2);
+
+	/* Model matrix per instance as 4 column attributes */
+	glBindBuffer(GL_ARRAY_BUFFER, boxVBO);
+	glBufferData(GL_ARRAY_BUFFER, boxes.size() * sizeof(glm::mat4), boxes.data(), GL_STATIC_DRAW);
+	for (unsigned int column = 0; column < 4; column++) {
+		glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(column * sizeof(glm::vec4)));
+		glEnableVertexAttribArray(3 + column);
+		glVertexAttribDivisor(3 + column, 1);
+	}
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	/************************************ LIGHTS ************************************/
+	std::vector<Light> lights;
+	std::vector<Light_motion> motions;
+	unsigned int madeLightCount = lightCount;
+	makeLights(lightCount, extent, lights, motions);
+
+	ThreadPool workers(ThreadPool::DefaultThreadCount());
+	ClusteredLights clusters(clusterTilesX, clusterTilesY, clusterSlices, &workers);
+
+	/************************************ TEXTURES ************************************/
+	unsigned int diffuseMap = loadTexture("textures/container2.png");
+	unsigned int specularMap = loadTexture("textures/container2_specular.png");
+
+	/************************************ SHADERS ************************************/
+	Shader lightingShader("shaders/shader.vs", "shaders/shader.fs");
+	lightingShader.use();
+	lightingShader.setVec3("ambient", 0.03f, 0.03f, 0.03f);
+	lightingShader.setInt("material.diffuse", 0);
+	lightingShader.setInt("material.specular", 1);
+	lightingShader.setFloat("material.shininess", 32.0f);
+	lightingShader.setInt("lightData", 2);
+	lightingShader.setInt("clusterData", 3);
+	lightingShader.setInt("lightIndices", 4);
+
+	/************************************ RENDER LOOP ************************************/
+	glEnable(GL_DEPTH_TEST);
+	std::cout << boxes.size() << " boxes, " << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+	std::cout << "1 - brute force, 2 - clustered, 3/4/5 - 16/256/4096 lights" << std::endl;
+
+	std::vector<Benchmark_step> sweep;
+	if (benchmarkSweep) {
+		for (unsigned int count : { 16u, 256u, 4096u }) {
+			sweep.push_back(Benchmark_step{ count, false, 0.0, 0.0, 0.0, 0.0f });
+			sweep.push_back(Benchmark_step{ count, true, 0.0, 0.0, 0.0, 0.0f });
+		}
+	}
+	size_t sweepStep = 0;
+
+	GpuTimer shadingTimer;
+	unsigned int measuredFrames = 0;
+	double measuredAssignMs = 0.0, measuredIndices = 0.0;
+	double measureStart = glfwGetTime();
+	float lightTime = 0.0f;
+	lastFrame = glfwGetTime();
+	while (!glfwWindowShouldClose(window)) {
+		float currentFrame = glfwGetTime();
+		deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+
+		processInput(window);
+
+		if (sweepStep < sweep.size()) {
+			lightCount = sweep[sweepStep].lightCount;
+			clusteredShading = sweep[sweepStep].clustered;
+		}
+		if (madeLightCount != lightCount) {
+			makeLights(lightCount, extent, lights, motions);
+			madeLightCount = lightCount;
+		}
+		lightTime += deltaTime;
+		moveLights(lights, motions, lightTime);
+
+		/* View and projection transformations */
+		glm::mat4 view = camera.GetViewMatrix();
+		/* The framebuffer's size, the window may have been resized */
+		int width, height;
+		glfwGetFramebufferSize(window, &width, &height);
+		width = std::max(width, 1);
+		height = std::max(height, 1);
+		float aspect = (float)width / height;
+		glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), aspect, zNear, zFar);
+
+		/* Brute force only needs the light data, the froxel lists are the clustered path's CPU cost */
+		if (clusteredShading) {
+			clusters.Assign(lights, view, camera.Zoom, aspect, zNear, zFar);
+			measuredAssignMs += clusters.AssignMs;
+			measuredIndices += clusters.IndexCount;
+		}
+		else
+			clusters.PackLights(lights);
+		clusters.Upload();
+
+		glClearColor(0.02f, 0.02f, 0.02f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		lightingShader.use();
+		lightingShader.setMat4f("view", view);
+		lightingShader.setMat4f("projection", projection);
+		lightingShader.setVec3("viewPos", camera.Position);
+		lightingShader.setBool("clustered", clusteredShading);
+		lightingShader.setInt("directionalCount", (int)clusters.DirectionalCount());
+		lightingShader.setInt("lightCount", (int)clusters.LightCount());
+		lightingShader.setIvec3("clusterCounts", clusterTilesX, clusterTilesY, clusterSlices);
+		lightingShader.setVec2("tileSize", (float)width / clusterTilesX, (float)height / clusterTilesY);
+		lightingShader.setFloat("sliceScale", clusters.SliceScale());
+		lightingShader.setFloat("sliceBias", clusters.SliceBias());
+
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, diffuseMap);
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, specularMap);
+		clusters.Bind(2, 3, 4);
+
+		/* GPU time of the lit geometry, what the light lists save */
+		shadingTimer.Begin();
+		glBindVertexArray(cubeVAO);
+		glDrawArraysInstanced(GL_TRIANGLES, 0, 36, (GLsizei)boxes.size());
+		shadingTimer.End();
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+
+		/* Averages over the measured time, restarted when the configuration changes */
+		double measured = glfwGetTime() - measureStart;
+		if (measured < 0.0) {
+			/* Still settling */
+			measuredFrames = 0;
+			measuredAssignMs = measuredIndices = 0.0;
+			shadingTimer.Reset();
+			continue;
+		}
+		measuredFrames++;
+		double period = sweepStep < sweep.size() ? benchmarkStepTime - 0.5 : 2.0;
+		if (measured >= period) {
+			double frameMs = measured * 1000.0 / measuredFrames;
+			double assignMs = measuredAssignMs / measuredFrames;
+			float lightsPerCluster = (float)(measuredIndices / measuredFrames / clusters.ClusterCount());
+			double shadingMs = shadingTimer.AverageMs();
+			std::cout << lightCount << " lights, " << (clusteredShading ? "clustered" : "brute force") << ": " << frameMs << " ms per frame, "
+				<< shadingMs << " ms shading";
+			if (clusteredShading)
+				std::cout << ", " << assignMs << " ms assigning, " << lightsPerCluster << " lights per cluster"
+				<< (clusters.Overflows ? ", some clusters overflowed" : "");
+			std::cout << std::endl;
+
+			if (sweepStep < sweep.size()) {
+				sweep[sweepStep].frameMs = frameMs;
+				sweep[sweepStep].assignMs = assignMs;
+				sweep[sweepStep].shadingMs = shadingMs;
+				sweep[sweepStep].lightsPerCluster = lightsPerCluster;
+				if (++sweepStep == sweep.size()) {
+					std::cout << std::endl << std::setw(8) << "Lights" << std::setw(14) << "Mode" << std::setw(12) << "Frame ms"
+						<< std::setw(14) << "Shading ms" << std::setw(14) << "Assign ms" << std::setw(18) << "Lights/cluster" << std::endl;
+					for (const Benchmark_step& step : sweep)
+						std::cout << std::setw(8) << step.lightCount << std::setw(14) << (step.clustered ? "clustered" : "brute force")
+						<< std::setw(12) << step.frameMs << std::setw(14) << step.shadingMs << std::setw(14) << step.assignMs
+						<< std::setw(18) << step.lightsPerCluster << std::endl;
+				}
+			}
+
+			measuredFrames = 0;
+			measuredAssignMs = measuredIndices = 0.0;
+			shadingTimer.Reset();
+			/* Let a new configuration settle before measuring it */
+			measureStart = glfwGetTime() + (sweepStep < sweep.size() ? 0.5 : 0.0);
+		}
+	}
+
+	glDeleteVertexArrays(1, &cubeVAO);
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &boxVBO);
+	glDeleteTextures(1, &diffuseMap);
+	glDeleteTextures(1, &specularMap);
+	glfwTerminate();
+}
+
+
+void processInput(GLFWwindow* window)
+{
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, true);
+	if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
+		deltaTime *= 2;
+	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::FORWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::BACKWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::LEFT, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::RIGHT, deltaTime);
+}
+
+void keyPress_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	if (action != GLFW_PRESS)
+		return;
+	if (key == GLFW_KEY_1)
+		clusteredShading = false;
+	else if (key == GLFW_KEY_2)
+		clusteredShading = true;
+	else if (key == GLFW_KEY_3)
+		lightCount = 16;
+	else if (key == GLFW_KEY_4)
+		lightCount = 256;
+	else if (key == GLFW_KEY_5)
+		lightCount = 4096;
+}
+
+void frameBufferResize_callback(GLFWwindow* window, int width, int height)
+{
+	glViewport(0, 0, width, height);
+}
+
+void mouseMovement_callback(GLFWwindow* window, double xPos, double yPos)
+{
+	if (firstMouseMove) {
+		lastX = xPos;
+		lastY = yPos;
+		firstMouseMove = false;
+	}
+
+	float xOffset = (float)xPos - lastX;
+	float yOffset = lastY - (float)yPos;
+	lastX = xPos;
+	lastY = yPos;
+
+	camera.ProcessMouseMovement(xOffset, yOffset);
+}
+
+void mouseScroll_callback(GLFWwindow* window, double xOffset, double yOffset)
+{
+	camera.ProcessMouseScroll(yOffset);
+}
+
+unsigned int loadTexture(const char* path)
+{
+	unsigned int textureID;
+	glGenTextures(1, &textureID);
+
+	int width, height, nrComponents;
+	unsigned char* data = stbi_load(path, &width, &height, &nrComponents, 0);
+	if (data) {
+		/* See which color format the texture uses */
+		GLenum format;
+		if (nrComponents == 1)
+			format = GL_RED;
+		else if (nrComponents == 3)
+			format = GL_RGB;
+		else if (nrComponents == 4)
+			format = GL_RGBA;
+
+		glBindTexture(GL_TEXTURE_2D, textureID);
+		glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+		glGenerateMipmap(GL_TEXTURE_2D);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	}
+	else
+		std::cout << "Texture failed to load at path: " << path << std::endl;
+	stbi_image_free(data);
+
+	return textureID;
+}
+
+void makeLights(unsigned int count, float extent, std::vector<Light>& lights, std::vector<Light_motion>& motions)
+{
+	/* Same seed for every count, the first lights stay where they were */
+	std::mt19937 random(5);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	/* More lights, each dimmer, so the image stays about as bright */
+	float brightness = std::min(1.0f, 64.0f / count);
+
+	lights.clear();
+	motions.clear();
+	/* A dim moon, its direction circles slowly */
+	lights.push_back(Light{ Light_type::DIRECTIONAL, glm::vec3(0.0f), glm::vec3(-0.3f, -1.0f, -0.5f), glm::vec3(0.08f, 0.08f, 0.12f), 0.0f, 0.0f, 0.0f });
+	motions.push_back(Light_motion{ glm::vec3(0.0f), 0.0f, 0.05f, 0.0f });
+	for (unsigned int i = 1; i <= count; i++) {
+		/* Bright saturated colors, the scene has little ambient */
+		float hue = unit(random) * 6.28f;
+		glm::vec3 color = glm::vec3(0.5f) + 0.5f * glm::vec3(std::cos(hue), std::cos(hue + 2.09f), std::cos(hue + 4.19f));
+		bool spot = i % spotEvery == 0;
+		lights.push_back(Light{ spot ? Light_type::SPOT : Light_type::POINT, glm::vec3(0.0f), glm::vec3(0.0f, -1.0f, 0.0f),
+			color * (spot ? 40.0f : 12.0f) * brightness, lightRange, 20.0f, 30.0f });
+
+		glm::vec3 center((unit(random) - 0.5f) * extent, (spot ? 4.0f : 1.5f) + unit(random) * 1.5f, (unit(random) - 0.5f) * extent);
+		motions.push_back(Light_motion{ center, 1.0f + unit(random) * 4.0f, (unit(random) - 0.5f) * 2.0f, unit(random) * 6.28f });
+	}
+}
+
+void moveLights(std::vector<Light>& lights, const std::vector<Light_motion>& motions, float time)
+{
+	for (size_t i = 0; i < lights.size(); i++) {
+		float angle = motions[i].phase + motions[i].speed * time;
+		if (lights[i].type == Light_type::DIRECTIONAL)
+			lights[i].direction = glm::vec3(std::cos(angle) * 0.5f, -1.0f, std::sin(angle) * 0.5f);
+		else
+			lights[i].position = motions[i].center + motions[i].radius * glm::vec3(std::cos(angle), 0.0f, std::sin(angle));
+	}
+}
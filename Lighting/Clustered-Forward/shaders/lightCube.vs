@@ -0,0 +1,17 @@
+#version 330 core
+layout (location = 0) in vec3 aPosition;
+// per instance
+layout (location = 3) in vec3 aLightPosition;
+layout (location = 4) in vec3 aLightColor;
+
+out vec3 lightColor;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform float size;
+
+void main()
+{
+  gl_Position = projection * view * vec4(aPosition * size + aLightPosition, 1.0f);
+  lightColor = aLightColor;
+}
@@ -0,0 +1,108 @@
+#version 330 core
+
+#define LIGHT_DIRECTIONAL 0
+#define LIGHT_POINT 1
+#define LIGHT_SPOT 2
+
+struct Material {
+  sampler2D diffuse;
+  sampler2D specular;
+  float shininess;
+};
+
+out vec4 fragColor;
+
+in vec3 Normal;
+in vec3 fragPos;
+in vec2 texCoords;
+in float viewDepth;
+
+uniform vec3 viewPos;
+uniform vec3 ambient;
+uniform Material material;
+
+// 4 texels per light, the directional lights first - see ClusteredLights
+// xyz position, w range / xyz direction, w cosine of the outer cutoff / rgb color, w cosine of the inner cutoff / x type
+uniform samplerBuffer lightData;
+// offset into lightIndices and light count per cluster
+uniform usamplerBuffer clusterData;
+uniform usamplerBuffer lightIndices;
+uniform int directionalCount;
+uniform int lightCount;
+
+// off to evaluate every light for every fragment, the brute force reference
+uniform bool clustered;
+uniform ivec3 clusterCounts;
+// screen pixels per tile
+uniform vec2 tileSize;
+// slice = log(viewDepth) * sliceScale + sliceBias
+uniform float sliceScale;
+uniform float sliceBias;
+
+vec3 diffuseColor;
+vec3 specularColor;
+vec3 norm;
+vec3 viewDir;
+
+vec3 shade(int light)
+{
+  vec4 position = texelFetch(lightData, light * 4);
+  vec4 direction = texelFetch(lightData, light * 4 + 1);
+  vec4 color = texelFetch(lightData, light * 4 + 2);
+  int type = int(texelFetch(lightData, light * 4 + 3).x);
+
+  vec3 lightDir;
+  float attenuation = 1.0;
+  if (type == LIGHT_DIRECTIONAL)
+    lightDir = -direction.xyz;
+  else {
+    vec3 toLight = position.xyz - fragPos;
+    float dist = length(toLight);
+    // out of range, the light doesn't reach
+    if (dist >= position.w)
+      return vec3(0.0);
+    lightDir = toLight / dist;
+    // inverse square, windowed to reach zero at the range
+    float window = clamp(1.0 - pow(dist / position.w, 4.0), 0.0, 1.0);
+    attenuation = window * window / (dist * dist + 1.0);
+
+    if (type == LIGHT_SPOT) {
+      float theta = dot(lightDir, -direction.xyz);
+      attenuation *= clamp((theta - direction.w) / (color.w - direction.w), 0.0, 1.0);
+    }
+  }
+
+  // diffuse
+  float diff = max(dot(norm, lightDir), 0.0);
+  // specular
+  vec3 reflectDir = reflect(-lightDir, norm);
+  float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+
+  return attenuation * color.rgb * (diff * diffuseColor + spec * specularColor);
+}
+
+void main()
+{
+  diffuseColor = vec3(texture(material.diffuse, texCoords));
+  specularColor = vec3(texture(material.specular, texCoords));
+  norm = normalize(Normal);
+  viewDir = normalize(viewPos - fragPos);
+
+  vec3 result = ambient * diffuseColor;
+  for (int i = 0; i < directionalCount; i++)
+    result += shade(i);
+
+  if (clustered) {
+    ivec2 tile = min(ivec2(gl_FragCoord.xy / tileSize), clusterCounts.xy - 1);
+    int slice = clamp(int(log(viewDepth) * sliceScale + sliceBias), 0, clusterCounts.z - 1);
+    int cluster = (slice * clusterCounts.y + tile.y) * clusterCounts.x + tile.x;
+    uvec2 list = texelFetch(clusterData, cluster).xy;
+    for (uint i = 0u; i < list.y; i++)
+      result += shade(int(texelFetch(lightIndices, int(list.x + i)).x));
+  }
+  else {
+    for (int i = directionalCount; i < lightCount; i++)
+      result += shade(i);
+  }
+  fragColor = vec4(result, 1.0);
+}
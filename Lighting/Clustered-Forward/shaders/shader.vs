@@ -0,0 +1,27 @@
+#version 330 core
+layout (location = 0) in vec3 aPosition;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+// per instance
+layout (location = 3) in mat4 aModel;
+
+out vec3 Normal;
+out vec3 fragPos;
+out vec2 texCoords;
+out float viewDepth;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+  vec4 worldPos = aModel * vec4(aPosition, 1.0);
+  vec4 viewPos = view * worldPos;
+  gl_Position = projection * viewPos;
+  // the boxes are only translated and scaled along the axes, their axis aligned normals keep the direction
+  Normal = mat3(aModel) * aNormal;
+  fragPos = vec3(worldPos);
+  texCoords = aTexCoords;
+  // distance along the view direction, picks the depth slice
+  viewDepth = -viewPos.z;
+}
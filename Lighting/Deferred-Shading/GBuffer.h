@@ -0,0 +1,114 @@
+#ifndef G_BUFFER_H
+#define G_BUFFER_H
+
+#include <iostream>
+
+#include "glad/glad.h"
+
+/* Compact G-buffer for deferred shading, 12 bytes per pixel:
+	albedo and specular intensity	RGBA8
+	normal and shininess			RGB10_A2, octahedral normal in rg, shininess / 256 in b
+	depth and stencil				DEPTH24_STENCIL8, the lighting passes reconstruct the position from it
+The geometry pass writes it once per covered fragment, the lighting then reads it once per lit pixel */
+class GBuffer
+{
+public:
+	/* Constructor and destructor */
+	GBuffer(int width, int height);
+	~GBuffer() noexcept;
+
+	/* Render the geometry pass into the G-buffer */
+	void BindForWriting() const;
+	/* Bind albedo, normal and depth to three texture units from firstUnit on */
+	void BindTextures(int firstUnit) const;
+	/* Copy the depth to the bound draw framebuffer, e.g. to depth test light volumes and forward objects against the scene */
+	void BlitDepth() const;
+
+	/* Get functions */
+	static unsigned int BytesPerPixel() noexcept;
+
+public:
+	const int Width;
+	const int Height;
+
+private:
+	/* Helper functions */
+	unsigned int createTexture(GLint internalFormat, GLenum format, GLenum type) const;
+private:
+	unsigned int framebuffer;
+	unsigned int albedoSpecular, normalShininess, depth;
+};
+
+
+GBuffer::GBuffer(int width, int height) : Width(width), Height(height)
+{
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+	albedoSpecular = createTexture(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+	normalShininess = createTexture(GL_RGB10_A2, GL_RGBA, GL_UNSIGNED_INT_2_10_10_10_REV);
+	depth = createTexture(GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, albedoSpecular, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, normalShininess, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depth, 0);
+
+	const GLenum attachments[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+	glDrawBuffers(2, attachments);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		std::cout << "ERROR::G_BUFFER::FRAMEBUFFER_INCOMPLETE" << std::endl;
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+GBuffer::~GBuffer() noexcept
+{
+	unsigned int textures[] = { albedoSpecular, normalShininess, depth };
+	glDeleteTextures(3, textures);
+	glDeleteFramebuffers(1, &framebuffer);
+}
+
+inline void GBuffer::BindForWriting() const
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glViewport(0, 0, Width, Height);
+}
+
+void GBuffer::BindTextures(int firstUnit) const
+{
+	glActiveTexture(GL_TEXTURE0 + firstUnit);
+	glBindTexture(GL_TEXTURE_2D, albedoSpecular);
+	glActiveTexture(GL_TEXTURE0 + firstUnit + 1);
+	glBindTexture(GL_TEXTURE_2D, normalShininess);
+	glActiveTexture(GL_TEXTURE0 + firstUnit + 2);
+	glBindTexture(GL_TEXTURE_2D, depth);
+}
+
+void GBuffer::BlitDepth() const
+{
+	/* The default framebuffer has to be DEPTH24_STENCIL8 too, which is what the drivers create */
+	GLint drawFramebuffer;
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &drawFramebuffer);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+	glBlitFramebuffer(0, 0, Width, Height, 0, 0, Width, Height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, drawFramebuffer);
+}
+
+inline unsigned int GBuffer::BytesPerPixel() noexcept
+{
+	return 4 + 4 + 4;
+}
+
+unsigned int GBuffer::createTexture(GLint internalFormat, GLenum format, GLenum type) const
+{
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, Width, Height, 0, format, type, NULL);
+	/* Read texel by texel, never filtered */
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	return texture;
+}
+
+#endif
@@ -0,0 +1,628 @@
+#include "glad/glad.h"
+#include "GLFW/glfw3.h"
+
+#include "stb_image.h"
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+#include "Shader.h"
+#include "Camera.h"
+#include "LightSystem.h"
+#include "GBuffer.h"
+#include "GpuTimer.h"
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+
+/* Ways to light the scene */
+enum class Render_path {
+	/* Phong for every rasterized fragment, like the other lighting demos */
+	FORWARD,
+	/* G-buffer, then one full screen pass evaluating every light per pixel */
+	DEFERRED_FULL_SCREEN,
+	/* G-buffer, then a full screen pass for the directional light and a sphere per point and spot light */
+	DEFERRED_LIGHT_VOLUMES
+};
+
+/* Circle a light moves on */
+struct Light_motion {
+	glm::vec3 center;
+	float radius;
+	/* Radians per second */
+	float speed;
+	float phase;
+};
+
+/* Per instance data of the light cubes */
+struct Light_marker {
+	glm::vec3 position;
+	glm::vec3 color;
+};
+
+void processInput(GLFWwindow* window);
+void frameBufferResize_callback(GLFWwindow* window, int width, int height);
+void mouseMovement_callback(GLFWwindow* window, double xPos, double yPos);
+void mouseScroll_callback(GLFWwindow* window, double xOffset, double yOffset);
+void keyPress_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+
+unsigned int loadTexture(const char* path);
+std::vector<glm::vec3> makeSphere(int rings, int segments);
+void moveLights(LightSystem& lights, const std::vector<Light_motion>& motions, float time);
+const char* pathName(Render_path path);
+
+
+const int winWidth = 800;
+const int winHeight = 600;
+
+/************************************ CAMERA ************************************/
+Camera camera({ 0.0f, 0.0f, 12.0f });
+
+float lastX = winWidth / 2;
+float lastY = winHeight / 2;
+bool firstMouseMove = true;
+
+/************************************ FRAMES ************************************/
+float deltaTime = 0.0f;
+float lastFrame = 0.0f;
+
+/************************************ LIGHTING ************************************/
+/* Switched with the 1, 2 and 3 keys */
+Render_path renderPath = Render_path::DEFERRED_LIGHT_VOLUMES;
+const unsigned int lightCount = LightSystem::MaxLights;
+const float lightRange = 4.0f;
+/* Paused with space */
+bool lightsAnimating = true;
+float lightTime = 0.0f;
+
+/************************************ SCENE ************************************/
+/* Walls of boxes one behind the other, drawn back to front. Every wall hides the ones
+before it, so forward shading lights each pixel about once per wall */
+const int wallCount = 12;
+const float wallSpacing = 4.0f;
+const int wallColumns = 16;
+const int wallRows = 10;
+
+
+int main()
+{
+	/************************************ INITIALIZATION ************************************/
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	/* GBuffer::BlitDepth() copies into it, the formats have to match */
+	glfwWindowHint(GLFW_DEPTH_BITS, 24);
+	glfwWindowHint(GLFW_STENCIL_BITS, 8);
+	/* The G-buffer is made once with the window size */
+	glfwWindowHint(GLFW_RESIZABLE, GL_FALSE);
+
+	GLFWwindow* window = glfwCreateWindow(winWidth, winHeight, "Deferred shading", NULL, NULL);
+	if (window == NULL) {
+		std::cout << "ERROR::GLFW::INITIALIZATION_FAILED" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		std::cout << "ERROR::GLAD::INITIALIZATION_FAILED" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	/* Framebuffer pixels, more than the window size on high DPI screens */
+	int framebufferWidth, framebufferHeight;
+	glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+	glViewport(0, 0, framebufferWidth, framebufferHeight);
+	/* Measure the lighting, not the display refresh */
+	glfwSwapInterval(0);
+
+	glfwSetFramebufferSizeCallback(window, frameBufferResize_callback);
+	glfwSetCursorPosCallback(window, mouseMovement_callback);
+	glfwSetScrollCallback(window, mouseScroll_callback);
+	glfwSetKeyCallback(window, keyPress_callback);
+
+	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+	/************************************ POSITIONS ************************************/
+	float cubeVertices[] = {
+		/*	  Positions			Normals		  TextureCoords	*/
+		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
+
+		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
+
+		-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+		-0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
+		-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
+		-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+
+		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+
+		-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  1.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  0.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
+
+		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  1.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  0.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f
+	};
+
+	/************************************ OBJECTS ************************************/
+	/* Farthest wall first */
+	std::vector<glm::mat4> boxes;
+	for (int wall = wallCount - 1; wall >= 0; wall--) {
+		for (int row = 0; row < wallRows; row++) {
+			for (int column = 0; column < wallColumns; column++) {
+				glm::vec3 position((column - (wallColumns - 1) / 2.0f) * 2.0f, (row - (wallRows - 1) / 2.0f) * 2.0f, -wall * wallSpacing);
+				boxes.push_back(glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(1.8f, 1.8f, 0.4f)));
+			}
+		}
+	}
+
+	/************************************ BUFFERS ************************************/
+	unsigned int cubeVAO, VBO, boxVBO;
+	glGenVertexArrays(1, &cubeVAO);
+	glGenBuffers(1, &VBO);
+	glGenBuffers(1, &boxVBO);
+
+	glBindVertexArray(cubeVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), cubeVertices, GL_STATIC_DRAW);
+
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+	glEnableVertexAttribArray(2);
+
+	/* Model matrix per instance as 4 column attributes */
+	glBindBuffer(GL_ARRAY_BUFFER, boxVBO);
+	glBufferData(GL_ARRAY_BUFFER, boxes.size() * sizeof(glm::mat4), boxes.data(), GL_STATIC_DRAW);
+	for (unsigned int column = 0; column < 4; column++) {
+		glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(column * sizeof(glm::vec4)));
+		glEnableVertexAttribArray(3 + column);
+		glVertexAttribDivisor(3 + column, 1);
+	}
+
+	/* The light cubes share the vertices, position and color come per instance */
+	unsigned int lightVAO, markerVBO;
+	glGenVertexArrays(1, &lightVAO);
+	glGenBuffers(1, &markerVBO);
+
+	glBindVertexArray(lightVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+
+	glBindBuffer(GL_ARRAY_BUFFER, markerVBO);
+	glBufferData(GL_ARRAY_BUFFER, lightCount * sizeof(Light_marker), NULL, GL_DYNAMIC_DRAW);
+	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Light_marker), (void*)0);
+	glEnableVertexAttribArray(3);
+	glVertexAttribDivisor(3, 1);
+	glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Light_marker), (void*)sizeof(glm::vec3));
+	glEnableVertexAttribArray(4);
+	glVertexAttribDivisor(4, 1);
+
+	/* Light volumes, a unit sphere instanced per light */
+	std::vector<glm::vec3> sphere = makeSphere(8, 12);
+	unsigned int sphereVAO, sphereVBO;
+	glGenVertexArrays(1, &sphereVAO);
+	glGenBuffers(1, &sphereVBO);
+	glBindVertexArray(sphereVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, sphereVBO);
+	glBufferData(GL_ARRAY_BUFFER, sphere.size() * sizeof(glm::vec3), sphere.data(), GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+	glEnableVertexAttribArray(0);
+
+	/* The full screen triangle is made in the vertex shader, but a VAO has to be bound */
+	unsigned int screenVAO;
+	glGenVertexArrays(1, &screenVAO);
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	/************************************ LIGHTS ************************************/
+	LightSystem lights;
+	/* A dim moon, its direction circles slowly */
+	lights.Add(Light{ Light_type::DIRECTIONAL, glm::vec3(0.0f), glm::vec3(-0.3f, -0.5f, -1.0f), glm::vec3(0.1f, 0.1f, 0.14f), 0.0f, 0.0f, 0.0f });
+
+	std::mt19937 random(3);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::vector<Light_motion> motions(1, Light_motion{ glm::vec3(0.0f), 0.0f, 0.05f, 0.0f });
+	for (unsigned int i = 1; i < lightCount; i++) {
+		float hue = unit(random) * 6.28f;
+		glm::vec3 color = glm::vec3(0.5f) + 0.5f * glm::vec3(std::cos(hue), std::cos(hue + 2.09f), std::cos(hue + 4.19f));
+		lights.Add(Light{ Light_type::POINT, glm::vec3(0.0f), glm::vec3(0.0f), color * 6.0f, lightRange, 0.0f, 0.0f });
+
+		/* In the gaps in front of the walls */
+		int gap = (int)(unit(random) * wallCount);
+		glm::vec3 center((unit(random) - 0.5f) * wallColumns * 1.6f, (unit(random) - 0.5f) * wallRows * 1.6f, -gap * wallSpacing + wallSpacing / 2.0f);
+		motions.push_back(Light_motion{ center, 0.5f + unit(random) * 2.0f, (unit(random) - 0.5f) * 2.0f, unit(random) * 6.28f });
+	}
+	moveLights(lights, motions, lightTime);
+
+	/************************************ TEXTURES ************************************/
+	unsigned int diffuseMap = loadTexture("textures/container2.png");
+	unsigned int specularMap = loadTexture("textures/container2_specular.png");
+
+	/************************************ G-BUFFER ************************************/
+	GBuffer gBuffer(framebufferWidth, framebufferHeight);
+
+	/************************************ SHADERS ************************************/
+	Shader forwardShader("shaders/shader.vs", "shaders/shader.fs");
+	Shader geometryShader("shaders/shader.vs", "shaders/gbuffer.fs");
+	Shader lightingShader("shaders/deferred.vs", "shaders/deferredLighting.fs");
+	Shader lightVolumeShader("shaders/lightVolume.vs", "shaders/lightVolume.fs");
+	Shader lightCubeShader("shaders/lightCube.vs", "shaders/lightCube.fs");
+	/* The same material inputs for the forward and the G-buffer pass */
+	for (const Shader* shader : { &forwardShader, &geometryShader }) {
+		shader->use();
+		shader->setInt("material.diffuse", 0);
+		shader->setInt("material.specular", 1);
+		shader->setFloat("material.shininess", 32.0f);
+	}
+	for (const Shader* shader : { &forwardShader, &lightingShader, &lightVolumeShader }) {
+		shader->use();
+		shader->setUniformBlock("Lights", lights.Binding);
+	}
+	forwardShader.use();
+	forwardShader.setVec3("ambient", 0.03f, 0.03f, 0.03f);
+	lightingShader.use();
+	lightingShader.setVec3("ambient", 0.03f, 0.03f, 0.03f);
+	for (const Shader* shader : { &lightingShader, &lightVolumeShader }) {
+		shader->use();
+		shader->setInt("gBuffer.albedoSpecular", 2);
+		shader->setInt("gBuffer.normalShininess", 3);
+		shader->setInt("gBuffer.depth", 4);
+	}
+	lightVolumeShader.use();
+	lightVolumeShader.setVec2("screenSize", (float)framebufferWidth, (float)framebufferHeight);
+	lightVolumeShader.setInt("firstLight", 1);
+	lightCubeShader.use();
+	lightCubeShader.setFloat("size", 0.15f);
+
+	/************************************ RENDER LOOP ************************************/
+	glEnable(GL_DEPTH_TEST);
+	std::cout << boxes.size() << " boxes in " << wallCount << " walls, " << lightCount << " lights. "
+		<< "1 - forward, 2 - deferred full screen, 3 - deferred light volumes" << std::endl;
+
+	/* Forward shading happens in the geometry pass, the lighting passes then only draw the light cubes */
+	GpuTimer geometryTimer, lightingTimer;
+	/* Fragments of the geometry pass and the light volumes, for the overdraw and the G-buffer traffic */
+	GpuTimer geometrySamples(GL_SAMPLES_PASSED), volumeSamples(GL_SAMPLES_PASSED);
+	std::vector<Light_marker> markers;
+	Render_path measuredPath = renderPath;
+	unsigned int measuredFrames = 0;
+	double measureStart = glfwGetTime();
+	lastFrame = glfwGetTime();
+	while (!glfwWindowShouldClose(window)) {
+		float currentFrame = glfwGetTime();
+		deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+
+		processInput(window);
+
+		if (lightsAnimating) {
+			lightTime += deltaTime;
+			moveLights(lights, motions, lightTime);
+		}
+		if (lights.Upload()) {
+			markers.clear();
+			for (unsigned int i = 1; i < lights.Count(); i++)
+				markers.push_back(Light_marker{ lights.Get(i).position, lights.Get(i).color / 6.0f });
+			glBindBuffer(GL_ARRAY_BUFFER, markerVBO);
+			glBufferSubData(GL_ARRAY_BUFFER, 0, markers.size() * sizeof(Light_marker), markers.data());
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+		}
+
+		/* View and projection transformations */
+		glm::mat4 view = camera.GetViewMatrix();
+		glm::mat4 projection =
+			glm::perspective(glm::radians(camera.Zoom), (float)winWidth / winHeight, 0.1f, 200.0f);
+
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, diffuseMap);
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, specularMap);
+
+		if (renderPath == Render_path::FORWARD) {
+			glClearColor(0.02f, 0.02f, 0.02f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+			forwardShader.use();
+			forwardShader.setMat4f("view", view);
+			forwardShader.setMat4f("projection", projection);
+			forwardShader.setVec3("viewPos", camera.Position);
+
+			geometryTimer.Begin();
+			geometrySamples.Begin();
+			glBindVertexArray(cubeVAO);
+			glDrawArraysInstanced(GL_TRIANGLES, 0, 36, (GLsizei)boxes.size());
+			geometrySamples.End();
+			geometryTimer.End();
+		}
+		else {
+			/* Geometry pass, material inputs only */
+			gBuffer.BindForWriting();
+			glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+			geometryShader.use();
+			geometryShader.setMat4f("view", view);
+			geometryShader.setMat4f("projection", projection);
+
+			geometryTimer.Begin();
+			geometrySamples.Begin();
+			glBindVertexArray(cubeVAO);
+			glDrawArraysInstanced(GL_TRIANGLES, 0, 36, (GLsizei)boxes.size());
+			geometrySamples.End();
+			geometryTimer.End();
+
+			/* Lighting passes, into the window */
+			lightingTimer.Begin();
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			glViewport(0, 0, framebufferWidth, framebufferHeight);
+			glClearColor(0.02f, 0.02f, 0.02f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT);
+			gBuffer.BlitDepth();
+			gBuffer.BindTextures(2);
+			glm::mat4 inverseViewProjection = glm::inverse(projection * view);
+
+			/* Ambient and all lights, or only the directional one when the volumes follow */
+			glDisable(GL_DEPTH_TEST);
+			lightingShader.use();
+			lightingShader.setMat4f("inverseViewProjection", inverseViewProjection);
+			lightingShader.setVec3("viewPos", camera.Position);
+			lightingShader.setInt("lightLimit", renderPath == Render_path::DEFERRED_FULL_SCREEN ? (int)lights.Count() : 1);
+			glBindVertexArray(screenVAO);
+			glDrawArrays(GL_TRIANGLES, 0, 3);
+
+			if (renderPath == Render_path::DEFERRED_LIGHT_VOLUMES) {
+				/* Back faces that lie behind the scene, so the volume covers the pixel even with the camera inside it */
+				glEnable(GL_DEPTH_TEST);
+				glDepthFunc(GL_GEQUAL);
+				glDepthMask(GL_FALSE);
+				glEnable(GL_CULL_FACE);
+				glCullFace(GL_FRONT);
+				glEnable(GL_BLEND);
+				glBlendFunc(GL_ONE, GL_ONE);
+
+				lightVolumeShader.use();
+				lightVolumeShader.setMat4f("view", view);
+				lightVolumeShader.setMat4f("projection", projection);
+				lightVolumeShader.setMat4f("inverseViewProjection", inverseViewProjection);
+				lightVolumeShader.setVec3("viewPos", camera.Position);
+
+				volumeSamples.Begin();
+				glBindVertexArray(sphereVAO);
+				glDrawArraysInstanced(GL_TRIANGLES, 0, (GLsizei)sphere.size(), (GLsizei)lights.Count() - 1);
+				volumeSamples.End();
+
+				glDisable(GL_BLEND);
+				glCullFace(GL_BACK);
+				glDisable(GL_CULL_FACE);
+				glDepthMask(GL_TRUE);
+				glDepthFunc(GL_LESS);
+			}
+			glEnable(GL_DEPTH_TEST);
+		}
+
+		/* Draw the light objects, tested against the scene depth on both paths */
+		if (renderPath == Render_path::FORWARD)
+			lightingTimer.Begin();
+		lightCubeShader.use();
+		lightCubeShader.setMat4f("view", view);
+		lightCubeShader.setMat4f("projection", projection);
+		glBindVertexArray(lightVAO);
+		glDrawArraysInstanced(GL_TRIANGLES, 0, 36, (GLsizei)markers.size());
+		lightingTimer.End();
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+
+		/* Averages per path, restarted when the path changes */
+		measuredFrames++;
+		double measured = glfwGetTime() - measureStart;
+		if (measuredPath != renderPath || measured >= 2.0) {
+			if (measuredPath == renderPath) {
+				double pixels = (double)framebufferWidth * framebufferHeight;
+				double geometryFragments = geometrySamples.Average();
+				std::cout << pathName(renderPath) << ": " << measured * 1000.0 / measuredFrames << " ms per frame, "
+					<< geometryTimer.AverageMs() << " ms GPU geometry pass, " << lightingTimer.AverageMs() << " ms GPU lighting passes, overdraw "
+					<< geometryFragments / pixels;
+				if (renderPath != Render_path::FORWARD) {
+					/* Color targets written per geometry fragment, read once by the full screen pass and once per volume fragment.
+					Estimated from the fragment counts, compression and caches change the real traffic */
+					double written = geometryFragments * (GBuffer::BytesPerPixel() - 4);
+					double read = (pixels + volumeSamples.Average()) * GBuffer::BytesPerPixel();
+					std::cout << ", G-buffer " << written / (1024.0 * 1024.0) << " MB written and "
+						<< read / (1024.0 * 1024.0) << " MB read per frame";
+				}
+				std::cout << std::endl;
+			}
+			measuredPath = renderPath;
+			measuredFrames = 0;
+			geometryTimer.Reset();
+			lightingTimer.Reset();
+			geometrySamples.Reset();
+			volumeSamples.Reset();
+			measureStart = glfwGetTime();
+		}
+	}
+
+	glDeleteVertexArrays(1, &cubeVAO);
+	glDeleteVertexArrays(1, &lightVAO);
+	glDeleteVertexArrays(1, &sphereVAO);
+	glDeleteVertexArrays(1, &screenVAO);
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &boxVBO);
+	glDeleteBuffers(1, &markerVBO);
+	glDeleteBuffers(1, &sphereVBO);
+	glDeleteTextures(1, &diffuseMap);
+	glDeleteTextures(1, &specularMap);
+	glfwTerminate();
+}
+
+
+void processInput(GLFWwindow* window)
+{
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, true);
+	if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
+		deltaTime *= 2;
+	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::FORWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::BACKWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::LEFT, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::RIGHT, deltaTime);
+}
+
+void keyPress_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	if (action != GLFW_PRESS)
+		return;
+	if (key == GLFW_KEY_SPACE)
+		lightsAnimating = !lightsAnimating;
+	else if (key == GLFW_KEY_1)
+		renderPath = Render_path::FORWARD;
+	else if (key == GLFW_KEY_2)
+		renderPath = Render_path::DEFERRED_FULL_SCREEN;
+	else if (key == GLFW_KEY_3)
+		renderPath = Render_path::DEFERRED_LIGHT_VOLUMES;
+}
+
+void frameBufferResize_callback(GLFWwindow* window, int width, int height)
+{
+	glViewport(0, 0, width, height);
+}
+
+void mouseMovement_callback(GLFWwindow* window, double xPos, double yPos)
+{
+	if (firstMouseMove) {
+		lastX = xPos;
+		lastY = yPos;
+		firstMouseMove = false;
+	}
+
+	float xOffset = (float)xPos - lastX;
+	float yOffset = lastY - (float)yPos;
+	lastX = xPos;
+	lastY = yPos;
+
+	camera.ProcessMouseMovement(xOffset, yOffset);
+}
+
+void mouseScroll_callback(GLFWwindow* window, double xOffset, double yOffset)
+{
+	camera.ProcessMouseScroll(yOffset);
+}
+
+unsigned int loadTexture(const char* path)
+{
+	unsigned int textureID;
+	glGenTextures(1, &textureID);
+
+	int width, height, nrComponents;
+	unsigned char* data = stbi_load(path, &width, &height, &nrComponents, 0);
+	if (data) {
+		/* See which color format the texture uses */
+		GLenum format;
+		if (nrComponents == 1)
+			format = GL_RED;
+		else if (nrComponents == 3)
+			format = GL_RGB;
+		else if (nrComponents == 4)
+			format = GL_RGBA;
+
+		glBindTexture(GL_TEXTURE_2D, textureID);
+		glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+		glGenerateMipmap(GL_TEXTURE_2D);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	}
+	else
+		std::cout << "Texture failed to load at path: " << path << std::endl;
+	stbi_image_free(data);
+
+	return textureID;
+}
+
+std::vector<glm::vec3> makeSphere(int rings, int segments)
+{
+	/* Triangles of a UV sphere, pushed out so the flat faces enclose the unit sphere */
+	float scale = 1.0f / (std::cos(glm::pi<float>() / rings) * std::cos(glm::pi<float>() / segments));
+	auto point = [&](int ring, int segment) {
+		float theta = glm::pi<float>() * ring / rings, phi = 2.0f * glm::pi<float>() * segment / segments;
+		return scale * glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+	};
+
+	std::vector<glm::vec3> vertices;
+	for (int ring = 0; ring < rings; ring++) {
+		for (int segment = 0; segment < segments; segment++) {
+			/* Counter clockwise from outside */
+			glm::vec3 a = point(ring, segment), b = point(ring + 1, segment), c = point(ring + 1, segment + 1), d = point(ring, segment + 1);
+			vertices.insert(vertices.end(), { a, c, b, a, d, c });
+		}
+	}
+	return vertices;
+}
+
+void moveLights(LightSystem& lights, const std::vector<Light_motion>& motions, float time)
+{
+	for (unsigned int i = 0; i < lights.Count(); i++) {
+		Light light = lights.Get(i);
+		float angle = motions[i].phase + motions[i].speed * time;
+		if (light.type == Light_type::DIRECTIONAL)
+			light.direction = glm::vec3(std::cos(angle) * 0.5f, std::sin(angle) * 0.5f, -1.0f);
+		else
+			/* Parallel to the walls, the lights stay in their gap */
+			light.position = motions[i].center + motions[i].radius * glm::vec3(std::cos(angle), std::sin(angle), 0.0f);
+		lights.Set(i, light);
+	}
+}
+
+const char* pathName(Render_path path)
+{
+	switch (path) {
+	case Render_path::FORWARD:
+		return "Forward";
+	case Render_path::DEFERRED_FULL_SCREEN:
+		return "Deferred full screen";
+	default:
+		return "Deferred light volumes";
+	}
+}
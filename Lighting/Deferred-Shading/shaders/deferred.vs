@@ -0,0 +1,11 @@
+#version 330 core
+
+// full screen triangle, no vertex buffer needed
+out vec2 screenCoords;
+
+void main()
+{
+  vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+  screenCoords = corner;
+  gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,103 @@
+#version 330 core
+
+#define MAX_LIGHTS 256
+#define LIGHT_DIRECTIONAL 0
+#define LIGHT_POINT 1
+#define LIGHT_SPOT 2
+
+// std140 layout of LightSystem::Gpu_light
+struct Light {
+  vec4 position;  // xyz position, w range
+  vec4 direction; // xyz direction, w cosine of the outer cutoff
+  vec4 color;     // rgb color, w cosine of the inner cutoff
+  ivec4 type;     // x type, y of lights[0] the light count
+};
+
+// filled by LightSystem, shared by every program
+layout (std140) uniform Lights {
+  Light lights[MAX_LIGHTS];
+};
+
+// see GBuffer
+struct GBuffer {
+  sampler2D albedoSpecular;
+  sampler2D normalShininess;
+  sampler2D depth;
+};
+
+out vec4 fragColor;
+
+in vec2 screenCoords;
+
+uniform GBuffer gBuffer;
+uniform mat4 inverseViewProjection;
+uniform vec3 viewPos;
+uniform vec3 ambient;
+// lights [0, lightLimit) are applied, only the directional ones when light volumes do the rest
+uniform int lightLimit;
+
+vec3 octDecode(vec2 e)
+{
+  vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+  if (n.z < 0.0)
+    n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+  return normalize(n);
+}
+
+vec3 shade(int i, vec3 fragPos, vec3 norm, vec3 viewDir, vec3 diffuseColor, float specularIntensity, float shininess)
+{
+  vec3 lightDir;
+  float attenuation = 1.0;
+  if (lights[i].type.x == LIGHT_DIRECTIONAL)
+    lightDir = -lights[i].direction.xyz;
+  else {
+    vec3 toLight = lights[i].position.xyz - fragPos;
+    float dist = length(toLight);
+    float range = lights[i].position.w;
+    // out of range, the light doesn't reach
+    if (dist >= range)
+      return vec3(0.0);
+    lightDir = toLight / dist;
+    // inverse square, windowed to reach zero at the range
+    float window = clamp(1.0 - pow(dist / range, 4.0), 0.0, 1.0);
+    attenuation = window * window / (dist * dist + 1.0);
+
+    if (lights[i].type.x == LIGHT_SPOT) {
+      float theta = dot(lightDir, -lights[i].direction.xyz);
+      float epsilon = lights[i].color.w - lights[i].direction.w;
+      attenuation *= clamp((theta - lights[i].direction.w) / epsilon, 0.0, 1.0);
+    }
+  }
+
+  // diffuse
+  float diff = max(dot(norm, lightDir), 0.0);
+  // specular
+  vec3 reflectDir = reflect(-lightDir, norm);
+  float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
+
+  return attenuation * lights[i].color.rgb * (diff * diffuseColor + spec * specularIntensity);
+}
+
+void main()
+{
+  float depth = texture(gBuffer.depth, screenCoords).r;
+  // nothing was drawn here
+  if (depth == 1.0)
+    discard;
+
+  // position from the depth, the inverse of the projection the geometry pass used
+  vec4 world = inverseViewProjection * vec4(vec3(screenCoords, depth) * 2.0 - 1.0, 1.0);
+  vec3 fragPos = world.xyz / world.w;
+
+  vec4 albedoSpecular = texture(gBuffer.albedoSpecular, screenCoords);
+  vec4 normalShininess = texture(gBuffer.normalShininess, screenCoords);
+  vec3 norm = octDecode(normalShininess.xy * 2.0 - 1.0);
+  float shininess = normalShininess.z * 256.0;
+  vec3 viewDir = normalize(viewPos - fragPos);
+
+  vec3 result = ambient * albedoSpecular.rgb;
+  int count = min(lights[0].type.y, lightLimit);
+  for (int i = 0; i < count; i++)
+    result += shade(i, fragPos, norm, viewDir, albedoSpecular.rgb, albedoSpecular.a, shininess);
+  fragColor = vec4(result, 1.0);
+}
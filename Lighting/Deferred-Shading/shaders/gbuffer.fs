@@ -0,0 +1,33 @@
+#version 330 core
+
+// same material inputs as shader.fs
+struct Material {
+  sampler2D diffuse;
+  sampler2D specular;
+  float shininess;
+};
+
+// see GBuffer
+layout (location = 0) out vec4 albedoSpecular;
+layout (location = 1) out vec4 normalShininess;
+
+in vec3 Normal;
+in vec3 fragPos;
+in vec2 texCoords;
+
+uniform Material material;
+
+// unit vector to the octahedron unfolded onto [-1, 1]^2, 2 channels instead of 3
+vec2 octEncode(vec3 n)
+{
+  n /= abs(n.x) + abs(n.y) + abs(n.z);
+  vec2 folded = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+  return n.z >= 0.0 ? n.xy : folded;
+}
+
+void main()
+{
+  // the specular maps are grey, one channel keeps them
+  albedoSpecular = vec4(vec3(texture(material.diffuse, texCoords)), texture(material.specular, texCoords).r);
+  normalShininess = vec4(octEncode(normalize(Normal)) * 0.5 + 0.5, material.shininess / 256.0, 0.0);
+}
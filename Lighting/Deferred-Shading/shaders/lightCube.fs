@@ -0,0 +1,9 @@
+#version 330 core
+out vec4 fragColor;
+
+in vec3 lightColor;
+
+void main()
+{
+  fragColor = vec4(lightColor, 1.0);
+}
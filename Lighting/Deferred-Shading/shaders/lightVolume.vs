@@ -0,0 +1,33 @@
+#version 330 core
+
+#define MAX_LIGHTS 256
+
+// std140 layout of LightSystem::Gpu_light
+struct Light {
+  vec4 position;  // xyz position, w range
+  vec4 direction; // xyz direction, w cosine of the outer cutoff
+  vec4 color;     // rgb color, w cosine of the inner cutoff
+  ivec4 type;     // x type, y of lights[0] the light count
+};
+
+// filled by LightSystem, shared by every program
+layout (std140) uniform Lights {
+  Light lights[MAX_LIGHTS];
+};
+
+// unit sphere, scaled to the range of the light of the instance
+layout (location = 0) in vec3 aPosition;
+
+flat out int lightIndex;
+
+uniform mat4 view;
+uniform mat4 projection;
+// lights before it are directional and have no volume
+uniform int firstLight;
+
+void main()
+{
+  lightIndex = firstLight + gl_InstanceID;
+  vec3 position = lights[lightIndex].position.xyz + aPosition * lights[lightIndex].position.w;
+  gl_Position = projection * view * vec4(position, 1.0);
+}
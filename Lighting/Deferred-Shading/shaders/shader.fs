@@ -0,0 +1,78 @@
+#version 330 core
+
+#define MAX_LIGHTS 256
+#define LIGHT_DIRECTIONAL 0
+#define LIGHT_POINT 1
+#define LIGHT_SPOT 2
+
+struct Material {
+  sampler2D diffuse;
+  sampler2D specular;
+  float shininess;
+};
+
+// std140 layout of LightSystem::Gpu_light
+struct Light {
+  vec4 position;  // xyz position, w range
+  vec4 direction; // xyz direction, w cosine of the outer cutoff
+  vec4 color;     // rgb color, w cosine of the inner cutoff
+  ivec4 type;     // x type, y of lights[0] the light count
+};
+
+// filled by LightSystem, shared by every program
+layout (std140) uniform Lights {
+  Light lights[MAX_LIGHTS];
+};
+
+out vec4 fragColor;
+
+in vec3 Normal;
+in vec3 fragPos;
+in vec2 texCoords;
+
+uniform vec3 viewPos;
+uniform vec3 ambient;
+uniform Material material;
+
+void main()
+{
+  vec3 diffuseColor = vec3(texture(material.diffuse, texCoords));
+  vec3 specularColor = vec3(texture(material.specular, texCoords));
+  vec3 norm = normalize(Normal);
+  vec3 viewDir = normalize(viewPos - fragPos);
+
+  vec3 result = ambient * diffuseColor;
+  for (int i = 0; i < lights[0].type.y; i++) {
+    vec3 lightDir;
+    float attenuation = 1.0;
+    if (lights[i].type.x == LIGHT_DIRECTIONAL)
+      lightDir = -lights[i].direction.xyz;
+    else {
+      vec3 toLight = lights[i].position.xyz - fragPos;
+      float dist = length(toLight);
+      float range = lights[i].position.w;
+      // out of range, the light doesn't reach
+      if (dist >= range)
+        continue;
+      lightDir = toLight / dist;
+      // inverse square, windowed to reach zero at the range
+      float window = clamp(1.0 - pow(dist / range, 4.0), 0.0, 1.0);
+      attenuation = window * window / (dist * dist + 1.0);
+
+      if (lights[i].type.x == LIGHT_SPOT) {
+        float theta = dot(lightDir, -lights[i].direction.xyz);
+        float epsilon = lights[i].color.w - lights[i].direction.w;
+        attenuation *= clamp((theta - lights[i].direction.w) / epsilon, 0.0, 1.0);
+      }
+    }
+
+    // diffuse
+    float diff = max(dot(norm, lightDir), 0.0);
+    // specular
+    vec3 reflectDir = reflect(-lightDir, norm);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+
+    result += attenuation * lights[i].color.rgb * (diff * diffuseColor + spec * specularColor);
+  }
+  fragColor = vec4(result, 1.0);
+}
@@ -62,13 +62,16 @@ public:
 	float Zoom;
 	float MouseSensitivity;
 	float MoveSpeed;
+	/* Bumped on every change of the view or projection, lets the renderer skip unchanged frames */
+	unsigned int Version;
 };
 
 
 Camera::Camera(glm::vec3 position = { 0.0f, 0.0f, 0.0f }, glm::vec3 up = { 0.0f, 1.0f, 0.0f },
 	float yaw = Camera_consts::YAW, float pitch = Camera_consts::PITCH)
 	: Position(position), Front({ 0.0f, 0.0f, -1.0f }), WorldUp(up), Yaw(yaw), Pitch(pitch),
-	Zoom(Camera_consts::ZOOM), MouseSensitivity(Camera_consts::SENSITIVITY), MoveSpeed(Camera_consts::SPEED)
+	Zoom(Camera_consts::ZOOM), MouseSensitivity(Camera_consts::SENSITIVITY), MoveSpeed(Camera_consts::SPEED),
+	Version(0)
 {
 	updateCameraVectors();
 }
@@ -77,7 +80,7 @@ Camera::Camera(float posX, float posY, float posZ, float upX, float upY, float u
 	float yaw = Camera_consts::YAW, float pitch = Camera_consts::PITCH)
 	: Position({ posX, posY, posZ }), Front({ 0.0f, 0.0f, -1.0f }), WorldUp({ upX, upY, upZ }),
 	Yaw(yaw), Pitch(pitch), Zoom(Camera_consts::ZOOM), MouseSensitivity(Camera_consts::SENSITIVITY),
-	MoveSpeed(Camera_consts::SPEED)
+	MoveSpeed(Camera_consts::SPEED), Version(0)
 {
 	updateCameraVectors();
 }
@@ -90,6 +93,8 @@ glm::mat4 Camera::GetViewMatrix() const
 void Camera::ProcessKeyboard(Camera_movement direction, float deltaTime)
 {
 	float velocity = MoveSpeed * deltaTime;
+	if (velocity == 0.0f)
+		return;
 	if (direction == Camera_movement::FORWARD)
 		Position += Front * velocity;
 	else if (direction == Camera_movement::BACKWARD)
@@ -100,10 +105,14 @@ void Camera::ProcessKeyboard(Camera_movement direction, float deltaTime)
 		Position += Right * velocity;
 	/* True FPS Camera - can't fly */
 	// Position.y = 0;
+	Version++;
 }
 
 void Camera::ProcessMouseMovement(float xOffset, float yOffset, GLboolean constraintPitch = GL_TRUE)
 {
+	if (xOffset == 0.0f && yOffset == 0.0f)
+		return;
+
 	xOffset *= MouseSensitivity;
 	yOffset *= MouseSensitivity;
 
@@ -122,11 +131,15 @@ void Camera::ProcessMouseMovement(float xOffset, float yOffset, GLboolean constr
 
 void Camera::ProcessMouseScroll(float yOffset)
 {
+	float oldZoom = Zoom;
 	Zoom -= yOffset;
 	if (Zoom > 45.0f)
 		Zoom = 45.0f;
 	else if (Zoom < 1.0f)
 		Zoom = 1.0f;
+
+	if (Zoom != oldZoom)
+		Version++;
 }
 
 void Camera::updateCameraVectors()
@@ -139,6 +152,7 @@ void Camera::updateCameraVectors()
 
 	Right = glm::normalize(glm::cross(Front, WorldUp));
 	Up = glm::normalize(glm::cross(Right, Front));
+	Version++;
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,53 @@
+#ifndef CHANNEL_PACKING_H
+#define CHANNEL_PACKING_H
+
+#include <string>
+#include <cstddef>
+
+/* Color plus mask packing - the RGB of a color image and the intensity of a mask image
+(e.g. a specular map) in one RGBA texture, so a shader fetches both with one texture read */
+namespace ChannelPacking {
+	/* Path the packed texture of the color image is baked to and loaded from,
+	textures/container2.png -> textures/container2_packed.png (.ktx when baked) */
+	std::string PackedPath(const std::string& colorPath);
+	/* Replace the alpha of the RGBA pixels with the mask intensity, the average of its first 3 channels */
+	void PackIntensity(unsigned char* rgba, const unsigned char* mask, int maskComponents, size_t pixelCount);
+	/* The color channels of the mask are equal, one channel holds it without loss */
+	bool IsGrey(const unsigned char* mask, int maskComponents, size_t pixelCount);
+}
+
+
+inline std::string ChannelPacking::PackedPath(const std::string& colorPath)
+{
+	size_t dot = colorPath.find_last_of('.');
+	if (dot == std::string::npos)
+		return colorPath + "_packed";
+	return colorPath.substr(0, dot) + "_packed" + colorPath.substr(dot);
+}
+
+inline void ChannelPacking::PackIntensity(unsigned char* rgba, const unsigned char* mask, int maskComponents, size_t pixelCount)
+{
+	/* Alpha of a grey-alpha or RGBA mask isn't intensity */
+	int channels = maskComponents >= 3 ? 3 : 1;
+	for (size_t i = 0; i < pixelCount; i++) {
+		const unsigned char* texel = mask + i * maskComponents;
+		int sum = 0;
+		for (int c = 0; c < channels; c++)
+			sum += texel[c];
+		rgba[i * 4 + 3] = (unsigned char)((sum + channels / 2) / channels);
+	}
+}
+
+inline bool ChannelPacking::IsGrey(const unsigned char* mask, int maskComponents, size_t pixelCount)
+{
+	if (maskComponents < 3)
+		return true;
+	for (size_t i = 0; i < pixelCount; i++) {
+		const unsigned char* texel = mask + i * maskComponents;
+		if (texel[0] != texel[1] || texel[0] != texel[2])
+			return false;
+	}
+	return true;
+}
+
+#endif
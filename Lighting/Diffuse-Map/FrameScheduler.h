@@ -0,0 +1,95 @@
+#ifndef FRAME_SCHEDULER_H
+#define FRAME_SCHEDULER_H
+
+#include "GLFW/glfw3.h"
+
+/* Frame scheduler - decides whether the next frame has to be rendered.
+In on-demand mode the loop sleeps in glfwWaitEventsTimeout until the scene becomes dirty
+(camera moved, animated uniform changed, window resized or damaged), the last presented
+frame stays on the screen meanwhile. In continuous mode every frame is rendered, like before */
+class FrameScheduler
+{
+public:
+	/* Constructor */
+	FrameScheduler(bool onDemand, double idleTimeout);
+
+	/* Dirtiness functions */
+	/* Force the next frame to be rendered */
+	void MarkDirty() noexcept;
+	/* Mark dirty if the watched version changed since the last check */
+	void TrackVersion(unsigned int& seenVersion, unsigned int currentVersion) noexcept;
+	/* Render every frame while something animates (held keys, time based uniforms) */
+	void SetAnimating(bool animating) noexcept;
+
+	/* Frame functions */
+	/* Whether the current frame should be rendered and presented */
+	bool ShouldRender() const noexcept;
+	/* Call after the rendered frame was swapped */
+	void FramePresented() noexcept;
+	/* Process the pending events, block while there is nothing to draw.
+	Returns true if the thread slept, so the caller can restart its frame timer */
+	bool WaitForEvents();
+
+public:
+	/* Scheduling options */
+	bool OnDemand;
+	double IdleTimeout;
+	/* Statistics */
+	unsigned long long FramesRendered;
+	unsigned long long IdleWaits;
+private:
+	bool dirty;
+	bool animating;
+};
+
+
+FrameScheduler::FrameScheduler(bool onDemand, double idleTimeout = 0.5)
+	: OnDemand(onDemand), IdleTimeout(idleTimeout), FramesRendered(0), IdleWaits(0),
+	dirty(true), animating(false)
+{
+}
+
+inline void FrameScheduler::MarkDirty() noexcept
+{
+	dirty = true;
+}
+
+inline void FrameScheduler::TrackVersion(unsigned int& seenVersion, unsigned int currentVersion) noexcept
+{
+	if (seenVersion != currentVersion) {
+		seenVersion = currentVersion;
+		dirty = true;
+	}
+}
+
+inline void FrameScheduler::SetAnimating(bool animating) noexcept
+{
+	this->animating = animating;
+}
+
+inline bool FrameScheduler::ShouldRender() const noexcept
+{
+	return !OnDemand || dirty || animating;
+}
+
+inline void FrameScheduler::FramePresented() noexcept
+{
+	dirty = false;
+	FramesRendered++;
+}
+
+bool FrameScheduler::WaitForEvents()
+{
+	/* Something is still changing, don't block the loop */
+	if (!OnDemand || dirty || animating) {
+		glfwPollEvents();
+		return false;
+	}
+
+	/* Nothing to draw, sleep until an event arrives or the timeout passes */
+	glfwWaitEventsTimeout(IdleTimeout);
+	IdleWaits++;
+	return true;
+}
+
+#endif
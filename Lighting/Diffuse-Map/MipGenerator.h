@@ -0,0 +1,333 @@
+#ifndef MIP_GENERATOR_H
+#define MIP_GENERATOR_H
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MIP_GENERATOR_SSE2
+#endif
+#if defined(__AVX__)
+#include <immintrin.h>
+#define MIP_GENERATOR_AVX
+#endif
+
+#include "ThreadPool.h"
+
+/* Downsampling filters */
+enum class Mip_filter {
+	/* 2x2 average, cheap */
+	BOX,
+	/* Separable Kaiser windowed sinc over 12 taps, sharper and without aliasing */
+	KAISER
+};
+
+/* CPU mip chain generator.
+Filtering runs on linear RGBA floats: sRGB color is decoded before averaging and encoded
+again when the level is written, alpha is always linear. Every level is computed from the
+previous one, rows of a level are split across the thread pool when one is given */
+class MipGenerator
+{
+public:
+	/* Constructor */
+	MipGenerator(Mip_filter filter, bool srgb);
+
+	/* Append the levels below levels[0] (width * height * components bytes) down to 1x1 */
+	void Generate(std::vector<std::vector<unsigned char>>& levels, int width, int height, int components,
+		ThreadPool* pool) const;
+
+	/* Get functions */
+	static unsigned int LevelCount(int width, int height) noexcept;
+
+public:
+	Mip_filter Filter;
+	/* Color channels are sRGB encoded, average them in linear space */
+	bool Srgb;
+
+private:
+	/* Helper functions */
+	/* Run body over the rows, on the pool if the level is big enough to be worth it */
+	static void forRows(ThreadPool* pool, int rows, const std::function<void(unsigned int, unsigned int)>& body);
+	void toLinear(const unsigned char* source, int pixelCount, int components, float* linear) const;
+	void fromLinear(const float* linear, int pixelCount, int components, unsigned char* target) const;
+	static void boxRows(const float* source, int width, int height, float* target, int targetWidth, int firstRow, int lastRow);
+	static void kaiserHorizontal(const float* source, int width, float* target, int targetWidth, int firstRow, int lastRow);
+	static void kaiserVertical(const float* source, int height, int width, float* target, int firstRow, int lastRow);
+	static const float* kaiserWeights();
+	static const float* srgbToLinearTable();
+	static const unsigned char* linearToSrgbTable();
+
+	static const int kaiserTaps = 12;
+	static const int srgbTableSize = 4096;
+};
+
+
+MipGenerator::MipGenerator(Mip_filter filter = Mip_filter::BOX, bool srgb = true) : Filter(filter), Srgb(srgb)
+{
+}
+
+void MipGenerator::Generate(std::vector<std::vector<unsigned char>>& levels, int width, int height, int components,
+	ThreadPool* pool = nullptr) const
+{
+	levels.resize(1);
+	std::vector<float> current((size_t)width * height * 4);
+	toLinear(levels[0].data(), width * height, components, current.data());
+
+	std::vector<float> next, horizontal;
+	while (width > 1 || height > 1) {
+		int nextWidth = std::max(width / 2, 1);
+		int nextHeight = std::max(height / 2, 1);
+		next.resize((size_t)nextWidth * nextHeight * 4);
+		levels.emplace_back((size_t)nextWidth * nextHeight * components);
+		unsigned char* target = levels.back().data();
+
+		if (Filter == Mip_filter::BOX) {
+			forRows(pool, nextHeight, [&](unsigned int begin, unsigned int end) {
+				boxRows(current.data(), width, height, next.data(), nextWidth, (int)begin, (int)end);
+				fromLinear(next.data() + (size_t)begin * nextWidth * 4, (int)(end - begin) * nextWidth, components,
+					target + (size_t)begin * nextWidth * components);
+			});
+		}
+		else {
+			/* Separable - halve the width of every row, then the height of every column */
+			horizontal.resize((size_t)nextWidth * height * 4);
+			forRows(pool, height, [&](unsigned int begin, unsigned int end) {
+				kaiserHorizontal(current.data(), width, horizontal.data(), nextWidth, (int)begin, (int)end);
+			});
+			forRows(pool, nextHeight, [&](unsigned int begin, unsigned int end) {
+				if (height > 1)
+					kaiserVertical(horizontal.data(), height, nextWidth, next.data(), (int)begin, (int)end);
+				else
+					std::copy(horizontal.begin(), horizontal.end(), next.begin());
+				fromLinear(next.data() + (size_t)begin * nextWidth * 4, (int)(end - begin) * nextWidth, components,
+					target + (size_t)begin * nextWidth * components);
+			});
+		}
+
+		current.swap(next);
+		width = nextWidth;
+		height = nextHeight;
+	}
+}
+
+inline unsigned int MipGenerator::LevelCount(int width, int height) noexcept
+{
+	unsigned int levels = 1;
+	while (width > 1 || height > 1) {
+		width = std::max(width / 2, 1);
+		height = std::max(height / 2, 1);
+		levels++;
+	}
+	return levels;
+}
+
+void MipGenerator::forRows(ThreadPool* pool, int rows, const std::function<void(unsigned int, unsigned int)>& body)
+{
+	/* Small levels finish faster than the workers wake up */
+	if (pool && rows >= 64)
+		pool->ParallelFor((unsigned int)rows, body);
+	else
+		body(0, (unsigned int)rows);
+}
+
+void MipGenerator::toLinear(const unsigned char* source, int pixelCount, int components, float* linear) const
+{
+	const float* table = srgbToLinearTable();
+	/* The last channel of grey and alpha or RGBA images is alpha, which is never sRGB */
+	bool alpha = components == 2 || components == 4;
+	int colorChannels = alpha ? components - 1 : components;
+	for (int i = 0; i < pixelCount; i++) {
+		const unsigned char* pixel = source + (size_t)i * components;
+		float* out = linear + (size_t)i * 4;
+		for (int c = 0; c < 4; c++) {
+			if (c < colorChannels)
+				out[c] = Srgb ? table[pixel[c]] : pixel[c] / 255.0f;
+			else if (c == 3)
+				out[c] = alpha ? pixel[components - 1] / 255.0f : 1.0f;
+			else
+				out[c] = 0.0f;
+		}
+	}
+}
+
+void MipGenerator::fromLinear(const float* linear, int pixelCount, int components, unsigned char* target) const
+{
+	const unsigned char* table = linearToSrgbTable();
+	bool alpha = components == 2 || components == 4;
+	int colorChannels = alpha ? components - 1 : components;
+	for (int i = 0; i < pixelCount; i++) {
+		const float* pixel = linear + (size_t)i * 4;
+		unsigned char* out = target + (size_t)i * components;
+		/* Sharp filters overshoot, clamp before quantizing */
+		for (int c = 0; c < colorChannels; c++) {
+			float value = std::min(std::max(pixel[c], 0.0f), 1.0f);
+			out[c] = Srgb ? table[(int)(value * (srgbTableSize - 1) + 0.5f)] : (unsigned char)(value * 255.0f + 0.5f);
+		}
+		if (alpha)
+			out[components - 1] = (unsigned char)(std::min(std::max(pixel[3], 0.0f), 1.0f) * 255.0f + 0.5f);
+	}
+}
+
+void MipGenerator::boxRows(const float* source, int width, int height, float* target, int targetWidth, int firstRow, int lastRow)
+{
+	for (int y = firstRow; y < lastRow; y++) {
+		/* Odd sizes repeat their last row/column */
+		const float* row0 = source + (size_t)std::min(y * 2, height - 1) * width * 4;
+		const float* row1 = source + (size_t)std::min(y * 2 + 1, height - 1) * width * 4;
+		float* out = target + (size_t)y * targetWidth * 4;
+
+		for (int x = 0; x < targetWidth; x++) {
+			int x0 = std::min(x * 2, width - 1);
+			int x1 = std::min(x * 2 + 1, width - 1);
+#if defined(MIP_GENERATOR_AVX)
+			/* Both source pixels of a row are adjacent, one 8 float load per row */
+			if (x1 == x0 + 1) {
+				__m256 sum = _mm256_add_ps(_mm256_loadu_ps(row0 + x0 * 4), _mm256_loadu_ps(row1 + x0 * 4));
+				__m128 pixel = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+				_mm_storeu_ps(out + x * 4, _mm_mul_ps(pixel, _mm_set1_ps(0.25f)));
+				continue;
+			}
+#endif
+#if defined(MIP_GENERATOR_SSE2)
+			__m128 sum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(row0 + x0 * 4), _mm_loadu_ps(row0 + x1 * 4)),
+				_mm_add_ps(_mm_loadu_ps(row1 + x0 * 4), _mm_loadu_ps(row1 + x1 * 4)));
+			_mm_storeu_ps(out + x * 4, _mm_mul_ps(sum, _mm_set1_ps(0.25f)));
+#else
+			for (int c = 0; c < 4; c++)
+				out[x * 4 + c] = (row0[x0 * 4 + c] + row0[x1 * 4 + c] + row1[x0 * 4 + c] + row1[x1 * 4 + c]) * 0.25f;
+#endif
+		}
+	}
+}
+
+void MipGenerator::kaiserHorizontal(const float* source, int width, float* target, int targetWidth, int firstRow, int lastRow)
+{
+	const float* weights = kaiserWeights();
+	for (int y = firstRow; y < lastRow; y++) {
+		const float* row = source + (size_t)y * width * 4;
+		float* out = target + (size_t)y * targetWidth * 4;
+		for (int x = 0; x < targetWidth; x++) {
+			/* Taps 2x-5 .. 2x+6 around the center of the destination pixel, clamped to the edge */
+			int first = x * 2 - kaiserTaps / 2 + 1;
+#if defined(MIP_GENERATOR_SSE2)
+			__m128 sum = _mm_setzero_ps();
+			for (int t = 0; t < kaiserTaps; t++) {
+				int sx = std::min(std::max(first + t, 0), width - 1);
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(row + sx * 4), _mm_set1_ps(weights[t])));
+			}
+			_mm_storeu_ps(out + x * 4, sum);
+#else
+			float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			for (int t = 0; t < kaiserTaps; t++) {
+				int sx = std::min(std::max(first + t, 0), width - 1);
+				for (int c = 0; c < 4; c++)
+					sum[c] += row[sx * 4 + c] * weights[t];
+			}
+			std::copy(sum, sum + 4, out + x * 4);
+#endif
+		}
+	}
+}
+
+void MipGenerator::kaiserVertical(const float* source, int height, int width, float* target, int firstRow, int lastRow)
+{
+	const float* weights = kaiserWeights();
+	int floatsPerRow = width * 4;
+	for (int y = firstRow; y < lastRow; y++) {
+		float* out = target + (size_t)y * floatsPerRow;
+		int first = y * 2 - kaiserTaps / 2 + 1;
+		const float* rows[kaiserTaps];
+		for (int t = 0; t < kaiserTaps; t++)
+			rows[t] = source + (size_t)std::min(std::max(first + t, 0), height - 1) * floatsPerRow;
+
+		/* Whole rows are contiguous, 8 floats (2 pixels) per step with AVX */
+		int i = 0;
+#if defined(MIP_GENERATOR_AVX)
+		for (; i + 8 <= floatsPerRow; i += 8) {
+			__m256 sum = _mm256_setzero_ps();
+			for (int t = 0; t < kaiserTaps; t++)
+				sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_loadu_ps(rows[t] + i), _mm256_set1_ps(weights[t])));
+			_mm256_storeu_ps(out + i, sum);
+		}
+#endif
+#if defined(MIP_GENERATOR_SSE2)
+		for (; i + 4 <= floatsPerRow; i += 4) {
+			__m128 sum = _mm_setzero_ps();
+			for (int t = 0; t < kaiserTaps; t++)
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(rows[t] + i), _mm_set1_ps(weights[t])));
+			_mm_storeu_ps(out + i, sum);
+		}
+#endif
+		for (; i < floatsPerRow; i++) {
+			float sum = 0.0f;
+			for (int t = 0; t < kaiserTaps; t++)
+				sum += rows[t][i] * weights[t];
+			out[i] = sum;
+		}
+	}
+}
+
+const float* MipGenerator::kaiserWeights()
+{
+	/* Sinc of the destination pixel spacing, Kaiser window (alpha 4) 3 destination pixels wide */
+	static const std::vector<float> weights = [] {
+		const double pi = 3.14159265358979323846;
+		const double alpha = 4.0;
+		const double radius = 3.0;
+		auto besselI0 = [](double x) {
+			double sum = 1.0, term = 1.0;
+			for (int k = 1; k < 32; k++) {
+				term *= (x / (2.0 * k)) * (x / (2.0 * k));
+				sum += term;
+			}
+			return sum;
+		};
+
+		std::vector<float> result(kaiserTaps);
+		double total = 0.0;
+		for (int t = 0; t < kaiserTaps; t++) {
+			/* Distance of the tap from the destination pixel center, in destination pixels */
+			double distance = (t - kaiserTaps / 2 + 0.5) / 2.0;
+			double sinc = std::sin(pi * distance) / (pi * distance);
+			double ratio = distance / radius;
+			double window = besselI0(alpha * std::sqrt(std::max(0.0, 1.0 - ratio * ratio))) / besselI0(alpha);
+			result[t] = (float)(sinc * window);
+			total += result[t];
+		}
+		for (float& weight : result)
+			weight = (float)(weight / total);
+		return result;
+	}();
+	return weights.data();
+}
+
+const float* MipGenerator::srgbToLinearTable()
+{
+	static const std::vector<float> table = [] {
+		std::vector<float> result(256);
+		for (int i = 0; i < 256; i++) {
+			double value = i / 255.0;
+			result[i] = (float)(value <= 0.04045 ? value / 12.92 : std::pow((value + 0.055) / 1.055, 2.4));
+		}
+		return result;
+	}();
+	return table.data();
+}
+
+const unsigned char* MipGenerator::linearToSrgbTable()
+{
+	static const std::vector<unsigned char> table = [] {
+		std::vector<unsigned char> result(srgbTableSize);
+		for (int i = 0; i < srgbTableSize; i++) {
+			double value = (double)i / (srgbTableSize - 1);
+			double encoded = value <= 0.0031308 ? value * 12.92 : 1.055 * std::pow(value, 1.0 / 2.4) - 0.055;
+			result[i] = (unsigned char)(encoded * 255.0 + 0.5);
+		}
+		return result;
+	}();
+	return table.data();
+}
+
+#endif
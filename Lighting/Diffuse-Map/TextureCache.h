@@ -0,0 +1,255 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "glad/glad.h"
+
+#include "TextureLoader.h"
+
+/* Sampler state that is part of the cache key, equal images with other state get their own texture */
+struct Texture_params {
+	/* Color or data, changes how the mips are filtered */
+	bool srgb = true;
+	GLint wrapS = GL_REPEAT;
+	GLint wrapT = GL_REPEAT;
+};
+
+/* Content addressed texture cache.
+Images are keyed by a hash of the file bytes plus their parameters, so the same image
+under another path or requested twice is decoded and uploaded once. The hash of a path is
+kept with the file's modification time and size, later requests only stat the file and read
+it again when it changed. Textures are reference counted, Release() deletes the texture with
+the last reference */
+class TextureCache
+{
+public:
+	/* Constructor and destructor */
+	TextureCache(TextureLoader& loader);
+	~TextureCache() noexcept;
+
+	/* Get the texture of the image, loading it through the loader on a miss. 0 if the file can't be read */
+	unsigned int Acquire(const char* path, const Texture_params& params);
+	/* Drop a reference taken by Acquire */
+	void Release(unsigned int texture);
+
+	/* Get functions */
+	float HitRate() const noexcept;
+	unsigned int TextureCount() const noexcept;
+
+public:
+	/* Statistics */
+	unsigned int Lookups;
+	unsigned int Hits;
+	/* Files read and hashed on the GL thread, the other lookups reused a kept hash */
+	unsigned int FilesHashed;
+	/* Bytes of the cached textures when they were uploaded, the streamer tracks the levels it adds later */
+	unsigned long long ResidentBytes;
+
+private:
+	struct Cache_key {
+		uint64_t hash;
+		bool srgb;
+		GLint wrapS;
+		GLint wrapT;
+
+		bool operator<(const Cache_key& other) const noexcept;
+	};
+	struct File_stamp {
+		long long modified;
+		long long size;
+
+		bool operator==(const File_stamp& other) const noexcept;
+	};
+	struct File_hash {
+		File_stamp stamp;
+		uint64_t hash;
+	};
+	struct Cache_entry {
+		Cache_key key;
+		unsigned int references;
+		size_t bytes;
+		bool resident;
+	};
+
+	/* Helper functions */
+	/* Called by the loader once the texture is uploaded or failed */
+	void finished(unsigned int texture, size_t bytes);
+	/* Hash of the file, read again only when its stamp changed */
+	bool contentHash(const char* path, uint64_t& hash);
+	static bool stampFile(const char* path, File_stamp& stamp);
+	static bool hashFile(const char* path, uint64_t& hash);
+private:
+	TextureLoader& loader;
+	std::map<Cache_key, unsigned int> textures;
+	std::map<unsigned int, Cache_entry> entries;
+	std::map<std::string, File_hash> fileHashes;
+	/* Released before their upload finished, deleted when it does */
+	std::vector<unsigned int> orphans;
+};
+
+
+TextureCache::TextureCache(TextureLoader& loader) : Lookups(0), Hits(0), FilesHashed(0), ResidentBytes(0), loader(loader)
+{
+	loader.Finished = [this](unsigned int texture, size_t bytes) { finished(texture, bytes); };
+}
+
+TextureCache::~TextureCache() noexcept
+{
+	loader.Finished = nullptr;
+	for (const auto& entry : entries)
+		glDeleteTextures(1, &entry.first);
+	if (!orphans.empty())
+		glDeleteTextures((GLsizei)orphans.size(), orphans.data());
+}
+
+unsigned int TextureCache::Acquire(const char* path, const Texture_params& params = Texture_params())
+{
+	/* A stat per request, the file is only read the first time and after it changed */
+	uint64_t hash;
+	if (!contentHash(path, hash)) {
+		std::cout << "Texture failed to load at path: " << path << std::endl;
+		return 0;
+	}
+
+	Lookups++;
+	Cache_key key{ hash, params.srgb, params.wrapS, params.wrapT };
+	auto found = textures.find(key);
+	if (found != textures.end()) {
+		Hits++;
+		entries[found->second].references++;
+		return found->second;
+	}
+
+	unsigned int texture = loader.Load(path, params.srgb);
+	/* The loader doesn't touch the wrap modes after Load() */
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, params.wrapS);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, params.wrapT);
+
+	textures[key] = texture;
+	entries[texture] = Cache_entry{ key, 1, 0, false };
+	return texture;
+}
+
+void TextureCache::Release(unsigned int texture)
+{
+	auto found = entries.find(texture);
+	if (found == entries.end() || --found->second.references > 0)
+		return;
+
+	textures.erase(found->second.key);
+	ResidentBytes -= found->second.bytes;
+	if (loader.Streamer)
+		loader.Streamer->Unregister(texture);
+	/* A decode is still running for it, the loader would upload into a deleted name */
+	if (!found->second.resident)
+		orphans.push_back(texture);
+	else
+		glDeleteTextures(1, &texture);
+	entries.erase(found);
+}
+
+inline float TextureCache::HitRate() const noexcept
+{
+	return Lookups ? (float)Hits / Lookups : 0.0f;
+}
+
+inline unsigned int TextureCache::TextureCount() const noexcept
+{
+	return (unsigned int)entries.size();
+}
+
+inline bool TextureCache::Cache_key::operator<(const Cache_key& other) const noexcept
+{
+	if (hash != other.hash)
+		return hash < other.hash;
+	if (srgb != other.srgb)
+		return srgb < other.srgb;
+	if (wrapS != other.wrapS)
+		return wrapS < other.wrapS;
+	return wrapT < other.wrapT;
+}
+
+void TextureCache::finished(unsigned int texture, size_t bytes)
+{
+	auto orphan = std::find(orphans.begin(), orphans.end(), texture);
+	if (orphan != orphans.end()) {
+		/* The upload already handed it to the streamer, which would keep the name and count its levels */
+		if (loader.Streamer)
+			loader.Streamer->Unregister(texture);
+		glDeleteTextures(1, &texture);
+		orphans.erase(orphan);
+		return;
+	}
+
+	auto found = entries.find(texture);
+	if (found == entries.end())
+		return;
+	found->second.resident = true;
+	found->second.bytes = bytes;
+	ResidentBytes += bytes;
+}
+
+bool TextureCache::contentHash(const char* path, uint64_t& hash)
+{
+	File_stamp stamp;
+	if (!stampFile(path, stamp))
+		return false;
+
+	auto found = fileHashes.find(path);
+	if (found != fileHashes.end() && found->second.stamp == stamp) {
+		hash = found->second.hash;
+		return true;
+	}
+	if (!hashFile(path, hash))
+		return false;
+	FilesHashed++;
+	fileHashes[path] = File_hash{ stamp, hash };
+	return true;
+}
+
+inline bool TextureCache::File_stamp::operator==(const File_stamp& other) const noexcept
+{
+	return modified == other.modified && size == other.size;
+}
+
+inline bool TextureCache::stampFile(const char* path, File_stamp& stamp)
+{
+	struct stat status;
+	if (stat(path, &status) != 0)
+		return false;
+	stamp.modified = (long long)status.st_mtime;
+	stamp.size = (long long)status.st_size;
+	return true;
+}
+
+bool TextureCache::hashFile(const char* path, uint64_t& hash)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+		return false;
+
+	/* 64 bit FNV-1a over the whole file */
+	hash = 14695981039346656037ull;
+	std::vector<char> buffer(64 * 1024);
+	while (file) {
+		file.read(buffer.data(), buffer.size());
+		std::streamsize count = file.gcount();
+		for (std::streamsize i = 0; i < count; i++) {
+			hash ^= (unsigned char)buffer[i];
+			hash *= 1099511628211ull;
+		}
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,259 @@
+#ifndef TEXTURE_STREAMER_H
+#define TEXTURE_STREAMER_H
+
+#include <vector>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+#include "glad/glad.h"
+
+#include "KtxTexture.h"
+#include "PixelBufferPool.h"
+
+/* Mip streaming under a memory budget.
+Registered textures keep their mip chain in system memory and start with only the small
+levels resident, GL_TEXTURE_BASE_LEVEL hides the missing ones from sampling. Each frame the
+renderer reports how many pixels the objects using a texture cover on screen, Update() then
+streams in the finer levels that footprint needs and evicts the ones it doesn't, keeping the
+resident levels of all textures within BudgetBytes. With PixelBuffers set the levels are copied into
+a pixel unpack buffer, so the driver transfers them without stalling on client memory */
+class TextureStreamer
+{
+public:
+	/* Constructor */
+	TextureStreamer(size_t budgetBytes, int residentSize);
+
+	/* Take over the texture, uploads its small levels. Returns their size in bytes */
+	size_t Register(unsigned int texture, std::shared_ptr<KtxTexture> levels);
+	/* Forget the texture before it is deleted */
+	void Unregister(unsigned int texture);
+	/* The object using the texture spans screenPixels along its longest side this frame */
+	void RequestFootprint(unsigned int texture, float screenPixels);
+	/* Evict what isn't needed and stream in levels until the time budget runs out, true if a level changed */
+	bool Update(double budgetMs);
+
+	/* Get functions */
+	/* Finer levels are wanted and fit into the budget */
+	bool StreamingPending() const noexcept;
+
+public:
+	size_t BudgetBytes;
+	/* Staging buffers for the level uploads, null to upload from client memory */
+	PixelBufferPool* PixelBuffers;
+	/* Levels of at most this many pixels per side are always resident */
+	int ResidentSize;
+	/* Statistics, updated by Update() */
+	/* Bytes of the resident levels */
+	size_t ResidentBytes;
+	/* Bytes the footprints ask for, before the budget cuts them */
+	size_t RequestedBytes;
+	unsigned int LevelsStreamedIn;
+	unsigned int LevelsEvicted;
+
+private:
+	struct Streamed_texture {
+		std::shared_ptr<KtxTexture> levels;
+		/* Finest resident level */
+		int baseLevel;
+		/* Coarsest level that is always resident */
+		int tailLevel;
+		/* Finest level wanted by the footprints and allowed by the budget */
+		int targetLevel;
+		/* Largest footprint reported since the last Update() */
+		float footprint;
+	};
+
+	/* Helper functions */
+	void uploadLevel(unsigned int texture, const KtxTexture& levels, int level) const;
+	void setBaseLevel(unsigned int texture, int level) const;
+	/* Level whose texels map about 1:1 to the footprint pixels */
+	static int levelForFootprint(const KtxTexture& levels, float footprint, int tailLevel) noexcept;
+	/* Bytes of the levels from level to the end of the chain */
+	static size_t chainBytes(const KtxTexture& levels, int level) noexcept;
+private:
+	std::map<unsigned int, Streamed_texture> textures;
+};
+
+
+TextureStreamer::TextureStreamer(size_t budgetBytes = 64 * 1024 * 1024, int residentSize = 64)
+	: BudgetBytes(budgetBytes), PixelBuffers(nullptr), ResidentSize(residentSize), ResidentBytes(0), RequestedBytes(0), LevelsStreamedIn(0),
+	LevelsEvicted(0)
+{
+}
+
+size_t TextureStreamer::Register(unsigned int texture, std::shared_ptr<KtxTexture> levels)
+{
+	int tailLevel = (int)levels->Levels.size() - 1;
+	while (tailLevel > 0 && std::max(levels->LevelWidth(tailLevel - 1), levels->LevelHeight(tailLevel - 1)) <= ResidentSize)
+		tailLevel--;
+
+	for (int level = (int)levels->Levels.size() - 1; level >= tailLevel; level--)
+		uploadLevel(texture, *levels, level);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)levels->Levels.size() - 1);
+	setBaseLevel(texture, tailLevel);
+
+	size_t bytes = chainBytes(*levels, tailLevel);
+	ResidentBytes += bytes;
+	textures[texture] = Streamed_texture{ levels, tailLevel, tailLevel, tailLevel, 0.0f };
+	return bytes;
+}
+
+void TextureStreamer::Unregister(unsigned int texture)
+{
+	auto found = textures.find(texture);
+	if (found == textures.end())
+		return;
+	ResidentBytes -= chainBytes(*found->second.levels, found->second.baseLevel);
+	textures.erase(found);
+}
+
+inline void TextureStreamer::RequestFootprint(unsigned int texture, float screenPixels)
+{
+	auto found = textures.find(texture);
+	if (found != textures.end())
+		found->second.footprint = std::max(found->second.footprint, screenPixels);
+}
+
+bool TextureStreamer::Update(double budgetMs)
+{
+	/* Biggest footprints first, they get the budget when it runs short */
+	std::vector<std::pair<float, unsigned int>> order;
+	RequestedBytes = 0;
+	for (auto& entry : textures) {
+		Streamed_texture& streamed = entry.second;
+		streamed.targetLevel = levelForFootprint(*streamed.levels, streamed.footprint, streamed.tailLevel);
+		RequestedBytes += chainBytes(*streamed.levels, streamed.targetLevel);
+		order.push_back({ streamed.footprint, entry.first });
+		streamed.footprint = 0.0f;
+	}
+	std::sort(order.begin(), order.end(), [](const std::pair<float, unsigned int>& a, const std::pair<float, unsigned int>& b) {
+		return a.first > b.first;
+	});
+
+	/* The tails are always resident, the rest of the budget goes to the finer levels */
+	size_t available = BudgetBytes;
+	for (auto& entry : textures)
+		available -= std::min(available, chainBytes(*entry.second.levels, entry.second.tailLevel));
+	for (const auto& item : order) {
+		Streamed_texture& streamed = textures[item.second];
+		while (streamed.targetLevel < streamed.tailLevel) {
+			size_t bytes = chainBytes(*streamed.levels, streamed.targetLevel) - chainBytes(*streamed.levels, streamed.tailLevel);
+			if (bytes <= available) {
+				available -= bytes;
+				break;
+			}
+			streamed.targetLevel++;
+		}
+	}
+
+	/* Evicting is cheap - a 0x0 image frees the level, it is below the base level so the texture stays complete */
+	bool changed = false;
+	for (auto& entry : textures) {
+		Streamed_texture& streamed = entry.second;
+		if (streamed.baseLevel >= streamed.targetLevel)
+			continue;
+
+		setBaseLevel(entry.first, streamed.targetLevel);
+		for (int level = streamed.baseLevel; level < streamed.targetLevel; level++) {
+			if (streamed.levels->IsCompressed())
+				glCompressedTexImage2D(GL_TEXTURE_2D, level, streamed.levels->GlInternalFormat, 0, 0, 0, 0, NULL);
+			else
+				glTexImage2D(GL_TEXTURE_2D, level, streamed.levels->GlInternalFormat, 0, 0, 0,
+					streamed.levels->GlFormat, streamed.levels->GlType, NULL);
+			ResidentBytes -= streamed.levels->Levels[level].size();
+			LevelsEvicted++;
+		}
+		streamed.baseLevel = streamed.targetLevel;
+		changed = true;
+	}
+
+	/* Stream in one level at a time, the biggest footprints first, so sharpness improves gradually */
+	auto start = std::chrono::steady_clock::now();
+	bool streamedAny = true;
+	while (streamedAny) {
+		streamedAny = false;
+		for (const auto& item : order) {
+			double spent = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			if (changed && spent >= budgetMs)
+				return true;
+
+			Streamed_texture& streamed = textures[item.second];
+			if (streamed.baseLevel <= streamed.targetLevel)
+				continue;
+
+			streamed.baseLevel--;
+			uploadLevel(item.second, *streamed.levels, streamed.baseLevel);
+			setBaseLevel(item.second, streamed.baseLevel);
+			ResidentBytes += streamed.levels->Levels[streamed.baseLevel].size();
+			LevelsStreamedIn++;
+			streamedAny = changed = true;
+		}
+	}
+	return changed;
+}
+
+inline bool TextureStreamer::StreamingPending() const noexcept
+{
+	for (const auto& entry : textures) {
+		if (entry.second.baseLevel > entry.second.targetLevel)
+			return true;
+	}
+	return false;
+}
+
+void TextureStreamer::uploadLevel(unsigned int texture, const KtxTexture& levels, int level) const
+{
+	const std::vector<unsigned char>& data = levels.Levels[level];
+	/* Every buffer in flight or mapping failed, the level goes from client memory instead */
+	void* mapped = nullptr;
+	int buffer = PixelBuffers ? PixelBuffers->Acquire((GLsizeiptr)data.size(), &mapped) : PixelBufferPool::InFlight;
+	const void* pixels = data.data();
+	if (buffer >= 0) {
+		memcpy(mapped, data.data(), data.size());
+		PixelBuffers->Bind(buffer);
+		/* The pixels start at offset 0 of the bound buffer */
+		pixels = NULL;
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	if (levels.IsCompressed())
+		glCompressedTexImage2D(GL_TEXTURE_2D, level, levels.GlInternalFormat, levels.LevelWidth(level), levels.LevelHeight(level),
+			0, (GLsizei)data.size(), pixels);
+	else
+		glTexImage2D(GL_TEXTURE_2D, level, levels.GlInternalFormat, levels.LevelWidth(level), levels.LevelHeight(level), 0,
+			levels.GlFormat, levels.GlType, pixels);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	if (buffer >= 0)
+		PixelBuffers->Release(buffer);
+}
+
+inline void TextureStreamer::setBaseLevel(unsigned int texture, int level) const
+{
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+}
+
+inline int TextureStreamer::levelForFootprint(const KtxTexture& levels, float footprint, int tailLevel) noexcept
+{
+	/* Not on screen, the tail is enough */
+	if (footprint < 1.0f)
+		return tailLevel;
+	float texels = (float)std::max(levels.Width, levels.Height);
+	int level = (int)std::floor(std::log2(std::max(texels / footprint, 1.0f)));
+	return std::min(level, tailLevel);
+}
+
+inline size_t TextureStreamer::chainBytes(const KtxTexture& levels, int level) noexcept
+{
+	size_t bytes = 0;
+	for (size_t i = (size_t)level; i < levels.Levels.size(); i++)
+		bytes += levels.Levels[i].size();
+	return bytes;
+}
+
+#endif
@@ -8,14 +8,20 @@
 
 #include "Shader.h"
 #include "Camera.h"
+#include "FrameScheduler.h"
+#include "TextureLoader.h"
+#include "TextureCache.h"
 
 #include <iostream>
+#include <vector>
 
 
 void processInput(GLFWwindow* window);
 void frameBufferResize_callback(GLFWwindow* window, int width, int height);
 void mouseMovement_callback(GLFWwindow* window, double xPos, double yPos);
 void mouseScroll_callback(GLFWwindow* window, double xOffset, double yOffset);
+void windowRefresh_callback(GLFWwindow* window);
+bool isMoving(GLFWwindow* window);
 
 unsigned int loadTexture(const char* path);
 
@@ -37,6 +43,24 @@ float lastFrame = 0.0f;
 /************************************ LIGHTING ************************************/
 glm::vec3 lightPos(1.2f, 1.0f, 2.0f);
 
+/************************************ FRAME SCHEDULING ************************************/
+/* Render only when something changed, the scene is static otherwise */
+const bool renderOnDemand = true;
+FrameScheduler frameScheduler(renderOnDemand);
+unsigned int seenCameraVersion = 0;
+
+/************************************ TEXTURE LOADING ************************************/
+/* Decode the textures on worker threads, the first frames show placeholders */
+const bool asyncTextureLoading = true;
+/* Time every frame may spend uploading the decoded textures */
+const double textureUploadBudgetMs = 2.0;
+/* Stage the uploads through pixel buffers or upload from client memory (DIRECT) */
+const Texture_upload textureUploadPath = Texture_upload::PIXEL_BUFFER;
+/* Benchmark - additional copies of the textures to load, e.g. 128 */
+const unsigned int benchmarkTextureCount = 0;
+/* Share one texture between identical images, off to load every benchmark copy on its own */
+const bool textureCaching = true;
+
 int main()
 {
 	/************************************ INITIALIZATION ************************************/
@@ -63,6 +87,7 @@ int main()
 	glfwSetFramebufferSizeCallback(window, frameBufferResize_callback);
 	glfwSetCursorPosCallback(window, mouseMovement_callback);
 	glfwSetScrollCallback(window, mouseScroll_callback);
+	glfwSetWindowRefreshCallback(window, windowRefresh_callback);
 
 	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
@@ -144,7 +169,31 @@ int main()
 	glEnableVertexAttribArray(0);
 
 	/************************************ TEXTURES ************************************/
-	unsigned int diffuseMap = loadTexture("textures/container2.png");
+	/* Baked .ktx files in textures (Tools/Texture-Baker) are loaded instead of the images if present */
+	TextureLoader textureLoader(textureUploadPath);
+	double textureRequestTime = glfwGetTime();
+	/* Color maps get their mips averaged in linear space, data maps as they are */
+	TextureCache textureCache(textureLoader);
+	auto requestTexture = [&textureLoader, &textureCache](const char* path, bool srgb) {
+		if (!asyncTextureLoading)
+			return loadTexture(path);
+		Texture_params params;
+		params.srgb = srgb;
+		return textureCaching ? textureCache.Acquire(path, params) : textureLoader.Load(path, srgb);
+	};
+	auto releaseTexture = [&textureCache](unsigned int texture) {
+		if (asyncTextureLoading && textureCaching)
+			textureCache.Release(texture);
+		else
+			glDeleteTextures(1, &texture);
+	};
+
+	unsigned int diffuseMap = requestTexture("textures/container2.png", true);
+
+	std::vector<unsigned int> benchmarkTextures;
+	for (unsigned int i = 0; i < benchmarkTextureCount; i++)
+		benchmarkTextures.push_back(requestTexture(i % 2 ? "textures/container.jpg" : "textures/container2.png", true));
+	bool texturesReported = false;
 
 	/************************************ SHADERS ************************************/
 	Shader lightingShader("shaders/shader.vs", "shaders/shader.fs");
@@ -152,20 +201,43 @@ int main()
 
 	/************************************ RENDER LOOP ************************************/
 	glEnable(GL_DEPTH_TEST);
+	lastFrame = glfwGetTime();
 	while (!glfwWindowShouldClose(window)) {
+		float currentFrame = glfwGetTime();
+		deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+
 		processInput(window);
 
+		/* Upload the textures decoded meanwhile, they replace the placeholders */
+		if (textureLoader.Update(textureUploadBudgetMs) > 0)
+			frameScheduler.MarkDirty();
+		if (!texturesReported && textureLoader.AllResident()) {
+			std::cout << "All " << 1 + benchmarkTextureCount << " textures resident after "
+				<< (glfwGetTime() - textureRequestTime) * 1000.0 << " ms" << std::endl;
+			if (asyncTextureLoading)
+				std::cout << "Uploaded " << textureLoader.UploadedBytes / (1024.0 * 1024.0) << " MB in "
+				<< textureLoader.UploadMs << " ms of GL thread time (" << textureLoader.UploadThroughput() << " MB/s)" << std::endl;
+			if (asyncTextureLoading && textureCaching)
+				std::cout << "Texture cache: " << textureCache.TextureCount() << " textures for " << textureCache.Lookups
+				<< " requests (" << textureCache.HitRate() * 100.0f << "% hits, " << textureCache.FilesHashed << " files hashed), "
+				<< textureCache.ResidentBytes / (1024.0 * 1024.0) << " MB resident" << std::endl;
+			texturesReported = true;
+		}
+
+		/* Redraw only if the camera moved, a key is held or the window changed */
+		frameScheduler.TrackVersion(seenCameraVersion, camera.Version);
+		frameScheduler.SetAnimating(isMoving(window) || textureLoader.UploadsPending());
+		if (!frameScheduler.ShouldRender()) {
+			/* Keep the last presented frame, restart the timer after sleeping */
+			if (frameScheduler.WaitForEvents())
+				lastFrame = glfwGetTime();
+			continue;
+		}
+
 		glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-		glm::vec3 lightColor;
-		lightColor.x = sin(glfwGetTime() * 2.0f);
-		lightColor.y = sin(glfwGetTime() * 0.7f);
-		lightColor.z = sin(glfwGetTime() * 1.3f);
-
-		glm::vec3 diffuseColor = lightColor * glm::vec3(0.5f);
-		glm::vec3 ambientColor = lightColor * glm::vec3(0.2f);
-
 		/* Set the light colors */
 		lightingShader.use();
 		lightingShader.setVec3("light.ambient", 0.2f, 0.2f, 0.2f);
@@ -212,17 +284,20 @@ int main()
 		glDrawArrays(GL_TRIANGLES, 0, 36);
 
 
-		float currentFrame = glfwGetTime();
-		deltaTime = currentFrame - lastFrame;
-		lastFrame = currentFrame;
-
 		glfwSwapBuffers(window);
-		glfwPollEvents();
+		frameScheduler.FramePresented();
+		if (frameScheduler.FramesRendered == 1)
+			std::cout << "Time to first frame: " << glfwGetTime() * 1000.0 << " ms" << std::endl;
+		if (frameScheduler.WaitForEvents())
+			lastFrame = glfwGetTime();
 	}
 
 	glDeleteVertexArrays(1, &cubeVAO);
 	glDeleteVertexArrays(1, &lightVAO);
 	glDeleteBuffers(1, &VBO);
+	releaseTexture(diffuseMap);
+	for (unsigned int texture : benchmarkTextures)
+		releaseTexture(texture);
 	glfwTerminate();
 }
 
@@ -243,9 +318,22 @@ void processInput(GLFWwindow* window)
 		camera.ProcessKeyboard(Camera_movement::RIGHT, deltaTime);
 }
 
+bool isMoving(GLFWwindow* window)
+{
+	return glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS ||
+		glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS;
+}
+
 void frameBufferResize_callback(GLFWwindow* window, int width, int height)
 {
 	glViewport(0, 0, width, height);
+	frameScheduler.MarkDirty();
+}
+
+void windowRefresh_callback(GLFWwindow* window)
+{
+	/* Window was uncovered or damaged, its contents have to be drawn again */
+	frameScheduler.MarkDirty();
 }
 
 void mouseMovement_callback(GLFWwindow* window, double xPos, double yPos)
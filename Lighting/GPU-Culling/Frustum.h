@@ -0,0 +1,72 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <cmath>
+
+#include "glm/glm.hpp"
+
+/* View frustum as six planes taken from a view projection matrix (Gribb and Hartmann).
+The planes point inwards and are normalized, a point p is inside if dot(plane.xyz, p) + plane.w >= 0
+for all of them */
+class Frustum
+{
+public:
+	/* Constructor */
+	explicit Frustum(const glm::mat4& viewProjection);
+
+	/* Conservative, a box near an edge of the frustum may pass without touching it */
+	bool IntersectsBox(const glm::vec3& boundsMin, const glm::vec3& boundsMax) const noexcept;
+	bool IntersectsSphere(const glm::vec3& center, float radius) const noexcept;
+
+	/* Get functions */
+	/* Left, right, bottom, top, near, far */
+	const glm::vec4& Plane(int index) const noexcept;
+
+private:
+	glm::vec4 planes[6];
+};
+
+
+inline Frustum::Frustum(const glm::mat4& viewProjection)
+{
+	/* glm is column major, row i is (m[0][i], m[1][i], m[2][i], m[3][i]) */
+	glm::vec4 rows[4];
+	for (int i = 0; i < 4; i++)
+		rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+
+	planes[0] = rows[3] + rows[0];
+	planes[1] = rows[3] - rows[0];
+	planes[2] = rows[3] + rows[1];
+	planes[3] = rows[3] - rows[1];
+	planes[4] = rows[3] + rows[2];
+	planes[5] = rows[3] - rows[2];
+	for (glm::vec4& plane : planes)
+		plane /= glm::length(glm::vec3(plane));
+}
+
+inline bool Frustum::IntersectsBox(const glm::vec3& boundsMin, const glm::vec3& boundsMax) const noexcept
+{
+	for (const glm::vec4& plane : planes) {
+		/* The corner furthest along the plane normal */
+		glm::vec3 corner(plane.x > 0.0f ? boundsMax.x : boundsMin.x, plane.y > 0.0f ? boundsMax.y : boundsMin.y,
+			plane.z > 0.0f ? boundsMax.z : boundsMin.z);
+		if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+			return false;
+	}
+	return true;
+}
+
+inline bool Frustum::IntersectsSphere(const glm::vec3& center, float radius) const noexcept
+{
+	for (const glm::vec4& plane : planes)
+		if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+			return false;
+	return true;
+}
+
+inline const glm::vec4& Frustum::Plane(int index) const noexcept
+{
+	return planes[index];
+}
+
+#endif
@@ -0,0 +1,276 @@
+#ifndef GPU_CULLER_H
+#define GPU_CULLER_H
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+
+#include "Shader.h"
+#include "Frustum.h"
+
+/* Ways to cull on the GPU */
+enum class Cull_method {
+	/* GL 3.3, a geometry shader drops the culled instances and transform feedback captures the rest */
+	TRANSFORM_FEEDBACK,
+	/* GL 4.3, a compute shader appends the survivors and counts them in the indirect command */
+	COMPUTE
+};
+
+/* Frustum culling of instanced boxes without a CPU readback.
+Every instance is a vec4, the box center and its size. Cull() writes the instances whose
+bounding sphere touches the frustum to the survivor buffer, the draws then take the survivor
+count from GPU memory: DrawIndirect() after COMPUTE, DrawFeedback() after TRANSFORM_FEEDBACK.
+glDrawTransformFeedback (ARB_transform_feedback2) can't draw instanced, so it draws the
+survivors as points for a geometry shader that expands them to boxes. Without
+ARB_transform_feedback2 FeedbackCount() reads the count back, which waits for the GPU */
+class GpuCuller
+{
+public:
+	/* Constructor and destructor */
+	GpuCuller(const std::vector<glm::vec4>& instances, GLuint boxIndexCount);
+	~GpuCuller() noexcept;
+
+	/* Write the survivors of the method to the survivor buffer */
+	void Cull(Cull_method method, const Frustum& frustum);
+	/* Draw the box elements once per survivor of COMPUTE, the VAO has to read the survivor buffer per instance */
+	void DrawIndirect() const;
+	/* Draw the survivors of TRANSFORM_FEEDBACK as points, the VAO has to read the survivor buffer per vertex */
+	void DrawFeedback() const;
+	/* Wait for the survivor count of the last Cull() */
+	unsigned int FeedbackCount();
+	/* Read the survivors of the last Cull() back, to check them */
+	std::vector<glm::vec4> ReadSurvivors(Cull_method method);
+
+	/* Get functions */
+	unsigned int SurvivorBuffer() const noexcept;
+	unsigned int InstanceCount() const noexcept;
+
+public:
+	/* GL 4.3 and the loader has compute shaders, storage buffers and indirect draws */
+	const bool ComputeSupported;
+	/* glDrawTransformFeedback, else the count is read back */
+	const bool FeedbackDrawSupported;
+	/* Statistics */
+	unsigned int Readbacks;
+
+private:
+	/* Helper functions */
+	static bool computeSupported();
+	static bool feedbackDrawSupported();
+	static void setPlanes(const Shader& shader, const Frustum& frustum);
+private:
+	Shader feedbackShader;
+	std::unique_ptr<Shader> computeShader;
+	unsigned int instanceCount;
+	unsigned int instanceBuffer, survivorBuffer, commandBuffer;
+	/* Points of every instance for the transform feedback pass */
+	unsigned int instanceVAO;
+	unsigned int feedback, feedbackQuery;
+};
+
+
+GpuCuller::GpuCuller(const std::vector<glm::vec4>& instances, GLuint boxIndexCount)
+	: ComputeSupported(computeSupported()), FeedbackDrawSupported(feedbackDrawSupported()), Readbacks(0),
+	feedbackShader("shaders/cull.vs", "shaders/cull.gs", "", { "survivor" }),
+	instanceCount((unsigned int)instances.size()), commandBuffer(0), feedback(0)
+{
+	glGenBuffers(1, &instanceBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+	glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(glm::vec4), instances.data(), GL_STATIC_DRAW);
+	/* Room for every instance, written on the GPU only */
+	glGenBuffers(1, &survivorBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, survivorBuffer);
+	glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(glm::vec4), NULL, GL_DYNAMIC_COPY);
+
+	glGenVertexArrays(1, &instanceVAO);
+	glBindVertexArray(instanceVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)0);
+	glEnableVertexAttribArray(0);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glGenQueries(1, &feedbackQuery);
+#ifdef GL_ARB_transform_feedback2
+	if (FeedbackDrawSupported) {
+		/* The object remembers the buffer and how much was written to it */
+		glGenTransformFeedbacks(1, &feedback);
+		glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, feedback);
+		glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, survivorBuffer);
+		glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0);
+	}
+#endif
+
+#if defined(GL_ARB_compute_shader) && defined(GL_ARB_shader_storage_buffer_object) && defined(GL_ARB_draw_indirect)
+	if (ComputeSupported) {
+		/* DrawElementsIndirectCommand, the compute pass counts instanceCount */
+		GLuint command[5] = { boxIndexCount, 0, 0, 0, 0 };
+		glGenBuffers(1, &commandBuffer);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(command), command, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+		computeShader.reset(new Shader("shaders/cull.comp"));
+		computeShader->setStorageBlock("Instances", 0);
+		computeShader->setStorageBlock("Survivors", 1);
+		computeShader->setStorageBlock("Command", 2);
+	}
+#endif
+}
+
+GpuCuller::~GpuCuller() noexcept
+{
+	glDeleteVertexArrays(1, &instanceVAO);
+	glDeleteBuffers(1, &instanceBuffer);
+	glDeleteBuffers(1, &survivorBuffer);
+	glDeleteBuffers(1, &commandBuffer);
+	glDeleteQueries(1, &feedbackQuery);
+#ifdef GL_ARB_transform_feedback2
+	if (feedback)
+		glDeleteTransformFeedbacks(1, &feedback);
+#endif
+}
+
+void GpuCuller::Cull(Cull_method method, const Frustum& frustum)
+{
+	if (method == Cull_method::COMPUTE && !ComputeSupported) {
+		std::cout << "ERROR::GPU_CULLER::COMPUTE_NOT_SUPPORTED" << std::endl;
+		return;
+	}
+
+	if (method == Cull_method::TRANSFORM_FEEDBACK) {
+		feedbackShader.use();
+		setPlanes(feedbackShader, frustum);
+#ifdef GL_ARB_transform_feedback2
+		if (FeedbackDrawSupported)
+			glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, feedback);
+		else
+#endif
+			glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, survivorBuffer);
+
+		/* Nothing to rasterize, the points only go through the geometry shader */
+		glEnable(GL_RASTERIZER_DISCARD);
+		glBindVertexArray(instanceVAO);
+		glBeginQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, feedbackQuery);
+		glBeginTransformFeedback(GL_POINTS);
+		glDrawArrays(GL_POINTS, 0, (GLsizei)instanceCount);
+		glEndTransformFeedback();
+		glEndQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN);
+		glBindVertexArray(0);
+		glDisable(GL_RASTERIZER_DISCARD);
+
+#ifdef GL_ARB_transform_feedback2
+		if (FeedbackDrawSupported)
+			glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0);
+		else
+#endif
+			glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+		return;
+	}
+
+#if defined(GL_ARB_compute_shader) && defined(GL_ARB_shader_storage_buffer_object)
+	/* Restart the count, once the atomics of the previous dispatch are visible to the write */
+	glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+	GLuint zero = 0;
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+	glBufferSubData(GL_DRAW_INDIRECT_BUFFER, sizeof(GLuint), sizeof(GLuint), &zero);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+	computeShader->use();
+	setPlanes(*computeShader, frustum);
+	computeShader->setInt("totalInstances", (int)instanceCount);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, instanceBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, survivorBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, commandBuffer);
+	glDispatchCompute((instanceCount + 255) / 256, 1, 1);
+	/* The draw reads the count as a command and the survivors as vertex attributes */
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+#endif
+}
+
+inline void GpuCuller::DrawIndirect() const
+{
+#ifdef GL_ARB_draw_indirect
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+	glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, (void*)0);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+#endif
+}
+
+inline void GpuCuller::DrawFeedback() const
+{
+#ifdef GL_ARB_transform_feedback2
+	glDrawTransformFeedback(GL_POINTS, feedback);
+#endif
+}
+
+unsigned int GpuCuller::FeedbackCount()
+{
+	GLuint count = 0;
+	glGetQueryObjectuiv(feedbackQuery, GL_QUERY_RESULT, &count);
+	Readbacks++;
+	return count;
+}
+
+std::vector<glm::vec4> GpuCuller::ReadSurvivors(Cull_method method)
+{
+	GLuint count = 0;
+	if (method == Cull_method::COMPUTE) {
+#ifdef GL_ARB_shader_storage_buffer_object
+		glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+#endif
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+		glGetBufferSubData(GL_DRAW_INDIRECT_BUFFER, sizeof(GLuint), sizeof(GLuint), &count);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	}
+	else
+		glGetQueryObjectuiv(feedbackQuery, GL_QUERY_RESULT, &count);
+
+	std::vector<glm::vec4> survivors(count);
+	glBindBuffer(GL_ARRAY_BUFFER, survivorBuffer);
+	glGetBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(glm::vec4), survivors.data());
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	return survivors;
+}
+
+inline unsigned int GpuCuller::SurvivorBuffer() const noexcept
+{
+	return survivorBuffer;
+}
+
+inline unsigned int GpuCuller::InstanceCount() const noexcept
+{
+	return instanceCount;
+}
+
+inline bool GpuCuller::computeSupported()
+{
+	/* cull.comp is #version 430, and the loader has to have the functions the COMPUTE path calls */
+#if defined(GL_ARB_compute_shader) && defined(GL_ARB_shader_storage_buffer_object) && defined(GL_ARB_draw_indirect)
+	return (GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 3)) &&
+		GLAD_GL_ARB_compute_shader && GLAD_GL_ARB_shader_storage_buffer_object && GLAD_GL_ARB_draw_indirect;
+#else
+	return false;
+#endif
+}
+
+inline bool GpuCuller::feedbackDrawSupported()
+{
+#ifdef GL_ARB_transform_feedback2
+	return GLAD_GL_ARB_transform_feedback2 != 0;
+#else
+	return false;
+#endif
+}
+
+inline void GpuCuller::setPlanes(const Shader& shader, const Frustum& frustum)
+{
+	for (int i = 0; i < 6; i++)
+		shader.setVec4("planes[" + std::to_string(i) + "]", frustum.Plane(i));
+}
+
+#endif
@@ -0,0 +1,213 @@
+#ifndef SHADER_H
+#define SHADER_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+#include "glm/gtc/type_ptr.hpp"
+
+class Shader
+{
+public:
+	/* Constructors and destructor */
+	Shader(const std::string& pathVertex, const std::string& pathFragment);
+	/* An empty fragment path links without a fragment stage, for a program that only feeds transform feedback.
+	The varyings are captured interleaved into the buffer bound at index 0 */
+	Shader(const std::string& pathVertex, const std::string& pathGeometry, const std::string& pathFragment,
+		const std::vector<std::string>& feedbackVaryings);
+	/* Compute program */
+	explicit Shader(const std::string& pathCompute);
+	~Shader() noexcept;
+	/* Use function */
+	void use() const noexcept;
+	/* Set functions */
+	void setInt(const std::string& name, int val) const;
+	void setBool(const std::string& name, bool val) const;
+	void setFloat(const std::string& name, float val) const;
+	void setDouble(const std::string& name, double val) const;
+	void setMat4f(const std::string& name, glm::mat4 val) const;
+	void setVec3(const std::string& name, glm::vec3 val) const;
+	void setVec3(const std::string& name, float x, float y, float z) const;
+	void setVec4(const std::string& name, glm::vec4 val) const;
+	/* Connect the uniform block to the buffer bound at the binding point */
+	void setUniformBlock(const std::string& name, unsigned int binding) const;
+	/* Connect the shader storage block to the buffer bound at the binding point */
+	void setStorageBlock(const std::string& name, unsigned int binding) const;
+private:
+	/* Helper functions */
+	static unsigned int compile(GLenum type, const std::string& path, const char* stageName);
+	void link();
+private:
+	unsigned int ID;
+};
+
+
+Shader::Shader(const std::string& pathVertex, const std::string& pathFragment)
+{
+	unsigned int shaderVertex = compile(GL_VERTEX_SHADER, pathVertex, "VERTEX");
+	unsigned int shaderFragment = compile(GL_FRAGMENT_SHADER, pathFragment, "FRAGMENT");
+
+	ID = glCreateProgram();
+	glAttachShader(ID, shaderVertex);
+	glAttachShader(ID, shaderFragment);
+	link();
+
+	glDeleteShader(shaderFragment);
+	glDeleteShader(shaderVertex);
+}
+
+Shader::Shader(const std::string& pathVertex, const std::string& pathGeometry, const std::string& pathFragment,
+	const std::vector<std::string>& feedbackVaryings = {})
+{
+	std::vector<unsigned int> shaders;
+	shaders.push_back(compile(GL_VERTEX_SHADER, pathVertex, "VERTEX"));
+	shaders.push_back(compile(GL_GEOMETRY_SHADER, pathGeometry, "GEOMETRY"));
+	if (!pathFragment.empty())
+		shaders.push_back(compile(GL_FRAGMENT_SHADER, pathFragment, "FRAGMENT"));
+
+	ID = glCreateProgram();
+	for (unsigned int shader : shaders)
+		glAttachShader(ID, shader);
+	/* Has to be set before linking */
+	if (!feedbackVaryings.empty()) {
+		std::vector<const char*> names;
+		for (const std::string& varying : feedbackVaryings)
+			names.push_back(varying.c_str());
+		glTransformFeedbackVaryings(ID, (GLsizei)names.size(), names.data(), GL_INTERLEAVED_ATTRIBS);
+	}
+	link();
+
+	for (unsigned int shader : shaders)
+		glDeleteShader(shader);
+}
+
+Shader::Shader(const std::string& pathCompute)
+{
+	unsigned int shaderCompute = 0;
+#ifdef GL_ARB_compute_shader
+	shaderCompute = compile(GL_COMPUTE_SHADER, pathCompute, "COMPUTE");
+#endif
+
+	ID = glCreateProgram();
+	glAttachShader(ID, shaderCompute);
+	link();
+
+	glDeleteShader(shaderCompute);
+}
+
+inline void Shader::use() const noexcept
+{
+	glUseProgram(ID);
+}
+
+inline Shader::~Shader() noexcept
+{
+	glDeleteProgram(ID);
+}
+
+inline void Shader::setInt(const std::string& name, int val) const
+{
+	glUniform1i(glGetUniformLocation(ID, name.c_str()), val);
+}
+
+inline void Shader::setBool(const std::string& name, bool val) const
+{
+	glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)val);
+}
+
+inline void Shader::setFloat(const std::string& name, float val) const
+{
+	glUniform1f(glGetUniformLocation(ID, name.c_str()), val);
+}
+
+inline void Shader::setDouble(const std::string& name, double val) const
+{
+	glUniform1d(glGetUniformLocation(ID, name.c_str()), val);
+}
+
+inline void Shader::setMat4f(const std::string& name, glm::mat4 val) const
+{
+	glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(val));
+}
+
+inline void Shader::setVec3(const std::string& name, glm::vec3 val) const
+{
+	glUniform3f(glGetUniformLocation(ID, name.c_str()), val.x, val.y, val.z);
+}
+
+inline void Shader::setVec3(const std::string& name, float x, float y, float z) const
+{
+	glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+}
+
+inline void Shader::setVec4(const std::string& name, glm::vec4 val) const
+{
+	glUniform4f(glGetUniformLocation(ID, name.c_str()), val.x, val.y, val.z, val.w);
+}
+
+inline void Shader::setUniformBlock(const std::string& name, unsigned int binding) const
+{
+	unsigned int index = glGetUniformBlockIndex(ID, name.c_str());
+	if (index != GL_INVALID_INDEX)
+		glUniformBlockBinding(ID, index, binding);
+}
+
+inline void Shader::setStorageBlock(const std::string& name, unsigned int binding) const
+{
+#ifdef GL_ARB_shader_storage_buffer_object
+	unsigned int index = glGetProgramResourceIndex(ID, GL_SHADER_STORAGE_BLOCK, name.c_str());
+	if (index != GL_INVALID_INDEX)
+		glShaderStorageBlockBinding(ID, index, binding);
+#endif
+}
+
+unsigned int Shader::compile(GLenum type, const std::string& path, const char* stageName)
+{
+	std::ifstream file;
+	std::stringstream stream;
+	file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+	try {
+		file.open(path);
+		stream << file.rdbuf();
+		file.close();
+	}
+	catch (std::ifstream::failure& fail) {
+		std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ\n" << path << ": " << fail.what() << std::endl;
+	}
+
+	std::string sCode(stream.str());
+	const char* code = sCode.c_str();
+
+	int success;
+	char infoLog[512];
+
+	unsigned int shader = glCreateShader(type);
+	glShaderSource(shader, 1, &code, NULL);
+	glCompileShader(shader);
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+	if (!success) {
+		glGetShaderInfoLog(shader, 512, NULL, infoLog);
+		std::cout << "ERROR::SHADER::" << stageName << "::COMPILATION_FAILED\n" << path << "\n" << infoLog << std::endl;
+	}
+	return shader;
+}
+
+void Shader::link()
+{
+	int success;
+	char infoLog[512];
+
+	glLinkProgram(ID);
+	glGetProgramiv(ID, GL_LINK_STATUS, &success);
+	if (!success) {
+		glGetProgramInfoLog(ID, 512, NULL, infoLog);
+		std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+	}
+}
+
+#endif
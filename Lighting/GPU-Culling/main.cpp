@@ -0,0 +1,427 @@
+#include "glad/glad.h"
+#include "GLFW/glfw3.h"
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+#include "Shader.h"
+#include "Camera.h"
+#include "GpuTimer.h"
+#include "Frustum.h"
+#include "GpuCuller.h"
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <cfloat>
+
+
+/* Where the frustum culling runs */
+enum class Cull_mode {
+	/* Frustum::IntersectsSphere for every instance, the survivors uploaded every frame */
+	CPU,
+	/* GpuCuller, Cull_method::TRANSFORM_FEEDBACK */
+	TRANSFORM_FEEDBACK,
+	/* GpuCuller, Cull_method::COMPUTE */
+	COMPUTE
+};
+
+void processInput(GLFWwindow* window);
+void frameBufferResize_callback(GLFWwindow* window, int width, int height);
+void mouseMovement_callback(GLFWwindow* window, double xPos, double yPos);
+void mouseScroll_callback(GLFWwindow* window, double xOffset, double yOffset);
+void keyPress_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+
+void buildBox(std::vector<float>& vertices, std::vector<unsigned short>& indices);
+void verifyCulling(GpuCuller& culler, const std::vector<glm::vec4>& instances, const Frustum& frustum);
+const char* modeName(Cull_mode mode);
+
+
+const int winWidth = 800;
+const int winHeight = 600;
+
+/************************************ CAMERA ************************************/
+Camera camera({ 0.0f, 20.0f, 0.0f });
+
+float lastX = winWidth / 2;
+float lastY = winHeight / 2;
+bool firstMouseMove = true;
+
+/************************************ FRAMES ************************************/
+float deltaTime = 0.0f;
+float lastFrame = 0.0f;
+
+/************************************ CULLING ************************************/
+/* Switched with the 1, 2 and 3 keys */
+Cull_mode cullMode = Cull_mode::COMPUTE;
+/* T compares the GPU survivors with the CPU ones for the current view */
+bool verifyRequested = true;
+
+/************************************ SCENE ************************************/
+const unsigned int instanceCount = 1000000;
+/* Boxes in a slab of this half size and height */
+const float fieldSize = 300.0f;
+const float fieldHeight = 40.0f;
+
+
+int main()
+{
+	/************************************ INITIALIZATION ************************************/
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+	GLFWwindow* window = glfwCreateWindow(winWidth, winHeight, "GPU culling", NULL, NULL);
+	if (window == NULL) {
+		std::cout << "ERROR::GLFW::INITIALIZATION_FAILED" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		std::cout << "ERROR::GLAD::INITIALIZATION_FAILED" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glViewport(0, 0, winWidth, winHeight);
+	/* Measure the culling, not the display refresh */
+	glfwSwapInterval(0);
+
+	glfwSetFramebufferSizeCallback(window, frameBufferResize_callback);
+	glfwSetCursorPosCallback(window, mouseMovement_callback);
+	glfwSetScrollCallback(window, mouseScroll_callback);
+	glfwSetKeyCallback(window, keyPress_callback);
+
+	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+	camera.MoveSpeed = 20.0f;
+	camera.FarPlane = 300.0f;
+
+	/************************************ OBJECTS ************************************/
+	/* Center and size of every box */
+	std::vector<glm::vec4> instances(instanceCount);
+	std::mt19937 random(23);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	for (glm::vec4& instance : instances)
+		instance = glm::vec4((unit(random) * 2.0f - 1.0f) * fieldSize, unit(random) * fieldHeight, (unit(random) * 2.0f - 1.0f) * fieldSize,
+			0.2f + 0.8f * unit(random));
+
+	std::vector<float> boxVertices;
+	std::vector<unsigned short> boxIndices;
+	buildBox(boxVertices, boxIndices);
+
+	/************************************ CULLER ************************************/
+	GpuCuller culler(instances, (GLuint)boxIndices.size());
+	if (!culler.ComputeSupported) {
+		std::cout << "No GL 4.3 compute shaders, storage buffers and indirect draws, culling with transform feedback instead of compute" << std::endl;
+		cullMode = Cull_mode::TRANSFORM_FEEDBACK;
+	}
+	if (!culler.FeedbackDrawSupported)
+		std::cout << "No ARB_transform_feedback2, the transform feedback survivors are counted with a readback" << std::endl;
+
+	/************************************ BUFFERS ************************************/
+	unsigned int VBO, EBO, cpuSurvivorVBO;
+	glGenBuffers(1, &VBO);
+	glGenBuffers(1, &EBO);
+	glGenBuffers(1, &cpuSurvivorVBO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, boxVertices.size() * sizeof(float), boxVertices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, cpuSurvivorVBO);
+	glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(glm::vec4), NULL, GL_STREAM_DRAW);
+
+	/* Instanced boxes, the survivors of the CPU or of the compute pass per instance */
+	unsigned int cpuVAO, survivorVAO;
+	glGenVertexArrays(1, &cpuVAO);
+	glGenVertexArrays(1, &survivorVAO);
+	for (unsigned int VAO : { cpuVAO, survivorVAO }) {
+		glBindVertexArray(VAO);
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
+		glEnableVertexAttribArray(1);
+
+		glBindBuffer(GL_ARRAY_BUFFER, VAO == cpuVAO ? cpuSurvivorVBO : culler.SurvivorBuffer());
+		glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)0);
+		glEnableVertexAttribArray(2);
+		glVertexAttribDivisor(2, 1);
+	}
+	/* Both VAOs point at the element buffer, filled through the last one bound */
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, boxIndices.size() * sizeof(unsigned short), boxIndices.data(), GL_STATIC_DRAW);
+
+	/* The transform feedback survivors as points, expanded to boxes by the geometry shader */
+	unsigned int pointVAO;
+	glGenVertexArrays(1, &pointVAO);
+	glBindVertexArray(pointVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, culler.SurvivorBuffer());
+	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)0);
+	glEnableVertexAttribArray(0);
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	/************************************ SHADERS ************************************/
+	Shader boxShader("shaders/box.vs", "shaders/box.fs");
+	Shader pointShader("shaders/boxPoint.vs", "shaders/box.gs", "shaders/box.fs");
+	for (const Shader* shader : { &boxShader, &pointShader }) {
+		shader->use();
+		shader->setVec3("sunDirection", glm::normalize(glm::vec3(0.4f, -1.0f, 0.3f)));
+	}
+
+	/************************************ RENDER LOOP ************************************/
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_CULL_FACE);
+	std::cout << instanceCount << " boxes. 1 - CPU, 2 - transform feedback, 3 - compute culling, T checks the GPU culling" << std::endl;
+
+	GpuTimer cullTimer, drawTimer;
+	std::vector<glm::vec4> cpuSurvivors;
+	cpuSurvivors.reserve(instances.size());
+	double cullMs = 0.0;
+	size_t survivorsDrawn = 0;
+	Cull_mode measuredMode = cullMode;
+	unsigned int measuredFrames = 0;
+	double measureStart = glfwGetTime();
+	lastFrame = glfwGetTime();
+	while (!glfwWindowShouldClose(window)) {
+		float currentFrame = glfwGetTime();
+		deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+
+		processInput(window);
+
+		int width, height;
+		glfwGetFramebufferSize(window, &width, &height);
+		float aspect = (float)width / std::max(height, 1);
+		glm::mat4 view = camera.GetViewMatrix();
+		glm::mat4 projection = camera.GetProjectionMatrix(aspect);
+		Frustum frustum(projection * view);
+
+		if (cullMode == Cull_mode::COMPUTE && !culler.ComputeSupported)
+			cullMode = Cull_mode::TRANSFORM_FEEDBACK;
+		if (verifyRequested) {
+			verifyCulling(culler, instances, frustum);
+			verifyRequested = false;
+		}
+
+		/* Culling, the CPU time is the whole test for CPU and the submission for the GPU modes */
+		auto cullStart = std::chrono::steady_clock::now();
+		cullTimer.Begin();
+		if (cullMode == Cull_mode::CPU) {
+			cpuSurvivors.clear();
+			for (const glm::vec4& instance : instances)
+				if (frustum.IntersectsSphere(glm::vec3(instance), instance.w * 0.8660254f))
+					cpuSurvivors.push_back(instance);
+			glBindBuffer(GL_ARRAY_BUFFER, cpuSurvivorVBO);
+			glBufferSubData(GL_ARRAY_BUFFER, 0, cpuSurvivors.size() * sizeof(glm::vec4), cpuSurvivors.data());
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			survivorsDrawn += cpuSurvivors.size();
+		}
+		else
+			culler.Cull(cullMode == Cull_mode::COMPUTE ? Cull_method::COMPUTE : Cull_method::TRANSFORM_FEEDBACK, frustum);
+		cullTimer.End();
+		cullMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - cullStart).count();
+
+		glClearColor(0.5f, 0.65f, 0.8f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		drawTimer.Begin();
+		if (cullMode == Cull_mode::TRANSFORM_FEEDBACK && culler.FeedbackDrawSupported) {
+			pointShader.use();
+			pointShader.setMat4f("view", view);
+			pointShader.setMat4f("projection", projection);
+			glBindVertexArray(pointVAO);
+			culler.DrawFeedback();
+		}
+		else {
+			boxShader.use();
+			boxShader.setMat4f("view", view);
+			boxShader.setMat4f("projection", projection);
+			if (cullMode == Cull_mode::CPU) {
+				glBindVertexArray(cpuVAO);
+				glDrawElementsInstanced(GL_TRIANGLES, (GLsizei)boxIndices.size(), GL_UNSIGNED_SHORT, 0, (GLsizei)cpuSurvivors.size());
+			}
+			else if (cullMode == Cull_mode::COMPUTE) {
+				glBindVertexArray(survivorVAO);
+				culler.DrawIndirect();
+			}
+			else {
+				glBindVertexArray(survivorVAO);
+				glDrawElementsInstanced(GL_TRIANGLES, (GLsizei)boxIndices.size(), GL_UNSIGNED_SHORT, 0, (GLsizei)culler.FeedbackCount());
+			}
+		}
+		drawTimer.End();
+		glBindVertexArray(0);
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+
+		/* Averages over two seconds, restarted when the mode changes. The GPU modes never read their survivor count */
+		measuredFrames++;
+		double measured = glfwGetTime() - measureStart;
+		if (measuredMode != cullMode || measured >= 2.0) {
+			if (measuredMode == cullMode) {
+				std::cout << modeName(cullMode) << ": " << measured * 1000.0 / measuredFrames << " ms per frame, " << cullTimer.AverageMs()
+					<< " ms GPU culling, " << drawTimer.AverageMs() << " ms GPU drawing, " << cullMs / measuredFrames << " ms CPU culling";
+				if (cullMode == Cull_mode::CPU)
+					std::cout << ", " << survivorsDrawn / measuredFrames << " of " << instanceCount << " boxes drawn";
+				std::cout << std::endl;
+			}
+			measuredMode = cullMode;
+			measuredFrames = 0;
+			cullMs = 0.0;
+			survivorsDrawn = 0;
+			cullTimer.Reset();
+			drawTimer.Reset();
+			measureStart = glfwGetTime();
+		}
+	}
+
+	glDeleteVertexArrays(1, &cpuVAO);
+	glDeleteVertexArrays(1, &survivorVAO);
+	glDeleteVertexArrays(1, &pointVAO);
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &EBO);
+	glDeleteBuffers(1, &cpuSurvivorVBO);
+	glfwTerminate();
+}
+
+
+void processInput(GLFWwindow* window)
+{
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, true);
+	if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
+		deltaTime *= 2;
+	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::FORWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::BACKWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::LEFT, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::RIGHT, deltaTime);
+}
+
+void keyPress_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	if (action != GLFW_PRESS)
+		return;
+	if (key == GLFW_KEY_1)
+		cullMode = Cull_mode::CPU;
+	else if (key == GLFW_KEY_2)
+		cullMode = Cull_mode::TRANSFORM_FEEDBACK;
+	else if (key == GLFW_KEY_3)
+		cullMode = Cull_mode::COMPUTE;
+	else if (key == GLFW_KEY_T)
+		verifyRequested = true;
+}
+
+void frameBufferResize_callback(GLFWwindow* window, int width, int height)
+{
+	glViewport(0, 0, width, height);
+}
+
+void mouseMovement_callback(GLFWwindow* window, double xPos, double yPos)
+{
+	if (firstMouseMove) {
+		lastX = xPos;
+		lastY = yPos;
+		firstMouseMove = false;
+	}
+
+	float xOffset = (float)xPos - lastX;
+	float yOffset = lastY - (float)yPos;
+	lastX = xPos;
+	lastY = yPos;
+
+	camera.ProcessMouseMovement(xOffset, yOffset);
+}
+
+void mouseScroll_callback(GLFWwindow* window, double xOffset, double yOffset)
+{
+	camera.ProcessMouseScroll(yOffset);
+}
+
+void buildBox(std::vector<float>& vertices, std::vector<unsigned short>& indices)
+{
+	/* Unit box with 4 vertices per face, positions then normals. The face spans u and v with u x v = normal */
+	const glm::vec3 faces[6][3] = {
+		{ {  1.0f,  0.0f,  0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } },
+		{ { -1.0f,  0.0f,  0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f, 0.0f } },
+		{ {  0.0f,  1.0f,  0.0f }, { 0.0f, 0.0f, 1.0f }, { 1.0f, 0.0f, 0.0f } },
+		{ {  0.0f, -1.0f,  0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } },
+		{ {  0.0f,  0.0f,  1.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f } },
+		{ {  0.0f,  0.0f, -1.0f }, { 0.0f, 1.0f, 0.0f }, { 1.0f, 0.0f, 0.0f } }
+	};
+	const float corners[4][2] = { { -1.0f, -1.0f }, { 1.0f, -1.0f }, { 1.0f, 1.0f }, { -1.0f, 1.0f } };
+
+	for (const auto& face : faces) {
+		unsigned short first = (unsigned short)(vertices.size() / 6);
+		for (const auto& corner : corners) {
+			glm::vec3 position = 0.5f * (face[0] + corner[0] * face[1] + corner[1] * face[2]);
+			vertices.insert(vertices.end(), { position.x, position.y, position.z, face[0].x, face[0].y, face[0].z });
+		}
+		/* Counter clockwise seen from outside */
+		for (unsigned short index : { 0, 1, 2, 2, 3, 0 })
+			indices.push_back(first + index);
+	}
+}
+
+void verifyCulling(GpuCuller& culler, const std::vector<glm::vec4>& instances, const Frustum& frustum)
+{
+	/* The CPU reference, minus the boxes so close to a plane that float rounding may decide either way */
+	const float tolerance = 1e-3f;
+	std::vector<glm::vec4> surely, maybe;
+	for (const glm::vec4& instance : instances) {
+		float margin = FLT_MAX;
+		for (int i = 0; i < 6; i++)
+			margin = std::min(margin, glm::dot(glm::vec3(frustum.Plane(i)), glm::vec3(instance)) + frustum.Plane(i).w + instance.w * 0.8660254f);
+		if (margin >= tolerance)
+			surely.push_back(instance);
+		if (margin >= -tolerance)
+			maybe.push_back(instance);
+	}
+	auto less = [](const glm::vec4& a, const glm::vec4& b) {
+		return a.x != b.x ? a.x < b.x : a.y != b.y ? a.y < b.y : a.z != b.z ? a.z < b.z : a.w < b.w;
+	};
+	std::sort(surely.begin(), surely.end(), less);
+	std::sort(maybe.begin(), maybe.end(), less);
+
+	for (Cull_method method : { Cull_method::TRANSFORM_FEEDBACK, Cull_method::COMPUTE }) {
+		if (method == Cull_method::COMPUTE && !culler.ComputeSupported)
+			continue;
+		culler.Cull(method, frustum);
+		std::vector<glm::vec4> survivors = culler.ReadSurvivors(method);
+		std::sort(survivors.begin(), survivors.end(), less);
+
+		/* Every sure survivor and nothing outside the tolerance, each once */
+		bool unique = std::adjacent_find(survivors.begin(), survivors.end(), [](const glm::vec4& a, const glm::vec4& b) { return a == b; }) == survivors.end();
+		bool matches = unique && std::includes(survivors.begin(), survivors.end(), surely.begin(), surely.end(), less) &&
+			std::includes(maybe.begin(), maybe.end(), survivors.begin(), survivors.end(), less);
+		const char* name = method == Cull_method::COMPUTE ? "Compute" : "Transform feedback";
+		if (matches)
+			std::cout << name << " culling matches the CPU: " << survivors.size() << " of " << instances.size() << " boxes, "
+				<< maybe.size() - surely.size() << " within " << tolerance << " of a plane" << std::endl;
+		else
+			std::cout << "ERROR::GPU_CULLING::MISMATCH\n" << name << ": " << survivors.size() << " survivors, the CPU keeps "
+				<< surely.size() << " to " << maybe.size() << std::endl;
+	}
+}
+
+const char* modeName(Cull_mode mode)
+{
+	switch (mode) {
+	case Cull_mode::CPU:
+		return "CPU";
+	case Cull_mode::TRANSFORM_FEEDBACK:
+		return "Transform feedback";
+	default:
+		return "Compute";
+	}
+}
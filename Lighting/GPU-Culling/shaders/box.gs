@@ -0,0 +1,45 @@
+#version 330 core
+// Expands every survivor into its box, for glDrawTransformFeedback which can't draw instanced boxes
+layout (points) in;
+layout (triangle_strip, max_vertices = 24) out;
+
+in vec4 instance[];
+
+out vec3 Normal;
+out vec3 color;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+// normal, then u and v of every face with cross(u, v) = normal
+const vec3 faces[18] = vec3[](
+  vec3( 1.0,  0.0,  0.0), vec3(0.0, 1.0, 0.0), vec3(0.0, 0.0, 1.0),
+  vec3(-1.0,  0.0,  0.0), vec3(0.0, 0.0, 1.0), vec3(0.0, 1.0, 0.0),
+  vec3( 0.0,  1.0,  0.0), vec3(0.0, 0.0, 1.0), vec3(1.0, 0.0, 0.0),
+  vec3( 0.0, -1.0,  0.0), vec3(1.0, 0.0, 0.0), vec3(0.0, 0.0, 1.0),
+  vec3( 0.0,  0.0,  1.0), vec3(1.0, 0.0, 0.0), vec3(0.0, 1.0, 0.0),
+  vec3( 0.0,  0.0, -1.0), vec3(0.0, 1.0, 0.0), vec3(1.0, 0.0, 0.0)
+);
+
+void main()
+{
+  mat4 viewProjection = projection * view;
+  vec3 center = instance[0].xyz;
+  float size = instance[0].w;
+  vec3 boxColor = 0.55 + 0.35 * cos(center * 0.37 + vec3(0.0, 2.0, 4.0));
+
+  for (int face = 0; face < 6; face++) {
+    vec3 normal = faces[face * 3];
+    vec3 u = faces[face * 3 + 1];
+    vec3 v = faces[face * 3 + 2];
+    // strip order, counter clockwise seen from outside
+    for (int corner = 0; corner < 4; corner++) {
+      vec2 side = vec2(corner % 2 == 0 ? -1.0 : 1.0, corner < 2 ? -1.0 : 1.0);
+      gl_Position = viewProjection * vec4(center + 0.5 * size * (normal + side.x * u + side.y * v), 1.0);
+      Normal = normal;
+      color = boxColor;
+      EmitVertex();
+    }
+    EndPrimitive();
+  }
+}
@@ -0,0 +1,19 @@
+#version 330 core
+layout (location = 0) in vec3 aPosition;
+layout (location = 1) in vec3 aNormal;
+// per instance, xyz the box center and w its size
+layout (location = 2) in vec4 aInstance;
+
+out vec3 Normal;
+out vec3 color;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+  gl_Position = projection * view * vec4(aInstance.xyz + aPosition * aInstance.w, 1.0);
+  Normal = aNormal;
+  // the survivors come in any order, the color follows the position
+  color = 0.55 + 0.35 * cos(aInstance.xyz * 0.37 + vec3(0.0, 2.0, 4.0));
+}
@@ -0,0 +1,10 @@
+#version 330 core
+// a survivor written by transform feedback, xyz the box center and w its size
+layout (location = 0) in vec4 aInstance;
+
+out vec4 instance;
+
+void main()
+{
+  instance = aInstance;
+}
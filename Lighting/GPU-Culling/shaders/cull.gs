@@ -0,0 +1,18 @@
+#version 330 core
+layout (points) in;
+layout (points, max_vertices = 1) out;
+
+in vec4 instance[];
+flat in int visible[];
+
+// captured by transform feedback, the culled instances emit nothing
+out vec4 survivor;
+
+void main()
+{
+  if (visible[0] == 0)
+    return;
+  survivor = instance[0];
+  EmitVertex();
+  EndPrimitive();
+}
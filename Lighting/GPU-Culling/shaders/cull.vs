@@ -0,0 +1,20 @@
+#version 330 core
+// one point per instance, xyz the box center and w its size
+layout (location = 0) in vec4 aInstance;
+
+out vec4 instance;
+flat out int visible;
+
+// Frustum planes pointing inwards, see Frustum.h
+uniform vec4 planes[6];
+
+void main()
+{
+  // bounding sphere of the box
+  float radius = aInstance.w * 0.8660254;
+  visible = 1;
+  for (int i = 0; i < 6; i++)
+    if (dot(planes[i].xyz, aInstance.xyz) + planes[i].w < -radius)
+      visible = 0;
+  instance = aInstance;
+}
@@ -0,0 +1,547 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BVH_SSE2
+#endif
+
+#include "glm/glm.hpp"
+
+/* Ray of the single ray queries */
+struct Ray {
+	glm::vec3 origin;
+	glm::vec3 direction;
+	/* Only hits closer than this count */
+	float maxDistance;
+};
+
+/* Four rays traced together, one per SIMD lane, as structure of arrays */
+struct Ray_packet {
+	float originX[4], originY[4], originZ[4];
+	float directionX[4], directionY[4], directionZ[4];
+	float maxDistance[4];
+	/* Bit i set when lane i holds a ray, the other lanes are skipped */
+	int activeMask;
+};
+
+/* Closest hit of a ray */
+struct Ray_hit {
+	/* Index of the triangle as passed to the constructor, -1 for a miss */
+	int triangle;
+	float distance;
+	/* Barycentric coordinates of the hit, weights of the second and third corner */
+	float u, v;
+};
+
+/* Bounding volume hierarchy over triangles for ray casting.
+Built top down with the surface area heuristic over binned centroids. Besides single rays it
+traces packets of four rays, every node box and triangle is tested against the four rays at
+once with SSE2. That pays off when the rays go roughly the same way, like the shadow rays of
+neighbouring lightmap texels towards one light. Without SSE2 the packets fall back to four
+single rays */
+class Bvh
+{
+public:
+	/* Leaves hold at most this many triangles */
+	static const unsigned int MaxLeafSize = 4;
+
+	/* Build over triangles given as three corners each */
+	explicit Bvh(const std::vector<glm::vec3>& corners);
+
+	/* Closest hit along the ray, false on a miss */
+	bool Intersect(const Ray& ray, Ray_hit& hit) const;
+	/* Any hit before maxDistance, for shadow rays */
+	bool Occluded(const Ray& ray) const;
+	/* Closest hits of the active rays of the packet, the other lanes report a miss */
+	void Intersect(const Ray_packet& packet, Ray_hit hits[4]) const;
+	/* Mask of the active rays that hit anything before their maxDistance */
+	int Occluded(const Ray_packet& packet) const;
+
+	/* Get functions */
+	unsigned int NodeCount() const noexcept;
+	unsigned int TriangleCount() const noexcept;
+
+private:
+	/* Bins of the surface area heuristic per axis */
+	static const int binCount = 12;
+	/* Deeper than any tree of a few million triangles */
+	static const int stackSize = 64;
+
+	/* 32 bytes, two per cache line */
+	struct Node {
+		glm::vec3 boundsMin;
+		/* Inner node: index of the left child, the right one follows it. Leaf: first triangle */
+		unsigned int leftOrFirst;
+		glm::vec3 boundsMax;
+		/* Triangles of a leaf, 0 for inner nodes */
+		std::uint16_t count;
+		/* Split axis of an inner node, the left child holds the lower centroids */
+		std::uint16_t axis;
+	};
+	/* First corner and the two edges from it, what the Moller-Trumbore test needs */
+	struct Triangle {
+		glm::vec3 v0, edge1, edge2;
+	};
+	/* Bounds grown point by point */
+	struct Bounds {
+		glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+		glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+
+		void Grow(const glm::vec3& point) { min = glm::min(min, point); max = glm::max(max, point); }
+		void Grow(const Bounds& other) { min = glm::min(min, other.min); max = glm::max(max, other.max); }
+		float Area() const { glm::vec3 size = max - min; return size.x < 0.0f ? 0.0f : 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x); }
+	};
+
+	/* Helper functions */
+	/* Split the node over triangles [first, first + count) of order */
+	void subdivide(unsigned int nodeIndex, unsigned int first, unsigned int count);
+	static bool intersectTriangle(const Triangle& triangle, const Ray& ray, float maxDistance, float& distance, float& u, float& v);
+	static bool intersectBox(const Node& node, const Ray& ray, const glm::vec3& inverseDirection, float maxDistance);
+private:
+	std::vector<Node> nodes;
+	std::vector<Triangle> triangles;
+	/* Constructor index of every triangle in leaf order */
+	std::vector<unsigned int> triangleIds;
+
+	/* Build only */
+	std::vector<Bounds> triangleBounds;
+	std::vector<glm::vec3> centroids;
+};
+
+
+Bvh::Bvh(const std::vector<glm::vec3>& corners)
+{
+	unsigned int count = (unsigned int)(corners.size() / 3);
+	for (unsigned int i = 0; i < count; i++) {
+		Bounds bounds;
+		bounds.Grow(corners[3 * i]);
+		bounds.Grow(corners[3 * i + 1]);
+		bounds.Grow(corners[3 * i + 2]);
+		triangleBounds.push_back(bounds);
+		centroids.push_back((bounds.min + bounds.max) * 0.5f);
+		triangleIds.push_back(i);
+	}
+
+	nodes.reserve(count > 0 ? 2 * count - 1 : 1);
+	nodes.push_back(Node());
+	subdivide(0, 0, count);
+
+	/* Triangles in leaf order, a leaf reads a contiguous range */
+	for (unsigned int id : triangleIds)
+		triangles.push_back(Triangle{ corners[3 * id], corners[3 * id + 1] - corners[3 * id], corners[3 * id + 2] - corners[3 * id] });
+	std::vector<Bounds>().swap(triangleBounds);
+	std::vector<glm::vec3>().swap(centroids);
+}
+
+bool Bvh::Intersect(const Ray& ray, Ray_hit& hit) const
+{
+	hit.triangle = -1;
+	hit.distance = ray.maxDistance;
+	glm::vec3 inverseDirection = 1.0f / ray.direction;
+
+	unsigned int stack[stackSize];
+	int stackTop = 0;
+	/* Without triangles the root would read as an inner node */
+	if (!triangles.empty())
+		stack[stackTop++] = 0;
+	while (stackTop > 0) {
+		const Node& node = nodes[stack[--stackTop]];
+		if (!intersectBox(node, ray, inverseDirection, hit.distance))
+			continue;
+
+		if (node.count > 0) {
+			for (unsigned int i = node.leftOrFirst; i < node.leftOrFirst + node.count; i++) {
+				float distance, u, v;
+				if (intersectTriangle(triangles[i], ray, hit.distance, distance, u, v)) {
+					hit.triangle = (int)triangleIds[i];
+					hit.distance = distance;
+					hit.u = u;
+					hit.v = v;
+				}
+			}
+		}
+		else {
+			/* Near child on top */
+			bool backwards = ray.direction[node.axis] < 0.0f;
+			stack[stackTop++] = node.leftOrFirst + (backwards ? 0 : 1);
+			stack[stackTop++] = node.leftOrFirst + (backwards ? 1 : 0);
+		}
+	}
+	return hit.triangle >= 0;
+}
+
+bool Bvh::Occluded(const Ray& ray) const
+{
+	glm::vec3 inverseDirection = 1.0f / ray.direction;
+
+	unsigned int stack[stackSize];
+	int stackTop = 0;
+	/* Without triangles the root would read as an inner node */
+	if (!triangles.empty())
+		stack[stackTop++] = 0;
+	while (stackTop > 0) {
+		const Node& node = nodes[stack[--stackTop]];
+		if (!intersectBox(node, ray, inverseDirection, ray.maxDistance))
+			continue;
+
+		if (node.count > 0) {
+			float distance, u, v;
+			for (unsigned int i = node.leftOrFirst; i < node.leftOrFirst + node.count; i++)
+				if (intersectTriangle(triangles[i], ray, ray.maxDistance, distance, u, v))
+					return true;
+		}
+		else {
+			stack[stackTop++] = node.leftOrFirst;
+			stack[stackTop++] = node.leftOrFirst + 1;
+		}
+	}
+	return false;
+}
+
+#if defined(BVH_SSE2)
+void Bvh::Intersect(const Ray_packet& packet, Ray_hit hits[4]) const
+{
+	for (int lane = 0; lane < 4; lane++)
+		hits[lane] = Ray_hit{ -1, packet.maxDistance[lane], 0.0f, 0.0f };
+	if (!packet.activeMask)
+		return;
+
+	const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), epsilon = _mm_set1_ps(1e-7f);
+	__m128 originX = _mm_loadu_ps(packet.originX), originY = _mm_loadu_ps(packet.originY), originZ = _mm_loadu_ps(packet.originZ);
+	__m128 directionX = _mm_loadu_ps(packet.directionX), directionY = _mm_loadu_ps(packet.directionY), directionZ = _mm_loadu_ps(packet.directionZ);
+	__m128 inverseX = _mm_div_ps(one, directionX), inverseY = _mm_div_ps(one, directionY), inverseZ = _mm_div_ps(one, directionZ);
+	/* Closest hit so far per lane */
+	__m128 closest = _mm_loadu_ps(packet.maxDistance);
+	__m128 hitU = zero, hitV = zero;
+	const int laneBits[4] = { packet.activeMask & 1 ? -1 : 0, packet.activeMask & 2 ? -1 : 0, packet.activeMask & 4 ? -1 : 0, packet.activeMask & 8 ? -1 : 0 };
+	const __m128 active = _mm_castsi128_ps(_mm_setr_epi32(laneBits[0], laneBits[1], laneBits[2], laneBits[3]));
+	/* Visit order by the direction of the first active ray */
+	int leader = 0;
+	while (!(packet.activeMask & (1 << leader)))
+		leader++;
+	const float leaderDirection[3] = { packet.directionX[leader], packet.directionY[leader], packet.directionZ[leader] };
+
+	unsigned int stack[stackSize];
+	int stackTop = 0;
+	/* Without triangles the root would read as an inner node */
+	if (!triangles.empty())
+		stack[stackTop++] = 0;
+	while (stackTop > 0) {
+		const Node& node = nodes[stack[--stackTop]];
+
+		/* Slab test of the four rays */
+		__m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMin.x), originX), inverseX);
+		__m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMax.x), originX), inverseX);
+		__m128 tNear = _mm_min_ps(t1, t2), tFar = _mm_max_ps(t1, t2);
+		t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMin.y), originY), inverseY);
+		t2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMax.y), originY), inverseY);
+		tNear = _mm_max_ps(tNear, _mm_min_ps(t1, t2));
+		tFar = _mm_min_ps(tFar, _mm_max_ps(t1, t2));
+		t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMin.z), originZ), inverseZ);
+		t2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMax.z), originZ), inverseZ);
+		tNear = _mm_max_ps(_mm_max_ps(tNear, _mm_min_ps(t1, t2)), zero);
+		tFar = _mm_min_ps(_mm_min_ps(tFar, _mm_max_ps(t1, t2)), closest);
+		if (!_mm_movemask_ps(_mm_and_ps(_mm_cmple_ps(tNear, tFar), active)))
+			continue;
+
+		if (node.count == 0) {
+			bool backwards = leaderDirection[node.axis] < 0.0f;
+			stack[stackTop++] = node.leftOrFirst + (backwards ? 0 : 1);
+			stack[stackTop++] = node.leftOrFirst + (backwards ? 1 : 0);
+			continue;
+		}
+
+		/* Moller-Trumbore, one triangle against the four rays */
+		for (unsigned int i = node.leftOrFirst; i < node.leftOrFirst + node.count; i++) {
+			const Triangle& triangle = triangles[i];
+			__m128 edge1X = _mm_set1_ps(triangle.edge1.x), edge1Y = _mm_set1_ps(triangle.edge1.y), edge1Z = _mm_set1_ps(triangle.edge1.z);
+			__m128 edge2X = _mm_set1_ps(triangle.edge2.x), edge2Y = _mm_set1_ps(triangle.edge2.y), edge2Z = _mm_set1_ps(triangle.edge2.z);
+			/* p = direction x edge2 */
+			__m128 pX = _mm_sub_ps(_mm_mul_ps(directionY, edge2Z), _mm_mul_ps(directionZ, edge2Y));
+			__m128 pY = _mm_sub_ps(_mm_mul_ps(directionZ, edge2X), _mm_mul_ps(directionX, edge2Z));
+			__m128 pZ = _mm_sub_ps(_mm_mul_ps(directionX, edge2Y), _mm_mul_ps(directionY, edge2X));
+			__m128 determinant = _mm_add_ps(_mm_add_ps(_mm_mul_ps(edge1X, pX), _mm_mul_ps(edge1Y, pY)), _mm_mul_ps(edge1Z, pZ));
+			__m128 inverseDeterminant = _mm_div_ps(one, determinant);
+			__m128 toOriginX = _mm_sub_ps(originX, _mm_set1_ps(triangle.v0.x));
+			__m128 toOriginY = _mm_sub_ps(originY, _mm_set1_ps(triangle.v0.y));
+			__m128 toOriginZ = _mm_sub_ps(originZ, _mm_set1_ps(triangle.v0.z));
+			__m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(toOriginX, pX), _mm_mul_ps(toOriginY, pY)), _mm_mul_ps(toOriginZ, pZ)), inverseDeterminant);
+			/* q = toOrigin x edge1 */
+			__m128 qX = _mm_sub_ps(_mm_mul_ps(toOriginY, edge1Z), _mm_mul_ps(toOriginZ, edge1Y));
+			__m128 qY = _mm_sub_ps(_mm_mul_ps(toOriginZ, edge1X), _mm_mul_ps(toOriginX, edge1Z));
+			__m128 qZ = _mm_sub_ps(_mm_mul_ps(toOriginX, edge1Y), _mm_mul_ps(toOriginY, edge1X));
+			__m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(directionX, qX), _mm_mul_ps(directionY, qY)), _mm_mul_ps(directionZ, qZ)), inverseDeterminant);
+			__m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(edge2X, qX), _mm_mul_ps(edge2Y, qY)), _mm_mul_ps(edge2Z, qZ)), inverseDeterminant);
+
+			/* |determinant| > epsilon, both sides of the triangle count */
+			__m128 absDeterminant = _mm_andnot_ps(_mm_set1_ps(-0.0f), determinant);
+			__m128 hit = _mm_and_ps(active, _mm_cmpgt_ps(absDeterminant, epsilon));
+			hit = _mm_and_ps(hit, _mm_cmpge_ps(u, zero));
+			hit = _mm_and_ps(hit, _mm_cmpge_ps(v, zero));
+			hit = _mm_and_ps(hit, _mm_cmple_ps(_mm_add_ps(u, v), one));
+			hit = _mm_and_ps(hit, _mm_cmpgt_ps(t, zero));
+			hit = _mm_and_ps(hit, _mm_cmplt_ps(t, closest));
+			int hitMask = _mm_movemask_ps(hit);
+			if (!hitMask)
+				continue;
+
+			closest = _mm_or_ps(_mm_and_ps(hit, t), _mm_andnot_ps(hit, closest));
+			hitU = _mm_or_ps(_mm_and_ps(hit, u), _mm_andnot_ps(hit, hitU));
+			hitV = _mm_or_ps(_mm_and_ps(hit, v), _mm_andnot_ps(hit, hitV));
+			for (int lane = 0; lane < 4; lane++)
+				if (hitMask & (1 << lane))
+					hits[lane].triangle = (int)triangleIds[i];
+		}
+	}
+
+	float distances[4], us[4], vs[4];
+	_mm_storeu_ps(distances, closest);
+	_mm_storeu_ps(us, hitU);
+	_mm_storeu_ps(vs, hitV);
+	for (int lane = 0; lane < 4; lane++) {
+		if (hits[lane].triangle < 0)
+			continue;
+		hits[lane].distance = distances[lane];
+		hits[lane].u = us[lane];
+		hits[lane].v = vs[lane];
+	}
+}
+
+int Bvh::Occluded(const Ray_packet& packet) const
+{
+	if (!packet.activeMask)
+		return 0;
+
+	const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), epsilon = _mm_set1_ps(1e-7f);
+	__m128 originX = _mm_loadu_ps(packet.originX), originY = _mm_loadu_ps(packet.originY), originZ = _mm_loadu_ps(packet.originZ);
+	__m128 directionX = _mm_loadu_ps(packet.directionX), directionY = _mm_loadu_ps(packet.directionY), directionZ = _mm_loadu_ps(packet.directionZ);
+	__m128 inverseX = _mm_div_ps(one, directionX), inverseY = _mm_div_ps(one, directionY), inverseZ = _mm_div_ps(one, directionZ);
+	__m128 maxDistance = _mm_loadu_ps(packet.maxDistance);
+	int pending = packet.activeMask;
+	int occluded = 0;
+
+	unsigned int stack[stackSize];
+	int stackTop = 0;
+	/* Without triangles the root would read as an inner node */
+	if (!triangles.empty())
+		stack[stackTop++] = 0;
+	while (stackTop > 0) {
+		/* Lanes still looking for a blocker */
+		const int laneBits[4] = { pending & 1 ? -1 : 0, pending & 2 ? -1 : 0, pending & 4 ? -1 : 0, pending & 8 ? -1 : 0 };
+		const __m128 active = _mm_castsi128_ps(_mm_setr_epi32(laneBits[0], laneBits[1], laneBits[2], laneBits[3]));
+		const Node& node = nodes[stack[--stackTop]];
+
+		__m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMin.x), originX), inverseX);
+		__m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMax.x), originX), inverseX);
+		__m128 tNear = _mm_min_ps(t1, t2), tFar = _mm_max_ps(t1, t2);
+		t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMin.y), originY), inverseY);
+		t2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMax.y), originY), inverseY);
+		tNear = _mm_max_ps(tNear, _mm_min_ps(t1, t2));
+		tFar = _mm_min_ps(tFar, _mm_max_ps(t1, t2));
+		t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMin.z), originZ), inverseZ);
+		t2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMax.z), originZ), inverseZ);
+		tNear = _mm_max_ps(_mm_max_ps(tNear, _mm_min_ps(t1, t2)), zero);
+		tFar = _mm_min_ps(_mm_min_ps(tFar, _mm_max_ps(t1, t2)), maxDistance);
+		if (!_mm_movemask_ps(_mm_and_ps(_mm_cmple_ps(tNear, tFar), active)))
+			continue;
+
+		if (node.count == 0) {
+			stack[stackTop++] = node.leftOrFirst;
+			stack[stackTop++] = node.leftOrFirst + 1;
+			continue;
+		}
+
+		__m128 blocked = zero;
+		for (unsigned int i = node.leftOrFirst; i < node.leftOrFirst + node.count; i++) {
+			const Triangle& triangle = triangles[i];
+			__m128 edge1X = _mm_set1_ps(triangle.edge1.x), edge1Y = _mm_set1_ps(triangle.edge1.y), edge1Z = _mm_set1_ps(triangle.edge1.z);
+			__m128 edge2X = _mm_set1_ps(triangle.edge2.x), edge2Y = _mm_set1_ps(triangle.edge2.y), edge2Z = _mm_set1_ps(triangle.edge2.z);
+			__m128 pX = _mm_sub_ps(_mm_mul_ps(directionY, edge2Z), _mm_mul_ps(directionZ, edge2Y));
+			__m128 pY = _mm_sub_ps(_mm_mul_ps(directionZ, edge2X), _mm_mul_ps(directionX, edge2Z));
+			__m128 pZ = _mm_sub_ps(_mm_mul_ps(directionX, edge2Y), _mm_mul_ps(directionY, edge2X));
+			__m128 determinant = _mm_add_ps(_mm_add_ps(_mm_mul_ps(edge1X, pX), _mm_mul_ps(edge1Y, pY)), _mm_mul_ps(edge1Z, pZ));
+			__m128 inverseDeterminant = _mm_div_ps(one, determinant);
+			__m128 toOriginX = _mm_sub_ps(originX, _mm_set1_ps(triangle.v0.x));
+			__m128 toOriginY = _mm_sub_ps(originY, _mm_set1_ps(triangle.v0.y));
+			__m128 toOriginZ = _mm_sub_ps(originZ, _mm_set1_ps(triangle.v0.z));
+			__m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(toOriginX, pX), _mm_mul_ps(toOriginY, pY)), _mm_mul_ps(toOriginZ, pZ)), inverseDeterminant);
+			__m128 qX = _mm_sub_ps(_mm_mul_ps(toOriginY, edge1Z), _mm_mul_ps(toOriginZ, edge1Y));
+			__m128 qY = _mm_sub_ps(_mm_mul_ps(toOriginZ, edge1X), _mm_mul_ps(toOriginX, edge1Z));
+			__m128 qZ = _mm_sub_ps(_mm_mul_ps(toOriginX, edge1Y), _mm_mul_ps(toOriginY, edge1X));
+			__m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(directionX, qX), _mm_mul_ps(directionY, qY)), _mm_mul_ps(directionZ, qZ)), inverseDeterminant);
+			__m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(edge2X, qX), _mm_mul_ps(edge2Y, qY)), _mm_mul_ps(edge2Z, qZ)), inverseDeterminant);
+
+			__m128 absDeterminant = _mm_andnot_ps(_mm_set1_ps(-0.0f), determinant);
+			__m128 hit = _mm_and_ps(active, _mm_cmpgt_ps(absDeterminant, epsilon));
+			hit = _mm_and_ps(hit, _mm_cmpge_ps(u, zero));
+			hit = _mm_and_ps(hit, _mm_cmpge_ps(v, zero));
+			hit = _mm_and_ps(hit, _mm_cmple_ps(_mm_add_ps(u, v), one));
+			hit = _mm_and_ps(hit, _mm_cmpgt_ps(t, zero));
+			hit = _mm_and_ps(hit, _mm_cmplt_ps(t, maxDistance));
+			blocked = _mm_or_ps(blocked, hit);
+		}
+		occluded |= _mm_movemask_ps(blocked);
+		pending &= ~occluded;
+		if (!pending)
+			break;
+	}
+	return occluded;
+}
+#else
+void Bvh::Intersect(const Ray_packet& packet, Ray_hit hits[4]) const
+{
+	for (int lane = 0; lane < 4; lane++) {
+		hits[lane] = Ray_hit{ -1, packet.maxDistance[lane], 0.0f, 0.0f };
+		if (packet.activeMask & (1 << lane)) {
+			Ray ray{ glm::vec3(packet.originX[lane], packet.originY[lane], packet.originZ[lane]),
+				glm::vec3(packet.directionX[lane], packet.directionY[lane], packet.directionZ[lane]), packet.maxDistance[lane] };
+			Intersect(ray, hits[lane]);
+		}
+	}
+}
+
+int Bvh::Occluded(const Ray_packet& packet) const
+{
+	int occluded = 0;
+	for (int lane = 0; lane < 4; lane++) {
+		if (!(packet.activeMask & (1 << lane)))
+			continue;
+		Ray ray{ glm::vec3(packet.originX[lane], packet.originY[lane], packet.originZ[lane]),
+			glm::vec3(packet.directionX[lane], packet.directionY[lane], packet.directionZ[lane]), packet.maxDistance[lane] };
+		if (Occluded(ray))
+			occluded |= 1 << lane;
+	}
+	return occluded;
+}
+#endif
+
+inline unsigned int Bvh::NodeCount() const noexcept
+{
+	return (unsigned int)nodes.size();
+}
+
+inline unsigned int Bvh::TriangleCount() const noexcept
+{
+	return (unsigned int)triangles.size();
+}
+
+void Bvh::subdivide(unsigned int nodeIndex, unsigned int first, unsigned int count)
+{
+	Bounds bounds, centroidBounds;
+	for (unsigned int i = first; i < first + count; i++) {
+		bounds.Grow(triangleBounds[triangleIds[i]]);
+		centroidBounds.Grow(centroids[triangleIds[i]]);
+	}
+	nodes[nodeIndex].boundsMin = bounds.min;
+	nodes[nodeIndex].boundsMax = bounds.max;
+	nodes[nodeIndex].leftOrFirst = first;
+	nodes[nodeIndex].count = (std::uint16_t)count;
+	nodes[nodeIndex].axis = 0;
+	if (count <= MaxLeafSize)
+		return;
+
+	/* Cheapest split over the bin borders of all axes */
+	float bestCost = std::numeric_limits<float>::max();
+	int bestAxis = -1, bestBin = 0;
+	for (int axis = 0; axis < 3; axis++) {
+		float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+		if (extent <= 0.0f)
+			continue;
+		Bounds bins[binCount];
+		unsigned int binTriangles[binCount] = {};
+		float scale = binCount / extent;
+		for (unsigned int i = first; i < first + count; i++) {
+			unsigned int id = triangleIds[i];
+			int bin = std::min(binCount - 1, (int)((centroids[id][axis] - centroidBounds.min[axis]) * scale));
+			bins[bin].Grow(triangleBounds[id]);
+			binTriangles[bin]++;
+		}
+		/* Area times triangles left and right of every border, swept from both sides */
+		float leftCost[binCount - 1];
+		Bounds sweep;
+		unsigned int sweepCount = 0;
+		for (int bin = 0; bin < binCount - 1; bin++) {
+			sweep.Grow(bins[bin]);
+			sweepCount += binTriangles[bin];
+			leftCost[bin] = sweepCount * sweep.Area();
+		}
+		sweep = Bounds();
+		sweepCount = 0;
+		for (int bin = binCount - 1; bin > 0; bin--) {
+			sweep.Grow(bins[bin]);
+			sweepCount += binTriangles[bin];
+			float cost = leftCost[bin - 1] + sweepCount * sweep.Area();
+			if (cost < bestCost) {
+				bestCost = cost;
+				bestAxis = axis;
+				bestBin = bin;
+			}
+		}
+	}
+
+	/* Small leaves that no split makes cheaper stay leaves */
+	if (bestAxis >= 0 && count <= 2 * MaxLeafSize && bestCost >= count * bounds.Area())
+		return;
+
+	unsigned int middle;
+	if (bestAxis >= 0) {
+		float scale = binCount / (centroidBounds.max[bestAxis] - centroidBounds.min[bestAxis]);
+		auto split = std::partition(triangleIds.begin() + first, triangleIds.begin() + first + count, [&](unsigned int id) {
+			return std::min(binCount - 1, (int)((centroids[id][bestAxis] - centroidBounds.min[bestAxis]) * scale)) < bestBin;
+		});
+		middle = (unsigned int)(split - triangleIds.begin());
+	}
+	else {
+		/* All centroids in one point, any halves do */
+		bestAxis = 0;
+		middle = first + count / 2;
+	}
+
+	unsigned int left = (unsigned int)nodes.size();
+	nodes.push_back(Node());
+	nodes.push_back(Node());
+	nodes[nodeIndex].leftOrFirst = left;
+	nodes[nodeIndex].count = 0;
+	nodes[nodeIndex].axis = (std::uint16_t)bestAxis;
+	subdivide(left, first, middle - first);
+	subdivide(left + 1, middle, first + count - middle);
+}
+
+inline bool Bvh::intersectTriangle(const Triangle& triangle, const Ray& ray, float maxDistance, float& distance, float& u, float& v)
+{
+	glm::vec3 p = glm::cross(ray.direction, triangle.edge2);
+	float determinant = glm::dot(triangle.edge1, p);
+	/* Parallel to the plane, both sides of the triangle count */
+	if (std::abs(determinant) <= 1e-7f)
+		return false;
+	float inverseDeterminant = 1.0f / determinant;
+	glm::vec3 toOrigin = ray.origin - triangle.v0;
+	u = glm::dot(toOrigin, p) * inverseDeterminant;
+	if (u < 0.0f || u > 1.0f)
+		return false;
+	glm::vec3 q = glm::cross(toOrigin, triangle.edge1);
+	v = glm::dot(ray.direction, q) * inverseDeterminant;
+	if (v < 0.0f || u + v > 1.0f)
+		return false;
+	distance = glm::dot(triangle.edge2, q) * inverseDeterminant;
+	return distance > 0.0f && distance < maxDistance;
+}
+
+inline bool Bvh::intersectBox(const Node& node, const Ray& ray, const glm::vec3& inverseDirection, float maxDistance)
+{
+	glm::vec3 t1 = (node.boundsMin - ray.origin) * inverseDirection;
+	glm::vec3 t2 = (node.boundsMax - ray.origin) * inverseDirection;
+	glm::vec3 tMin = glm::min(t1, t2), tMax = glm::max(t1, t2);
+	float tNear = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.0f));
+	float tFar = std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, maxDistance));
+	return tNear <= tFar;
+}
+
+#endif
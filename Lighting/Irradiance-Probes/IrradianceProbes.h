@@ -0,0 +1,357 @@
+#ifndef IRRADIANCE_PROBES_H
+#define IRRADIANCE_PROBES_H
+
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+
+#include "Bvh.h"
+#include "ThreadPool.h"
+
+/* Triangles of the static scene the probes see */
+struct Probe_scene {
+	/* Three corners per triangle */
+	std::vector<glm::vec3> corners;
+	/* Per triangle, the side the normal points to is the front */
+	std::vector<glm::vec3> normals;
+	/* Diffuse reflectance per triangle */
+	std::vector<glm::vec3> albedos;
+};
+
+/* Grid of light probes storing the irradiance around them as L2 spherical harmonics.
+Every probe traces rays in all directions through the static scene. A hit reflects the direct
+light of the point light there, tested with a shadow ray, a miss sees the Background color. The
+radiance is projected onto the nine spherical harmonics and convolved with the cosine lobe, which
+leaves nine RGB coefficients that give the irradiance for any normal. They go into a 3D texture,
+one slab of the grid per coefficient along z, so the shader reads any point with nine trilinear
+fetches however many lights and surfaces went into the bake. Probes stuck inside geometry see
+mostly back faces, they take the average of their valid neighbours */
+class IrradianceProbes
+{
+public:
+	static const int Coefficients = 9;
+
+	/* Constructor and destructor */
+	IrradianceProbes(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::ivec3& count);
+	~IrradianceProbes() noexcept;
+
+	/* Bake the probes for the point light and upload them, samples is rounded up to whole packets of four */
+	void Bake(const Probe_scene& scene, const glm::vec3& lightPosition, const glm::vec3& lightDiffuse, int samples, ThreadPool& pool);
+	void Bind(int unit) const;
+
+	/* Get functions */
+	int ProbeCount() const noexcept;
+	glm::vec3 ProbePosition(int probe) const;
+	/* Irradiance of the probe for a surface facing along normal, the same sum the shader does */
+	glm::vec3 Irradiance(int probe, const glm::vec3& normal) const;
+
+public:
+	const glm::vec3 BoundsMin;
+	const glm::vec3 BoundsMax;
+	const glm::ivec3 Count;
+	/* Radiance of the rays leaving the scene */
+	glm::vec3 Background;
+	/* Statistics of the last Bake() */
+	double BakeMs;
+	unsigned int InvalidProbes;
+
+private:
+	/* Helper functions */
+	/* The nine basis functions of four directions, structure of arrays */
+	static void evaluateBasis(const float* x, const float* y, const float* z, float* basis, int stride);
+	/* Sum of radiance times basis over the samples, both in structure of arrays */
+	static void project(const float* radiance, const float* basis, int sampleCount, float* coefficients);
+	void bakeProbe(int probe, const Probe_scene& scene, const Bvh& bvh, const glm::vec3& lightPosition, const glm::vec3& lightDiffuse,
+		const std::vector<glm::vec3>& directions, const std::vector<float>& basis);
+	void fillInvalid();
+	void upload();
+private:
+	unsigned int texture;
+	/* Coefficients per probe, already convolved to irradiance */
+	std::vector<glm::vec3> coefficients;
+	std::vector<unsigned char> valid;
+};
+
+
+IrradianceProbes::IrradianceProbes(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::ivec3& count)
+	: BoundsMin(boundsMin), BoundsMax(boundsMax), Count(glm::max(count, glm::ivec3(2))), Background(0.1f, 0.12f, 0.16f), BakeMs(0.0), InvalidProbes(0),
+	coefficients(Count.x * Count.y * Count.z * Coefficients, glm::vec3(0.0f)), valid(Count.x * Count.y * Count.z, 0)
+{
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_3D, texture);
+	glTexImage3D(GL_TEXTURE_3D, 0, GL_RGB16F, Count.x, Count.y, Count.z * Coefficients, 0, GL_RGB, GL_FLOAT, NULL);
+	/* Trilinear between the probes, the shader keeps the lookups half a texel inside the slab of a coefficient */
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_3D, 0);
+}
+
+IrradianceProbes::~IrradianceProbes() noexcept
+{
+	glDeleteTextures(1, &texture);
+}
+
+void IrradianceProbes::Bake(const Probe_scene& scene, const glm::vec3& lightPosition, const glm::vec3& lightDiffuse, int samples, ThreadPool& pool)
+{
+	auto start = std::chrono::steady_clock::now();
+	Bvh bvh(scene.corners);
+
+	/* The same directions for every probe, spread evenly over the sphere on a Fibonacci spiral */
+	int sampleCount = std::max(4, (samples + 3) / 4 * 4);
+	std::vector<glm::vec3> directions;
+	std::vector<float> x, y, z;
+	for (int i = 0; i < sampleCount; i++) {
+		float cosTheta = 1.0f - (2.0f * i + 1.0f) / sampleCount;
+		float sinTheta = std::sqrt(std::max(0.0f, 1.0f - cosTheta * cosTheta));
+		float phi = 2.39996323f * i;
+		directions.push_back(glm::vec3(sinTheta * std::cos(phi), cosTheta, sinTheta * std::sin(phi)));
+		x.push_back(directions.back().x);
+		y.push_back(directions.back().y);
+		z.push_back(directions.back().z);
+	}
+	/* basis[c * sampleCount + i] is basis function c of direction i */
+	std::vector<float> basis(Coefficients * sampleCount);
+	for (int i = 0; i < sampleCount; i += 4)
+		evaluateBasis(&x[i], &y[i], &z[i], &basis[i], sampleCount);
+
+	pool.ParallelFor(ProbeCount(), [&](unsigned int begin, unsigned int end) {
+		for (unsigned int probe = begin; probe < end; probe++)
+			bakeProbe((int)probe, scene, bvh, lightPosition, lightDiffuse, directions, basis);
+	});
+	fillInvalid();
+	upload();
+
+	BakeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void IrradianceProbes::Bind(int unit) const
+{
+	glActiveTexture(GL_TEXTURE0 + unit);
+	glBindTexture(GL_TEXTURE_3D, texture);
+}
+
+inline int IrradianceProbes::ProbeCount() const noexcept
+{
+	return Count.x * Count.y * Count.z;
+}
+
+glm::vec3 IrradianceProbes::ProbePosition(int probe) const
+{
+	glm::vec3 cell((float)(probe % Count.x), (float)(probe / Count.x % Count.y), (float)(probe / (Count.x * Count.y)));
+	return BoundsMin + (BoundsMax - BoundsMin) * cell / glm::vec3(Count - 1);
+}
+
+glm::vec3 IrradianceProbes::Irradiance(int probe, const glm::vec3& normal) const
+{
+	float basis[4 * Coefficients];
+	float x[4] = { normal.x }, y[4] = { normal.y }, z[4] = { normal.z };
+	evaluateBasis(x, y, z, basis, 4);
+	glm::vec3 irradiance(0.0f);
+	for (int c = 0; c < Coefficients; c++)
+		irradiance += coefficients[probe * Coefficients + c] * basis[4 * c];
+	return glm::max(irradiance, glm::vec3(0.0f));
+}
+
+#if defined(BVH_SSE2)
+void IrradianceProbes::evaluateBasis(const float* x, const float* y, const float* z, float* basis, int stride)
+{
+	__m128 vx = _mm_loadu_ps(x), vy = _mm_loadu_ps(y), vz = _mm_loadu_ps(z);
+	_mm_storeu_ps(basis, _mm_set1_ps(0.282095f));
+	_mm_storeu_ps(basis + stride, _mm_mul_ps(_mm_set1_ps(0.488603f), vy));
+	_mm_storeu_ps(basis + 2 * stride, _mm_mul_ps(_mm_set1_ps(0.488603f), vz));
+	_mm_storeu_ps(basis + 3 * stride, _mm_mul_ps(_mm_set1_ps(0.488603f), vx));
+	_mm_storeu_ps(basis + 4 * stride, _mm_mul_ps(_mm_set1_ps(1.092548f), _mm_mul_ps(vx, vy)));
+	_mm_storeu_ps(basis + 5 * stride, _mm_mul_ps(_mm_set1_ps(1.092548f), _mm_mul_ps(vy, vz)));
+	_mm_storeu_ps(basis + 6 * stride, _mm_mul_ps(_mm_set1_ps(0.315392f), _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(3.0f), _mm_mul_ps(vz, vz)), _mm_set1_ps(1.0f))));
+	_mm_storeu_ps(basis + 7 * stride, _mm_mul_ps(_mm_set1_ps(1.092548f), _mm_mul_ps(vx, vz)));
+	_mm_storeu_ps(basis + 8 * stride, _mm_mul_ps(_mm_set1_ps(0.546274f), _mm_sub_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy))));
+}
+
+void IrradianceProbes::project(const float* radiance, const float* basis, int sampleCount, float* coefficients)
+{
+	/* Four samples per step, radiance holds the red, green and blue of all samples one after the other */
+	for (int c = 0; c < Coefficients; c++) {
+		__m128 red = _mm_setzero_ps(), green = _mm_setzero_ps(), blue = _mm_setzero_ps();
+		for (int i = 0; i < sampleCount; i += 4) {
+			__m128 weight = _mm_loadu_ps(basis + c * sampleCount + i);
+			red = _mm_add_ps(red, _mm_mul_ps(weight, _mm_loadu_ps(radiance + i)));
+			green = _mm_add_ps(green, _mm_mul_ps(weight, _mm_loadu_ps(radiance + sampleCount + i)));
+			blue = _mm_add_ps(blue, _mm_mul_ps(weight, _mm_loadu_ps(radiance + 2 * sampleCount + i)));
+		}
+		float sums[3][4];
+		_mm_storeu_ps(sums[0], red);
+		_mm_storeu_ps(sums[1], green);
+		_mm_storeu_ps(sums[2], blue);
+		for (int channel = 0; channel < 3; channel++)
+			coefficients[3 * c + channel] = sums[channel][0] + sums[channel][1] + sums[channel][2] + sums[channel][3];
+	}
+}
+#else
+void IrradianceProbes::evaluateBasis(const float* x, const float* y, const float* z, float* basis, int stride)
+{
+	for (int i = 0; i < 4; i++) {
+		basis[i] = 0.282095f;
+		basis[stride + i] = 0.488603f * y[i];
+		basis[2 * stride + i] = 0.488603f * z[i];
+		basis[3 * stride + i] = 0.488603f * x[i];
+		basis[4 * stride + i] = 1.092548f * x[i] * y[i];
+		basis[5 * stride + i] = 1.092548f * y[i] * z[i];
+		basis[6 * stride + i] = 0.315392f * (3.0f * z[i] * z[i] - 1.0f);
+		basis[7 * stride + i] = 1.092548f * x[i] * z[i];
+		basis[8 * stride + i] = 0.546274f * (x[i] * x[i] - y[i] * y[i]);
+	}
+}
+
+void IrradianceProbes::project(const float* radiance, const float* basis, int sampleCount, float* coefficients)
+{
+	for (int c = 0; c < Coefficients; c++)
+		for (int channel = 0; channel < 3; channel++) {
+			float sum = 0.0f;
+			for (int i = 0; i < sampleCount; i++)
+				sum += basis[c * sampleCount + i] * radiance[channel * sampleCount + i];
+			coefficients[3 * c + channel] = sum;
+		}
+}
+#endif
+
+void IrradianceProbes::bakeProbe(int probe, const Probe_scene& scene, const Bvh& bvh, const glm::vec3& lightPosition, const glm::vec3& lightDiffuse,
+	const std::vector<glm::vec3>& directions, const std::vector<float>& basis)
+{
+	int sampleCount = (int)directions.size();
+	glm::vec3 origin = ProbePosition(probe);
+	/* Red, green and blue of the samples one after the other */
+	std::vector<float> radiance(3 * sampleCount, 0.0f);
+	int backFaces = 0;
+
+	for (int first = 0; first < sampleCount; first += 4) {
+		Ray_packet packet;
+		packet.activeMask = 0xF;
+		for (int lane = 0; lane < 4; lane++) {
+			packet.originX[lane] = origin.x;
+			packet.originY[lane] = origin.y;
+			packet.originZ[lane] = origin.z;
+			packet.directionX[lane] = directions[first + lane].x;
+			packet.directionY[lane] = directions[first + lane].y;
+			packet.directionZ[lane] = directions[first + lane].z;
+			packet.maxDistance[lane] = std::numeric_limits<float>::max();
+		}
+		Ray_hit hits[4];
+		bvh.Intersect(packet, hits);
+
+		/* Direct light at the hits, reflected diffusely */
+		Ray_packet shadow;
+		shadow.activeMask = 0;
+		glm::vec3 reflected[4];
+		for (int lane = 0; lane < 4; lane++) {
+			int sample = first + lane;
+			const Ray_hit& hit = hits[lane];
+			if (hit.triangle < 0) {
+				for (int channel = 0; channel < 3; channel++)
+					radiance[channel * sampleCount + sample] = Background[channel];
+				continue;
+			}
+			const glm::vec3& normal = scene.normals[hit.triangle];
+			if (glm::dot(normal, directions[sample]) > 0.0f) {
+				backFaces++;
+				continue;
+			}
+
+			glm::vec3 position = origin + directions[sample] * hit.distance + normal * 1e-3f;
+			glm::vec3 toLight = lightPosition - position;
+			float distance = glm::length(toLight);
+			float cosine = glm::dot(normal, toLight / distance);
+			if (cosine <= 0.0f)
+				continue;
+			/* Irradiance times albedo over pi is the radiance leaving a diffuse surface */
+			reflected[lane] = lightDiffuse * cosine * scene.albedos[hit.triangle] * 0.31830989f;
+			shadow.originX[lane] = position.x;
+			shadow.originY[lane] = position.y;
+			shadow.originZ[lane] = position.z;
+			shadow.directionX[lane] = toLight.x / distance;
+			shadow.directionY[lane] = toLight.y / distance;
+			shadow.directionZ[lane] = toLight.z / distance;
+			shadow.maxDistance[lane] = distance;
+			shadow.activeMask |= 1 << lane;
+		}
+		int lit = shadow.activeMask & ~bvh.Occluded(shadow);
+		for (int lane = 0; lane < 4; lane++)
+			if (lit & (1 << lane))
+				for (int channel = 0; channel < 3; channel++)
+					radiance[channel * sampleCount + first + lane] = reflected[lane][channel];
+	}
+
+	/* Inside a box or a wall */
+	valid[probe] = backFaces * 4 < sampleCount;
+
+	float projected[3 * Coefficients];
+	project(radiance.data(), basis.data(), sampleCount, projected);
+	/* Every sample stands for the same solid angle, then the cosine lobe convolution per band */
+	const float solidAngle = 4.0f * 3.14159265f / sampleCount;
+	const float bands[Coefficients] = { 3.14159265f, 2.09439510f, 2.09439510f, 2.09439510f, 0.78539816f, 0.78539816f, 0.78539816f, 0.78539816f, 0.78539816f };
+	for (int c = 0; c < Coefficients; c++)
+		coefficients[probe * Coefficients + c] = glm::vec3(projected[3 * c], projected[3 * c + 1], projected[3 * c + 2]) * solidAngle * bands[c];
+}
+
+void IrradianceProbes::fillInvalid()
+{
+	InvalidProbes = 0;
+	for (unsigned char probeValid : valid)
+		if (!probeValid)
+			InvalidProbes++;
+
+	/* Grow the valid probes into the invalid ones ring by ring */
+	bool changed = true;
+	while (changed) {
+		changed = false;
+		std::vector<unsigned char> next = valid;
+		for (int probe = 0; probe < ProbeCount(); probe++) {
+			if (valid[probe])
+				continue;
+			glm::ivec3 cell(probe % Count.x, probe / Count.x % Count.y, probe / (Count.x * Count.y));
+			std::vector<glm::vec3> sum(Coefficients, glm::vec3(0.0f));
+			int neighbours = 0;
+			for (int axis = 0; axis < 3; axis++)
+				for (int step = -1; step <= 1; step += 2) {
+					glm::ivec3 other = cell;
+					other[axis] += step;
+					if (other[axis] < 0 || other[axis] >= Count[axis])
+						continue;
+					int neighbour = other.x + Count.x * (other.y + Count.y * other.z);
+					if (!valid[neighbour])
+						continue;
+					for (int c = 0; c < Coefficients; c++)
+						sum[c] += coefficients[neighbour * Coefficients + c];
+					neighbours++;
+				}
+			if (neighbours == 0)
+				continue;
+			for (int c = 0; c < Coefficients; c++)
+				coefficients[probe * Coefficients + c] = sum[c] / (float)neighbours;
+			next[probe] = 1;
+			changed = true;
+		}
+		valid.swap(next);
+	}
+}
+
+void IrradianceProbes::upload()
+{
+	/* Slab c holds coefficient c of the whole grid */
+	std::vector<glm::vec3> texels(coefficients.size());
+	for (int probe = 0; probe < ProbeCount(); probe++)
+		for (int c = 0; c < Coefficients; c++)
+			texels[c * ProbeCount() + probe] = coefficients[probe * Coefficients + c];
+	glBindTexture(GL_TEXTURE_3D, texture);
+	glTexSubImage3D(GL_TEXTURE_3D, 0, 0, 0, 0, Count.x, Count.y, Count.z * Coefficients, GL_RGB, GL_FLOAT, texels.data());
+	glBindTexture(GL_TEXTURE_3D, 0);
+}
+
+#endif
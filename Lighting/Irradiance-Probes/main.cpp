@@ -0,0 +1,455 @@
+#include "glad/glad.h"
+#include "GLFW/glfw3.h"
+
+#include "stb_image.h"
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+#include "Shader.h"
+#include "Camera.h"
+#include "GpuTimer.h"
+#include "ThreadPool.h"
+#include "IrradianceProbes.h"
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <cmath>
+#include <algorithm>
+
+
+void processInput(GLFWwindow* window);
+void frameBufferResize_callback(GLFWwindow* window, int width, int height);
+void mouseMovement_callback(GLFWwindow* window, double xPos, double yPos);
+void mouseScroll_callback(GLFWwindow* window, double xOffset, double yOffset);
+void keyPress_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+
+unsigned int loadTexture(const char* path);
+glm::vec3 averageColor(const char* path);
+void appendBox(Probe_scene& scene, const float* cubeVertices, const glm::mat4& model, const glm::vec3& albedo);
+
+
+const int winWidth = 800;
+const int winHeight = 600;
+
+/************************************ CAMERA ************************************/
+Camera camera({ 0.0f, 0.5f, 4.0f });
+
+float lastX = winWidth / 2;
+float lastY = winHeight / 2;
+bool firstMouseMove = true;
+
+/************************************ FRAMES ************************************/
+float deltaTime = 0.0f;
+float lastFrame = 0.0f;
+
+/************************************ LIGHTING ************************************/
+/* L moves the light to the next spot and bakes the probes again */
+const glm::vec3 lightSpots[] = { glm::vec3(1.2f, 1.0f, 2.0f), glm::vec3(-3.0f, 2.5f, -3.0f), glm::vec3(3.5f, 0.5f, -4.0f) };
+int lightSpot = 0;
+bool lightMoved = false;
+/* P switches between the probes and the constant ambient of the other demos */
+bool useProbes = true;
+/* V shows the probe irradiance alone */
+bool showProbes = false;
+
+/************************************ PROBES ************************************/
+/* The grid spans the inside of the room */
+const glm::vec3 probeMin(-4.8f, -0.3f, -4.8f);
+const glm::vec3 probeMax(4.8f, 3.2f, 4.8f);
+const glm::ivec3 probeCount(8, 4, 8);
+/* Rays per probe */
+const int probeSamples = 256;
+
+
+int main()
+{
+	/************************************ INITIALIZATION ************************************/
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+	GLFWwindow* window = glfwCreateWindow(winWidth, winHeight, "Irradiance probes", NULL, NULL);
+	if (window == NULL) {
+		std::cout << "ERROR::GLFW::INITIALIZATION_FAILED" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		std::cout << "ERROR::GLAD::INITIALIZATION_FAILED" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glViewport(0, 0, winWidth, winHeight);
+	/* Measure the shading, not the display refresh */
+	glfwSwapInterval(0);
+
+	glfwSetFramebufferSizeCallback(window, frameBufferResize_callback);
+	glfwSetCursorPosCallback(window, mouseMovement_callback);
+	glfwSetScrollCallback(window, mouseScroll_callback);
+	glfwSetKeyCallback(window, keyPress_callback);
+
+	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+	/************************************ POSITIONS ************************************/
+	float cubeVertices[] = {
+		/*	  Positions			Normals		  TextureCoords	*/
+		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
+
+		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
+
+		-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+		-0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
+		-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
+		-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+
+		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+
+		-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  1.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  0.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
+
+		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  1.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  0.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f
+	};
+
+	/************************************ OBJECTS ************************************/
+	/* The room and crates of the lightmap demo, static and seen by the probes */
+	std::vector<glm::vec3> cubePositions = {
+		glm::vec3(0.0f, -0.6f, 0.0f),
+		glm::vec3(0.0f, 1.4f, -5.1f),
+		glm::vec3(-5.1f, 1.4f, 0.0f),
+		glm::vec3(5.1f, 1.4f, -2.5f),
+		glm::vec3(0.0f, 0.0f, 0.0f),
+		glm::vec3(-2.0f, 0.25f, -1.5f),
+		glm::vec3(-2.0f, 1.5f, -1.5f),
+		glm::vec3(2.6f, 0.0f, -1.8f),
+		glm::vec3(-1.2f, -0.2f, 2.0f),
+		glm::vec3(0.8f, -0.25f, -3.2f),
+		glm::vec3(3.4f, 0.5f, 1.0f)
+	};
+	std::vector<glm::vec3> cubeSizes = {
+		glm::vec3(10.0f, 0.2f, 10.0f),
+		glm::vec3(10.0f, 4.0f, 0.2f),
+		glm::vec3(0.2f, 4.0f, 10.0f),
+		glm::vec3(0.2f, 4.0f, 5.0f),
+		glm::vec3(1.0f),
+		glm::vec3(1.5f),
+		glm::vec3(1.0f),
+		glm::vec3(1.0f),
+		glm::vec3(0.6f),
+		glm::vec3(0.5f),
+		glm::vec3(1.0f, 2.0f, 1.0f)
+	};
+	std::vector<float> cubeAngles = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 20.0f, 55.0f, 45.0f, 10.0f, 30.0f, 0.0f };
+	/* Crates flying around the room, lit by the probes like everything else */
+	const unsigned int dynamicCount = 3;
+
+	Probe_scene probeScene;
+	glm::vec3 albedo = averageColor("textures/container2.png");
+	std::vector<glm::mat4> staticModels;
+	for (unsigned int i = 0; i < cubePositions.size(); i++) {
+		glm::mat4 model = glm::translate(glm::mat4(1.0f), cubePositions[i]);
+		model = glm::rotate(model, glm::radians(cubeAngles[i]), glm::vec3(0.0f, 1.0f, 0.0f));
+		model = glm::scale(model, cubeSizes[i]);
+		staticModels.push_back(model);
+		appendBox(probeScene, cubeVertices, model, albedo);
+	}
+
+	/************************************ BUFFERS ************************************/
+	unsigned int VBO, cubeVAO, lightVAO;
+	glGenVertexArrays(1, &cubeVAO);
+	glGenVertexArrays(1, &lightVAO);
+	glGenBuffers(1, &VBO);
+
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), cubeVertices, GL_STATIC_DRAW);
+
+	glBindVertexArray(cubeVAO);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+	glEnableVertexAttribArray(2);
+
+	glBindVertexArray(lightVAO);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	/************************************ TEXTURES ************************************/
+	unsigned int diffuseMap = loadTexture("textures/container2.png");
+	unsigned int specularMap = loadTexture("textures/container2_specular.png");
+
+	/************************************ PROBES ************************************/
+	/* The render loop waits for the bake, every core may trace */
+	ThreadPool bakePool(std::max(1u, std::thread::hardware_concurrency()));
+	IrradianceProbes probes(probeMin, probeMax, probeCount);
+	glm::vec3 lightDiffuse(0.5f);
+	probes.Bake(probeScene, lightSpots[lightSpot], lightDiffuse, probeSamples, bakePool);
+	std::cout << probes.ProbeCount() << " probes, " << probeSamples << " rays each, baked in " << probes.BakeMs << " ms on "
+		<< bakePool.ThreadCount() << " threads, " << probes.InvalidProbes << " inside geometry" << std::endl;
+
+	/************************************ SHADERS ************************************/
+	Shader lightingShader("shaders/shader.vs", "shaders/shader.fs");
+	Shader lightCubeShader("shaders/lightCube.vs", "shaders/lightCube.fs");
+	lightingShader.use();
+	lightingShader.setInt("material.diffuse", 0);
+	lightingShader.setInt("material.specular", 1);
+	lightingShader.setFloat("material.shininess", 32.0f);
+	lightingShader.setVec3("light.ambient", 0.2f, 0.2f, 0.2f);
+	lightingShader.setVec3("light.diffuse", lightDiffuse);
+	lightingShader.setVec3("light.specular", 1.0f, 1.0f, 1.0f);
+	lightingShader.setInt("probes.coefficients", 2);
+	lightingShader.setVec3("probes.boundsMin", probes.BoundsMin);
+	lightingShader.setVec3("probes.boundsMax", probes.BoundsMax);
+	lightingShader.setVec3("probes.count", glm::vec3(probes.Count));
+
+	/************************************ RENDER LOOP ************************************/
+	glEnable(GL_DEPTH_TEST);
+	std::cout << "P switches between probes and constant ambient, V shows the probes, L moves the light" << std::endl;
+
+	GpuTimer sceneTimer;
+	bool measuredProbes = useProbes;
+	unsigned int measuredFrames = 0;
+	double measureStart = glfwGetTime();
+	lastFrame = glfwGetTime();
+	while (!glfwWindowShouldClose(window)) {
+		float currentFrame = glfwGetTime();
+		deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+
+		processInput(window);
+
+		if (lightMoved) {
+			probes.Bake(probeScene, lightSpots[lightSpot], lightDiffuse, probeSamples, bakePool);
+			std::cout << "Probes baked again in " << probes.BakeMs << " ms" << std::endl;
+			lightMoved = false;
+		}
+		const glm::vec3& lightPos = lightSpots[lightSpot];
+
+		int width, height;
+		glfwGetFramebufferSize(window, &width, &height);
+		glm::mat4 view = camera.GetViewMatrix();
+		glm::mat4 projection = camera.GetProjectionMatrix((float)width / std::max(height, 1));
+
+		glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		/* Scene */
+		lightingShader.use();
+		lightingShader.setMat4f("view", view);
+		lightingShader.setMat4f("projection", projection);
+		lightingShader.setVec3("viewPos", camera.Position);
+		lightingShader.setVec3("light.position", lightPos);
+		lightingShader.setBool("useProbes", useProbes);
+		lightingShader.setBool("showProbes", showProbes);
+
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, diffuseMap);
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, specularMap);
+		probes.Bind(2);
+
+		sceneTimer.Begin();
+		glBindVertexArray(cubeVAO);
+		for (const glm::mat4& model : staticModels) {
+			lightingShader.setMat4f("model", model);
+			glDrawArrays(GL_TRIANGLES, 0, 36);
+		}
+		for (unsigned int i = 0; i < dynamicCount; i++) {
+			float angle = currentFrame * 0.4f + i * 2.094f;
+			glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(std::cos(angle) * 3.0f, 1.0f + i * 0.8f, std::sin(angle) * 3.0f));
+			model = glm::rotate(model, currentFrame * (1.0f + i), glm::vec3(0.3f, 1.0f, 0.5f));
+			model = glm::scale(model, glm::vec3(0.5f));
+			lightingShader.setMat4f("model", model);
+			glDrawArrays(GL_TRIANGLES, 0, 36);
+		}
+		sceneTimer.End();
+
+		/* Light cube */
+		lightCubeShader.use();
+		lightCubeShader.setMat4f("projection", projection);
+		lightCubeShader.setMat4f("view", view);
+		glm::mat4 model = glm::mat4(1.0f);
+		model = glm::translate(model, lightPos);
+		model = glm::scale(model, glm::vec3(0.2f)); // Make the cube smaller
+		lightCubeShader.setMat4f("model", model);
+		glBindVertexArray(lightVAO);
+		glDrawArrays(GL_TRIANGLES, 0, 36);
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+
+		/* Averages over two seconds, restarted when the ambient is switched */
+		measuredFrames++;
+		double measured = glfwGetTime() - measureStart;
+		if (measuredProbes != useProbes || measured >= 2.0) {
+			if (measuredProbes == useProbes)
+				std::cout << (useProbes ? "Probe" : "Constant") << " ambient: " << measured * 1000.0 / measuredFrames << " ms per frame, "
+					<< sceneTimer.AverageMs() << " ms GPU for the scene" << std::endl;
+			measuredProbes = useProbes;
+			measuredFrames = 0;
+			sceneTimer.Reset();
+			measureStart = glfwGetTime();
+		}
+	}
+
+	glDeleteVertexArrays(1, &cubeVAO);
+	glDeleteVertexArrays(1, &lightVAO);
+	glDeleteBuffers(1, &VBO);
+	glDeleteTextures(1, &diffuseMap);
+	glDeleteTextures(1, &specularMap);
+	glfwTerminate();
+}
+
+
+void processInput(GLFWwindow* window)
+{
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, true);
+	if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
+		deltaTime *= 2;
+	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::FORWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::BACKWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::LEFT, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::RIGHT, deltaTime);
+}
+
+void keyPress_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	if (action != GLFW_PRESS)
+		return;
+	if (key == GLFW_KEY_P)
+		useProbes = !useProbes;
+	else if (key == GLFW_KEY_V)
+		showProbes = !showProbes;
+	else if (key == GLFW_KEY_L) {
+		lightSpot = (lightSpot + 1) % 3;
+		lightMoved = true;
+	}
+}
+
+void frameBufferResize_callback(GLFWwindow* window, int width, int height)
+{
+	glViewport(0, 0, width, height);
+}
+
+void mouseMovement_callback(GLFWwindow* window, double xPos, double yPos)
+{
+	if (firstMouseMove) {
+		lastX = xPos;
+		lastY = yPos;
+		firstMouseMove = false;
+	}
+
+	float xOffset = (float)xPos - lastX;
+	float yOffset = lastY - (float)yPos;
+	lastX = xPos;
+	lastY = yPos;
+
+	camera.ProcessMouseMovement(xOffset, yOffset);
+}
+
+void mouseScroll_callback(GLFWwindow* window, double xOffset, double yOffset)
+{
+	camera.ProcessMouseScroll(yOffset);
+}
+
+unsigned int loadTexture(const char* path)
+{
+	unsigned int textureID;
+	glGenTextures(1, &textureID);
+
+	int width, height, nrComponents;
+	unsigned char* data = stbi_load(path, &width, &height, &nrComponents, 0);
+	if (data) {
+		/* See which color format the texture uses */
+		GLenum format;
+		if (nrComponents == 1)
+			format = GL_RED;
+		else if (nrComponents == 3)
+			format = GL_RGB;
+		else if (nrComponents == 4)
+			format = GL_RGBA;
+
+		glBindTexture(GL_TEXTURE_2D, textureID);
+		glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+		glGenerateMipmap(GL_TEXTURE_2D);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	}
+	else
+		std::cout << "Texture failed to load at path: " << path << std::endl;
+	stbi_image_free(data);
+
+	return textureID;
+}
+
+glm::vec3 averageColor(const char* path)
+{
+	int width, height, nrComponents;
+	unsigned char* data = stbi_load(path, &width, &height, &nrComponents, 3);
+	if (!data) {
+		std::cout << "Texture failed to load at path: " << path << std::endl;
+		return glm::vec3(0.5f);
+	}
+
+	double sum[3] = {};
+	for (int i = 0; i < width * height; i++)
+		for (int channel = 0; channel < 3; channel++)
+			sum[channel] += data[3 * i + channel];
+	stbi_image_free(data);
+	double scale = 1.0 / (255.0 * width * height);
+	return glm::vec3((float)(sum[0] * scale), (float)(sum[1] * scale), (float)(sum[2] * scale));
+}
+
+void appendBox(Probe_scene& scene, const float* cubeVertices, const glm::mat4& model, const glm::vec3& albedo)
+{
+	for (int triangle = 0; triangle < 12; triangle++) {
+		const float* vertex = cubeVertices + 24 * triangle;
+		for (int corner = 0; corner < 3; corner++)
+			scene.corners.push_back(glm::vec3(model * glm::vec4(vertex[8 * corner], vertex[8 * corner + 1], vertex[8 * corner + 2], 1.0f)));
+		/* Scaled along their own axes, the normals keep the direction */
+		scene.normals.push_back(glm::normalize(glm::mat3(model) * glm::vec3(vertex[3], vertex[4], vertex[5])));
+		scene.albedos.push_back(albedo);
+	}
+}
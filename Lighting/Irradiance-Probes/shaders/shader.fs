@@ -0,0 +1,85 @@
+#version 330 core
+
+struct Material {
+  sampler2D diffuse;
+  sampler2D specular;
+  float shininess;
+};
+
+struct Light {
+  vec3 position;
+
+  vec3 ambient;
+  vec3 diffuse;
+  vec3 specular;
+};
+
+// Grid of L2 spherical harmonic irradiance probes, slab i along z holds coefficient i
+struct Probes {
+  sampler3D coefficients;
+  vec3 boundsMin;
+  vec3 boundsMax;
+  vec3 count;
+};
+
+out vec4 fragColor;
+
+in vec3 Normal;
+in vec3 fragPos;
+in vec2 texCoords;
+
+uniform vec3 viewPos;
+uniform Material material;
+uniform Light light;
+uniform Probes probes;
+// off uses the constant light.ambient
+uniform bool useProbes;
+// shows the probe irradiance alone
+uniform bool showProbes;
+
+vec3 probeIrradiance(vec3 position, vec3 n)
+{
+  // texel coordinates between the outer probe centers, half a texel inside every slab
+  vec3 count = probes.count;
+  vec3 grid = clamp((position - probes.boundsMin) / (probes.boundsMax - probes.boundsMin), 0.0, 1.0);
+  vec3 texel = grid * (count - 1.0) + 0.5;
+  vec2 xy = texel.xy / count.xy;
+  float slabs = count.z * 9.0;
+
+  float basis[9] = float[9](
+    0.282095,
+    0.488603 * n.y, 0.488603 * n.z, 0.488603 * n.x,
+    1.092548 * n.x * n.y, 1.092548 * n.y * n.z, 0.315392 * (3.0 * n.z * n.z - 1.0),
+    1.092548 * n.x * n.z, 0.546274 * (n.x * n.x - n.y * n.y));
+  vec3 irradiance = vec3(0.0);
+  for (int i = 0; i < 9; i++)
+    irradiance += basis[i] * texture(probes.coefficients, vec3(xy, (texel.z + float(i) * count.z) / slabs)).rgb;
+  return max(irradiance, vec3(0.0));
+}
+
+void main()
+{
+  vec3 albedo = vec3(texture(material.diffuse, texCoords));
+  vec3 norm = normalize(Normal);
+
+  // ambient from the probes, the light the static scene bounces around
+  vec3 ambient = useProbes ? probeIrradiance(fragPos, norm) : light.ambient;
+  if (showProbes) {
+    fragColor = vec4(ambient, 1.0);
+    return;
+  }
+  ambient *= albedo;
+
+  // diffuse
+  vec3 lightDir = normalize(light.position - fragPos);
+  float diff = max(dot(norm, lightDir), 0.0);
+  vec3 diffuse = light.diffuse * diff * albedo;
+
+  // specular
+  vec3 viewDir = normalize(viewPos - fragPos);
+  vec3 reflectDir = reflect(-lightDir, norm);
+  float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+  vec3 specular = light.specular * (spec * vec3(texture(material.specular, texCoords)));
+
+  fragColor = vec4(ambient + diffuse + specular, 1.0);
+}
@@ -0,0 +1,21 @@
+#version 330 core
+layout (location = 0) in vec3 aPosition;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+
+out vec3 Normal;
+out vec3 fragPos;
+out vec2 texCoords;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+  gl_Position = projection * view * model * vec4(aPosition, 1.0f);
+  // the boxes are scaled along their own axes, so their axis aligned normals keep the direction
+  Normal = mat3(model) * aNormal;
+  fragPos = vec3(model * vec4(aPosition, 1.0));
+  texCoords = aTexCoords;
+}
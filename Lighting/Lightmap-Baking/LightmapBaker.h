@@ -0,0 +1,409 @@
+#ifndef LIGHTMAP_BAKER_H
+#define LIGHTMAP_BAKER_H
+
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+
+#include "Bvh.h"
+#include "LightmapUnwrap.h"
+#include "ThreadPool.h"
+
+/* Point light of the baked lighting, without falloff like the dynamic shader */
+struct Bake_light {
+	glm::vec3 position;
+	glm::vec3 diffuse;
+};
+
+/* Quality and tracing settings of a bake */
+struct Bake_settings {
+	/* Hemisphere samples per texel for the indirect light, rounded up to whole packets of four */
+	int indirectSamples = 64;
+	/* Diffuse bounces followed from every sample */
+	int bounces = 2;
+	/* Trace four rays at once, off traces them one by one */
+	bool packets = true;
+};
+
+/* Path tracer baking the diffuse light of a static scene into a lightmap on the CPU.
+Every covered texel gets the direct light of the point light, tested with a shadow ray, plus the
+light arriving over diffuse bounces, from cosine weighted hemisphere samples. The texels are baked
+in tiles spread over a thread pool, the shadow rays of four neighbouring texels and the samples of
+a texel travel as ray packets through the BVH. Texels outside every triangle but next to one get
+the average of their neighbours, so bilinear filtering at the chart edges doesn't pull in black */
+class LightmapBaker
+{
+public:
+	/* Texels along the side of a tile, the unit of work of a thread */
+	static const int TileSize = 16;
+
+	/* The triangle list unwrapped by LightmapUnwrap and the diffuse reflectance of every triangle */
+	LightmapBaker(const std::vector<Lightmap_vertex>& vertices, const std::vector<glm::vec3>& albedos, int size, int padding);
+
+	/* Bake the lightmap, replaces the previous one */
+	void Bake(const Bake_light& light, const Bake_settings& settings, ThreadPool& pool);
+	/* RGBA16F texture, the irradiance in rgb and the light visibility for the specular highlight in a */
+	unsigned int CreateTexture() const;
+
+	/* Get functions */
+	const std::vector<glm::vec4>& Texels() const noexcept;
+
+public:
+	const int Size;
+	const int Padding;
+	/* Statistics of the last Bake() */
+	double BakeMs;
+	unsigned long long RaysTraced;
+	unsigned int CoveredTexels;
+
+private:
+	/* Packet helpers, trace packets or their rays one by one */
+	struct Tracer {
+		const Bvh& bvh;
+		bool packets;
+		unsigned long long rays;
+
+		void Intersect(const Ray_packet& packet, Ray_hit hits[4]);
+		int Occluded(const Ray_packet& packet);
+	};
+
+	/* Helper functions */
+	/* Position and normal of every texel center inside a triangle */
+	void rasterize(const std::vector<Lightmap_vertex>& vertices);
+	void bakeTile(int tile, const Bake_light& light, const Bake_settings& settings, Tracer& tracer);
+	/* Indirect irradiance at the texel */
+	glm::vec3 gather(int texel, const Bake_light& light, const Bake_settings& settings, Tracer& tracer) const;
+	/* Fill the uncovered texels next to covered ones, Padding rings */
+	void dilate();
+	/* Small offset along the normal that keeps rays from hitting the surface they start on */
+	static glm::vec3 offset(const glm::vec3& position, const glm::vec3& normal) noexcept;
+	static float random(unsigned int& state) noexcept;
+private:
+	Bvh bvh;
+	std::vector<glm::vec3> faceNormals;
+	std::vector<glm::vec3> albedos;
+	/* Per texel */
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec3> normals;
+	std::vector<unsigned char> covered;
+	std::vector<glm::vec4> texels;
+};
+
+
+namespace {
+	std::vector<glm::vec3> lightmapCorners(const std::vector<Lightmap_vertex>& vertices)
+	{
+		std::vector<glm::vec3> corners;
+		corners.reserve(vertices.size());
+		for (const Lightmap_vertex& vertex : vertices)
+			corners.push_back(vertex.position);
+		return corners;
+	}
+}
+
+LightmapBaker::LightmapBaker(const std::vector<Lightmap_vertex>& vertices, const std::vector<glm::vec3>& albedos, int size, int padding = 2)
+	: Size(size), Padding(padding), BakeMs(0.0), RaysTraced(0), CoveredTexels(0), bvh(lightmapCorners(vertices)), albedos(albedos),
+	positions(size * size), normals(size * size), covered(size * size, 0), texels(size * size, glm::vec4(0.0f))
+{
+	for (unsigned int i = 0; i + 2 < vertices.size(); i += 3) {
+		glm::vec3 normal = glm::normalize(glm::cross(vertices[i + 1].position - vertices[i].position, vertices[i + 2].position - vertices[i].position));
+		/* The winding doesn't matter, the front is where the vertex normals point */
+		if (glm::dot(normal, vertices[i].normal + vertices[i + 1].normal + vertices[i + 2].normal) < 0.0f)
+			normal = -normal;
+		faceNormals.push_back(normal);
+	}
+	rasterize(vertices);
+}
+
+void LightmapBaker::Bake(const Bake_light& light, const Bake_settings& settings, ThreadPool& pool)
+{
+	auto start = std::chrono::steady_clock::now();
+	std::fill(texels.begin(), texels.end(), glm::vec4(0.0f));
+
+	int tilesPerRow = (Size + TileSize - 1) / TileSize;
+	std::atomic<unsigned long long> rays(0);
+	pool.ParallelFor(tilesPerRow * tilesPerRow, [&](unsigned int begin, unsigned int end) {
+		Tracer tracer{ bvh, settings.packets, 0 };
+		for (unsigned int tile = begin; tile < end; tile++)
+			bakeTile((int)tile, light, settings, tracer);
+		rays += tracer.rays;
+	});
+	dilate();
+
+	RaysTraced = rays;
+	BakeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+unsigned int LightmapBaker::CreateTexture() const
+{
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, Size, Size, 0, GL_RGBA, GL_FLOAT, texels.data());
+	/* No mipmaps, they would blend the charts across the gutters */
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	return texture;
+}
+
+inline const std::vector<glm::vec4>& LightmapBaker::Texels() const noexcept
+{
+	return texels;
+}
+
+void LightmapBaker::Tracer::Intersect(const Ray_packet& packet, Ray_hit hits[4])
+{
+	for (int lane = 0; lane < 4; lane++)
+		rays += (packet.activeMask >> lane) & 1;
+	if (packets) {
+		bvh.Intersect(packet, hits);
+		return;
+	}
+	for (int lane = 0; lane < 4; lane++) {
+		hits[lane] = Ray_hit{ -1, packet.maxDistance[lane], 0.0f, 0.0f };
+		if (packet.activeMask & (1 << lane))
+			bvh.Intersect(Ray{ glm::vec3(packet.originX[lane], packet.originY[lane], packet.originZ[lane]),
+				glm::vec3(packet.directionX[lane], packet.directionY[lane], packet.directionZ[lane]), packet.maxDistance[lane] }, hits[lane]);
+	}
+}
+
+int LightmapBaker::Tracer::Occluded(const Ray_packet& packet)
+{
+	for (int lane = 0; lane < 4; lane++)
+		rays += (packet.activeMask >> lane) & 1;
+	if (packets)
+		return bvh.Occluded(packet);
+	int occluded = 0;
+	for (int lane = 0; lane < 4; lane++)
+		if ((packet.activeMask & (1 << lane)) && bvh.Occluded(Ray{ glm::vec3(packet.originX[lane], packet.originY[lane], packet.originZ[lane]),
+			glm::vec3(packet.directionX[lane], packet.directionY[lane], packet.directionZ[lane]), packet.maxDistance[lane] }))
+			occluded |= 1 << lane;
+	return occluded;
+}
+
+void LightmapBaker::rasterize(const std::vector<Lightmap_vertex>& vertices)
+{
+	for (unsigned int triangle = 0; triangle + 2 < vertices.size(); triangle += 3) {
+		/* In texels, the center of texel (x, y) at (x + 0.5, y + 0.5) */
+		glm::vec2 a = vertices[triangle].lightmapCoords * (float)Size;
+		glm::vec2 b = vertices[triangle + 1].lightmapCoords * (float)Size;
+		glm::vec2 c = vertices[triangle + 2].lightmapCoords * (float)Size;
+		float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+		if (std::abs(area) < 1e-8f)
+			continue;
+
+		int minX = std::max(0, (int)std::floor(std::min(std::min(a.x, b.x), c.x)));
+		int maxX = std::min(Size - 1, (int)std::ceil(std::max(std::max(a.x, b.x), c.x)));
+		int minY = std::max(0, (int)std::floor(std::min(std::min(a.y, b.y), c.y)));
+		int maxY = std::min(Size - 1, (int)std::ceil(std::max(std::max(a.y, b.y), c.y)));
+		for (int y = minY; y <= maxY; y++)
+			for (int x = minX; x <= maxX; x++) {
+				glm::vec2 p(x + 0.5f, y + 0.5f);
+				/* Barycentric weights from the edge functions, a little slack so the shared edges leave no holes */
+				float wA = ((b.x - p.x) * (c.y - p.y) - (b.y - p.y) * (c.x - p.x)) / area;
+				float wB = ((c.x - p.x) * (a.y - p.y) - (c.y - p.y) * (a.x - p.x)) / area;
+				float wC = 1.0f - wA - wB;
+				if (wA < -1e-4f || wB < -1e-4f || wC < -1e-4f)
+					continue;
+
+				int texel = y * Size + x;
+				positions[texel] = wA * vertices[triangle].position + wB * vertices[triangle + 1].position + wC * vertices[triangle + 2].position;
+				normals[texel] = glm::normalize(wA * vertices[triangle].normal + wB * vertices[triangle + 1].normal + wC * vertices[triangle + 2].normal);
+				if (!covered[texel])
+					CoveredTexels++;
+				covered[texel] = 1;
+			}
+	}
+}
+
+void LightmapBaker::bakeTile(int tile, const Bake_light& light, const Bake_settings& settings, Tracer& tracer)
+{
+	int tilesPerRow = (Size + TileSize - 1) / TileSize;
+	int x0 = (tile % tilesPerRow) * TileSize, y0 = (tile / tilesPerRow) * TileSize;
+	int x1 = std::min(x0 + TileSize, Size), y1 = std::min(y0 + TileSize, Size);
+
+	for (int y = y0; y < y1; y++) {
+		/* Shadow rays of up to four covered texels of the row in one packet */
+		int lanes[4];
+		float cosines[4];
+		Ray_packet packet;
+		packet.activeMask = 0;
+		int laneCount = 0;
+		for (int x = x0; x <= x1; x++) {
+			if (x < x1) {
+				int texel = y * Size + x;
+				if (!covered[texel])
+					continue;
+				texels[texel] = glm::vec4(gather(texel, light, settings, tracer), 0.0f);
+
+				glm::vec3 origin = offset(positions[texel], normals[texel]);
+				glm::vec3 toLight = light.position - origin;
+				float distance = glm::length(toLight);
+				float cosine = glm::dot(normals[texel], toLight / distance);
+				/* Facing away, no direct light and no highlight */
+				if (cosine <= 0.0f)
+					continue;
+
+				lanes[laneCount] = texel;
+				cosines[laneCount] = cosine;
+				packet.originX[laneCount] = origin.x;
+				packet.originY[laneCount] = origin.y;
+				packet.originZ[laneCount] = origin.z;
+				packet.directionX[laneCount] = toLight.x / distance;
+				packet.directionY[laneCount] = toLight.y / distance;
+				packet.directionZ[laneCount] = toLight.z / distance;
+				packet.maxDistance[laneCount] = distance;
+				packet.activeMask |= 1 << laneCount;
+				laneCount++;
+			}
+			if (laneCount == 4 || (x == x1 && laneCount > 0)) {
+				int occluded = tracer.Occluded(packet);
+				for (int lane = 0; lane < laneCount; lane++)
+					if (!(occluded & (1 << lane)))
+						texels[lanes[lane]] += glm::vec4(light.diffuse * cosines[lane], 1.0f);
+				packet.activeMask = 0;
+				laneCount = 0;
+			}
+		}
+	}
+}
+
+glm::vec3 LightmapBaker::gather(int texel, const Bake_light& light, const Bake_settings& settings, Tracer& tracer) const
+{
+	/* Seeded by the texel, the result doesn't depend on the thread count */
+	unsigned int state = (0x9E3779B9u ^ (unsigned int)texel * 0x85EBCA6Bu) | 1u;
+	random(state);
+
+	const glm::vec3& normal = normals[texel];
+	glm::vec3 origin = offset(positions[texel], normal);
+	glm::vec3 irradiance(0.0f);
+	int packetCount = (settings.indirectSamples + 3) / 4;
+	for (int p = 0; p < packetCount; p++) {
+		glm::vec3 origins[4], bases[4], throughputs[4], radiance[4];
+		for (int lane = 0; lane < 4; lane++) {
+			origins[lane] = origin;
+			bases[lane] = normal;
+			throughputs[lane] = glm::vec3(1.0f);
+			radiance[lane] = glm::vec3(0.0f);
+		}
+		int active = 0xF;
+
+		for (int bounce = 0; bounce < settings.bounces && active; bounce++) {
+			/* Cosine weighted directions around the normals, the cosine and the 1 / pi of the diffuse
+			reflection cancel against the sample density */
+			Ray_packet packet;
+			packet.activeMask = active;
+			glm::vec3 directions[4];
+			for (int lane = 0; lane < 4; lane++) {
+				const glm::vec3& n = bases[lane];
+				glm::vec3 up = std::abs(n.y) > 0.99f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+				glm::vec3 tangent = glm::normalize(glm::cross(up, n)), bitangent = glm::cross(n, tangent);
+				float angle = 6.2831853f * random(state), radius2 = random(state), radius = std::sqrt(radius2);
+				directions[lane] = tangent * (radius * std::cos(angle)) + bitangent * (radius * std::sin(angle)) + n * std::sqrt(std::max(0.0f, 1.0f - radius2));
+				packet.originX[lane] = origins[lane].x;
+				packet.originY[lane] = origins[lane].y;
+				packet.originZ[lane] = origins[lane].z;
+				packet.directionX[lane] = directions[lane].x;
+				packet.directionY[lane] = directions[lane].y;
+				packet.directionZ[lane] = directions[lane].z;
+				packet.maxDistance[lane] = std::numeric_limits<float>::max();
+			}
+			Ray_hit hits[4];
+			tracer.Intersect(packet, hits);
+
+			/* Direct light at the hits */
+			Ray_packet shadow;
+			shadow.activeMask = 0;
+			float cosines[4] = {};
+			for (int lane = 0; lane < 4; lane++) {
+				if (!(active & (1 << lane)))
+					continue;
+				/* Nothing is lit outside the scene, and the back of a face is the inside of a closed box */
+				const Ray_hit& hit = hits[lane];
+				if (hit.triangle < 0 || glm::dot(faceNormals[hit.triangle], directions[lane]) > 0.0f) {
+					active &= ~(1 << lane);
+					continue;
+				}
+				const glm::vec3& hitNormal = faceNormals[hit.triangle];
+				throughputs[lane] *= albedos[hit.triangle];
+				origins[lane] = offset(origins[lane] + directions[lane] * hit.distance, hitNormal);
+				bases[lane] = hitNormal;
+
+				glm::vec3 toLight = light.position - origins[lane];
+				float distance = glm::length(toLight);
+				cosines[lane] = glm::dot(hitNormal, toLight / distance);
+				if (cosines[lane] <= 0.0f)
+					continue;
+				shadow.originX[lane] = origins[lane].x;
+				shadow.originY[lane] = origins[lane].y;
+				shadow.originZ[lane] = origins[lane].z;
+				shadow.directionX[lane] = toLight.x / distance;
+				shadow.directionY[lane] = toLight.y / distance;
+				shadow.directionZ[lane] = toLight.z / distance;
+				shadow.maxDistance[lane] = distance;
+				shadow.activeMask |= 1 << lane;
+			}
+			int occluded = tracer.Occluded(shadow);
+			for (int lane = 0; lane < 4; lane++)
+				if ((shadow.activeMask & ~occluded) & (1 << lane))
+					radiance[lane] += throughputs[lane] * light.diffuse * cosines[lane];
+		}
+
+		for (int lane = 0; lane < 4; lane++)
+			irradiance += radiance[lane];
+	}
+	return irradiance / (float)(4 * packetCount);
+}
+
+void LightmapBaker::dilate()
+{
+	std::vector<unsigned char> filled = covered;
+	for (int ring = 0; ring < Padding; ring++) {
+		std::vector<unsigned char> next = filled;
+		for (int y = 0; y < Size; y++)
+			for (int x = 0; x < Size; x++) {
+				if (filled[y * Size + x])
+					continue;
+				glm::vec4 sum(0.0f);
+				int count = 0;
+				for (int dy = -1; dy <= 1; dy++)
+					for (int dx = -1; dx <= 1; dx++) {
+						int nx = x + dx, ny = y + dy;
+						if (nx < 0 || ny < 0 || nx >= Size || ny >= Size || !filled[ny * Size + nx])
+							continue;
+						sum += texels[ny * Size + nx];
+						count++;
+					}
+				if (count > 0) {
+					texels[y * Size + x] = sum / (float)count;
+					next[y * Size + x] = 1;
+				}
+			}
+		filled.swap(next);
+	}
+}
+
+inline glm::vec3 LightmapBaker::offset(const glm::vec3& position, const glm::vec3& normal) noexcept
+{
+	return position + normal * 1e-3f;
+}
+
+inline float LightmapBaker::random(unsigned int& state) noexcept
+{
+	/* xorshift32, uniform in [0, 1) */
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return (state >> 8) * (1.0f / 16777216.0f);
+}
+
+#endif
@@ -0,0 +1,201 @@
+#ifndef LIGHTMAP_UNWRAP_H
+#define LIGHTMAP_UNWRAP_H
+
+#include <vector>
+#include <map>
+#include <array>
+#include <numeric>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "glm/glm.hpp"
+
+/* Vertex of the static scene in world space */
+struct Lightmap_vertex {
+	glm::vec3 position;
+	glm::vec3 normal;
+	glm::vec2 texCoords;
+	/* Second texture coordinates, a spot of its own in the lightmap for every surface point */
+	glm::vec2 lightmapCoords;
+};
+
+/* Automatic second UV set for lightmaps.
+Triangles that share an edge and lie in one plane form a chart. Every chart is projected onto its
+plane, so it keeps its shape and size, and the charts are packed on shelves into the square
+lightmap with a gutter of Padding texels around each, which keeps bilinear filtering from
+blending two charts. The texel density is the same for all charts, the highest one that fits */
+class LightmapUnwrap
+{
+public:
+	/* Constructor */
+	LightmapUnwrap(int size, int padding);
+
+	/* Fill in the lightmapCoords of the triangle list, false if the charts don't fit at any density */
+	bool Unwrap(std::vector<Lightmap_vertex>& vertices);
+
+public:
+	const int Size;
+	const int Padding;
+	/* Results of the last Unwrap() */
+	float TexelsPerUnit;
+	unsigned int Charts;
+
+private:
+	struct Chart {
+		std::vector<unsigned int> triangles;
+		/* Plane axes */
+		glm::vec3 tangent, bitangent;
+		glm::vec2 min, max;
+		/* Lower left texel of the rectangle in the lightmap, gutter included */
+		int x, y;
+	};
+
+	/* Helper functions */
+	/* Triangles connected over edges within one plane, with union find */
+	std::vector<Chart> findCharts(const std::vector<Lightmap_vertex>& vertices) const;
+	/* Place the chart rectangles on shelves at the density, false if they overflow the lightmap */
+	bool pack(std::vector<Chart>& charts, float texelsPerUnit) const;
+	int texels(float extent, float texelsPerUnit) const;
+};
+
+
+LightmapUnwrap::LightmapUnwrap(int size, int padding = 2) : Size(size), Padding(padding), TexelsPerUnit(0.0f), Charts(0)
+{
+}
+
+bool LightmapUnwrap::Unwrap(std::vector<Lightmap_vertex>& vertices)
+{
+	std::vector<Chart> charts = findCharts(vertices);
+	Charts = (unsigned int)charts.size();
+
+	/* Packing gets harder with the density, search the highest that fits. The total chart area
+	filling the whole lightmap is the upper bound */
+	float area = 0.0f;
+	for (const Chart& chart : charts)
+		area += (chart.max.x - chart.min.x) * (chart.max.y - chart.min.y);
+	float low = 0.0f, high = area > 0.0f ? Size / std::sqrt(area) : (float)Size;
+	for (int step = 0; step < 24; step++) {
+		float middle = (low + high) * 0.5f;
+		if (pack(charts, middle))
+			low = middle;
+		else
+			high = middle;
+	}
+	TexelsPerUnit = low;
+	if (TexelsPerUnit <= 0.0f || !pack(charts, TexelsPerUnit))
+		return false;
+
+	for (const Chart& chart : charts)
+		for (unsigned int triangle : chart.triangles)
+			for (unsigned int i = 3 * triangle; i < 3 * triangle + 3; i++) {
+				glm::vec2 planar(glm::dot(vertices[i].position, chart.tangent), glm::dot(vertices[i].position, chart.bitangent));
+				glm::vec2 texel = glm::vec2(chart.x + Padding, chart.y + Padding) + (planar - chart.min) * TexelsPerUnit;
+				vertices[i].lightmapCoords = texel / (float)Size;
+			}
+	return true;
+}
+
+std::vector<LightmapUnwrap::Chart> LightmapUnwrap::findCharts(const std::vector<Lightmap_vertex>& vertices) const
+{
+	unsigned int triangleCount = (unsigned int)(vertices.size() / 3);
+	std::vector<glm::vec3> faceNormals;
+	for (unsigned int i = 0; i < triangleCount; i++) {
+		glm::vec3 normal = glm::cross(vertices[3 * i + 1].position - vertices[3 * i].position, vertices[3 * i + 2].position - vertices[3 * i].position);
+		float length = glm::length(normal);
+		faceNormals.push_back(length > 0.0f ? normal / length : vertices[3 * i].normal);
+	}
+
+	std::vector<unsigned int> parent(triangleCount);
+	std::iota(parent.begin(), parent.end(), 0u);
+	auto root = [&parent](unsigned int triangle) {
+		while (parent[triangle] != triangle)
+			triangle = parent[triangle] = parent[parent[triangle]];
+		return triangle;
+	};
+
+	/* Edges by their corners, rounded so the copies of a corner in the triangle list match */
+	typedef std::array<long long, 3> Corner;
+	std::map<std::pair<Corner, Corner>, std::vector<unsigned int>> edges;
+	auto corner = [&vertices](unsigned int vertex) {
+		const glm::vec3& position = vertices[vertex].position;
+		return Corner{ std::llround(position.x * 1e4), std::llround(position.y * 1e4), std::llround(position.z * 1e4) };
+	};
+	for (unsigned int i = 0; i < triangleCount; i++)
+		for (unsigned int edge = 0; edge < 3; edge++) {
+			Corner a = corner(3 * i + edge), b = corner(3 * i + (edge + 1) % 3);
+			edges[std::minmax(a, b)].push_back(i);
+		}
+	for (const auto& edge : edges)
+		for (unsigned int j = 1; j < edge.second.size(); j++) {
+			unsigned int a = edge.second[0], b = edge.second[j];
+			if (glm::dot(faceNormals[a], faceNormals[b]) > 0.999f)
+				parent[root(a)] = root(b);
+		}
+
+	std::vector<Chart> charts;
+	std::vector<int> chartOfRoot(triangleCount, -1);
+	for (unsigned int i = 0; i < triangleCount; i++) {
+		unsigned int r = root(i);
+		if (chartOfRoot[r] < 0) {
+			chartOfRoot[r] = (int)charts.size();
+			Chart chart;
+			glm::vec3 normal = faceNormals[r];
+			/* Any axis that isn't parallel to the plane normal */
+			glm::vec3 up = std::abs(normal.y) > 0.99f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+			chart.tangent = glm::normalize(glm::cross(up, normal));
+			chart.bitangent = glm::cross(normal, chart.tangent);
+			chart.min = glm::vec2(std::numeric_limits<float>::max());
+			chart.max = glm::vec2(-std::numeric_limits<float>::max());
+			chart.x = chart.y = 0;
+			charts.push_back(chart);
+		}
+		Chart& chart = charts[chartOfRoot[r]];
+		chart.triangles.push_back(i);
+		for (unsigned int vertex = 3 * i; vertex < 3 * i + 3; vertex++) {
+			glm::vec2 planar(glm::dot(vertices[vertex].position, chart.tangent), glm::dot(vertices[vertex].position, chart.bitangent));
+			chart.min = glm::min(chart.min, planar);
+			chart.max = glm::max(chart.max, planar);
+		}
+	}
+	return charts;
+}
+
+bool LightmapUnwrap::pack(std::vector<Chart>& charts, float texelsPerUnit) const
+{
+	/* Tallest first, the shelves then waste little height */
+	std::vector<unsigned int> order(charts.size());
+	std::iota(order.begin(), order.end(), 0u);
+	std::stable_sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b) {
+		return charts[a].max.y - charts[a].min.y > charts[b].max.y - charts[b].min.y;
+	});
+
+	int x = 0, shelfY = 0, shelfHeight = 0;
+	for (unsigned int i : order) {
+		Chart& chart = charts[i];
+		int width = texels(chart.max.x - chart.min.x, texelsPerUnit);
+		int height = texels(chart.max.y - chart.min.y, texelsPerUnit);
+		if (width > Size)
+			return false;
+		if (x + width > Size) {
+			x = 0;
+			shelfY += shelfHeight;
+			shelfHeight = 0;
+		}
+		if (shelfY + height > Size)
+			return false;
+		chart.x = x;
+		chart.y = shelfY;
+		x += width;
+		shelfHeight = std::max(shelfHeight, height);
+	}
+	return true;
+}
+
+inline int LightmapUnwrap::texels(float extent, float texelsPerUnit) const
+{
+	/* The texel centers on the border of the chart still lie inside */
+	return (int)std::ceil(extent * texelsPerUnit) + 1 + 2 * Padding;
+}
+
+#endif
@@ -0,0 +1,489 @@
+#include "glad/glad.h"
+#include "GLFW/glfw3.h"
+
+#include "stb_image.h"
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+#include "Shader.h"
+#include "Camera.h"
+#include "GpuTimer.h"
+#include "ThreadPool.h"
+#include "LightmapUnwrap.h"
+#include "LightmapBaker.h"
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <cmath>
+#include <algorithm>
+
+
+void processInput(GLFWwindow* window);
+void frameBufferResize_callback(GLFWwindow* window, int width, int height);
+void mouseMovement_callback(GLFWwindow* window, double xPos, double yPos);
+void mouseScroll_callback(GLFWwindow* window, double xOffset, double yOffset);
+void keyPress_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+
+unsigned int loadTexture(const char* path);
+glm::vec3 averageColor(const char* path);
+void appendBox(std::vector<Lightmap_vertex>& vertices, const float* cubeVertices, const glm::mat4& model, bool tiled);
+
+
+const int winWidth = 800;
+const int winHeight = 600;
+
+/************************************ CAMERA ************************************/
+Camera camera({ 0.0f, 0.5f, 4.0f });
+
+float lastX = winWidth / 2;
+float lastY = winHeight / 2;
+bool firstMouseMove = true;
+
+/************************************ FRAMES ************************************/
+float deltaTime = 0.0f;
+float lastFrame = 0.0f;
+
+/************************************ LIGHTING ************************************/
+glm::vec3 lightPos(1.2f, 1.0f, 2.0f);
+/* B switches between the baked lighting and the per fragment lighting of the other demos */
+bool bakedLighting = true;
+/* L shows the lightmap alone */
+bool showLightmap = false;
+
+/************************************ LIGHTMAP ************************************/
+const int lightmapSize = 256;
+/* Gutter texels around every chart */
+const int lightmapPadding = 2;
+/* The bake at startup */
+Bake_settings bakeSettings;
+/* Bake time over the thread counts, with fewer samples to keep the startup short */
+const bool measureBakeScaling = true;
+const int scalingSamples = 16;
+
+
+int main()
+{
+	/************************************ INITIALIZATION ************************************/
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+	GLFWwindow* window = glfwCreateWindow(winWidth, winHeight, "Lightmap baking", NULL, NULL);
+	if (window == NULL) {
+		std::cout << "ERROR::GLFW::INITIALIZATION_FAILED" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		std::cout << "ERROR::GLAD::INITIALIZATION_FAILED" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glViewport(0, 0, winWidth, winHeight);
+	/* Measure the shading, not the display refresh */
+	glfwSwapInterval(0);
+
+	glfwSetFramebufferSizeCallback(window, frameBufferResize_callback);
+	glfwSetCursorPosCallback(window, mouseMovement_callback);
+	glfwSetScrollCallback(window, mouseScroll_callback);
+	glfwSetKeyCallback(window, keyPress_callback);
+
+	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+	/************************************ POSITIONS ************************************/
+	float cubeVertices[] = {
+		/*	  Positions			Normals		  TextureCoords	*/
+		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
+
+		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
+
+		-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+		-0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
+		-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
+		-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+
+		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+
+		-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  1.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  0.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
+
+		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  1.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  0.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f
+	};
+
+	/************************************ OBJECTS ************************************/
+	/* A room of floor and three walls around the crates, the light of the other demos inside */
+	const unsigned int roomPieces = 4;
+	std::vector<glm::vec3> cubePositions = {
+		glm::vec3(0.0f, -0.6f, 0.0f),
+		glm::vec3(0.0f, 1.4f, -5.1f),
+		glm::vec3(-5.1f, 1.4f, 0.0f),
+		glm::vec3(5.1f, 1.4f, -2.5f),
+		glm::vec3(0.0f, 0.0f, 0.0f),
+		glm::vec3(-2.0f, 0.25f, -1.5f),
+		glm::vec3(-2.0f, 1.5f, -1.5f),
+		glm::vec3(2.6f, 0.0f, -1.8f),
+		glm::vec3(-1.2f, -0.2f, 2.0f),
+		glm::vec3(0.8f, -0.25f, -3.2f),
+		glm::vec3(3.4f, 0.5f, 1.0f)
+	};
+	std::vector<glm::vec3> cubeSizes = {
+		glm::vec3(10.0f, 0.2f, 10.0f),
+		glm::vec3(10.0f, 4.0f, 0.2f),
+		glm::vec3(0.2f, 4.0f, 10.0f),
+		glm::vec3(0.2f, 4.0f, 5.0f),
+		glm::vec3(1.0f),
+		glm::vec3(1.5f),
+		glm::vec3(1.0f),
+		glm::vec3(1.0f),
+		glm::vec3(0.6f),
+		glm::vec3(0.5f),
+		glm::vec3(1.0f, 2.0f, 1.0f)
+	};
+	std::vector<float> cubeAngles = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 20.0f, 55.0f, 45.0f, 10.0f, 30.0f, 0.0f };
+
+	/* Static batch, the whole scene in world space in one buffer */
+	std::vector<Lightmap_vertex> sceneVertices;
+	for (unsigned int i = 0; i < cubePositions.size(); i++) {
+		glm::mat4 model = glm::translate(glm::mat4(1.0f), cubePositions[i]);
+		model = glm::rotate(model, glm::radians(cubeAngles[i]), glm::vec3(0.0f, 1.0f, 0.0f));
+		model = glm::scale(model, cubeSizes[i]);
+		appendBox(sceneVertices, cubeVertices, model, i < roomPieces);
+	}
+	/* Everything is made of crate wood, the bounces reflect its average color */
+	std::vector<glm::vec3> albedos(sceneVertices.size() / 3, averageColor("textures/container2.png"));
+
+	/************************************ LIGHTMAP ************************************/
+	LightmapUnwrap unwrap(lightmapSize, lightmapPadding);
+	if (!unwrap.Unwrap(sceneVertices))
+		std::cout << "ERROR::LIGHTMAP::CHARTS_DO_NOT_FIT" << std::endl;
+	LightmapBaker baker(sceneVertices, albedos, lightmapSize, lightmapPadding);
+	std::cout << sceneVertices.size() / 3 << " triangles in " << unwrap.Charts << " charts, " << unwrap.TexelsPerUnit << " texels per unit, "
+		<< baker.CoveredTexels << " of " << lightmapSize * lightmapSize << " texels covered" << std::endl;
+
+	/* The render loop waits for the bake, every core may trace */
+	unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+	Bake_light bakeLight{ lightPos, glm::vec3(0.5f) };
+	if (measureBakeScaling) {
+		Bake_settings scaling = bakeSettings;
+		scaling.indirectSamples = scalingSamples;
+		std::cout << "Bake time with " << scalingSamples << " samples per texel:" << std::endl;
+		double singleThreadMs = 0.0;
+		for (unsigned int threads = 1; ; threads = std::min(threads * 2, cores)) {
+			ThreadPool pool(threads);
+			baker.Bake(bakeLight, scaling, pool);
+			if (threads == 1)
+				singleThreadMs = baker.BakeMs;
+			std::cout << "  " << threads << " threads: " << baker.BakeMs << " ms, " << singleThreadMs / baker.BakeMs << "x, "
+				<< baker.RaysTraced / (baker.BakeMs * 1000.0) << " Mrays/s" << std::endl;
+			if (threads == cores)
+				break;
+		}
+
+		/* Packets against the same rays one by one */
+		ThreadPool pool(cores);
+		scaling.packets = false;
+		baker.Bake(bakeLight, scaling, pool);
+		std::cout << "  " << cores << " threads, single rays: " << baker.BakeMs << " ms, "
+			<< baker.RaysTraced / (baker.BakeMs * 1000.0) << " Mrays/s" << std::endl;
+	}
+	{
+		ThreadPool pool(cores);
+		baker.Bake(bakeLight, bakeSettings, pool);
+	}
+	std::cout << "Baked " << bakeSettings.indirectSamples << " samples per texel, " << bakeSettings.bounces << " bounces in "
+		<< baker.BakeMs << " ms on " << cores << " threads, " << baker.RaysTraced / 1000000.0 << " million rays" << std::endl;
+	unsigned int lightmap = baker.CreateTexture();
+
+	/************************************ BUFFERS ************************************/
+	unsigned int sceneVBO, sceneVAO;
+	glGenVertexArrays(1, &sceneVAO);
+	glGenBuffers(1, &sceneVBO);
+
+	glBindVertexArray(sceneVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, sceneVBO);
+	glBufferData(GL_ARRAY_BUFFER, sceneVertices.size() * sizeof(Lightmap_vertex), sceneVertices.data(), GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Lightmap_vertex), (void*)offsetof(Lightmap_vertex, position));
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Lightmap_vertex), (void*)offsetof(Lightmap_vertex, normal));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Lightmap_vertex), (void*)offsetof(Lightmap_vertex, texCoords));
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(Lightmap_vertex), (void*)offsetof(Lightmap_vertex, lightmapCoords));
+	glEnableVertexAttribArray(3);
+
+	/* The light cube */
+	unsigned int cubeVBO, lightVAO;
+	glGenVertexArrays(1, &lightVAO);
+	glGenBuffers(1, &cubeVBO);
+
+	glBindVertexArray(lightVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), cubeVertices, GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	/************************************ TEXTURES ************************************/
+	unsigned int diffuseMap = loadTexture("textures/container2.png");
+	unsigned int specularMap = loadTexture("textures/container2_specular.png");
+
+	/************************************ SHADERS ************************************/
+	Shader lightingShader("shaders/shader.vs", "shaders/shader.fs");
+	Shader bakedShader("shaders/shader.vs", "shaders/shaderBaked.fs");
+	Shader lightCubeShader("shaders/lightCube.vs", "shaders/lightCube.fs");
+	for (Shader* shader : { &lightingShader, &bakedShader }) {
+		shader->use();
+		shader->setInt("material.diffuse", 0);
+		shader->setInt("material.specular", 1);
+		shader->setFloat("material.shininess", 32.0f);
+		shader->setVec3("light.position", lightPos);
+		shader->setVec3("light.ambient", 0.2f, 0.2f, 0.2f);
+		shader->setVec3("light.diffuse", bakeLight.diffuse);
+		shader->setVec3("light.specular", 1.0f, 1.0f, 1.0f);
+	}
+	bakedShader.use();
+	bakedShader.setInt("lightmap", 2);
+
+	/************************************ RENDER LOOP ************************************/
+	glEnable(GL_DEPTH_TEST);
+	std::cout << "B switches between baked and per fragment lighting, L shows the lightmap" << std::endl;
+
+	GpuTimer sceneTimer;
+	bool measuredBaked = bakedLighting;
+	unsigned int measuredFrames = 0;
+	double measureStart = glfwGetTime();
+	lastFrame = glfwGetTime();
+	while (!glfwWindowShouldClose(window)) {
+		float currentFrame = glfwGetTime();
+		deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+
+		processInput(window);
+
+		int width, height;
+		glfwGetFramebufferSize(window, &width, &height);
+		glm::mat4 view = camera.GetViewMatrix();
+		glm::mat4 projection = camera.GetProjectionMatrix((float)width / std::max(height, 1));
+
+		glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		/* Scene */
+		Shader& shader = bakedLighting ? bakedShader : lightingShader;
+		shader.use();
+		shader.setMat4f("view", view);
+		shader.setMat4f("projection", projection);
+		shader.setVec3("viewPos", camera.Position);
+		if (bakedLighting)
+			shader.setBool("showLightmap", showLightmap);
+
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, diffuseMap);
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, specularMap);
+		glActiveTexture(GL_TEXTURE2);
+		glBindTexture(GL_TEXTURE_2D, lightmap);
+
+		sceneTimer.Begin();
+		glBindVertexArray(sceneVAO);
+		glDrawArrays(GL_TRIANGLES, 0, (GLsizei)sceneVertices.size());
+		sceneTimer.End();
+
+		/* Light cube */
+		lightCubeShader.use();
+		lightCubeShader.setMat4f("projection", projection);
+		lightCubeShader.setMat4f("view", view);
+		glm::mat4 model = glm::mat4(1.0f);
+		model = glm::translate(model, lightPos);
+		model = glm::scale(model, glm::vec3(0.2f)); // Make the cube smaller
+		lightCubeShader.setMat4f("model", model);
+		glBindVertexArray(lightVAO);
+		glDrawArrays(GL_TRIANGLES, 0, 36);
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+
+		/* Averages over two seconds, restarted when the lighting is switched */
+		measuredFrames++;
+		double measured = glfwGetTime() - measureStart;
+		if (measuredBaked != bakedLighting || measured >= 2.0) {
+			if (measuredBaked == bakedLighting)
+				std::cout << (bakedLighting ? "Baked" : "Per fragment") << " lighting: " << measured * 1000.0 / measuredFrames << " ms per frame, "
+					<< sceneTimer.AverageMs() << " ms GPU for the scene" << std::endl;
+			measuredBaked = bakedLighting;
+			measuredFrames = 0;
+			sceneTimer.Reset();
+			measureStart = glfwGetTime();
+		}
+	}
+
+	glDeleteVertexArrays(1, &sceneVAO);
+	glDeleteVertexArrays(1, &lightVAO);
+	glDeleteBuffers(1, &sceneVBO);
+	glDeleteBuffers(1, &cubeVBO);
+	glDeleteTextures(1, &diffuseMap);
+	glDeleteTextures(1, &specularMap);
+	glDeleteTextures(1, &lightmap);
+	glfwTerminate();
+}
+
+
+void processInput(GLFWwindow* window)
+{
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, true);
+	if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
+		deltaTime *= 2;
+	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::FORWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::BACKWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::LEFT, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::RIGHT, deltaTime);
+}
+
+void keyPress_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	if (action != GLFW_PRESS)
+		return;
+	if (key == GLFW_KEY_B)
+		bakedLighting = !bakedLighting;
+	else if (key == GLFW_KEY_L)
+		showLightmap = !showLightmap;
+}
+
+void frameBufferResize_callback(GLFWwindow* window, int width, int height)
+{
+	glViewport(0, 0, width, height);
+}
+
+void mouseMovement_callback(GLFWwindow* window, double xPos, double yPos)
+{
+	if (firstMouseMove) {
+		lastX = xPos;
+		lastY = yPos;
+		firstMouseMove = false;
+	}
+
+	float xOffset = (float)xPos - lastX;
+	float yOffset = lastY - (float)yPos;
+	lastX = xPos;
+	lastY = yPos;
+
+	camera.ProcessMouseMovement(xOffset, yOffset);
+}
+
+void mouseScroll_callback(GLFWwindow* window, double xOffset, double yOffset)
+{
+	camera.ProcessMouseScroll(yOffset);
+}
+
+unsigned int loadTexture(const char* path)
+{
+	unsigned int textureID;
+	glGenTextures(1, &textureID);
+
+	int width, height, nrComponents;
+	unsigned char* data = stbi_load(path, &width, &height, &nrComponents, 0);
+	if (data) {
+		/* See which color format the texture uses */
+		GLenum format;
+		if (nrComponents == 1)
+			format = GL_RED;
+		else if (nrComponents == 3)
+			format = GL_RGB;
+		else if (nrComponents == 4)
+			format = GL_RGBA;
+
+		glBindTexture(GL_TEXTURE_2D, textureID);
+		glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+		glGenerateMipmap(GL_TEXTURE_2D);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	}
+	else
+		std::cout << "Texture failed to load at path: " << path << std::endl;
+	stbi_image_free(data);
+
+	return textureID;
+}
+
+glm::vec3 averageColor(const char* path)
+{
+	int width, height, nrComponents;
+	unsigned char* data = stbi_load(path, &width, &height, &nrComponents, 3);
+	if (!data) {
+		std::cout << "Texture failed to load at path: " << path << std::endl;
+		return glm::vec3(0.5f);
+	}
+
+	double sum[3] = {};
+	for (int i = 0; i < width * height; i++)
+		for (int channel = 0; channel < 3; channel++)
+			sum[channel] += data[3 * i + channel];
+	stbi_image_free(data);
+	double scale = 1.0 / (255.0 * width * height);
+	return glm::vec3((float)(sum[0] * scale), (float)(sum[1] * scale), (float)(sum[2] * scale));
+}
+
+void appendBox(std::vector<Lightmap_vertex>& vertices, const float* cubeVertices, const glm::mat4& model, bool tiled)
+{
+	glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
+	for (int i = 0; i < 36; i++) {
+		const float* vertex = cubeVertices + 8 * i;
+		Lightmap_vertex result;
+		result.position = glm::vec3(model * glm::vec4(vertex[0], vertex[1], vertex[2], 1.0f));
+		result.normal = glm::normalize(normalMatrix * glm::vec3(vertex[3], vertex[4], vertex[5]));
+		result.texCoords = glm::vec2(vertex[6], vertex[7]);
+		if (tiled) {
+			/* The texture once per world unit over the face instead of stretched across it */
+			glm::vec3 n = glm::abs(result.normal);
+			if (n.x >= n.y && n.x >= n.z)
+				result.texCoords = glm::vec2(result.position.z, result.position.y);
+			else if (n.y >= n.z)
+				result.texCoords = glm::vec2(result.position.x, result.position.z);
+			else
+				result.texCoords = glm::vec2(result.position.x, result.position.y);
+		}
+		result.lightmapCoords = glm::vec2(0.0f);
+		vertices.push_back(result);
+	}
+}
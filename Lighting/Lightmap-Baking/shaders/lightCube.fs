@@ -0,0 +1,7 @@
+#version 330 core
+out vec4 fragColor;
+
+void main()
+{
+  fragColor = vec4(1.0);
+}
\ No newline at end of file
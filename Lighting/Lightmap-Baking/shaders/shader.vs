@@ -0,0 +1,23 @@
+#version 330 core
+layout (location = 0) in vec3 aPosition;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+layout (location = 3) in vec2 aLightmapCoords;
+
+out vec3 Normal;
+out vec3 fragPos;
+out vec2 texCoords;
+out vec2 lightmapCoords;
+
+// The static scene is in world space already
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+  gl_Position = projection * view * vec4(aPosition, 1.0f);
+  Normal = aNormal;
+  fragPos = aPosition;
+  texCoords = aTexCoords;
+  lightmapCoords = aLightmapCoords;
+}
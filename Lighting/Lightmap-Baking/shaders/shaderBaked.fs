@@ -0,0 +1,51 @@
+#version 330 core
+
+struct Material {
+  sampler2D diffuse;
+  sampler2D specular;
+  float shininess;
+};
+
+struct Light {
+  vec3 position;
+
+  vec3 ambient;
+  vec3 specular;
+};
+
+out vec4 fragColor;
+
+in vec3 Normal;
+in vec3 fragPos;
+in vec2 texCoords;
+in vec2 lightmapCoords;
+
+uniform vec3 viewPos;
+uniform Material material;
+uniform Light light;
+// Diffuse irradiance in rgb, direct and bounced, and the visibility of the light in a
+uniform sampler2D lightmap;
+uniform bool showLightmap;
+
+void main()
+{
+  vec4 baked = texture(lightmap, lightmapCoords);
+  if (showLightmap) {
+    fragColor = vec4(baked.rgb, 1.0);
+    return;
+  }
+
+  // ambient and diffuse from the lightmap
+  vec3 albedo = vec3(texture(material.diffuse, texCoords));
+  vec3 diffuse = (light.ambient + baked.rgb) * albedo;
+
+  // specular stays dynamic, it depends on the view, but the shadows come from the lightmap
+  vec3 norm = normalize(Normal);
+  vec3 lightDir = normalize(light.position - fragPos);
+  vec3 viewDir = normalize(viewPos - fragPos);
+  vec3 reflectDir = reflect(-lightDir, norm);
+  float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+  vec3 specular = light.specular * (spec * baked.a * vec3(texture(material.specular, texCoords)));
+
+  fragColor = vec4(diffuse + specular, 1.0);
+}
@@ -0,0 +1,584 @@
+#include "glad/glad.h"
+#include "GLFW/glfw3.h"
+
+#include "stb_image.h"
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+#include "Shader.h"
+#include "Camera.h"
+#include "LightSystem.h"
+#include "GpuTimer.h"
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+
+/* Order the boxes are drawn in, it decides how many fragments early depth testing rejects */
+enum class Draw_order {
+	/* Farthest rows first, the floor before all */
+	AS_CREATED,
+	FRONT_TO_BACK,
+	BACK_TO_FRONT
+};
+
+/* Circle a light moves on */
+struct Light_motion {
+	glm::vec3 center;
+	float radius;
+	/* Radians per second */
+	float speed;
+	float phase;
+};
+
+/* Per instance data of the light cubes */
+struct Light_marker {
+	glm::vec3 position;
+	glm::vec3 color;
+};
+
+void processInput(GLFWwindow* window);
+void frameBufferResize_callback(GLFWwindow* window, int width, int height);
+void mouseMovement_callback(GLFWwindow* window, double xPos, double yPos);
+void mouseScroll_callback(GLFWwindow* window, double xOffset, double yOffset);
+void keyPress_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+
+unsigned int loadTexture(const char* path);
+void moveLights(LightSystem& lights, const std::vector<Light_motion>& motions, float time);
+void sortBoxes(std::vector<glm::mat4>& boxes, const glm::vec3& viewPos, Draw_order order);
+const char* orderName(Draw_order order);
+
+
+const int winWidth = 800;
+const int winHeight = 600;
+
+/************************************ CAMERA ************************************/
+Camera camera({ 0.0f, 12.0f, 40.0f });
+
+float lastX = winWidth / 2;
+float lastY = winHeight / 2;
+bool firstMouseMove = true;
+
+/************************************ FRAMES ************************************/
+float deltaTime = 0.0f;
+float lastFrame = 0.0f;
+
+/************************************ LIGHTING ************************************/
+/* The stress scene, a directional light and point and spot lights circling over the boxes */
+const unsigned int lightCount = LightSystem::MaxLights;
+/* Every fourth moving light is a spot */
+const unsigned int spotEvery = 4;
+const float lightRange = 8.0f;
+/* Paused with space, the lights are uploaded only while they move */
+bool lightsAnimating = true;
+float lightTime = 0.0f;
+
+/************************************ SCENE ************************************/
+const int gridSize = 24;
+const float gridSpacing = 2.6f;
+
+/************************************ OVERDRAW ************************************/
+/* P toggles a depth only pass before the color pass, which then shades only the visible fragment of each pixel */
+bool depthPrepass = false;
+/* O cycles through the orders */
+Draw_order drawOrder = Draw_order::AS_CREATED;
+/* V shows how often each pixel is shaded instead of the lighting */
+bool showOverdraw = false;
+
+
+int main()
+{
+	/************************************ INITIALIZATION ************************************/
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+	GLFWwindow* window = glfwCreateWindow(winWidth, winHeight, "Many lights", NULL, NULL);
+	if (window == NULL) {
+		std::cout << "ERROR::GLFW::INITIALIZATION_FAILED" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		std::cout << "ERROR::GLAD::INITIALIZATION_FAILED" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glViewport(0, 0, winWidth, winHeight);
+	/* Measure the lighting, not the display refresh */
+	glfwSwapInterval(0);
+
+	glfwSetFramebufferSizeCallback(window, frameBufferResize_callback);
+	glfwSetCursorPosCallback(window, mouseMovement_callback);
+	glfwSetScrollCallback(window, mouseScroll_callback);
+	glfwSetKeyCallback(window, keyPress_callback);
+
+	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+	/************************************ POSITIONS ************************************/
+	float cubeVertices[] = {
+		/*	  Positions			Normals		  TextureCoords	*/
+		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
+
+		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
+
+		-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+		-0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
+		-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
+		-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+
+		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+
+		-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  1.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  0.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
+
+		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  1.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  0.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f
+	};
+
+	/************************************ OBJECTS ************************************/
+	/* A floor and a grid of boxes of random height */
+	std::vector<glm::mat4> boxes;
+	float extent = gridSize * gridSpacing;
+	boxes.push_back(glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -0.25f, 0.0f)), glm::vec3(extent, 0.5f, extent)));
+	std::mt19937 random(11);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	for (int z = 0; z < gridSize; z++) {
+		for (int x = 0; x < gridSize; x++) {
+			float height = 0.5f + 2.5f * unit(random);
+			glm::vec3 position((x - (gridSize - 1) / 2.0f) * gridSpacing, height / 2.0f, (z - (gridSize - 1) / 2.0f) * gridSpacing);
+			boxes.push_back(glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(1.0f, height, 1.0f)));
+		}
+	}
+
+	/************************************ BUFFERS ************************************/
+	unsigned int cubeVAO, VBO, boxVBO;
+	glGenVertexArrays(1, &cubeVAO);
+	glGenBuffers(1, &VBO);
+	glGenBuffers(1, &boxVBO);
+
+	glBindVertexArray(cubeVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), cubeVertices, GL_STATIC_DRAW);
+
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+	glEnableVertexAttribArray(2);
+
+	/* Model matrix per instance as 4 column attributes */
+	glBindBuffer(GL_ARRAY_BUFFER, boxVBO);
+	glBufferData(GL_ARRAY_BUFFER, boxes.size() * sizeof(glm::mat4), boxes.data(), GL_DYNAMIC_DRAW);
+	for (unsigned int column = 0; column < 4; column++) {
+		glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(column * sizeof(glm::vec4)));
+		glEnableVertexAttribArray(3 + column);
+		glVertexAttribDivisor(3 + column, 1);
+	}
+
+	/* The depth pre-pass only needs the positions, tightly packed they take 12 instead of 32 bytes per vertex */
+	std::vector<glm::vec3> cubePositions;
+	for (size_t i = 0; i < sizeof(cubeVertices) / sizeof(float); i += 8)
+		cubePositions.push_back(glm::vec3(cubeVertices[i], cubeVertices[i + 1], cubeVertices[i + 2]));
+	unsigned int depthVAO, positionVBO;
+	glGenVertexArrays(1, &depthVAO);
+	glGenBuffers(1, &positionVBO);
+
+	glBindVertexArray(depthVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, positionVBO);
+	glBufferData(GL_ARRAY_BUFFER, cubePositions.size() * sizeof(glm::vec3), cubePositions.data(), GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+	glEnableVertexAttribArray(0);
+
+	glBindBuffer(GL_ARRAY_BUFFER, boxVBO);
+	for (unsigned int column = 0; column < 4; column++) {
+		glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(column * sizeof(glm::vec4)));
+		glEnableVertexAttribArray(3 + column);
+		glVertexAttribDivisor(3 + column, 1);
+	}
+
+	/* The light cubes share the vertices, position and color come per instance */
+	unsigned int lightVAO, markerVBO;
+	glGenVertexArrays(1, &lightVAO);
+	glGenBuffers(1, &markerVBO);
+
+	glBindVertexArray(lightVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+
+	glBindBuffer(GL_ARRAY_BUFFER, markerVBO);
+	glBufferData(GL_ARRAY_BUFFER, lightCount * sizeof(Light_marker), NULL, GL_DYNAMIC_DRAW);
+	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Light_marker), (void*)0);
+	glEnableVertexAttribArray(3);
+	glVertexAttribDivisor(3, 1);
+	glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Light_marker), (void*)sizeof(glm::vec3));
+	glEnableVertexAttribArray(4);
+	glVertexAttribDivisor(4, 1);
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	/************************************ LIGHTS ************************************/
+	LightSystem lights;
+	/* A dim moon, its direction circles slowly */
+	lights.Add(Light{ Light_type::DIRECTIONAL, glm::vec3(0.0f), glm::vec3(-0.3f, -1.0f, -0.5f), glm::vec3(0.08f, 0.08f, 0.12f), 0.0f, 0.0f, 0.0f });
+
+	std::vector<Light_motion> motions(1, Light_motion{ glm::vec3(0.0f), 0.0f, 0.05f, 0.0f });
+	for (unsigned int i = 1; i < lightCount; i++) {
+		/* Bright saturated colors, the scene has little ambient */
+		float hue = unit(random) * 6.28f;
+		glm::vec3 color = glm::vec3(0.5f) + 0.5f * glm::vec3(std::cos(hue), std::cos(hue + 2.09f), std::cos(hue + 4.19f));
+		bool spot = i % spotEvery == 0;
+		Light light{ spot ? Light_type::SPOT : Light_type::POINT, glm::vec3(0.0f), glm::vec3(0.0f, -1.0f, 0.0f),
+			color * (spot ? 40.0f : 12.0f), lightRange, 20.0f, 30.0f };
+		lights.Add(light);
+
+		glm::vec3 center((unit(random) - 0.5f) * extent, (spot ? 5.0f : 1.5f) + unit(random) * 2.0f, (unit(random) - 0.5f) * extent);
+		motions.push_back(Light_motion{ center, 1.0f + unit(random) * 4.0f, (unit(random) - 0.5f) * 2.0f, unit(random) * 6.28f });
+	}
+	moveLights(lights, motions, lightTime);
+
+	/************************************ TEXTURES ************************************/
+	unsigned int diffuseMap = loadTexture("textures/container2.png");
+	unsigned int specularMap = loadTexture("textures/container2_specular.png");
+
+	/************************************ SHADERS ************************************/
+	Shader lightingShader("shaders/shader.vs", "shaders/shader.fs");
+	Shader lightCubeShader("shaders/lightCube.vs", "shaders/lightCube.fs");
+	Shader depthShader("shaders/depth.vs", "shaders/depth.fs");
+	Shader overdrawShader("shaders/depth.vs", "shaders/overdraw.fs");
+	/* The lights never go through the programs, only the block binding does */
+	lightingShader.use();
+	lightingShader.setUniformBlock("Lights", lights.Binding);
+	lightingShader.setVec3("ambient", 0.03f, 0.03f, 0.03f);
+	lightingShader.setInt("material.diffuse", 0);
+	lightingShader.setInt("material.specular", 1);
+	lightingShader.setFloat("material.shininess", 32.0f);
+	lightCubeShader.use();
+	lightCubeShader.setFloat("size", 0.15f);
+
+	/************************************ RENDER LOOP ************************************/
+	glEnable(GL_DEPTH_TEST);
+	std::cout << lightCount << " lights, " << boxes.size() << " boxes. Space pauses the lights, "
+		<< "P toggles the depth pre-pass, O changes the draw order, V shows the overdraw" << std::endl;
+
+	/* Boxes in the current draw order, sorted again when the camera moves */
+	std::vector<glm::mat4> drawnBoxes = boxes;
+	Draw_order sortedOrder = Draw_order::AS_CREATED;
+	glm::vec3 sortedPosition = camera.Position;
+	GpuTimer prepassTimer, colorTimer;
+	/* Fragments that ran the lighting shader */
+	GpuTimer shadedSamples(GL_SAMPLES_PASSED);
+	bool measuredPrepass = depthPrepass;
+	Draw_order measuredOrder = drawOrder;
+
+	std::vector<Light_marker> markers;
+	unsigned int measuredFrames = 0, measuredUploads = 0;
+	double measureStart = glfwGetTime();
+	lastFrame = glfwGetTime();
+	while (!glfwWindowShouldClose(window)) {
+		float currentFrame = glfwGetTime();
+		deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+
+		processInput(window);
+
+		/* One buffer update for all lights, skipped while they stand still */
+		if (lightsAnimating) {
+			lightTime += deltaTime;
+			moveLights(lights, motions, lightTime);
+		}
+		if (lights.Upload()) {
+			measuredUploads++;
+			markers.clear();
+			for (unsigned int i = 0; i < lights.Count(); i++) {
+				/* The hue at full brightness, the intensity doesn't fit into a color */
+				const Light& light = lights.Get(i);
+				float brightest = std::max(std::max(light.color.r, light.color.g), std::max(light.color.b, 0.001f));
+				if (light.type != Light_type::DIRECTIONAL)
+					markers.push_back(Light_marker{ light.position, light.color / brightest });
+			}
+			glBindBuffer(GL_ARRAY_BUFFER, markerVBO);
+			glBufferSubData(GL_ARRAY_BUFFER, 0, markers.size() * sizeof(Light_marker), markers.data());
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+		}
+
+		if (drawOrder != sortedOrder || (drawOrder != Draw_order::AS_CREATED && camera.Position != sortedPosition)) {
+			drawnBoxes = boxes;
+			sortBoxes(drawnBoxes, camera.Position, drawOrder);
+			glBindBuffer(GL_ARRAY_BUFFER, boxVBO);
+			glBufferSubData(GL_ARRAY_BUFFER, 0, drawnBoxes.size() * sizeof(glm::mat4), drawnBoxes.data());
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			sortedOrder = drawOrder;
+			sortedPosition = camera.Position;
+		}
+
+		glClearColor(showOverdraw ? 0.0f : 0.02f, showOverdraw ? 0.0f : 0.02f, showOverdraw ? 0.0f : 0.02f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		/* View and projection transformations */
+		glm::mat4 view = camera.GetViewMatrix();
+		glm::mat4 projection =
+			glm::perspective(glm::radians(camera.Zoom), (float)winWidth / winHeight, 0.1f, 200.0f);
+
+		/* Depth of the nearest surfaces, no color writes and a fragment shader that does nothing */
+		if (depthPrepass) {
+			prepassTimer.Begin();
+			glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+			depthShader.use();
+			depthShader.setMat4f("view", view);
+			depthShader.setMat4f("projection", projection);
+			glBindVertexArray(depthVAO);
+			glDrawArraysInstanced(GL_TRIANGLES, 0, 36, (GLsizei)drawnBoxes.size());
+			glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+			prepassTimer.End();
+
+			/* Only the fragment that won the pre-pass gets shaded, the depth is already final */
+			glDepthFunc(GL_EQUAL);
+			glDepthMask(GL_FALSE);
+		}
+
+		colorTimer.Begin();
+		shadedSamples.Begin();
+		if (showOverdraw) {
+			/* Same depth state as the lighting, every fragment that would be shaded adds to its pixel */
+			glEnable(GL_BLEND);
+			glBlendFunc(GL_ONE, GL_ONE);
+			overdrawShader.use();
+			overdrawShader.setMat4f("view", view);
+			overdrawShader.setMat4f("projection", projection);
+			glBindVertexArray(depthVAO);
+			glDrawArraysInstanced(GL_TRIANGLES, 0, 36, (GLsizei)drawnBoxes.size());
+			glDisable(GL_BLEND);
+		}
+		else {
+			lightingShader.use();
+			lightingShader.setMat4f("view", view);
+			lightingShader.setMat4f("projection", projection);
+			lightingShader.setVec3("viewPos", camera.Position);
+
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, diffuseMap);
+			glActiveTexture(GL_TEXTURE1);
+			glBindTexture(GL_TEXTURE_2D, specularMap);
+
+			glBindVertexArray(cubeVAO);
+			glDrawArraysInstanced(GL_TRIANGLES, 0, 36, (GLsizei)drawnBoxes.size());
+		}
+		shadedSamples.End();
+		colorTimer.End();
+		glDepthFunc(GL_LESS);
+		glDepthMask(GL_TRUE);
+
+		/* Draw the light objects */
+		if (!showOverdraw) {
+			lightCubeShader.use();
+			lightCubeShader.setMat4f("view", view);
+			lightCubeShader.setMat4f("projection", projection);
+			glBindVertexArray(lightVAO);
+			glDrawArraysInstanced(GL_TRIANGLES, 0, 36, (GLsizei)markers.size());
+		}
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+
+		/* Average frame time over two seconds, restarted when the pre-pass or the order changes */
+		measuredFrames++;
+		double measured = glfwGetTime() - measureStart;
+		bool changed = measuredPrepass != depthPrepass || measuredOrder != drawOrder;
+		if (changed || measured >= 2.0) {
+			if (!changed) {
+				int width, height;
+				glfwGetFramebufferSize(window, &width, &height);
+				std::cout << lights.Count() << " lights: " << measured * 1000.0 / measuredFrames << " ms per frame, "
+					<< measuredUploads << " light uploads in " << measuredFrames << " frames (" << lights.UploadedBytes / 1024 << " KB in total)"
+					<< std::endl;
+				/* The pre-pass pays off once the shading it saves costs more than the pre-pass itself */
+				std::cout << "  " << orderName(drawOrder) << (depthPrepass ? " with" : " without") << " depth pre-pass: "
+					<< prepassTimer.AverageMs() << " ms GPU pre-pass, " << colorTimer.AverageMs() << " ms GPU color pass, "
+					<< shadedSamples.Average() / ((double)width * height) << " shaded fragments per pixel" << std::endl;
+			}
+			measuredFrames = measuredUploads = 0;
+			measuredPrepass = depthPrepass;
+			measuredOrder = drawOrder;
+			prepassTimer.Reset();
+			colorTimer.Reset();
+			shadedSamples.Reset();
+			measureStart = glfwGetTime();
+		}
+	}
+
+	glDeleteVertexArrays(1, &cubeVAO);
+	glDeleteVertexArrays(1, &lightVAO);
+	glDeleteVertexArrays(1, &depthVAO);
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &positionVBO);
+	glDeleteBuffers(1, &boxVBO);
+	glDeleteBuffers(1, &markerVBO);
+	glDeleteTextures(1, &diffuseMap);
+	glDeleteTextures(1, &specularMap);
+	glfwTerminate();
+}
+
+
+void processInput(GLFWwindow* window)
+{
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, true);
+	if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
+		deltaTime *= 2;
+	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::FORWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::BACKWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::LEFT, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::RIGHT, deltaTime);
+}
+
+void keyPress_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	if (action != GLFW_PRESS)
+		return;
+	if (key == GLFW_KEY_SPACE)
+		lightsAnimating = !lightsAnimating;
+	else if (key == GLFW_KEY_P)
+		depthPrepass = !depthPrepass;
+	else if (key == GLFW_KEY_O)
+		drawOrder = (Draw_order)(((int)drawOrder + 1) % 3);
+	else if (key == GLFW_KEY_V)
+		showOverdraw = !showOverdraw;
+}
+
+void frameBufferResize_callback(GLFWwindow* window, int width, int height)
+{
+	glViewport(0, 0, width, height);
+}
+
+void mouseMovement_callback(GLFWwindow* window, double xPos, double yPos)
+{
+	if (firstMouseMove) {
+		lastX = xPos;
+		lastY = yPos;
+		firstMouseMove = false;
+	}
+
+	float xOffset = (float)xPos - lastX;
+	float yOffset = lastY - (float)yPos;
+	lastX = xPos;
+	lastY = yPos;
+
+	camera.ProcessMouseMovement(xOffset, yOffset);
+}
+
+void mouseScroll_callback(GLFWwindow* window, double xOffset, double yOffset)
+{
+	camera.ProcessMouseScroll(yOffset);
+}
+
+unsigned int loadTexture(const char* path)
+{
+	unsigned int textureID;
+	glGenTextures(1, &textureID);
+
+	int width, height, nrComponents;
+	unsigned char* data = stbi_load(path, &width, &height, &nrComponents, 0);
+	if (data) {
+		/* See which color format the texture uses */
+		GLenum format;
+		if (nrComponents == 1)
+			format = GL_RED;
+		else if (nrComponents == 3)
+			format = GL_RGB;
+		else if (nrComponents == 4)
+			format = GL_RGBA;
+
+		glBindTexture(GL_TEXTURE_2D, textureID);
+		glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+		glGenerateMipmap(GL_TEXTURE_2D);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	}
+	else
+		std::cout << "Texture failed to load at path: " << path << std::endl;
+	stbi_image_free(data);
+
+	return textureID;
+}
+
+void moveLights(LightSystem& lights, const std::vector<Light_motion>& motions, float time)
+{
+	for (unsigned int i = 0; i < lights.Count(); i++) {
+		Light light = lights.Get(i);
+		float angle = motions[i].phase + motions[i].speed * time;
+		if (light.type == Light_type::DIRECTIONAL)
+			light.direction = glm::vec3(std::cos(angle) * 0.5f, -1.0f, std::sin(angle) * 0.5f);
+		else
+			light.position = motions[i].center + motions[i].radius * glm::vec3(std::cos(angle), 0.0f, std::sin(angle));
+		lights.Set(i, light);
+	}
+}
+
+void sortBoxes(std::vector<glm::mat4>& boxes, const glm::vec3& viewPos, Draw_order order)
+{
+	if (order == Draw_order::AS_CREATED)
+		return;
+	/* By the distance of the box centers, the translation column */
+	auto distance = [&](const glm::mat4& box) {
+		glm::vec3 offset = glm::vec3(box[3]) - viewPos;
+		return glm::dot(offset, offset);
+	};
+	std::sort(boxes.begin(), boxes.end(), [&](const glm::mat4& a, const glm::mat4& b) {
+		return order == Draw_order::FRONT_TO_BACK ? distance(a) < distance(b) : distance(a) > distance(b);
+	});
+}
+
+const char* orderName(Draw_order order)
+{
+	switch (order) {
+	case Draw_order::FRONT_TO_BACK:
+		return "Front to back";
+	case Draw_order::BACK_TO_FRONT:
+		return "Back to front";
+	default:
+		return "As created";
+	}
+}
@@ -0,0 +1,15 @@
+#version 330 core
+layout (location = 0) in vec3 aPosition;
+// per instance
+layout (location = 3) in mat4 aModel;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+// same transformation as shader.vs, the color pass tests against this depth with GL_EQUAL
+invariant gl_Position;
+
+void main()
+{
+  gl_Position = projection * view * aModel * vec4(aPosition, 1.0f);
+}
@@ -0,0 +1,8 @@
+#version 330 core
+out vec4 fragColor;
+
+// added up with additive blending, a pixel turns white after 8 shaded fragments
+void main()
+{
+  fragColor = vec4(vec3(1.0 / 8.0), 1.0);
+}
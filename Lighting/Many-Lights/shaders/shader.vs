@@ -0,0 +1,25 @@
+#version 330 core
+layout (location = 0) in vec3 aPosition;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+// per instance
+layout (location = 3) in mat4 aModel;
+
+out vec3 Normal;
+out vec3 fragPos;
+out vec2 texCoords;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+// the color pass after the depth pre-pass tests with GL_EQUAL, depth.vs has to give the exact same depth
+invariant gl_Position;
+
+void main()
+{
+  gl_Position = projection * view * aModel * vec4(aPosition, 1.0f);
+  // the boxes are only translated and scaled along the axes, their axis aligned normals keep the direction
+  Normal = mat3(aModel) * aNormal;
+  fragPos = vec3(aModel * vec4(aPosition, 1.0));
+  texCoords = aTexCoords;
+}
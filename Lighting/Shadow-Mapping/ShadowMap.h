@@ -0,0 +1,234 @@
+#ifndef SHADOW_MAP_H
+#define SHADOW_MAP_H
+
+#include <iostream>
+#include <vector>
+#include <functional>
+#include <cmath>
+
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+/* Kinds of shadow maps */
+enum class Shadow_type {
+	/* One orthographic depth map, sampled with a sampler2DShadow */
+	DIRECTIONAL,
+	/* Cube map of the distance to the light divided by the far plane, sampled with a samplerCubeShadow */
+	POINT
+};
+
+/* Shadow map of one light with a cache for the static casters.
+The static casters are rendered into a depth map of their own, only after the light or one of
+them moved. Every frame that depth is copied into the sampled map with a blit and the dynamic
+casters are drawn on top, so a frame pays for the copy and the few moving objects instead of
+the whole scene. With Caching off all casters are rendered every frame, like a plain shadow map */
+class ShadowMap
+{
+public:
+	/* Draws casters with the light space matrix of a face */
+	typedef std::function<void(const glm::mat4&)> Draw_casters;
+
+	/* Constructor and destructor */
+	ShadowMap(Shadow_type type, int size);
+	~ShadowMap() noexcept;
+
+	/* Light shining along direction onto the sphere around center */
+	void SetDirectional(const glm::vec3& direction, const glm::vec3& center, float radius);
+	/* Light at position, casters farther than farPlane cast no shadow */
+	void SetPoint(const glm::vec3& position, float farPlane);
+	/* A static caster moved, render them again in the next Render() */
+	void InvalidateStatic() noexcept;
+	/* Bring the map up to date. Leaves the last face framebuffer bound and the viewport at the map size,
+	the depth writes have to be on */
+	void Render(const Draw_casters& drawStatic, const Draw_casters& drawDynamic);
+	void Bind(int unit) const;
+
+	/* Get functions */
+	const glm::mat4& LightSpace(int face) const;
+	int FaceCount() const noexcept;
+
+public:
+	const Shadow_type Type;
+	const int Size;
+	/* Off renders the static casters every frame */
+	bool Caching;
+	/* Statistics, how often the static casters were rendered */
+	unsigned int StaticRenders;
+
+private:
+	/* Helper functions */
+	unsigned int createTexture() const;
+	unsigned int createFramebuffer(unsigned int depth, int face) const;
+	GLenum target() const noexcept;
+	GLenum faceTarget(int face) const noexcept;
+	/* Replace the light space matrices, the cache is stale if they changed */
+	void setLightSpaces(const std::vector<glm::mat4>& matrices);
+private:
+	unsigned int texture, staticTexture;
+	/* One per face */
+	std::vector<unsigned int> framebuffers, staticFramebuffers;
+	std::vector<glm::mat4> lightSpaces;
+	bool staticDirty;
+};
+
+
+ShadowMap::ShadowMap(Shadow_type type, int size = 2048)
+	: Type(type), Size(size), Caching(true), StaticRenders(0), lightSpaces(type == Shadow_type::POINT ? 6 : 1, glm::mat4(1.0f)), staticDirty(true)
+{
+	texture = createTexture();
+	staticTexture = createTexture();
+	for (int face = 0; face < FaceCount(); face++) {
+		framebuffers.push_back(createFramebuffer(texture, face));
+		staticFramebuffers.push_back(createFramebuffer(staticTexture, face));
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+ShadowMap::~ShadowMap() noexcept
+{
+	glDeleteFramebuffers((GLsizei)framebuffers.size(), framebuffers.data());
+	glDeleteFramebuffers((GLsizei)staticFramebuffers.size(), staticFramebuffers.data());
+	unsigned int textures[] = { texture, staticTexture };
+	glDeleteTextures(2, textures);
+}
+
+void ShadowMap::SetDirectional(const glm::vec3& direction, const glm::vec3& center, float radius)
+{
+	glm::vec3 forward = glm::normalize(direction);
+	/* Any up vector that isn't parallel to the light */
+	glm::vec3 up = std::abs(forward.y) > 0.99f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+	glm::mat4 view = glm::lookAt(center - forward * radius, center, up);
+	glm::mat4 projection = glm::ortho(-radius, radius, -radius, radius, 0.0f, 2.0f * radius);
+	setLightSpaces({ projection * view });
+}
+
+void ShadowMap::SetPoint(const glm::vec3& position, float farPlane)
+{
+	/* The faces in the order of GL_TEXTURE_CUBE_MAP_POSITIVE_X and the following targets, with the
+	up vectors the cube map lookup expects */
+	glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, 0.05f, farPlane);
+	setLightSpaces({
+		projection * glm::lookAt(position, position + glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f)),
+		projection * glm::lookAt(position, position + glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f)),
+		projection * glm::lookAt(position, position + glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f)),
+		projection * glm::lookAt(position, position + glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f)),
+		projection * glm::lookAt(position, position + glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, -1.0f, 0.0f)),
+		projection * glm::lookAt(position, position + glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, -1.0f, 0.0f))
+	});
+}
+
+inline void ShadowMap::InvalidateStatic() noexcept
+{
+	staticDirty = true;
+}
+
+void ShadowMap::Render(const Draw_casters& drawStatic, const Draw_casters& drawDynamic)
+{
+	glViewport(0, 0, Size, Size);
+	bool renderStatic = staticDirty || !Caching;
+	for (int face = 0; face < FaceCount(); face++) {
+		if (Caching) {
+			if (staticDirty) {
+				glBindFramebuffer(GL_FRAMEBUFFER, staticFramebuffers[face]);
+				glClear(GL_DEPTH_BUFFER_BIT);
+				drawStatic(lightSpaces[face]);
+			}
+			/* Start from the cached depth, the formats match so the blit is a plain copy */
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, staticFramebuffers[face]);
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffers[face]);
+			glBlitFramebuffer(0, 0, Size, Size, 0, 0, Size, Size, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+			glBindFramebuffer(GL_FRAMEBUFFER, framebuffers[face]);
+		}
+		else {
+			glBindFramebuffer(GL_FRAMEBUFFER, framebuffers[face]);
+			glClear(GL_DEPTH_BUFFER_BIT);
+			drawStatic(lightSpaces[face]);
+		}
+		drawDynamic(lightSpaces[face]);
+	}
+
+	if (renderStatic)
+		StaticRenders++;
+	/* Without caching the static map isn't kept up to date */
+	if (Caching)
+		staticDirty = false;
+}
+
+void ShadowMap::Bind(int unit) const
+{
+	glActiveTexture(GL_TEXTURE0 + unit);
+	glBindTexture(target(), texture);
+}
+
+inline const glm::mat4& ShadowMap::LightSpace(int face = 0) const
+{
+	return lightSpaces[face];
+}
+
+inline int ShadowMap::FaceCount() const noexcept
+{
+	return Type == Shadow_type::POINT ? 6 : 1;
+}
+
+unsigned int ShadowMap::createTexture() const
+{
+	unsigned int depth;
+	glGenTextures(1, &depth);
+	glBindTexture(target(), depth);
+	for (int face = 0; face < FaceCount(); face++)
+		glTexImage2D(faceTarget(face), 0, GL_DEPTH_COMPONENT24, Size, Size, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+
+	/* Depth comparison in the sampler, linear filtering then blends four comparisons */
+	glTexParameteri(target(), GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+	glTexParameteri(target(), GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+	glTexParameteri(target(), GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(target(), GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	if (Type == Shadow_type::DIRECTIONAL) {
+		/* Everything outside the map is lit */
+		const float border[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		glTexParameteri(target(), GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+		glTexParameteri(target(), GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+		glTexParameterfv(target(), GL_TEXTURE_BORDER_COLOR, border);
+	}
+	else {
+		glTexParameteri(target(), GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(target(), GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(target(), GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+	}
+	glBindTexture(target(), 0);
+	return depth;
+}
+
+unsigned int ShadowMap::createFramebuffer(unsigned int depth, int face) const
+{
+	unsigned int framebuffer;
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, faceTarget(face), depth, 0);
+	/* Depth only */
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		std::cout << "ERROR::SHADOW_MAP::FRAMEBUFFER_INCOMPLETE" << std::endl;
+	return framebuffer;
+}
+
+inline GLenum ShadowMap::target() const noexcept
+{
+	return Type == Shadow_type::POINT ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+}
+
+inline GLenum ShadowMap::faceTarget(int face) const noexcept
+{
+	return Type == Shadow_type::POINT ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face : GL_TEXTURE_2D;
+}
+
+void ShadowMap::setLightSpaces(const std::vector<glm::mat4>& matrices)
+{
+	if (matrices != lightSpaces)
+		staticDirty = true;
+	lightSpaces = matrices;
+}
+
+#endif
@@ -0,0 +1,489 @@
+#include "glad/glad.h"
+#include "GLFW/glfw3.h"
+
+#include "stb_image.h"
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+#include "Shader.h"
+#include "Camera.h"
+#include "ShadowMap.h"
+#include "GpuTimer.h"
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+
+
+void processInput(GLFWwindow* window);
+void frameBufferResize_callback(GLFWwindow* window, int width, int height);
+void mouseMovement_callback(GLFWwindow* window, double xPos, double yPos);
+void mouseScroll_callback(GLFWwindow* window, double xOffset, double yOffset);
+void keyPress_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+
+unsigned int loadTexture(const char* path);
+glm::vec3 sunDirection(float angle);
+
+
+const int winWidth = 800;
+const int winHeight = 600;
+
+/************************************ CAMERA ************************************/
+Camera camera({ 0.0f, 10.0f, 30.0f });
+
+float lastX = winWidth / 2;
+float lastY = winHeight / 2;
+bool firstMouseMove = true;
+
+/************************************ FRAMES ************************************/
+float deltaTime = 0.0f;
+float lastFrame = 0.0f;
+
+/************************************ LIGHTS ************************************/
+/* The lamp, moves in a circle while L is toggled on */
+glm::vec3 lightPos(0.0f, 4.0f, 0.0f);
+const float lampFarPlane = 25.0f;
+bool lampMoving = false;
+float lampTime = 0.0f;
+/* K turns the sun a step around the vertical */
+float sunAngle = 0.6f;
+
+/************************************ SHADOWS ************************************/
+/* C switches between the cached static shadow maps and rendering every caster every frame */
+bool shadowCaching = true;
+/* B moves one of the static boxes, the static casters have to be rendered again */
+bool staticMoved = false;
+
+/************************************ SCENE ************************************/
+const int gridSize = 20;
+const float gridSpacing = 3.0f;
+const unsigned int dynamicCount = 12;
+
+
+int main()
+{
+	/************************************ INITIALIZATION ************************************/
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+	GLFWwindow* window = glfwCreateWindow(winWidth, winHeight, "Shadow mapping", NULL, NULL);
+	if (window == NULL) {
+		std::cout << "ERROR::GLFW::INITIALIZATION_FAILED" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		std::cout << "ERROR::GLAD::INITIALIZATION_FAILED" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glViewport(0, 0, winWidth, winHeight);
+	/* Measure the shadows, not the display refresh */
+	glfwSwapInterval(0);
+
+	glfwSetFramebufferSizeCallback(window, frameBufferResize_callback);
+	glfwSetCursorPosCallback(window, mouseMovement_callback);
+	glfwSetScrollCallback(window, mouseScroll_callback);
+	glfwSetKeyCallback(window, keyPress_callback);
+
+	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+	/************************************ POSITIONS ************************************/
+	float cubeVertices[] = {
+		/*	  Positions			Normals		  TextureCoords	*/
+		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
+
+		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
+
+		-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+		-0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
+		-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
+		-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+
+		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+
+		-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  1.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  0.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
+
+		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  1.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  0.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f
+	};
+
+	/************************************ OBJECTS ************************************/
+	/* Static casters, a floor and a grid of pillars of random height */
+	std::vector<glm::mat4> staticBoxes;
+	float extent = gridSize * gridSpacing;
+	staticBoxes.push_back(glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -0.25f, 0.0f)), glm::vec3(extent, 0.5f, extent)));
+	std::mt19937 random(5);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	for (int z = 0; z < gridSize; z++) {
+		for (int x = 0; x < gridSize; x++) {
+			float height = 1.0f + 5.0f * unit(random);
+			glm::vec3 position((x - (gridSize - 1) / 2.0f) * gridSpacing, height / 2.0f, (z - (gridSize - 1) / 2.0f) * gridSpacing);
+			staticBoxes.push_back(glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(1.0f, height, 1.0f)));
+		}
+	}
+	/* Dynamic casters, boxes tumbling in circles between the pillars, updated every frame */
+	std::vector<glm::mat4> dynamicBoxes(dynamicCount, glm::mat4(1.0f));
+
+	/************************************ BUFFERS ************************************/
+	unsigned int VBO, staticVBO, dynamicVBO;
+	glGenBuffers(1, &VBO);
+	glGenBuffers(1, &staticVBO);
+	glGenBuffers(1, &dynamicVBO);
+
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), cubeVertices, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, staticVBO);
+	glBufferData(GL_ARRAY_BUFFER, staticBoxes.size() * sizeof(glm::mat4), staticBoxes.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, dynamicVBO);
+	glBufferData(GL_ARRAY_BUFFER, dynamicBoxes.size() * sizeof(glm::mat4), NULL, GL_DYNAMIC_DRAW);
+
+	/* The same cube for both, the model matrices come per instance from their own buffer */
+	unsigned int staticVAO, dynamicVAO;
+	glGenVertexArrays(1, &staticVAO);
+	glGenVertexArrays(1, &dynamicVAO);
+	unsigned int instanceBuffers[] = { staticVBO, dynamicVBO };
+	unsigned int instanceVAOs[] = { staticVAO, dynamicVAO };
+	for (int i = 0; i < 2; i++) {
+		glBindVertexArray(instanceVAOs[i]);
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+		glEnableVertexAttribArray(2);
+
+		glBindBuffer(GL_ARRAY_BUFFER, instanceBuffers[i]);
+		for (unsigned int column = 0; column < 4; column++) {
+			glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(column * sizeof(glm::vec4)));
+			glEnableVertexAttribArray(3 + column);
+			glVertexAttribDivisor(3 + column, 1);
+		}
+	}
+
+	unsigned int lightVAO;
+	glGenVertexArrays(1, &lightVAO);
+	glBindVertexArray(lightVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	/************************************ TEXTURES ************************************/
+	unsigned int diffuseMap = loadTexture("textures/container2.png");
+	unsigned int specularMap = loadTexture("textures/container2_specular.png");
+
+	/************************************ SHADOW MAPS ************************************/
+	ShadowMap sunShadow(Shadow_type::DIRECTIONAL, 2048);
+	ShadowMap lampShadow(Shadow_type::POINT, 1024);
+	/* The whole grid and the pillars on it */
+	float sceneRadius = extent * 0.75f;
+
+	/************************************ SHADERS ************************************/
+	Shader objectShader("shaders/shader.vs", "shaders/shader.fs");
+	Shader lightShader("shaders/lightCube.vs", "shaders/lightCube.fs");
+	Shader depthShader("shaders/shadowDepth.vs", "shaders/shadowDepth.fs");
+	Shader distanceShader("shaders/shadowDepth.vs", "shaders/shadowDistance.fs");
+	objectShader.use();
+	objectShader.setInt("material.diffuse", 0);
+	objectShader.setInt("material.specular", 1);
+	objectShader.setFloat("material.shininess", 32.0f);
+	objectShader.setInt("sunShadowMap", 2);
+	objectShader.setInt("lampShadowMap", 3);
+	objectShader.setVec3("sun.ambient", 0.08f, 0.08f, 0.1f);
+	objectShader.setVec3("sun.diffuse", 0.6f, 0.55f, 0.5f);
+	objectShader.setVec3("sun.specular", 0.3f, 0.3f, 0.3f);
+	objectShader.setVec3("lamp.diffuse", 1.5f, 1.2f, 0.8f);
+	objectShader.setVec3("lamp.specular", 1.0f, 1.0f, 1.0f);
+	objectShader.setFloat("lamp.farPlane", lampFarPlane);
+	distanceShader.use();
+	distanceShader.setFloat("farPlane", lampFarPlane);
+
+	/* Casters for the shadow maps, only the depth of the boxes */
+	const Shader* casterShader = &depthShader;
+	auto drawStatic = [&](const glm::mat4& lightSpace) {
+		casterShader->setMat4f("lightSpace", lightSpace);
+		glBindVertexArray(staticVAO);
+		glDrawArraysInstanced(GL_TRIANGLES, 0, 36, (GLsizei)staticBoxes.size());
+	};
+	auto drawDynamic = [&](const glm::mat4& lightSpace) {
+		casterShader->setMat4f("lightSpace", lightSpace);
+		glBindVertexArray(dynamicVAO);
+		glDrawArraysInstanced(GL_TRIANGLES, 0, 36, (GLsizei)dynamicBoxes.size());
+	};
+
+	/************************************ RENDER LOOP ************************************/
+	glEnable(GL_DEPTH_TEST);
+	std::cout << staticBoxes.size() << " static and " << dynamicBoxes.size() << " dynamic boxes. C toggles the shadow cache, "
+		<< "L moves the lamp, K turns the sun, B moves a static box" << std::endl;
+
+	GpuTimer shadowTimer;
+	/* Two seconds of each mode at the start, then the keys take over */
+	int comparisonStep = 0;
+	double comparisonMs[2] = { 0.0, 0.0 }, comparisonShadowMs[2] = { 0.0, 0.0 };
+	bool measuredCaching = shadowCaching;
+	unsigned int measuredFrames = 0, measuredStaticRenders = 0;
+	double measureStart = glfwGetTime();
+	lastFrame = glfwGetTime();
+	while (!glfwWindowShouldClose(window)) {
+		float currentFrame = glfwGetTime();
+		deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+
+		processInput(window);
+
+		/* Move the dynamic casters */
+		for (unsigned int i = 0; i < dynamicCount; i++) {
+			float angle = currentFrame * 0.4f + i * 6.28f / dynamicCount;
+			float radius = 5.0f + (i % 3) * 4.0f;
+			glm::vec3 position(std::cos(angle) * radius, 3.0f + std::sin(currentFrame + i) * 1.5f, std::sin(angle) * radius);
+			dynamicBoxes[i] = glm::rotate(glm::translate(glm::mat4(1.0f), position), currentFrame + i, glm::vec3(1.0f, 0.3f, 0.5f));
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, dynamicVBO);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, dynamicBoxes.size() * sizeof(glm::mat4), dynamicBoxes.data());
+
+		if (staticMoved) {
+			/* A pillar near the middle jumps up and down */
+			glm::mat4& pillar = staticBoxes[1 + gridSize * (gridSize / 2) + gridSize / 2];
+			pillar[3].y = pillar[3].y > pillar[1].y * 0.75f ? pillar[1].y / 2.0f : pillar[1].y;
+			glBindBuffer(GL_ARRAY_BUFFER, staticVBO);
+			glBufferSubData(GL_ARRAY_BUFFER, 0, staticBoxes.size() * sizeof(glm::mat4), staticBoxes.data());
+			sunShadow.InvalidateStatic();
+			lampShadow.InvalidateStatic();
+			staticMoved = false;
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		/* Move the lights, the maps notice themselves when their light changed */
+		if (lampMoving) {
+			lampTime += deltaTime;
+			lightPos.x = std::sin(lampTime) * 6.0f;
+			lightPos.z = std::cos(lampTime) * 6.0f;
+		}
+		sunShadow.SetDirectional(sunDirection(sunAngle), glm::vec3(0.0f), sceneRadius);
+		lampShadow.SetPoint(lightPos, lampFarPlane);
+
+		/* Shadow maps */
+		sunShadow.Caching = lampShadow.Caching = shadowCaching;
+		shadowTimer.Begin();
+		casterShader = &depthShader;
+		depthShader.use();
+		sunShadow.Render(drawStatic, drawDynamic);
+		casterShader = &distanceShader;
+		distanceShader.use();
+		distanceShader.setVec3("lightPos", lightPos);
+		lampShadow.Render(drawStatic, drawDynamic);
+		shadowTimer.End();
+
+		/* Scene */
+		int width, height;
+		glfwGetFramebufferSize(window, &width, &height);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glViewport(0, 0, width, height);
+		glClearColor(0.05f, 0.05f, 0.08f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		/* View and projection transformations */
+		glm::mat4 view = camera.GetViewMatrix();
+		glm::mat4 projection =
+			glm::perspective(glm::radians(camera.Zoom), (float)winWidth / winHeight, 0.1f, 200.0f);
+
+		objectShader.use();
+		objectShader.setMat4f("view", view);
+		objectShader.setMat4f("projection", projection);
+		objectShader.setVec3("viewPos", camera.Position);
+		objectShader.setVec3("sun.direction", sunDirection(sunAngle));
+		objectShader.setMat4f("sunLightSpace", sunShadow.LightSpace());
+		objectShader.setVec3("lamp.position", lightPos);
+
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, diffuseMap);
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, specularMap);
+		sunShadow.Bind(2);
+		lampShadow.Bind(3);
+
+		glBindVertexArray(staticVAO);
+		glDrawArraysInstanced(GL_TRIANGLES, 0, 36, (GLsizei)staticBoxes.size());
+		glBindVertexArray(dynamicVAO);
+		glDrawArraysInstanced(GL_TRIANGLES, 0, 36, (GLsizei)dynamicBoxes.size());
+
+		/* Draw the lamp */
+		lightShader.use();
+		lightShader.setMat4f("model", glm::scale(glm::translate(glm::mat4(1.0f), lightPos), glm::vec3(0.2f)));
+		lightShader.setMat4f("view", view);
+		lightShader.setMat4f("projection", projection);
+		glBindVertexArray(lightVAO);
+		glDrawArrays(GL_TRIANGLES, 0, 36);
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+
+		/* Average frame time over two seconds, restarted when the cache is toggled */
+		measuredFrames++;
+		double measured = glfwGetTime() - measureStart;
+		if (measuredCaching != shadowCaching || measured >= 2.0) {
+			if (measuredCaching == shadowCaching) {
+				double frameMs = measured * 1000.0 / measuredFrames;
+				unsigned int staticRenders = sunShadow.StaticRenders + lampShadow.StaticRenders;
+				std::cout << (shadowCaching ? "Cached" : "Naive") << " shadows: " << frameMs << " ms per frame, "
+					<< shadowTimer.AverageMs() << " ms GPU for the shadow maps, static casters rendered "
+					<< staticRenders - measuredStaticRenders << " times in " << measuredFrames << " frames" << std::endl;
+
+				if (comparisonStep < 2) {
+					comparisonMs[comparisonStep] = frameMs;
+					comparisonShadowMs[comparisonStep] = shadowTimer.AverageMs();
+					comparisonStep++;
+					shadowCaching = comparisonStep != 1;
+					if (comparisonStep == 2)
+						std::cout << "Cached vs naive: " << comparisonMs[0] << " vs " << comparisonMs[1] << " ms per frame, "
+							<< comparisonShadowMs[0] << " vs " << comparisonShadowMs[1] << " ms GPU for the shadow maps" << std::endl;
+				}
+			}
+			measuredCaching = shadowCaching;
+			measuredFrames = 0;
+			measuredStaticRenders = sunShadow.StaticRenders + lampShadow.StaticRenders;
+			shadowTimer.Reset();
+			measureStart = glfwGetTime();
+		}
+	}
+
+	glDeleteVertexArrays(1, &staticVAO);
+	glDeleteVertexArrays(1, &dynamicVAO);
+	glDeleteVertexArrays(1, &lightVAO);
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &staticVBO);
+	glDeleteBuffers(1, &dynamicVBO);
+	glDeleteTextures(1, &diffuseMap);
+	glDeleteTextures(1, &specularMap);
+	glfwTerminate();
+}
+
+
+void processInput(GLFWwindow* window)
+{
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, true);
+	if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
+		deltaTime *= 2;
+	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::FORWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::BACKWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::LEFT, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::RIGHT, deltaTime);
+}
+
+void keyPress_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	if (action != GLFW_PRESS)
+		return;
+	if (key == GLFW_KEY_C)
+		shadowCaching = !shadowCaching;
+	else if (key == GLFW_KEY_L)
+		lampMoving = !lampMoving;
+	else if (key == GLFW_KEY_K)
+		sunAngle += 0.2f;
+	else if (key == GLFW_KEY_B)
+		staticMoved = true;
+}
+
+void frameBufferResize_callback(GLFWwindow* window, int width, int height)
+{
+	glViewport(0, 0, width, height);
+}
+
+void mouseMovement_callback(GLFWwindow* window, double xPos, double yPos)
+{
+	if (firstMouseMove) {
+		lastX = xPos;
+		lastY = yPos;
+		firstMouseMove = false;
+	}
+
+	float xOffset = (float)xPos - lastX;
+	float yOffset = lastY - (float)yPos;
+	lastX = xPos;
+	lastY = yPos;
+
+	camera.ProcessMouseMovement(xOffset, yOffset);
+}
+
+void mouseScroll_callback(GLFWwindow* window, double xOffset, double yOffset)
+{
+	camera.ProcessMouseScroll(yOffset);
+}
+
+unsigned int loadTexture(const char* path)
+{
+	unsigned int textureID;
+	glGenTextures(1, &textureID);
+
+	int width, height, nrComponents;
+	unsigned char* data = stbi_load(path, &width, &height, &nrComponents, 0);
+	if (data) {
+		/* See which color format the texture uses */
+		GLenum format;
+		if (nrComponents == 1)
+			format = GL_RED;
+		else if (nrComponents == 3)
+			format = GL_RGB;
+		else if (nrComponents == 4)
+			format = GL_RGBA;
+
+		glBindTexture(GL_TEXTURE_2D, textureID);
+		glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+		glGenerateMipmap(GL_TEXTURE_2D);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	}
+	else
+		std::cout << "Texture failed to load at path: " << path << std::endl;
+	stbi_image_free(data);
+
+	return textureID;
+}
+glm::vec3 sunDirection(float angle)
+{
+	return glm::vec3(std::cos(angle) * 0.5f, -1.0f, std::sin(angle) * 0.5f);
+}
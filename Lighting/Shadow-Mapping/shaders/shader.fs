@@ -0,0 +1,93 @@
+#version 330 core
+
+struct Material {
+  sampler2D diffuse;
+  sampler2D specular;
+  float shininess;
+};
+
+// the sun
+struct DirLight {
+  vec3 direction;
+
+  vec3 ambient;
+  vec3 diffuse;
+  vec3 specular;
+};
+
+// the lamp at lightPos
+struct PointLight {
+  vec3 position;
+  float farPlane;
+
+  vec3 diffuse;
+  vec3 specular;
+};
+
+out vec4 fragColor;
+
+in vec3 Normal;
+in vec3 fragPos;
+in vec2 texCoords;
+
+uniform vec3 viewPos;
+uniform Material material;
+uniform DirLight sun;
+uniform PointLight lamp;
+
+uniform mat4 sunLightSpace;
+uniform sampler2DShadow sunShadowMap;
+uniform samplerCubeShadow lampShadowMap;
+
+// share of the fragment the sun reaches, 3x3 taps of the filtered comparison
+float sunShadow(vec3 norm, vec3 lightDir)
+{
+  vec4 lightCoords = sunLightSpace * vec4(fragPos, 1.0);
+  vec3 coords = lightCoords.xyz / lightCoords.w * 0.5 + 0.5;
+  if (coords.z > 1.0)
+    return 1.0;
+  // surfaces at a grazing angle need more bias against acne
+  float bias = max(0.002 * (1.0 - dot(norm, lightDir)), 0.0005);
+  vec2 texel = 1.0 / vec2(textureSize(sunShadowMap, 0));
+  float lit = 0.0;
+  for (int x = -1; x <= 1; x++)
+    for (int y = -1; y <= 1; y++)
+      lit += texture(sunShadowMap, vec3(coords.xy + vec2(x, y) * texel, coords.z - bias));
+  return lit / 9.0;
+}
+
+// the cube map stores the distance to the lamp divided by the far plane
+float lampShadow()
+{
+  vec3 fromLamp = fragPos - lamp.position;
+  float depth = length(fromLamp) / lamp.farPlane;
+  return texture(lampShadowMap, vec4(fromLamp, depth - 0.004));
+}
+
+vec3 phong(vec3 lightDir, vec3 diffuseColor, vec3 specularColor, vec3 norm, vec3 viewDir)
+{
+  float diff = max(dot(norm, lightDir), 0.0);
+  vec3 reflectDir = reflect(-lightDir, norm);
+  float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+  return diffuseColor * diff * vec3(texture(material.diffuse, texCoords))
+    + specularColor * spec * vec3(texture(material.specular, texCoords));
+}
+
+void main()
+{
+  vec3 norm = normalize(Normal);
+  vec3 viewDir = normalize(viewPos - fragPos);
+
+  // ambient same as diffuse
+  vec3 result = sun.ambient * vec3(texture(material.diffuse, texCoords));
+
+  vec3 sunDir = normalize(-sun.direction);
+  result += sunShadow(norm, sunDir) * phong(sunDir, sun.diffuse, sun.specular, norm, viewDir);
+
+  vec3 lampDir = normalize(lamp.position - fragPos);
+  float dist = length(lamp.position - fragPos);
+  float attenuation = 1.0 / (1.0 + 0.09 * dist + 0.032 * dist * dist);
+  result += attenuation * lampShadow() * phong(lampDir, lamp.diffuse, lamp.specular, norm, viewDir);
+
+  fragColor = vec4(result, 1.0);
+}
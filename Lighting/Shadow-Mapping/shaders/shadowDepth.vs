@@ -0,0 +1,15 @@
+#version 330 core
+layout (location = 0) in vec3 aPosition;
+// per instance
+layout (location = 3) in mat4 aModel;
+
+out vec3 fragPos;
+
+// projection and view of the shadow map face
+uniform mat4 lightSpace;
+
+void main()
+{
+  fragPos = vec3(aModel * vec4(aPosition, 1.0));
+  gl_Position = lightSpace * vec4(fragPos, 1.0);
+}
@@ -0,0 +1,11 @@
+#version 330 core
+in vec3 fragPos;
+
+uniform vec3 lightPos;
+uniform float farPlane;
+
+// the cube map keeps the distance to the light, the same value from every face
+void main()
+{
+  gl_FragDepth = length(fragPos - lightPos) / farPlane;
+}
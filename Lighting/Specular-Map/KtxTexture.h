@@ -0,0 +1,232 @@
+#ifndef KTX_TEXTURE_H
+#define KTX_TEXTURE_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <climits>
+
+/* GL enums stored in the KTX header, the file itself doesn't need a GL context */
+namespace Ktx_consts {
+	const uint32_t RED = 0x1903;
+	const uint32_t RG = 0x8227;
+	const uint32_t RGB = 0x1907;
+	const uint32_t RGBA = 0x1908;
+	const uint32_t UNSIGNED_BYTE = 0x1401;
+	const uint32_t R8 = 0x8229;
+	const uint32_t RGB8 = 0x8051;
+	const uint32_t RGBA8 = 0x8058;
+	const uint32_t SRGB8_ALPHA8 = 0x8C43;
+	const uint32_t COMPRESSED_RGB_S3TC_DXT1 = 0x83F0;
+	const uint32_t COMPRESSED_RGBA_S3TC_DXT5 = 0x83F3;
+	const uint32_t COMPRESSED_SRGB_S3TC_DXT1 = 0x8C4C;
+	const uint32_t COMPRESSED_SRGB_ALPHA_S3TC_DXT5 = 0x8C4F;
+	const uint32_t COMPRESSED_RED_RGTC1 = 0x8DBB;
+	const uint32_t COMPRESSED_RG_RGTC2 = 0x8DBD;
+}
+
+/* KTX 1.1 texture - 2D image with a precomputed mip chain, compressed or not.
+Layout: 64 byte header, key/value data, then every level as size + data padded to 4 bytes */
+class KtxTexture
+{
+public:
+	/* Constructor */
+	KtxTexture();
+
+	/* File functions */
+	bool Load(const std::string& path);
+	bool Save(const std::string& path) const;
+
+	/* Get functions */
+	/* glType is 0 for compressed formats */
+	bool IsCompressed() const noexcept;
+	/* Bytes of all the levels */
+	size_t DataSize() const noexcept;
+	int LevelWidth(unsigned int level) const noexcept;
+	int LevelHeight(unsigned int level) const noexcept;
+	/* Bytes the format needs for the level, 0 when the format isn't supported */
+	size_t RequiredSize(unsigned int level) const noexcept;
+
+public:
+	uint32_t GlType;
+	uint32_t GlFormat;
+	uint32_t GlInternalFormat;
+	uint32_t GlBaseInternalFormat;
+	int Width;
+	int Height;
+	/* Level 0 is the full resolution image */
+	std::vector<std::vector<unsigned char>> Levels;
+private:
+	static const unsigned char identifier[12];
+	static const uint32_t endianness = 0x04030201;
+};
+
+
+const unsigned char KtxTexture::identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+KtxTexture::KtxTexture() : GlType(0), GlFormat(0), GlInternalFormat(0), GlBaseInternalFormat(0), Width(0), Height(0)
+{
+}
+
+bool KtxTexture::Load(const std::string& path)
+{
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file)
+		return false;
+	/* Sizes read from the file are checked against it before anything is allocated */
+	const unsigned long long fileSize = (unsigned long long)file.tellg();
+	file.seekg(0);
+
+	unsigned char fileIdentifier[12];
+	uint32_t header[13];
+	file.read((char*)fileIdentifier, sizeof(fileIdentifier));
+	file.read((char*)header, sizeof(header));
+	if (!file || memcmp(fileIdentifier, identifier, sizeof(identifier)) != 0) {
+		std::cout << "ERROR::KTX::NOT_A_KTX_FILE " << path << std::endl;
+		return false;
+	}
+	/* Files are written in the native byte order, only little endian is supported here */
+	if (header[0] != endianness) {
+		std::cout << "ERROR::KTX::UNSUPPORTED_ENDIANNESS " << path << std::endl;
+		return false;
+	}
+	/* Only plain 2D textures, no arrays, cube maps or 3D textures */
+	if (header[8] > 1 || header[9] > 1 || header[10] != 1) {
+		std::cout << "ERROR::KTX::UNSUPPORTED_TEXTURE_TYPE " << path << std::endl;
+		return false;
+	}
+
+	GlType = header[1];
+	GlFormat = header[3];
+	GlInternalFormat = header[4];
+	GlBaseInternalFormat = header[5];
+	if (header[6] == 0 || header[7] == 0 || header[6] > INT_MAX || header[7] > INT_MAX) {
+		std::cout << "ERROR::KTX::INVALID_SIZE " << path << std::endl;
+		return false;
+	}
+	Width = (int)header[6];
+	Height = (int)header[7];
+	/* BC1/BC3/BC4/BC5 and R8/RGB8/RGBA8 only, the uploads size the levels by these */
+	if (RequiredSize(0) == 0) {
+		std::cout << "ERROR::KTX::UNSUPPORTED_FORMAT " << path << std::endl;
+		return false;
+	}
+	uint32_t levelCount = header[11] ? header[11] : 1;
+	/* A 2D chain has at most 32 levels, every level takes at least its size field */
+	if (levelCount > 32 || sizeof(fileIdentifier) + sizeof(header) + (unsigned long long)header[12] + levelCount * 4ull > fileSize) {
+		std::cout << "ERROR::KTX::TRUNCATED_FILE " << path << std::endl;
+		return false;
+	}
+	file.seekg(header[12], std::ios::cur);
+
+	Levels.assign(levelCount, std::vector<unsigned char>());
+	for (uint32_t level = 0; level < levelCount; level++) {
+		uint32_t imageSize = 0;
+		file.read((char*)&imageSize, sizeof(imageSize));
+		if (!file || imageSize > fileSize - (unsigned long long)file.tellg()) {
+			std::cout << "ERROR::KTX::TRUNCATED_FILE " << path << std::endl;
+			return false;
+		}
+		Levels[level].resize(imageSize);
+		file.read((char*)Levels[level].data(), imageSize);
+		/* Skip the mip padding */
+		file.seekg((4 - imageSize % 4) % 4, std::ios::cur);
+		if (!file) {
+			std::cout << "ERROR::KTX::TRUNCATED_FILE " << path << std::endl;
+			return false;
+		}
+		/* The GL upload reads the whole level whatever the file says */
+		if (Levels[level].size() < RequiredSize(level)) {
+			std::cout << "ERROR::KTX::LEVEL_TOO_SMALL " << path << " (level " << level << ")" << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+bool KtxTexture::Save(const std::string& path) const
+{
+	std::ofstream file(path, std::ios::binary);
+	if (!file)
+		return false;
+
+	uint32_t header[13] = {
+		endianness, GlType, 1, GlFormat, GlInternalFormat, GlBaseInternalFormat,
+		(uint32_t)Width, (uint32_t)Height, 0, 0, 1, (uint32_t)Levels.size(), 0
+	};
+	file.write((const char*)identifier, sizeof(identifier));
+	file.write((const char*)header, sizeof(header));
+
+	const unsigned char padding[3] = { 0, 0, 0 };
+	for (const std::vector<unsigned char>& level : Levels) {
+		uint32_t imageSize = (uint32_t)level.size();
+		file.write((const char*)&imageSize, sizeof(imageSize));
+		file.write((const char*)level.data(), imageSize);
+		file.write((const char*)padding, (4 - imageSize % 4) % 4);
+	}
+	return (bool)file;
+}
+
+inline bool KtxTexture::IsCompressed() const noexcept
+{
+	return GlType == 0;
+}
+
+inline size_t KtxTexture::DataSize() const noexcept
+{
+	size_t size = 0;
+	for (const std::vector<unsigned char>& level : Levels)
+		size += level.size();
+	return size;
+}
+
+inline int KtxTexture::LevelWidth(unsigned int level) const noexcept
+{
+	int width = Width >> level;
+	return width > 0 ? width : 1;
+}
+
+inline int KtxTexture::LevelHeight(unsigned int level) const noexcept
+{
+	int height = Height >> level;
+	return height > 0 ? height : 1;
+}
+
+inline size_t KtxTexture::RequiredSize(unsigned int level) const noexcept
+{
+	size_t width = (size_t)LevelWidth(level), height = (size_t)LevelHeight(level);
+	if (GlType == 0) {
+		if (GlFormat != 0)
+			return 0;
+		/* 4x4 blocks, 8 bytes for BC1 and BC4, 16 for BC3 and BC5 */
+		switch (GlInternalFormat) {
+		case Ktx_consts::COMPRESSED_RGB_S3TC_DXT1:
+		case Ktx_consts::COMPRESSED_SRGB_S3TC_DXT1:
+		case Ktx_consts::COMPRESSED_RED_RGTC1:
+			return (width + 3) / 4 * ((height + 3) / 4) * 8;
+		case Ktx_consts::COMPRESSED_RGBA_S3TC_DXT5:
+		case Ktx_consts::COMPRESSED_SRGB_ALPHA_S3TC_DXT5:
+		case Ktx_consts::COMPRESSED_RG_RGTC2:
+			return (width + 3) / 4 * ((height + 3) / 4) * 16;
+		default:
+			return 0;
+		}
+	}
+	if (GlType != Ktx_consts::UNSIGNED_BYTE)
+		return 0;
+
+	/* Tightly packed rows, the levels are uploaded with an unpack alignment of 1 */
+	size_t components = 0;
+	if (GlFormat == Ktx_consts::RED && GlInternalFormat == Ktx_consts::R8)
+		components = 1;
+	else if (GlFormat == Ktx_consts::RGB && GlInternalFormat == Ktx_consts::RGB8)
+		components = 3;
+	else if (GlFormat == Ktx_consts::RGBA && (GlInternalFormat == Ktx_consts::RGBA8 || GlInternalFormat == Ktx_consts::SRGB8_ALPHA8))
+		components = 4;
+	return width * components * height;
+}
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef PIXEL_BUFFER_POOL_H
+#define PIXEL_BUFFER_POOL_H
+
+#include <iostream>
+#include <vector>
+
+#include "glad/glad.h"
+
+/* Pool of pixel unpack buffers used as staging memory for texture uploads.
+A buffer is mapped for writing, filled (from any thread), then unmapped and used as the
+source of glTexSubImage2D. Released buffers are fenced and only handed out again once
+the GPU finished reading them, so the upload never waits for the copy to complete */
+class PixelBufferPool
+{
+public:
+	/* Constructor and destructor */
+	explicit PixelBufferPool(unsigned int bufferCount);
+	~PixelBufferPool() noexcept;
+
+	/* Map a free buffer of at least size bytes. Returns InFlight if all of them are in use,
+	MapFailed if the driver couldn't map one - upload from client memory then, waiting won't help */
+	int Acquire(GLsizeiptr size, void** mapped);
+	/* Unmap the buffer and bind it to GL_PIXEL_UNPACK_BUFFER, pixel pointers become offsets into it */
+	void Bind(int buffer);
+	/* Fence the buffer after the upload commands were issued and unbind it */
+	void Release(int buffer);
+
+	/* Get functions */
+	unsigned int BufferCount() const noexcept;
+	/* Bytes of staging memory allocated by the pool */
+	GLsizeiptr AllocatedBytes() const noexcept;
+
+public:
+	static const int InFlight = -1;
+	static const int MapFailed = -2;
+
+private:
+	struct Pixel_buffer {
+		unsigned int ID;
+		GLsizeiptr size;
+		GLsync fence;
+		bool inUse;
+	};
+	std::vector<Pixel_buffer> buffers;
+};
+
+
+PixelBufferPool::PixelBufferPool(unsigned int bufferCount)
+	: buffers(bufferCount, Pixel_buffer{ 0, 0, nullptr, false })
+{
+}
+
+PixelBufferPool::~PixelBufferPool() noexcept
+{
+	for (Pixel_buffer& buffer : buffers) {
+		/* Acquired by a copy which was cancelled or never uploaded, still mapped */
+		if (buffer.inUse) {
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.ID);
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		}
+		if (buffer.fence)
+			glDeleteSync(buffer.fence);
+		if (buffer.ID)
+			glDeleteBuffers(1, &buffer.ID);
+	}
+}
+
+int PixelBufferPool::Acquire(GLsizeiptr size, void** mapped)
+{
+	for (size_t i = 0; i < buffers.size(); i++) {
+		Pixel_buffer& buffer = buffers[i];
+		if (buffer.inUse)
+			continue;
+
+		/* Skip the buffers the GPU is still reading from, don't wait for them */
+		if (buffer.fence) {
+			GLenum state = glClientWaitSync(buffer.fence, 0, 0);
+			if (state == GL_TIMEOUT_EXPIRED)
+				continue;
+			glDeleteSync(buffer.fence);
+			buffer.fence = nullptr;
+		}
+
+		if (!buffer.ID)
+			glGenBuffers(1, &buffer.ID);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.ID);
+		/* Grow the buffer, staging memory is reused for all the later uploads */
+		if (buffer.size < size) {
+			glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+			buffer.size = size;
+		}
+
+		*mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		if (!*mapped) {
+			std::cout << "ERROR::PIXEL_BUFFER::MAPPING_FAILED" << std::endl;
+			return MapFailed;
+		}
+
+		buffer.inUse = true;
+		return (int)i;
+	}
+	return InFlight;
+}
+
+void PixelBufferPool::Bind(int buffer)
+{
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffers[buffer].ID);
+	glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+}
+
+void PixelBufferPool::Release(int buffer)
+{
+	buffers[buffer].fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	buffers[buffer].inUse = false;
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+inline unsigned int PixelBufferPool::BufferCount() const noexcept
+{
+	return (unsigned int)buffers.size();
+}
+
+inline GLsizeiptr PixelBufferPool::AllocatedBytes() const noexcept
+{
+	GLsizeiptr bytes = 0;
+	for (const Pixel_buffer& buffer : buffers)
+		bytes += buffer.size;
+	return bytes;
+}
+
+#endif
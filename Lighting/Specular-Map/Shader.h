@@ -2,19 +2,33 @@
 #define SHADER_H
 
 #include <iostream>
-#include <fstream>
-#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
 
 #include "glad/glad.h"
 #include "glm/glm.hpp"
 #include "glm/gtc/type_ptr.hpp"
 
+#include "ShaderPreprocessor.h"
+
 class Shader
 {
 public:
-	/* Constructor and destructor */
-	Shader(const std::string& pathVertex, const std::string& pathFragment);
+	/* Constructors and destructor */
+	Shader(const std::string& pathVertex, const std::string& pathFragment, const std::vector<std::string>& defines);
+	/* Takes over a program linked elsewhere, e.g. by ShaderPermutations */
+	explicit Shader(unsigned int program) noexcept;
+	/* Program pipeline of two separable stages, the stages stay owned by the caller */
+	Shader(unsigned int stageVertex, unsigned int stageFragment);
 	~Shader() noexcept;
+	/* Source helpers */
+	/* Shared by every shader, creating a program again reuses the expanded sources */
+	static ShaderPreprocessor& Preprocessor();
+	static std::string InjectDefines(const std::string& code, const std::vector<std::string>& defines);
+	/* Separable single stage program (ARB_separate_shader_objects), 0 without the extension */
+	static unsigned int CreateStage(GLenum type, const std::string& path, const std::vector<std::string>& defines);
+	static bool SeparableStagesSupported() noexcept;
 	/* Use function */
 	void use() const noexcept;
 	/* Set functions */
@@ -25,38 +39,23 @@ public:
 	void setMat4f(const std::string& name, glm::mat4 val) const;
 	void setVec3(const std::string& name, glm::vec3 val) const;
 	void setVec3(const std::string& name, float x, float y, float z) const;
+private:
+	/* Helper functions */
+	/* Location in the program, or in the pipeline stage declaring the uniform which becomes its active program */
+	int location(const std::string& name) const;
 private:
 	unsigned int ID;
+	unsigned int pipeline = 0;
+	unsigned int stages[2] = { 0, 0 };
 };
 
 
-Shader::Shader(const std::string& pathVertex, const std::string& pathFragment)
+Shader::Shader(const std::string& pathVertex, const std::string& pathFragment, const std::vector<std::string>& defines = {})
 {
-	std::ifstream fileVertex;
-	std::ifstream fileFragment;
-	std::stringstream streamVertex;
-	std::stringstream streamFragment;
-
-	fileVertex.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-	fileFragment.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-
-	try {
-		fileVertex.open(pathVertex);
-		fileFragment.open(pathFragment);
-
-		streamVertex << fileVertex.rdbuf();
-		streamFragment << fileFragment.rdbuf();
-
-		fileVertex.close();
-		fileFragment.close();
-	}
-
-	catch (std::ifstream::failure fail) {
-		std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ\n" << fail.what() << std::endl;
-	}
-
-	std::string sCodeVertex(streamVertex.str());
-	std::string sCodeFragment(streamFragment.str());
+	const Shader_source& sourceVertex = Preprocessor().Load(pathVertex);
+	const Shader_source& sourceFragment = Preprocessor().Load(pathFragment);
+	std::string sCodeVertex(InjectDefines(sourceVertex.code, defines));
+	std::string sCodeFragment(InjectDefines(sourceFragment.code, defines));
 	const char* codeVertex = sCodeVertex.c_str();
 	const char* codeFragment = sCodeFragment.c_str();
 
@@ -69,7 +68,7 @@ Shader::Shader(const std::string& pathVertex, const std::string& pathFragment)
 	glGetShaderiv(shaderVertex, GL_COMPILE_STATUS, &success);
 	if (!success) {
 		glGetShaderInfoLog(shaderVertex, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
+		std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << ShaderPreprocessor::RemapLog(infoLog, sourceVertex) << std::endl;
 	}
 
 	unsigned int shaderFragment = glCreateShader(GL_FRAGMENT_SHADER);
@@ -78,7 +77,7 @@ Shader::Shader(const std::string& pathVertex, const std::string& pathFragment)
 	glGetShaderiv(shaderFragment, GL_COMPILE_STATUS, &success);
 	if (!success) {
 		glGetShaderInfoLog(shaderFragment, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
+		std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << ShaderPreprocessor::RemapLog(infoLog, sourceFragment) << std::endl;
 	}
 
 	ID = glCreateProgram();
@@ -95,49 +94,174 @@ Shader::Shader(const std::string& pathVertex, const std::string& pathFragment)
 	glDeleteShader(shaderVertex);
 }
 
+inline Shader::Shader(unsigned int program) noexcept : ID(program)
+{
+}
+
+inline Shader::Shader(unsigned int stageVertex, unsigned int stageFragment) : ID(0), stages{ stageVertex, stageFragment }
+{
+#ifdef GL_ARB_separate_shader_objects
+	glGenProgramPipelines(1, &pipeline);
+	glUseProgramStages(pipeline, GL_VERTEX_SHADER_BIT, stageVertex);
+	glUseProgramStages(pipeline, GL_FRAGMENT_SHADER_BIT, stageFragment);
+#else
+	std::cout << "ERROR::SHADER::PIPELINE::SEPARABLE_STAGES_NOT_SUPPORTED" << std::endl;
+#endif
+}
+
+inline ShaderPreprocessor& Shader::Preprocessor()
+{
+	static ShaderPreprocessor preprocessor;
+	return preprocessor;
+}
+
+inline std::string Shader::InjectDefines(const std::string& code, const std::vector<std::string>& defines)
+{
+	if (defines.empty())
+		return code;
+
+	/* #version has to stay the first statement, the defines go right after it */
+	size_t versionLine = code.find("#version");
+	size_t insertAt = versionLine == std::string::npos ? 0 : code.find('\n', versionLine);
+	std::string injected;
+	if (insertAt == std::string::npos) {
+		insertAt = code.size();
+		injected = "\n";
+	}
+	else if (versionLine != std::string::npos)
+		insertAt++;
+
+	/* Keep the line numbers of compile errors pointing into the file */
+	int nextLine = 1 + (int)std::count(code.begin(), code.begin() + insertAt, '\n') + (injected.empty() ? 0 : 1);
+	for (const std::string& define : defines)
+		injected += "#define " + define + "\n";
+	injected += "#line " + std::to_string(nextLine) + "\n";
+
+	return code.substr(0, insertAt) + injected + code.substr(insertAt);
+}
+
+inline unsigned int Shader::CreateStage(GLenum type, const std::string& path, const std::vector<std::string>& defines = {})
+{
+#ifdef GL_ARB_separate_shader_objects
+	/* The stage's source redeclares the built-in outputs under SEPARABLE_STAGE */
+	const Shader_source& source = Preprocessor().Load(path);
+	std::vector<std::string> stageDefines(defines);
+	stageDefines.push_back("SEPARABLE_STAGE");
+	std::string sCode(InjectDefines(source.code, stageDefines));
+	const char* code = sCode.c_str();
+
+	int success;
+	char infoLog[512];
+
+	unsigned int shader = glCreateShader(type);
+	glShaderSource(shader, 1, &code, NULL);
+	glCompileShader(shader);
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+	if (!success) {
+		glGetShaderInfoLog(shader, 512, NULL, infoLog);
+		std::cout << "ERROR::SHADER::STAGE::COMPILATION_FAILED\n" << ShaderPreprocessor::RemapLog(infoLog, source) << std::endl;
+	}
+
+	unsigned int program = glCreateProgram();
+	glProgramParameteri(program, GL_PROGRAM_SEPARABLE, GL_TRUE);
+	glAttachShader(program, shader);
+	glLinkProgram(program);
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (!success) {
+		glGetProgramInfoLog(program, 512, NULL, infoLog);
+		std::cout << "ERROR::SHADER::STAGE::LINKING_FAILED\n" << infoLog << std::endl;
+	}
+
+	glDetachShader(program, shader);
+	glDeleteShader(shader);
+	return program;
+#else
+	return 0;
+#endif
+}
+
+inline bool Shader::SeparableStagesSupported() noexcept
+{
+#ifdef GL_ARB_separate_shader_objects
+	return GLAD_GL_ARB_separate_shader_objects != 0;
+#else
+	return false;
+#endif
+}
+
 inline void Shader::use() const noexcept
 {
+#ifdef GL_ARB_separate_shader_objects
+	if (pipeline) {
+		/* A program in use would override the pipeline */
+		glUseProgram(0);
+		glBindProgramPipeline(pipeline);
+		return;
+	}
+#endif
 	glUseProgram(ID);
 }
 
 inline Shader::~Shader() noexcept
 {
+#ifdef GL_ARB_separate_shader_objects
+	if (pipeline)
+		glDeleteProgramPipelines(1, &pipeline);
+#endif
 	glDeleteProgram(ID);
 }
 
+inline int Shader::location(const std::string& name) const
+{
+#ifdef GL_ARB_separate_shader_objects
+	if (pipeline) {
+		/* glUniform sets the active program of the bound pipeline */
+		for (unsigned int stage : stages) {
+			int found = glGetUniformLocation(stage, name.c_str());
+			if (found != -1) {
+				glActiveShaderProgram(pipeline, stage);
+				return found;
+			}
+		}
+		return -1;
+	}
+#endif
+	return glGetUniformLocation(ID, name.c_str());
+}
+
 inline void Shader::setInt(const std::string& name, int val) const
 {
-	glUniform1i(glGetUniformLocation(ID, name.c_str()), val);
+	glUniform1i(location(name), val);
 }
 
 inline void Shader::setBool(const std::string& name, bool val) const
 {
-	glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)val);
+	glUniform1i(location(name), (int)val);
 }
 
 inline void Shader::setFloat(const std::string& name, float val) const
 {
-	glUniform1f(glGetUniformLocation(ID, name.c_str()), val);
+	glUniform1f(location(name), val);
 }
 
 inline void Shader::setDouble(const std::string& name, double val) const
 {
-	glUniform1d(glGetUniformLocation(ID, name.c_str()), val);
+	glUniform1d(location(name), val);
 }
 
 inline void Shader::setMat4f(const std::string& name, glm::mat4 val) const
 {
-	glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(val));
+	glUniformMatrix4fv(location(name), 1, GL_FALSE, glm::value_ptr(val));
 }
 
 inline void Shader::setVec3(const std::string& name, glm::vec3 val) const
 {
-	glUniform3f(glGetUniformLocation(ID, name.c_str()), val.x, val.y, val.z);
+	glUniform3f(location(name), val.x, val.y, val.z);
 }
 
 inline void Shader::setVec3(const std::string& name, float x, float y, float z) const
 {
-	glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+	glUniform3f(location(name), x, y, z);
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,386 @@
+#ifndef SHADER_PERMUTATIONS_H
+#define SHADER_PERMUTATIONS_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+
+#include "glad/glad.h"
+
+#include "Shader.h"
+
+/* Variants of one uber shader.
+Bit i of a feature mask puts "#define featureNames[i]" after the #version line, so every
+material runs a shader specialized for exactly its features instead of branching on uniforms.
+Only the masks asked for are compiled. Prepare() issues several compiles before waiting on
+any, which lets drivers with parallel compilation work on them together. With a binary
+prefix the linked programs are stored as program binaries and loaded on the next run.
+With separable stages the vertex shader is compiled once into its own program, every
+variant links only its fragment stage and is bound as a program pipeline */
+class ShaderPermutations
+{
+public:
+	/* Constructor and destructor */
+	ShaderPermutations(const std::string& pathVertex, const std::string& pathFragment, const std::vector<std::string>& featureNames,
+		const std::string& binaryPrefix, bool separableStages);
+	~ShaderPermutations() noexcept;
+	ShaderPermutations(const ShaderPermutations&) = delete;
+	ShaderPermutations& operator=(const ShaderPermutations&) = delete;
+
+	/* Start compiling the variants without waiting for the compiler */
+	void Prepare(const std::vector<unsigned int>& featureMasks);
+	/* Get the variant, compiling it or waiting for its compile if necessary */
+	Shader& Get(unsigned int features);
+	/* Whether Get() returns the variant without waiting, only known early with KHR_parallel_shader_compile */
+	bool Ready(unsigned int features) const;
+
+	/* Separable vertex stage shared by the variants, compiled on the first call. 0 without separable stages */
+	unsigned int VertexStage();
+
+	/* Get functions */
+	std::vector<std::string> Defines(unsigned int features) const;
+	unsigned int VariantCount() const noexcept;
+	/* False if separable stages were asked for but aren't supported */
+	bool Separable() const noexcept;
+
+public:
+	/* Statistics */
+	unsigned int VariantsCompiled;
+	unsigned int VariantsLoaded;
+	/* Shader objects compiled, two per variant without separable stages */
+	unsigned int StagesCompiled;
+	/* GL thread time spent issuing compiles, waiting for them and loading binaries */
+	double CompileMs;
+
+private:
+	struct Variant {
+		unsigned int program = 0;
+		/* Nonzero until the compile and link results were checked, no vertex shader with separable stages */
+		unsigned int shaderVertex = 0;
+		unsigned int shaderFragment = 0;
+		std::unique_ptr<Shader> shader;
+	};
+
+	/* Helper functions */
+	Variant& issue(unsigned int features);
+	void finish(unsigned int features, Variant& variant);
+	Shader* createShader(unsigned int program);
+	bool loadBinary(unsigned int features, Variant& variant);
+	void saveBinary(unsigned int features, unsigned int program) const;
+	std::string binaryPath(unsigned int features) const;
+	uint64_t variantKey(unsigned int features) const noexcept;
+	static void hash(uint64_t& key, const std::string& text) noexcept;
+	static unsigned int compileStage(GLenum type, const std::string& code);
+private:
+	/* Copies, the preprocessor replaces its sources when the files change */
+	Shader_source sourceVertex;
+	Shader_source sourceFragment;
+	std::vector<std::string> featureNames;
+	std::string pathVertex;
+	std::string binaryPrefix;
+	bool separable;
+	unsigned int vertexStage;
+	/* Hash of the sources and the driver, binaries stored under another key are stale */
+	uint64_t sourceKey;
+	bool parallelCompile;
+	bool programBinaries;
+	std::map<unsigned int, Variant> variants;
+};
+
+
+ShaderPermutations::ShaderPermutations(const std::string& pathVertex, const std::string& pathFragment, const std::vector<std::string>& featureNames,
+	const std::string& binaryPrefix = "", bool separableStages = false)
+	: VariantsCompiled(0), VariantsLoaded(0), StagesCompiled(0), CompileMs(0.0), sourceVertex(Shader::Preprocessor().Load(pathVertex)),
+	sourceFragment(Shader::Preprocessor().Load(pathFragment)), featureNames(featureNames), pathVertex(pathVertex), binaryPrefix(binaryPrefix),
+	separable(separableStages && Shader::SeparableStagesSupported()), vertexStage(0), sourceKey(14695981039346656037ull), parallelCompile(false), programBinaries(false)
+{
+#ifdef GL_KHR_parallel_shader_compile
+	parallelCompile = GLAD_GL_KHR_parallel_shader_compile != 0;
+#endif
+#ifdef GL_ARB_get_program_binary
+	/* Drivers may support the extension with no binary format at all */
+	GLint formats = 0;
+	if (GLAD_GL_ARB_get_program_binary)
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	programBinaries = !binaryPrefix.empty() && formats > 0;
+#endif
+
+	hash(sourceKey, sourceVertex.code);
+	hash(sourceKey, sourceFragment.code);
+	for (const std::string& name : featureNames)
+		hash(sourceKey, name);
+	/* A separable fragment stage is another binary than the whole program */
+	if (separable)
+		hash(sourceKey, "SEPARABLE_STAGE");
+	for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+		const GLubyte* value = glGetString(name);
+		hash(sourceKey, value ? (const char*)value : "");
+	}
+}
+
+inline ShaderPermutations::~ShaderPermutations() noexcept
+{
+	for (auto& entry : variants) {
+		Variant& variant = entry.second;
+		if (variant.shaderFragment) {
+			glDeleteShader(variant.shaderVertex);
+			glDeleteShader(variant.shaderFragment);
+		}
+		/* Finished variants own their program through the Shader, a pipeline leaves its stages */
+		if (!variant.shader || separable)
+			glDeleteProgram(variant.program);
+	}
+	glDeleteProgram(vertexStage);
+}
+
+inline void ShaderPermutations::Prepare(const std::vector<unsigned int>& featureMasks)
+{
+	for (unsigned int features : featureMasks)
+		if (variants.find(features) == variants.end())
+			issue(features);
+}
+
+inline Shader& ShaderPermutations::Get(unsigned int features)
+{
+	auto found = variants.find(features);
+	Variant& variant = found != variants.end() ? found->second : issue(features);
+	finish(features, variant);
+	return *variant.shader;
+}
+
+inline unsigned int ShaderPermutations::VertexStage()
+{
+	if (separable && !vertexStage) {
+		vertexStage = Shader::CreateStage(GL_VERTEX_SHADER, pathVertex);
+		StagesCompiled++;
+	}
+	return vertexStage;
+}
+
+inline bool ShaderPermutations::Ready(unsigned int features) const
+{
+	auto found = variants.find(features);
+	if (found == variants.end())
+		return false;
+	if (found->second.shader)
+		return true;
+#ifdef GL_KHR_parallel_shader_compile
+	if (parallelCompile) {
+		GLint completed = GL_FALSE;
+		glGetProgramiv(found->second.program, GL_COMPLETION_STATUS_KHR, &completed);
+		return completed == GL_TRUE;
+	}
+#endif
+	/* Any status query would wait for the compiler */
+	return false;
+}
+
+inline std::vector<std::string> ShaderPermutations::Defines(unsigned int features) const
+{
+	std::vector<std::string> defines;
+	for (size_t i = 0; i < featureNames.size(); i++)
+		if (features & (1u << i))
+			defines.push_back(featureNames[i]);
+	return defines;
+}
+
+inline unsigned int ShaderPermutations::VariantCount() const noexcept
+{
+	return (unsigned int)variants.size();
+}
+
+inline bool ShaderPermutations::Separable() const noexcept
+{
+	return separable;
+}
+
+inline ShaderPermutations::Variant& ShaderPermutations::issue(unsigned int features)
+{
+	auto start = std::chrono::steady_clock::now();
+	Variant& variant = variants[features];
+
+	if (loadBinary(features, variant))
+		variant.shader.reset(createShader(variant.program));
+	else {
+		std::vector<std::string> defines = Defines(features);
+		if (separable)
+			defines.push_back("SEPARABLE_STAGE");
+		else
+			variant.shaderVertex = compileStage(GL_VERTEX_SHADER, Shader::InjectDefines(sourceVertex.code, defines));
+		variant.shaderFragment = compileStage(GL_FRAGMENT_SHADER, Shader::InjectDefines(sourceFragment.code, defines));
+
+		variant.program = glCreateProgram();
+#ifdef GL_ARB_separate_shader_objects
+		if (separable)
+			glProgramParameteri(variant.program, GL_PROGRAM_SEPARABLE, GL_TRUE);
+#endif
+		if (variant.shaderVertex)
+			glAttachShader(variant.program, variant.shaderVertex);
+		glAttachShader(variant.program, variant.shaderFragment);
+#ifdef GL_ARB_get_program_binary
+		if (programBinaries)
+			glProgramParameteri(variant.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+#endif
+		/* The status queries wait for the compiler, finish() does them once the variant is needed */
+		glLinkProgram(variant.program);
+	}
+
+	CompileMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	return variant;
+}
+
+inline void ShaderPermutations::finish(unsigned int features, Variant& variant)
+{
+	if (variant.shader)
+		return;
+	auto start = std::chrono::steady_clock::now();
+
+	/* Name the variant in the error, the same source compiles fine with other defines */
+	std::string variantName;
+	for (const std::string& define : Defines(features))
+		variantName += (variantName.empty() ? "" : " ") + define;
+	if (variantName.empty())
+		variantName = "no features";
+
+	int success = GL_TRUE;
+	char infoLog[512];
+	if (variant.shaderVertex)
+		glGetShaderiv(variant.shaderVertex, GL_COMPILE_STATUS, &success);
+	if (!success) {
+		glGetShaderInfoLog(variant.shaderVertex, 512, NULL, infoLog);
+		std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED (" << variantName << ")\n" << ShaderPreprocessor::RemapLog(infoLog, sourceVertex) << std::endl;
+	}
+	glGetShaderiv(variant.shaderFragment, GL_COMPILE_STATUS, &success);
+	if (!success) {
+		glGetShaderInfoLog(variant.shaderFragment, 512, NULL, infoLog);
+		std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED (" << variantName << ")\n" << ShaderPreprocessor::RemapLog(infoLog, sourceFragment) << std::endl;
+	}
+	glGetProgramiv(variant.program, GL_LINK_STATUS, &success);
+	if (!success) {
+		glGetProgramInfoLog(variant.program, 512, NULL, infoLog);
+		std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED (" << variantName << ")\n" << infoLog << std::endl;
+	}
+	else
+		saveBinary(features, variant.program);
+
+	glDeleteShader(variant.shaderFragment);
+	glDeleteShader(variant.shaderVertex);
+	StagesCompiled += variant.shaderVertex ? 2 : 1;
+	variant.shaderVertex = variant.shaderFragment = 0;
+	variant.shader.reset(createShader(variant.program));
+	VariantsCompiled++;
+
+	CompileMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+inline Shader* ShaderPermutations::createShader(unsigned int program)
+{
+	return separable ? new Shader(VertexStage(), program) : new Shader(program);
+}
+
+inline bool ShaderPermutations::loadBinary(unsigned int features, Variant& variant)
+{
+#ifdef GL_ARB_get_program_binary
+	if (!programBinaries)
+		return false;
+	std::ifstream file(binaryPath(features), std::ios::binary);
+	if (!file)
+		return false;
+
+	/* Key, binary format and length in front of the binary */
+	uint64_t key = 0;
+	uint32_t format = 0, length = 0;
+	file.read((char*)&key, sizeof(key));
+	file.read((char*)&format, sizeof(format));
+	file.read((char*)&length, sizeof(length));
+	if (!file || key != variantKey(features) || length == 0)
+		return false;
+	std::vector<char> binary(length);
+	if (!file.read(binary.data(), length))
+		return false;
+
+	unsigned int program = glCreateProgram();
+#ifdef GL_ARB_separate_shader_objects
+	if (separable)
+		glProgramParameteri(program, GL_PROGRAM_SEPARABLE, GL_TRUE);
+#endif
+	glProgramBinary(program, format, binary.data(), (GLsizei)length);
+	/* Drivers reject binaries of another build even if the version string stayed the same */
+	int success;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (!success) {
+		glDeleteProgram(program);
+		return false;
+	}
+	variant.program = program;
+	VariantsLoaded++;
+	return true;
+#else
+	return false;
+#endif
+}
+
+inline void ShaderPermutations::saveBinary(unsigned int features, unsigned int program) const
+{
+#ifdef GL_ARB_get_program_binary
+	if (!programBinaries)
+		return;
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+		return;
+	std::vector<char> binary(length);
+	GLenum format = 0;
+	glGetProgramBinary(program, length, NULL, &format, binary.data());
+
+	std::ofstream file(binaryPath(features), std::ios::binary);
+	uint64_t key = variantKey(features);
+	uint32_t format32 = format, length32 = (uint32_t)length;
+	file.write((const char*)&key, sizeof(key));
+	file.write((const char*)&format32, sizeof(format32));
+	file.write((const char*)&length32, sizeof(length32));
+	file.write(binary.data(), length);
+	if (!file)
+		std::cout << "ERROR::SHADER_PERMUTATIONS::BINARY_NOT_WRITTEN\n" << binaryPath(features) << std::endl;
+#endif
+}
+
+inline std::string ShaderPermutations::binaryPath(unsigned int features) const
+{
+	std::stringstream path;
+	path << binaryPrefix << "." << std::hex << features << ".bin";
+	return path.str();
+}
+
+inline uint64_t ShaderPermutations::variantKey(unsigned int features) const noexcept
+{
+	uint64_t key = sourceKey;
+	hash(key, std::to_string(features));
+	return key;
+}
+
+inline void ShaderPermutations::hash(uint64_t& key, const std::string& text) noexcept
+{
+	/* 64 bit FNV-1a */
+	for (unsigned char c : text) {
+		key ^= c;
+		key *= 1099511628211ull;
+	}
+}
+
+inline unsigned int ShaderPermutations::compileStage(GLenum type, const std::string& code)
+{
+	const char* source = code.c_str();
+	unsigned int shader = glCreateShader(type);
+	glShaderSource(shader, 1, &source, NULL);
+	glCompileShader(shader);
+	return shader;
+}
+
+#endif
@@ -0,0 +1,259 @@
+#ifndef SHADER_PREPROCESSOR_H
+#define SHADER_PREPROCESSOR_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+#include <cctype>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+/* A shader file with its includes expanded */
+struct Shader_source {
+	std::string code;
+	/* The source string number of a #line directive indexes this, 0 is the file itself */
+	std::vector<std::string> files;
+	/* 64 bit FNV-1a of the code */
+	uint64_t hash;
+};
+
+/* Shader preprocessor for #include "path".
+Paths are relative to the including file. A file with #pragma once is expanded once per
+source, anything else every time it is included, so #ifndef guards work as in C. Every
+included file gets its own source string number in the #line directives, RemapLog() turns
+the numbers of a compile log back into paths. Expanded sources are cached until the size
+or modification time of one of their files changes, so creating the same program again
+reads no file */
+class ShaderPreprocessor
+{
+public:
+	/* Constructor */
+	ShaderPreprocessor();
+
+	/* Get the expanded source, an empty code if a file can't be read */
+	const Shader_source& Load(const std::string& path);
+	/* Replace the source string numbers at the start of the log lines with the paths */
+	static std::string RemapLog(const std::string& log, const Shader_source& source);
+	/* Forget every source, the next loads read all files again */
+	void Clear();
+
+public:
+	/* Statistics */
+	unsigned int Loads;
+	unsigned int Hits;
+	unsigned int FilesRead;
+
+private:
+	struct File_stamp {
+		long long modified;
+		long long size;
+
+		bool operator==(const File_stamp& other) const noexcept;
+	};
+	struct File_entry {
+		File_stamp stamp;
+		std::string text;
+	};
+	struct Source_entry {
+		Shader_source source;
+		/* Stamps of source.files when they were read */
+		std::vector<File_stamp> stamps;
+	};
+
+	/* Helper functions */
+	const File_entry* readFile(const std::string& path);
+	bool expand(const std::string& path, Source_entry& entry, std::vector<std::string>& includeStack, std::vector<std::string>& onceFiles);
+	static bool stampFile(const std::string& path, File_stamp& stamp);
+	static std::string directoryOf(const std::string& path);
+private:
+	std::map<std::string, File_entry> files;
+	std::map<std::string, Source_entry> sources;
+	Shader_source failed;
+};
+
+
+inline ShaderPreprocessor::ShaderPreprocessor() : Loads(0), Hits(0), FilesRead(0)
+{
+	failed.hash = 0;
+}
+
+inline const Shader_source& ShaderPreprocessor::Load(const std::string& path)
+{
+	Loads++;
+	auto found = sources.find(path);
+	if (found != sources.end()) {
+		/* Valid while every file it was built from is unchanged */
+		bool valid = true;
+		for (size_t i = 0; i < found->second.stamps.size() && valid; i++) {
+			File_stamp stamp;
+			valid = stampFile(found->second.source.files[i], stamp) && stamp == found->second.stamps[i];
+		}
+		if (valid) {
+			Hits++;
+			return found->second.source;
+		}
+		sources.erase(found);
+	}
+
+	Source_entry entry;
+	std::vector<std::string> includeStack, onceFiles;
+	if (!expand(path, entry, includeStack, onceFiles))
+		return failed;
+
+	entry.source.hash = 14695981039346656037ull;
+	for (unsigned char c : entry.source.code) {
+		entry.source.hash ^= c;
+		entry.source.hash *= 1099511628211ull;
+	}
+	Source_entry& cached = sources[path];
+	cached = std::move(entry);
+	return cached.source;
+}
+
+inline std::string ShaderPreprocessor::RemapLog(const std::string& log, const Shader_source& source)
+{
+	/* Drivers start the lines with "0:12(5):", "0(12) :" or "ERROR: 0:12:" */
+	std::stringstream remapped;
+	std::istringstream lines(log);
+	std::string line;
+	while (std::getline(lines, line)) {
+		size_t start = 0;
+		for (const char* prefix : { "ERROR: ", "WARNING: " })
+			if (line.compare(0, std::char_traits<char>::length(prefix), prefix) == 0)
+				start = std::char_traits<char>::length(prefix);
+
+		size_t end = start;
+		while (end < line.size() && std::isdigit((unsigned char)line[end]))
+			end++;
+		bool numbered = end > start && end + 1 < line.size() && (line[end] == ':' || line[end] == '(') && std::isdigit((unsigned char)line[end + 1]);
+		if (numbered) {
+			size_t file = std::stoul(line.substr(start, end - start));
+			if (file < source.files.size())
+				line = line.substr(0, start) + source.files[file] + line.substr(end);
+		}
+		remapped << line << '\n';
+	}
+	return remapped.str();
+}
+
+inline void ShaderPreprocessor::Clear()
+{
+	files.clear();
+	sources.clear();
+}
+
+inline bool ShaderPreprocessor::File_stamp::operator==(const File_stamp& other) const noexcept
+{
+	return modified == other.modified && size == other.size;
+}
+
+inline const ShaderPreprocessor::File_entry* ShaderPreprocessor::readFile(const std::string& path)
+{
+	File_stamp stamp;
+	if (!stampFile(path, stamp))
+		return nullptr;
+	/* Files included by several sources are read once */
+	auto found = files.find(path);
+	if (found != files.end() && found->second.stamp == stamp)
+		return &found->second;
+
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+		return nullptr;
+	std::stringstream stream;
+	stream << file.rdbuf();
+	FilesRead++;
+
+	File_entry& entry = files[path];
+	entry.stamp = stamp;
+	entry.text = stream.str();
+	return &entry;
+}
+
+inline bool ShaderPreprocessor::expand(const std::string& path, Source_entry& entry, std::vector<std::string>& includeStack, std::vector<std::string>& onceFiles)
+{
+	/* Included before and marked #pragma once */
+	for (const std::string& once : onceFiles)
+		if (once == path)
+			return true;
+	for (const std::string& including : includeStack)
+		if (including == path) {
+			std::cout << "ERROR::SHADER::INCLUDE_CYCLE\n" << path << " includes itself" << std::endl;
+			return false;
+		}
+	const File_entry* file = readFile(path);
+	if (!file) {
+		std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ\n" << path << std::endl;
+		return false;
+	}
+
+	size_t fileNumber = entry.source.files.size();
+	entry.source.files.push_back(path);
+	entry.stamps.push_back(file->stamp);
+	/* The file itself starts at line 1 of string 0, #version has to stay its first statement */
+	if (fileNumber > 0)
+		entry.source.code += "#line 1 " + std::to_string(fileNumber) + "\n";
+
+	includeStack.push_back(path);
+	std::istringstream lines(file->text);
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(lines, line)) {
+		lineNumber++;
+		size_t directive = line.find_first_not_of(" \t");
+		if (directive == std::string::npos || line[directive] != '#') {
+			entry.source.code += line + "\n";
+			continue;
+		}
+		size_t word = line.find_first_not_of(" \t", directive + 1);
+		std::string statement = word == std::string::npos ? std::string() : line.substr(word);
+
+		if (statement.compare(0, 11, "pragma once") == 0) {
+			onceFiles.push_back(path);
+			/* Keep the line count */
+			entry.source.code += "\n";
+		}
+		else if (statement.compare(0, 7, "include") == 0) {
+			size_t open = statement.find('"');
+			size_t close = open == std::string::npos ? open : statement.find('"', open + 1);
+			if (close == std::string::npos) {
+				std::cout << "ERROR::SHADER::INCLUDE_SYNTAX\n" << path << ":" << lineNumber << ": " << line << std::endl;
+				includeStack.pop_back();
+				return false;
+			}
+			if (!expand(directoryOf(path) + statement.substr(open + 1, close - open - 1), entry, includeStack, onceFiles)) {
+				includeStack.pop_back();
+				return false;
+			}
+			/* Back in this file on the line after the #include */
+			entry.source.code += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(fileNumber) + "\n";
+		}
+		else
+			entry.source.code += line + "\n";
+	}
+	includeStack.pop_back();
+	return true;
+}
+
+inline bool ShaderPreprocessor::stampFile(const std::string& path, File_stamp& stamp)
+{
+	struct stat status;
+	if (stat(path.c_str(), &status) != 0)
+		return false;
+	stamp.modified = (long long)status.st_mtime;
+	stamp.size = (long long)status.st_size;
+	return true;
+}
+
+inline std::string ShaderPreprocessor::directoryOf(const std::string& path)
+{
+	size_t slash = path.find_last_of("/\\");
+	return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+#endif
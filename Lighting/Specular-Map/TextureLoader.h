@@ -0,0 +1,483 @@
+#ifndef TEXTURE_LOADER_H
+#define TEXTURE_LOADER_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <algorithm>
+#include <functional>
+
+#include "glad/glad.h"
+#include "GLFW/glfw3.h"
+#include "stb_image.h"
+
+#include "ThreadPool.h"
+#include "PixelBufferPool.h"
+#include "KtxTexture.h"
+#include "MipGenerator.h"
+#include "TextureStreamer.h"
+#include "ChannelPacking.h"
+
+/* Texture upload paths */
+enum class Texture_upload {
+	/* glTexImage2D straight from the decoded client memory */
+	DIRECT,
+	/* Copy every level into a mapped pixel unpack buffer on a worker, glTexSubImage2D from the buffer */
+	PIXEL_BUFFER
+};
+
+/* Asynchronous texture loader.
+Images are decoded by stbi_load on a pool of worker threads, the returned texture has
+a 1x1 placeholder bound right away. The decoded pixels are uploaded on the GL thread by
+Update(), which stops after the given time budget so a frame never stalls on loading.
+The mip chain is filtered by MipGenerator on the same worker and uploaded level by level.
+A baked .ktx file next to the image (see Tools/Texture-Baker) is used instead of decoding it */
+class TextureLoader
+{
+public:
+	/* Constructor and destructor */
+	TextureLoader(Texture_upload uploadPath, unsigned int threadCount);
+	~TextureLoader() noexcept;
+
+	/* Queue the image for decoding, returns the texture with the placeholder bound.
+	srgb tells the mip filter the image holds color, not data like a specular mask */
+	unsigned int Load(const char* path, bool srgb);
+	/* Queue the color image with the intensity of the mask image in its alpha, see ChannelPacking.
+	Loads the baked colorPath_packed.ktx instead when it exists */
+	unsigned int LoadPacked(const char* colorPath, const char* maskPath);
+	/* Upload the decoded images, returns how many textures became resident */
+	unsigned int Update(double budgetMs);
+
+	/* Get functions */
+	/* Decoded images are waiting for Update() */
+	bool UploadsPending();
+	/* Every requested texture is resident */
+	bool AllResident() const noexcept;
+	/* Megabytes per second of GL thread time spent in the upload calls */
+	double UploadThroughput() const noexcept;
+
+public:
+	/* Upload path, can be switched between the loads */
+	Texture_upload UploadPath;
+	/* Load image.ktx instead of decoding image.png when it exists */
+	bool PreferBaked;
+	/* Filter the mip chain on the workers, glGenerateMipmap on the GL thread otherwise */
+	bool CpuMips;
+	Mip_filter MipFilter;
+	/* Hand textures with a mip chain to the streamer instead of uploading every level, null to upload all */
+	TextureStreamer* Streamer;
+	/* Statistics */
+	unsigned int Requested;
+	unsigned int Resident;
+	unsigned int Failed;
+	/* Pixel bytes uploaded and the GL thread milliseconds spent on it */
+	unsigned long long UploadedBytes;
+	double UploadMs;
+	/* Called on the GL thread when a texture is uploaded with its size in bytes, or failed with 0 */
+	std::function<void(unsigned int, size_t)> Finished;
+
+private:
+	/* Decoded image waiting for the upload */
+	struct Decoded_image {
+		unsigned int texture;
+		std::string path;
+		/* Packed into the alpha, empty for plain images */
+		std::string maskPath;
+		bool srgb;
+		/* Decoded or baked levels, null when loading failed. Only level 0 when the driver builds the mips */
+		std::shared_ptr<KtxTexture> levels;
+		/* Pixel buffer holding a copy of all the levels, -1 when not staged */
+		int pixelBuffer;
+	};
+
+	/* Helper functions */
+	/* Create the texture with a 1x1 placeholder and queue its decode */
+	unsigned int queue(Decoded_image image);
+	/* Decode the image and filter its mips, runs on a worker thread */
+	void decode(Decoded_image image);
+	/* Put the intensity of the mask into the alpha of the decoded RGBA pixels */
+	static bool packMask(const std::string& maskPath, unsigned char* rgba, int width, int height);
+	/* Copy the levels into the mapped pixel buffer, runs on a worker thread */
+	void stage(Decoded_image image, void* mapped);
+	/* Map pixel buffers for the decoded images and hand the copies to the workers */
+	void startStaging();
+	/* Upload every level, from the pixel buffer when staged. Runs on the GL thread, returns the texture size */
+	size_t upload(Decoded_image& image);
+	/* The streamer takes the texture, it has a mip chain to stream */
+	bool streamed(const Decoded_image& image) const noexcept;
+	/* Single channel maps (BC4 or grey images) read the same as grey RGB ones, two channel ones as grey and alpha */
+	static void setSwizzle(const KtxTexture& levels);
+	/* Load the baked file of the image, null if there is none or the GPU can't sample it */
+	std::shared_ptr<KtxTexture> loadBaked(const std::string& path) const;
+	/* The GPU can sample the baked compressed format */
+	bool compressedFormatSupported(GLenum format) const;
+	static GLenum formatOf(int components) noexcept;
+private:
+	ThreadPool workers;
+	PixelBufferPool pixelBuffers;
+	/* Compressed formats the driver lists, read once on the GL thread. Only trusted for S3TC */
+	std::vector<GLint> compressedFormats;
+
+	std::mutex imagesMutex;
+	/* Decoded, not staged yet */
+	std::vector<Decoded_image> decoded;
+	/* Copied into a pixel buffer, ready for glTexSubImage2D */
+	std::vector<Decoded_image> staged;
+	/* Copies running on the workers */
+	unsigned int staging;
+};
+
+
+TextureLoader::TextureLoader(Texture_upload uploadPath = Texture_upload::PIXEL_BUFFER,
+	unsigned int threadCount = ThreadPool::DefaultThreadCount())
+	: UploadPath(uploadPath), PreferBaked(true), CpuMips(true), MipFilter(Mip_filter::KAISER), Streamer(nullptr), Requested(0), Resident(0), Failed(0), UploadedBytes(0), UploadMs(0.0),
+	workers(threadCount), pixelBuffers(4), staging(0)
+{
+	GLint formatCount = 0;
+	glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &formatCount);
+	compressedFormats.resize(formatCount);
+	if (formatCount > 0)
+		glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, compressedFormats.data());
+}
+
+TextureLoader::~TextureLoader() noexcept
+{
+	/* Finish the running decodes and copies, they still write to the queues.
+	The dropped ones free their pixels with the image they captured, their pixel buffers are unmapped by the pool */
+	workers.CancelPending();
+	workers.WaitIdle();
+	/* The streamer may outlive the pixel buffers it borrowed */
+	if (Streamer && Streamer->PixelBuffers == &pixelBuffers)
+		Streamer->PixelBuffers = nullptr;
+}
+
+unsigned int TextureLoader::Load(const char* path, bool srgb = true)
+{
+	return queue(Decoded_image{ 0, std::string(path), std::string(), srgb, nullptr, -1 });
+}
+
+unsigned int TextureLoader::LoadPacked(const char* colorPath, const char* maskPath)
+{
+	/* The mask sits in alpha, which is never sRGB filtered */
+	return queue(Decoded_image{ 0, std::string(colorPath), std::string(maskPath), true, nullptr, -1 });
+}
+
+unsigned int TextureLoader::queue(Decoded_image image)
+{
+	Requested++;
+
+	unsigned int textureID;
+	glGenTextures(1, &textureID);
+
+	/* Grey placeholder, sampled until the real image arrives */
+	const unsigned char placeholder[4] = { 128, 128, 128, 255 };
+	glBindTexture(GL_TEXTURE_2D, textureID);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	image.texture = textureID;
+	workers.Submit([this, image] { decode(image); });
+
+	return textureID;
+}
+
+unsigned int TextureLoader::Update(double budgetMs)
+{
+	/* Stage first, the copies run on the workers while this frame renders */
+	if (UploadPath == Texture_upload::PIXEL_BUFFER)
+		startStaging();
+
+	std::vector<Decoded_image> ready;
+	{
+		std::lock_guard<std::mutex> lock(imagesMutex);
+		if (UploadPath == Texture_upload::PIXEL_BUFFER)
+			ready.swap(staged);
+		else
+			ready.swap(decoded);
+	}
+	if (ready.empty())
+		return 0;
+
+	/* Upload until the budget runs out, at least one image per call to keep progressing */
+	auto start = std::chrono::steady_clock::now();
+	unsigned int uploaded = 0;
+	size_t i = 0;
+	for (; i < ready.size(); i++) {
+		double spent = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		if (uploaded > 0 && spent >= budgetMs)
+			break;
+
+		unsigned int texture = ready[i].texture;
+		size_t bytes = 0;
+		if (ready[i].levels) {
+			bytes = upload(ready[i]);
+			Resident++;
+			uploaded++;
+		}
+		else
+			Failed++;
+		if (Finished)
+			Finished(texture, bytes);
+	}
+
+	/* Put the rest back in front of the images finished meanwhile */
+	if (i < ready.size()) {
+		std::lock_guard<std::mutex> lock(imagesMutex);
+		std::vector<Decoded_image>& queue = UploadPath == Texture_upload::PIXEL_BUFFER ? staged : decoded;
+		queue.insert(queue.begin(), ready.begin() + i, ready.end());
+	}
+
+	return uploaded;
+}
+
+bool TextureLoader::UploadsPending()
+{
+	std::lock_guard<std::mutex> lock(imagesMutex);
+	return !decoded.empty() || !staged.empty() || staging > 0;
+}
+
+inline bool TextureLoader::AllResident() const noexcept
+{
+	return Resident + Failed == Requested;
+}
+
+inline double TextureLoader::UploadThroughput() const noexcept
+{
+	return UploadMs > 0.0 ? (UploadedBytes / (1024.0 * 1024.0)) / (UploadMs / 1000.0) : 0.0;
+}
+
+void TextureLoader::decode(Decoded_image image)
+{
+	bool packed = !image.maskPath.empty();
+	if (PreferBaked)
+		image.levels = loadBaked(packed ? ChannelPacking::PackedPath(image.path) : image.path);
+
+	if (!image.levels) {
+		int width, height, nrComponents;
+		/* Packed textures decode the color as RGBA, the mask replaces the alpha.
+		Owned so the decoded pixels are freed on every path, the level copy below can throw */
+		std::unique_ptr<unsigned char, void(*)(void*)> data(
+			stbi_load(image.path.c_str(), &width, &height, &nrComponents, packed ? 4 : 0), stbi_image_free);
+		if (data && packed) {
+			nrComponents = 4;
+			if (!packMask(image.maskPath, data.get(), width, height))
+				data.reset();
+		}
+		if (data) {
+			std::shared_ptr<KtxTexture> levels = std::make_shared<KtxTexture>();
+			levels->GlType = GL_UNSIGNED_BYTE;
+			levels->GlFormat = levels->GlInternalFormat = levels->GlBaseInternalFormat = formatOf(nrComponents);
+			levels->Width = width;
+			levels->Height = height;
+			levels->Levels.emplace_back(data.get(), data.get() + (size_t)width * height * nrComponents);
+			data.reset();
+
+			/* Running on a worker already, so the levels are filtered single threaded */
+			if (CpuMips)
+				MipGenerator(MipFilter, image.srgb).Generate(levels->Levels, width, height, nrComponents, nullptr);
+			image.levels = levels;
+		}
+		else
+			std::cout << "Texture failed to load at path: " << image.path << std::endl;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(imagesMutex);
+		decoded.push_back(image);
+	}
+	/* Wake up the render loop in case it sleeps in glfwWaitEvents */
+	glfwPostEmptyEvent();
+}
+
+bool TextureLoader::packMask(const std::string& maskPath, unsigned char* rgba, int width, int height)
+{
+	int maskWidth, maskHeight, maskComponents;
+	unsigned char* mask = stbi_load(maskPath.c_str(), &maskWidth, &maskHeight, &maskComponents, 0);
+	if (!mask || maskWidth != width || maskHeight != height) {
+		std::cout << "Texture mask failed to load at path: " << maskPath << (mask ? " (size differs from the color)" : "") << std::endl;
+		stbi_image_free(mask);
+		return false;
+	}
+
+	if (!ChannelPacking::IsGrey(mask, maskComponents, (size_t)width * height))
+		std::cout << "Texture mask " << maskPath << " isn't grey, its channels are averaged into one" << std::endl;
+	ChannelPacking::PackIntensity(rgba, mask, maskComponents, (size_t)width * height);
+	stbi_image_free(mask);
+	return true;
+}
+
+void TextureLoader::stage(Decoded_image image, void* mapped)
+{
+	/* Levels back to back, upload() walks the same offsets */
+	unsigned char* target = (unsigned char*)mapped;
+	for (const std::vector<unsigned char>& level : image.levels->Levels) {
+		memcpy(target, level.data(), level.size());
+		target += level.size();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(imagesMutex);
+		staged.push_back(image);
+		staging--;
+	}
+	glfwPostEmptyEvent();
+}
+void TextureLoader::startStaging()
+{
+	std::lock_guard<std::mutex> lock(imagesMutex);
+	size_t i = 0;
+	for (; i < decoded.size(); i++) {
+		Decoded_image& image = decoded[i];
+		/* Failed decodes have nothing to copy, streamed levels are staged level by level when the streamer uploads them */
+		if (!image.levels || streamed(image)) {
+			staged.push_back(image);
+			continue;
+		}
+
+		void* mapped = nullptr;
+		image.pixelBuffer = pixelBuffers.Acquire((GLsizeiptr)image.levels->DataSize(), &mapped);
+		/* Every buffer is in flight, try again next frame */
+		if (image.pixelBuffer == PixelBufferPool::InFlight)
+			break;
+		/* The driver couldn't map it, retrying won't help - upload from client memory */
+		if (image.pixelBuffer == PixelBufferPool::MapFailed) {
+			image.pixelBuffer = -1;
+			staged.push_back(image);
+			continue;
+		}
+
+		staging++;
+		Decoded_image copy = image;
+		workers.Submit([this, copy, mapped] { stage(copy, mapped); });
+	}
+	decoded.erase(decoded.begin(), decoded.begin() + i);
+}
+
+size_t TextureLoader::upload(Decoded_image& image)
+{
+	auto start = std::chrono::steady_clock::now();
+	const KtxTexture& levels = *image.levels;
+
+	if (streamed(image)) {
+		/* The streamer stages its levels through the same pool on the pixel buffer path */
+		Streamer->PixelBuffers = UploadPath == Texture_upload::PIXEL_BUFFER ? &pixelBuffers : nullptr;
+		glBindTexture(GL_TEXTURE_2D, image.texture);
+		size_t residentBytes = Streamer->Register(image.texture, image.levels);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		setSwizzle(levels);
+
+		UploadedBytes += residentBytes;
+		UploadMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		image.levels.reset();
+		return residentBytes;
+	}
+
+	/* Rows of 1 and 3 component images aren't 4 byte aligned */
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glBindTexture(GL_TEXTURE_2D, image.texture);
+	if (image.pixelBuffer >= 0)
+		pixelBuffers.Bind(image.pixelBuffer);
+
+	size_t offset = 0;
+	for (unsigned int level = 0; level < levels.Levels.size(); level++) {
+		const std::vector<unsigned char>& data = levels.Levels[level];
+		/* With a bound unpack buffer the pointer is the offset of the level in it */
+		const void* pixels = image.pixelBuffer >= 0 ? (const void*)offset : (const void*)data.data();
+		int width = levels.LevelWidth(level), height = levels.LevelHeight(level);
+		if (levels.IsCompressed())
+			glCompressedTexImage2D(GL_TEXTURE_2D, level, levels.GlInternalFormat, width, height, 0, (GLsizei)data.size(), pixels);
+		else if (image.pixelBuffer >= 0) {
+			/* Allocate the storage, then source the pixels from the bound buffer */
+			glTexImage2D(GL_TEXTURE_2D, level, levels.GlInternalFormat, width, height, 0, levels.GlFormat, levels.GlType, NULL);
+			glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, width, height, levels.GlFormat, levels.GlType, pixels);
+		}
+		else
+			glTexImage2D(GL_TEXTURE_2D, level, levels.GlInternalFormat, width, height, 0, levels.GlFormat, levels.GlType, pixels);
+		offset += data.size();
+	}
+
+	if (image.pixelBuffer >= 0)
+		pixelBuffers.Release(image.pixelBuffer);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	/* Without CpuMips only level 0 arrives, the driver builds the rest */
+	GLint maxLevel = (GLint)levels.Levels.size() - 1;
+	size_t textureBytes = levels.DataSize();
+	if (maxLevel == 0 && !levels.IsCompressed() && (levels.Width > 1 || levels.Height > 1)) {
+		glGenerateMipmap(GL_TEXTURE_2D);
+		maxLevel = (GLint)MipGenerator::LevelCount(levels.Width, levels.Height) - 1;
+		/* The generated levels add about a third */
+		textureBytes += textureBytes / 3;
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, maxLevel);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, maxLevel > 0 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+	setSwizzle(levels);
+
+	UploadedBytes += levels.DataSize();
+	UploadMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	/* Drop the pixels, the texture has them now */
+	image.levels.reset();
+	return textureBytes;
+}
+
+std::shared_ptr<KtxTexture> TextureLoader::loadBaked(const std::string& path) const
+{
+	std::shared_ptr<KtxTexture> baked = std::make_shared<KtxTexture>();
+	if (!baked->Load(path.substr(0, path.find_last_of('.')) + ".ktx"))
+		return nullptr;
+
+	if (baked->IsCompressed() && !compressedFormatSupported(baked->GlInternalFormat)) {
+		std::cout << "Baked texture format not supported, decoding " << path << std::endl;
+		return nullptr;
+	}
+	return baked;
+}
+
+inline bool TextureLoader::streamed(const Decoded_image& image) const noexcept
+{
+	return Streamer && image.levels && image.levels->Levels.size() > 1;
+}
+
+inline void TextureLoader::setSwizzle(const KtxTexture& levels)
+{
+	if (levels.GlBaseInternalFormat == GL_RED) {
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_RED);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
+	}
+	/* Grey and alpha images, decoded or baked to BC5 */
+	else if (levels.GlBaseInternalFormat == GL_RG) {
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_RED);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_A, GL_GREEN);
+	}
+}
+
+inline bool TextureLoader::compressedFormatSupported(GLenum format) const
+{
+	/* RGTC is core since GL 3.0, yet drivers commonly leave it out of GL_COMPRESSED_TEXTURE_FORMATS */
+	if (format == GL_COMPRESSED_RED_RGTC1 || format == GL_COMPRESSED_SIGNED_RED_RGTC1 ||
+		format == GL_COMPRESSED_RG_RGTC2 || format == GL_COMPRESSED_SIGNED_RG_RGTC2)
+		return true;
+	/* S3TC is an extension, the queried list tells */
+	return std::find(compressedFormats.begin(), compressedFormats.end(), (GLint)format) != compressedFormats.end();
+}
+
+inline GLenum TextureLoader::formatOf(int components) noexcept
+{
+	/* See which color format the texture uses */
+	if (components == 1)
+		return GL_RED;
+	else if (components == 2)
+		return GL_RG;
+	else if (components == 4)
+		return GL_RGBA;
+	return GL_RGB;
+}
+
+#endif
@@ -7,15 +7,27 @@
 #include "glm/gtc/matrix_transform.hpp"
 
 #include "Shader.h"
+#include "ShaderPermutations.h"
 #include "Camera.h"
+#include "FrameScheduler.h"
+#include "TextureLoader.h"
+#include "TextureCache.h"
 
 #include <iostream>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <memory>
 
 
 void processInput(GLFWwindow* window);
 void frameBufferResize_callback(GLFWwindow* window, int width, int height);
 void mouseMovement_callback(GLFWwindow* window, double xPos, double yPos);
 void mouseScroll_callback(GLFWwindow* window, double xOffset, double yOffset);
+void windowRefresh_callback(GLFWwindow* window);
+bool isMoving(GLFWwindow* window);
+float screenFootprint(const glm::vec3& center, float radius);
+bool comparePackedShading(const std::function<void(bool)>& drawCube);
 
 unsigned int loadTexture(const char* path);
 
@@ -37,8 +49,76 @@ float lastFrame = 0.0f;
 /************************************ LIGHTING ************************************/
 glm::vec3 lightPos(1.2f, 1.0f, 2.0f);
 
-int main()
+/************************************ FRAME SCHEDULING ************************************/
+/* Render only when something changed, the scene is static otherwise */
+const bool renderOnDemand = true;
+FrameScheduler frameScheduler(renderOnDemand);
+unsigned int seenCameraVersion = 0;
+
+/************************************ TEXTURE LOADING ************************************/
+/* Decode the textures on worker threads, the first frames show placeholders */
+const bool asyncTextureLoading = true;
+/* Time every frame may spend uploading the decoded textures */
+const double textureUploadBudgetMs = 2.0;
+/* Stage the uploads through pixel buffers or upload from client memory (DIRECT) */
+const Texture_upload textureUploadPath = Texture_upload::PIXEL_BUFFER;
+/* Benchmark - additional copies of the textures to load, e.g. 128 */
+const unsigned int benchmarkTextureCount = 0;
+/* Share one texture between identical images, off to load every benchmark copy on its own */
+const bool textureCaching = true;
+/* Upload the small mips first and stream in what the cube's size on screen needs */
+const bool textureStreaming = true;
+/* GPU memory the streamed levels may use, the always resident small levels included */
+const size_t textureStreamingBudget = 8 * 1024 * 1024;
+/* Time every frame may spend streaming in levels */
+const double textureStreamingBudgetMs = 1.0;
+
+/************************************ MATERIAL ************************************/
+/* Diffuse color and specular intensity in one RGBA texture (Tools/Texture-Baker --pack), one fetch per fragment */
+const bool packedMaterial = true;
+/* Render the cube once with the packed and once with the separate maps and compare the images.
+Run with --verify-packed, the demo closes after the comparison and exits with 1 if any pixel differs */
+bool verifyPackedShading = false;
+
+/************************************ SHADER VARIANTS ************************************/
+/* Features of shaders/uber.fs, bit i defines materialFeatureNames[i] */
+enum Material_feature : unsigned int {
+	LIGHT_AMBIENT = 1 << 0,
+	LIGHT_DIFFUSE = 1 << 1,
+	LIGHT_SPECULAR = 1 << 2,
+	DIFFUSE_MAP = 1 << 3,
+	SPECULAR_MAP = 1 << 4,
+	PACKED_MAP = 1 << 5
+};
+const std::vector<std::string> materialFeatureNames = { "LIGHT_AMBIENT", "LIGHT_DIFFUSE", "LIGHT_SPECULAR", "DIFFUSE_MAP", "SPECULAR_MAP", "PACKED_MAP" };
+const unsigned int phongFeatures = LIGHT_AMBIENT | LIGHT_DIFFUSE | LIGHT_SPECULAR;
+/* Keep the linked variants as program binaries next to the shader and load them on the next run.
+They only suit the GPU and driver that wrote them, git ignores them */
+const bool shaderBinaryCache = true;
+/* Compile the vertex shader once and combine it with every fragment variant in a program pipeline */
+const bool separableStages = true;
+
+/* Cubes beside the container, their constant colors need no maps and the matte ones no specular */
+struct Gallery_cube {
+	unsigned int features;
+	glm::vec3 position;
+	glm::vec3 diffuseColor;
+	glm::vec3 specularColor;
+};
+const Gallery_cube galleryCubes[] = {
+	{ LIGHT_AMBIENT | LIGHT_DIFFUSE, { -2.0f, 0.0f, -1.0f }, { 0.8f, 0.4f, 0.3f }, { 0.0f, 0.0f, 0.0f } },
+	{ phongFeatures, { 2.0f, 0.0f, -1.0f }, { 0.2f, 0.4f, 0.8f }, { 0.5f, 0.5f, 0.5f } },
+	{ 0, { 0.0f, 1.5f, -2.0f }, { 1.0f, 0.5f, 0.31f }, { 0.0f, 0.0f, 0.0f } }
+};
+
+int main(int argc, char** argv)
 {
+	for (int i = 1; i < argc; i++) {
+		if (std::string(argv[i]) == "--verify-packed")
+			verifyPackedShading = true;
+	}
+
+
 	/************************************ INITIALIZATION ************************************/
 	glfwInit();
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
@@ -63,6 +143,7 @@ int main()
 	glfwSetFramebufferSizeCallback(window, frameBufferResize_callback);
 	glfwSetCursorPosCallback(window, mouseMovement_callback);
 	glfwSetScrollCallback(window, mouseScroll_callback);
+	glfwSetWindowRefreshCallback(window, windowRefresh_callback);
 
 	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
@@ -144,90 +225,241 @@ int main()
 	glEnableVertexAttribArray(0);
 
 	/************************************ TEXTURES ************************************/
-	unsigned int diffuseMap = loadTexture("textures/container2.png");
-	unsigned int specularMap = loadTexture("textures/container2_specular.png");
+	/* Baked .ktx files in textures (Tools/Texture-Baker) are loaded instead of the images if present */
+	TextureStreamer textureStreamer(textureStreamingBudget);
+	TextureLoader textureLoader(textureUploadPath);
+	if (textureStreaming)
+		textureLoader.Streamer = &textureStreamer;
+	/* Bakes quantize the packed and the separate maps differently, decoded images must match exactly */
+	if (verifyPackedShading)
+		textureLoader.PreferBaked = false;
+	double textureRequestTime = glfwGetTime();
+	/* Color maps get their mips averaged in linear space, data maps as they are */
+	TextureCache textureCache(textureLoader);
+	auto requestTexture = [&textureLoader, &textureCache](const char* path, bool srgb) {
+		if (!asyncTextureLoading)
+			return loadTexture(path);
+		Texture_params params;
+		params.srgb = srgb;
+		return textureCaching ? textureCache.Acquire(path, params) : textureLoader.Load(path, srgb);
+	};
+	auto releaseTexture = [&textureCache](unsigned int texture) {
+		if (asyncTextureLoading && textureCaching)
+			textureCache.Release(texture);
+		else
+			glDeleteTextures(1, &texture);
+	};
+
+	unsigned int diffuseMap = 0, specularMap = 0, packedMap = 0;
+	if (!packedMaterial || verifyPackedShading) {
+		diffuseMap = requestTexture("textures/container2.png", true);
+		specularMap = requestTexture("textures/container2_specular.png", false);
+	}
+	/* The packed texture is built from two files, it doesn't go through the cache */
+	if (packedMaterial || verifyPackedShading)
+		packedMap = textureLoader.LoadPacked("textures/container2.png", "textures/container2_specular.png");
+	unsigned int materialTextureCount = (diffuseMap ? 2 : 0) + (packedMap ? 1 : 0);
+
+	std::vector<unsigned int> benchmarkTextures;
+	for (unsigned int i = 0; i < benchmarkTextureCount; i++)
+		benchmarkTextures.push_back(requestTexture(i % 2 ? "textures/container2_specular.png" : "textures/container2.png", i % 2 == 0));
+	bool texturesReported = false;
+	bool packedShadingVerified = false;
+	bool packedShadingMatches = true;
 
 	/************************************ SHADERS ************************************/
-	Shader lightingShader("shaders/shader.vs", "shaders/shader.fs");
-	Shader lightCubeShader("shaders/lightCube.vs", "shaders/lightCube.fs");
+	/* One source for every material, each gets the variant of its own features */
+	ShaderPermutations materialShaders("shaders/shader.vs", "shaders/uber.fs", materialFeatureNames, shaderBinaryCache ? "shaders/uber" : "", separableStages);
+	/* The lamp only needs the transform, it reuses the materials' vertex stage if that is separable */
+	unsigned int lightCubeStage = 0;
+	std::unique_ptr<Shader> lightCubeShader;
+	if (materialShaders.Separable()) {
+		lightCubeStage = Shader::CreateStage(GL_FRAGMENT_SHADER, "shaders/lightCube.fs");
+		lightCubeShader.reset(new Shader(materialShaders.VertexStage(), lightCubeStage));
+	}
+	else
+		lightCubeShader.reset(new Shader("shaders/lightCube.vs", "shaders/lightCube.fs"));
+	const unsigned int packedFeatures = phongFeatures | PACKED_MAP;
+	const unsigned int separateFeatures = phongFeatures | DIFFUSE_MAP | SPECULAR_MAP;
+	/* Issue the compiles of all used variants at once, the first frame waits for them together */
+	std::vector<unsigned int> usedVariants;
+	if (packedMaterial || verifyPackedShading)
+		usedVariants.push_back(packedFeatures);
+	if (!packedMaterial || verifyPackedShading)
+		usedVariants.push_back(separateFeatures);
+	for (const Gallery_cube& cube : galleryCubes)
+		usedVariants.push_back(cube.features);
+	materialShaders.Prepare(usedVariants);
 
 	/************************************ RENDER LOOP ************************************/
 	glEnable(GL_DEPTH_TEST);
+	lastFrame = glfwGetTime();
 	while (!glfwWindowShouldClose(window)) {
+		float currentFrame = glfwGetTime();
+		deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+
 		processInput(window);
 
+		/* Upload the textures decoded meanwhile, they replace the placeholders */
+		if (textureLoader.Update(textureUploadBudgetMs) > 0)
+			frameScheduler.MarkDirty();
+		if (!texturesReported && textureLoader.AllResident()) {
+			std::cout << "All " << materialTextureCount + benchmarkTextureCount << " textures resident after "
+				<< (glfwGetTime() - textureRequestTime) * 1000.0 << " ms" << std::endl;
+			if (asyncTextureLoading)
+				std::cout << "Uploaded " << textureLoader.UploadedBytes / (1024.0 * 1024.0) << " MB in "
+				<< textureLoader.UploadMs << " ms of GL thread time (" << textureLoader.UploadThroughput() << " MB/s)" << std::endl;
+			if (asyncTextureLoading && textureCaching)
+				std::cout << "Texture cache: " << textureCache.TextureCount() << " textures for " << textureCache.Lookups
+				<< " requests (" << textureCache.HitRate() * 100.0f << "% hits, " << textureCache.FilesHashed << " files hashed), "
+				<< textureCache.ResidentBytes / (1024.0 * 1024.0) << " MB resident" << std::endl;
+			texturesReported = true;
+		}
+
+		/* Redraw only if the camera moved, a key is held or the window changed */
+		frameScheduler.TrackVersion(seenCameraVersion, camera.Version);
+		frameScheduler.SetAnimating(isMoving(window) || textureLoader.UploadsPending() || textureStreamer.StreamingPending() ||
+			(verifyPackedShading && !packedShadingVerified));
+		if (!frameScheduler.ShouldRender()) {
+			/* Keep the last presented frame, restart the timer after sleeping */
+			if (frameScheduler.WaitForEvents())
+				lastFrame = glfwGetTime();
+			continue;
+		}
+
 		glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-		glm::vec3 lightColor;
-		lightColor.x = sin(glfwGetTime() * 2.0f);
-		lightColor.y = sin(glfwGetTime() * 0.7f);
-		lightColor.z = sin(glfwGetTime() * 1.3f);
-
-		glm::vec3 diffuseColor = lightColor * glm::vec3(0.5f);
-		glm::vec3 ambientColor = lightColor * glm::vec3(0.2f);
-
-		/* Set the light colors */
-		lightingShader.use();
-		lightingShader.setVec3("light.ambient", 0.2f, 0.2f, 0.2f);
-		lightingShader.setVec3("light.diffuse", 0.5f, 0.5f, 0.5f); // darkened
-		lightingShader.setVec3("light.specular", 1.0f, 1.0f, 1.0f);
-		lightingShader.setVec3("light.position", lightPos);
-		lightingShader.setVec3("viewPos", camera.Position);
-		/* Set the material colors */
-		lightingShader.setInt("material.diffuse", 0);
-		lightingShader.setInt("material.specular", 1);
-		lightingShader.setFloat("material.shininess", 32.0f);
-
 		/* View and projection transformations */
 		glm::mat4 view;
 		view = camera.GetViewMatrix();
 		glm::mat4 projection =
 			glm::perspective(glm::radians(camera.Zoom), (float)winWidth / winHeight, 0.1f, 100.0f);
-		lightingShader.setMat4f("view", view);
-		lightingShader.setMat4f("projection", projection);
 
-		/* World transformation */
-		glm::mat4 model = glm::mat4(1.0f);
-		lightingShader.setMat4f("model", model);
-
-		/* Use the correct texture */
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, diffuseMap);
+		/* The maps cover the cube, ask for the mips of its size on screen */
+		float footprint = screenFootprint(glm::vec3(0.0f), 0.87f);
+		textureStreamer.RequestFootprint(diffuseMap, footprint);
+		textureStreamer.RequestFootprint(specularMap, footprint);
+		textureStreamer.RequestFootprint(packedMap, footprint);
+
+		/* Bind the variant and set what every material shares */
+		auto useMaterialShader = [&](unsigned int features) -> Shader& {
+			Shader& shader = materialShaders.Get(features);
+			/* Set the light colors */
+			shader.use();
+			shader.setVec3("light.ambient", 0.2f, 0.2f, 0.2f);
+			shader.setVec3("light.diffuse", 0.5f, 0.5f, 0.5f); // darkened
+			shader.setVec3("light.specular", 1.0f, 1.0f, 1.0f);
+			shader.setVec3("light.position", lightPos);
+			shader.setVec3("viewPos", camera.Position);
+
+			shader.setMat4f("view", view);
+			shader.setMat4f("projection", projection);
+			return shader;
+		};
+
+		auto drawCube = [&](bool packed) {
+			Shader& shader = useMaterialShader(packed ? packedFeatures : separateFeatures);
+			/* Set the material colors */
+			if (packed)
+				shader.setInt("material.diffuseSpecular", 0);
+			else {
+				shader.setInt("material.diffuse", 0);
+				shader.setInt("material.specular", 1);
+			}
+			shader.setFloat("material.shininess", 32.0f);
+
+			/* World transformation */
+			shader.setMat4f("model", glm::mat4(1.0f));
+
+			/* Use the correct texture */
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, packed ? packedMap : diffuseMap);
+			if (!packed) {
+				glActiveTexture(GL_TEXTURE1);
+				glBindTexture(GL_TEXTURE_2D, specularMap);
+			}
+
+			/* Render the cube */
+			glBindVertexArray(cubeVAO);
+			glDrawArrays(GL_TRIANGLES, 0, 36);
+		};
+
+		/* Both versions need their final levels, or the comparison sees streaming differences */
+		if (verifyPackedShading && !packedShadingVerified && texturesReported && !textureStreamer.StreamingPending()) {
+			packedShadingMatches = comparePackedShading(drawCube);
+			packedShadingVerified = true;
+			glfwSetWindowShouldClose(window, true);
+		}
 
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, specularMap);
+		glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		drawCube(packedMaterial);
 
-		/* Render the cube */
-		glBindVertexArray(cubeVAO);
-		glDrawArrays(GL_TRIANGLES, 0, 36);
+		/* Draw the gallery, the cube VAO is still bound */
+		for (const Gallery_cube& cube : galleryCubes) {
+			Shader& shader = useMaterialShader(cube.features);
+			shader.setVec3("material.diffuseColor", cube.diffuseColor);
+			shader.setVec3("material.specularColor", cube.specularColor);
+			shader.setFloat("material.shininess", 32.0f);
+			glm::mat4 model = glm::mat4(1.0f);
+			model = glm::translate(model, cube.position);
+			shader.setMat4f("model", model);
+			glDrawArrays(GL_TRIANGLES, 0, 36);
+		}
 
 
 		/* Draw the lamp object */
-		lightCubeShader.use();
-		lightCubeShader.setMat4f("projection", projection);
-		lightCubeShader.setMat4f("view", view);
-		model = glm::mat4(1.0f);
+		lightCubeShader->use();
+		lightCubeShader->setMat4f("projection", projection);
+		lightCubeShader->setMat4f("view", view);
+		glm::mat4 model = glm::mat4(1.0f);
 		model = glm::translate(model, lightPos);
 		model = glm::scale(model, glm::vec3(0.2f)); // Make the cube smaller
-		lightCubeShader.setMat4f("model", model);
+		lightCubeShader->setMat4f("model", model);
 
 		glBindVertexArray(lightVAO);
 		glDrawArrays(GL_TRIANGLES, 0, 36);
 
 
-		float currentFrame = glfwGetTime();
-		deltaTime = currentFrame - lastFrame;
-		lastFrame = currentFrame;
-
 		glfwSwapBuffers(window);
-		glfwPollEvents();
+		frameScheduler.FramePresented();
+
+		/* Stream the levels this frame asked for, the next one samples them */
+		if (textureStreaming && textureStreamer.Update(textureStreamingBudgetMs)) {
+			frameScheduler.MarkDirty();
+			std::cout << "Texture streaming: " << textureStreamer.ResidentBytes / 1024 << " KB resident, "
+				<< textureStreamer.RequestedBytes / 1024 << " KB requested, budget " << textureStreamer.BudgetBytes / 1024 << " KB ("
+				<< textureStreamer.LevelsStreamedIn << " levels streamed in, " << textureStreamer.LevelsEvicted << " evicted)" << std::endl;
+		}
+		if (frameScheduler.FramesRendered == 1) {
+			std::cout << "Time to first frame: " << glfwGetTime() * 1000.0 << " ms" << std::endl;
+			std::cout << "Shader variants: " << materialShaders.VariantCount() << " of " << (1u << materialFeatureNames.size()) << " used, "
+				<< materialShaders.VariantsCompiled << " compiled, " << materialShaders.VariantsLoaded << " loaded as binaries in "
+				<< materialShaders.CompileMs << " ms, " << materialShaders.StagesCompiled << " stages compiled"
+				<< (materialShaders.Separable() ? " (separable)" : "") << std::endl;
+			std::cout << "Shader sources: " << Shader::Preprocessor().Loads << " loads, " << Shader::Preprocessor().Hits << " from the cache, "
+				<< Shader::Preprocessor().FilesRead << " files read" << std::endl;
+		}
+		if (frameScheduler.WaitForEvents())
+			lastFrame = glfwGetTime();
 	}
 
+	lightCubeShader.reset();
+	glDeleteProgram(lightCubeStage);
 	glDeleteVertexArrays(1, &cubeVAO);
 	glDeleteVertexArrays(1, &lightVAO);
 	glDeleteBuffers(1, &VBO);
+	if (diffuseMap) {
+		releaseTexture(diffuseMap);
+		releaseTexture(specularMap);
+	}
+	glDeleteTextures(1, &packedMap);
+	for (unsigned int texture : benchmarkTextures)
+		releaseTexture(texture);
 	glfwTerminate();
+	return packedShadingMatches ? 0 : 1;
 }
 
 
@@ -247,9 +479,22 @@ void processInput(GLFWwindow* window)
 		camera.ProcessKeyboard(Camera_movement::RIGHT, deltaTime);
 }
 
+bool isMoving(GLFWwindow* window)
+{
+	return glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS ||
+		glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS;
+}
+
 void frameBufferResize_callback(GLFWwindow* window, int width, int height)
 {
 	glViewport(0, 0, width, height);
+	frameScheduler.MarkDirty();
+}
+
+void windowRefresh_callback(GLFWwindow* window)
+{
+	/* Window was uncovered or damaged, its contents have to be drawn again */
+	frameScheduler.MarkDirty();
 }
 
 void mouseMovement_callback(GLFWwindow* window, double xPos, double yPos)
@@ -304,4 +549,63 @@ unsigned int loadTexture(const char* path)
 	stbi_image_free(data);
 
 	return textureID;
-}
\ No newline at end of file
+}
+
+float screenFootprint(const glm::vec3& center, float radius)
+{
+	/* Diameter in pixels of the bounding sphere, the whole screen height when the camera is inside it */
+	float distance = glm::length(center - camera.Position);
+	if (distance <= radius)
+		return (float)winHeight;
+	return radius / (distance * std::tan(glm::radians(camera.Zoom) / 2.0f)) * winHeight;
+}
+
+bool comparePackedShading(const std::function<void(bool)>& drawCube)
+{
+	/* Offscreen target, the window's back buffer may be scaled or lose pixels to overlapping windows */
+	unsigned int framebuffer, colorBuffer, depthBuffer;
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glGenRenderbuffers(1, &colorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, winWidth, winHeight);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+	glGenRenderbuffers(1, &depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, winWidth, winHeight);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	glViewport(0, 0, winWidth, winHeight);
+
+	std::vector<unsigned char> images[2];
+	for (int packed = 0; packed < 2; packed++) {
+		glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		drawCube(packed == 1);
+		images[packed].resize((size_t)winWidth * winHeight * 4);
+		glReadPixels(0, 0, winWidth, winHeight, GL_RGBA, GL_UNSIGNED_BYTE, images[packed].data());
+	}
+
+	size_t differing = 0;
+	int maxDifference = 0;
+	for (size_t i = 0; i < images[0].size(); i += 4) {
+		int difference = 0;
+		for (int c = 0; c < 3; c++)
+			difference = std::max(difference, std::abs(images[0][i + c] - images[1][i + c]));
+		if (difference > 0)
+			differing++;
+		maxDifference = std::max(maxDifference, difference);
+	}
+	/* Runtime packing and rgba8 bakes match exactly, BC3 bakes quantize both in their blocks */
+	std::cout << "Packed shading: " << differing << " of " << (size_t)winWidth * winHeight << " pixels differ from the separate maps"
+		<< ", max difference " << maxDifference << (differing ? "" : " - identical") << std::endl;
+
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glDeleteRenderbuffers(1, &colorBuffer);
+	glDeleteRenderbuffers(1, &depthBuffer);
+	glDeleteFramebuffers(1, &framebuffer);
+	return differing == 0;
+}
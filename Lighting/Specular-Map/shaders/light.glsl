@@ -0,0 +1,23 @@
+#pragma once
+// Point light and the Phong factors shared by the material shaders
+
+struct Light {
+  vec3 position;
+
+  vec3 ambient;
+  vec3 diffuse;
+  vec3 specular;
+};
+
+uniform Light light;
+
+float diffuseFactor(vec3 norm, vec3 lightDir)
+{
+  return max(dot(norm, lightDir), 0.0);
+}
+
+float specularFactor(vec3 norm, vec3 lightDir, vec3 viewDir, float shininess)
+{
+  vec3 reflectDir = reflect(-lightDir, norm);
+  return pow(max(dot(viewDir, reflectDir), 0.0), shininess);
+}
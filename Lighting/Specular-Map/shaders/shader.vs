@@ -1,4 +1,11 @@
 #version 330 core
+#ifdef SEPARABLE_STAGE
+#extension GL_ARB_separate_shader_objects : enable
+// Separable vertex stages declare the built-in outputs they write
+out gl_PerVertex {
+  vec4 gl_Position;
+};
+#endif
 layout (location = 0) in vec3 aPosition;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
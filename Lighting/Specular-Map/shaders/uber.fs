@@ -0,0 +1,88 @@
+#version 330 core
+
+// Features, defined after the version line by ShaderPermutations:
+//   LIGHT_AMBIENT, LIGHT_DIFFUSE, LIGHT_SPECULAR - the lighting terms, without any the color is unlit
+//   DIFFUSE_MAP  - diffuse color from material.diffuse instead of material.diffuseColor
+//   SPECULAR_MAP - specular intensity from material.specular instead of material.specularColor
+//   PACKED_MAP   - diffuse color in rgb, specular intensity in a - one fetch instead of two
+
+struct Material {
+#if defined(PACKED_MAP)
+  sampler2D diffuseSpecular;
+#else
+#if defined(DIFFUSE_MAP)
+  sampler2D diffuse;
+#else
+  vec3 diffuseColor;
+#endif
+#if defined(SPECULAR_MAP)
+  sampler2D specular;
+#else
+  vec3 specularColor;
+#endif
+#endif
+  float shininess;
+};
+
+out vec4 fragColor;
+
+in vec3 Normal;
+in vec3 fragPos;
+in vec2 texCoords;
+
+uniform vec3 viewPos;
+uniform Material material;
+
+#include "light.glsl"
+
+void main()
+{
+#if defined(PACKED_MAP)
+  vec4 texel = texture(material.diffuseSpecular, texCoords);
+  vec3 diffuseColor = texel.rgb;
+  vec3 specularColor = vec3(texel.a);
+#else
+#if defined(DIFFUSE_MAP)
+  vec3 diffuseColor = vec3(texture(material.diffuse, texCoords));
+#else
+  vec3 diffuseColor = material.diffuseColor;
+#endif
+#if defined(SPECULAR_MAP)
+  vec3 specularColor = vec3(texture(material.specular, texCoords));
+#else
+  vec3 specularColor = material.specularColor;
+#endif
+#endif
+
+#if !defined(LIGHT_AMBIENT) && !defined(LIGHT_DIFFUSE) && !defined(LIGHT_SPECULAR)
+  // unlit, the object color under a white light
+  vec3 result = diffuseColor;
+#else
+  vec3 result = vec3(0.0);
+
+#if defined(LIGHT_AMBIENT)
+  // ambient same as diffuse
+  result += light.ambient * diffuseColor;
+#endif
+
+#if defined(LIGHT_DIFFUSE) || defined(LIGHT_SPECULAR)
+  vec3 norm = normalize(Normal);
+  vec3 lightDir = normalize(light.position - fragPos);
+#endif
+
+#if defined(LIGHT_DIFFUSE)
+  // diffuse
+  float diff = diffuseFactor(norm, lightDir);
+  result += light.diffuse * diff * diffuseColor;
+#endif
+
+#if defined(LIGHT_SPECULAR)
+  // specular
+  vec3 viewDir = normalize(viewPos - fragPos);
+  float spec = specularFactor(norm, lightDir, viewDir, material.shininess);
+  result += light.specular * (spec * specularColor);
+#endif
+#endif
+
+  fragColor = vec4(result, 1.0);
+}
@@ -0,0 +1,109 @@
+#ifndef GPU_TIMER_H
+#define GPU_TIMER_H
+
+#include "glad/glad.h"
+
+/* GPU time of a range of commands, measured with GL_TIME_ELAPSED queries, or
+another query result like the GL_SAMPLES_PASSED fragment count.
+The results arrive a few frames late, a small ring of queries keeps the
+measurement from stalling the pipeline. Ranges of one target may not nest */
+class GpuTimer
+{
+public:
+	/* Constructor and destructor */
+	explicit GpuTimer(GLenum target);
+	~GpuTimer() noexcept;
+
+	/* Measure the commands between Begin() and End(). Skipped if every query still waits for its result */
+	void Begin();
+	void End();
+	/* Average of the results collected since the last Reset() */
+	double Average();
+	/* Average() of a GL_TIME_ELAPSED timer in milliseconds */
+	double AverageMs();
+	void Reset() noexcept;
+
+private:
+	static const int queryCount = 4;
+
+	/* Helper functions */
+	/* Add the finished results to the sum */
+	void collect();
+private:
+	GLenum target;
+	unsigned int queries[queryCount];
+	bool pending[queryCount];
+	int next;
+	bool running;
+	double total;
+	unsigned int samples;
+};
+
+
+GpuTimer::GpuTimer(GLenum target = GL_TIME_ELAPSED) : target(target), next(0), running(false), total(0.0), samples(0)
+{
+	glGenQueries(queryCount, queries);
+	for (bool& query : pending)
+		query = false;
+}
+
+GpuTimer::~GpuTimer() noexcept
+{
+	glDeleteQueries(queryCount, queries);
+}
+
+void GpuTimer::Begin()
+{
+	collect();
+	if (pending[next])
+		return;
+	glBeginQuery(target, queries[next]);
+	running = true;
+}
+
+void GpuTimer::End()
+{
+	if (!running)
+		return;
+	glEndQuery(target);
+	pending[next] = true;
+	next = (next + 1) % queryCount;
+	running = false;
+}
+
+inline double GpuTimer::Average()
+{
+	collect();
+	return samples ? total / samples : 0.0;
+}
+
+inline double GpuTimer::AverageMs()
+{
+	/* Nanoseconds */
+	return Average() / 1000000.0;
+}
+
+inline void GpuTimer::Reset() noexcept
+{
+	total = 0.0;
+	samples = 0;
+}
+
+void GpuTimer::collect()
+{
+	for (int i = 0; i < queryCount; i++) {
+		if (!pending[i])
+			continue;
+		GLint available = 0;
+		glGetQueryObjectiv(queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+			continue;
+		GLuint64 result = 0;
+		glGetQueryObjectui64v(queries[i], GL_QUERY_RESULT, &result);
+		total += (double)result;
+		samples++;
+		pending[i] = false;
+	}
+}
+
+#endif
@@ -0,0 +1,219 @@
+#ifndef INDIRECT_DRAW_LIST_H
+#define INDIRECT_DRAW_LIST_H
+
+#include <vector>
+#include <chrono>
+#include <cstring>
+
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+
+#include "ThreadPool.h"
+#include "Frustum.h"
+#include "StaticBatcher.h"
+
+/* Layout of GL_DRAW_INDIRECT_BUFFER for glMultiDrawElementsIndirect */
+struct Draw_elements_indirect_command {
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;
+};
+
+/* Every object of a StaticBatcher as its own draw, submitted in a handful of calls.
+Build() culls the objects on the thread pool, each task writes the commands of its visible
+objects into its own slice and the slices are packed after. With ARB_multi_draw_indirect (and
+ARB_base_instance, both core in GL 4.3) the commands go to an indirect buffer and one
+glMultiDrawElementsIndirect draws everything. The baseInstance of a command is the object's
+index, so the per instance attribute at MaterialLocation reads the object's material. GL 3.3
+draws each material with one glMultiDrawElementsBaseVertex instead, the material is then the
+current value of the disabled attribute */
+class IndirectDrawList
+{
+public:
+	/* Constructor and destructor */
+	IndirectDrawList(const StaticBatcher& batcher, unsigned int materialLocation);
+	~IndirectDrawList() noexcept;
+
+	/* Write the draws of the objects inside the frustum, or of every object without culling */
+	void Build(ThreadPool& pool, const Frustum& frustum, bool culling);
+	/* Submit the draws of the last Build() */
+	void Draw();
+
+	/* Get functions */
+	unsigned int DrawCount() const noexcept;
+
+public:
+	/* Vertex attribute location of the material index, an unsigned int */
+	const unsigned int MaterialLocation;
+	/* glMultiDrawElementsIndirect, else the GL 3.3 fallback */
+	const bool Indirect;
+	/* Statistics */
+	double BuildMs;
+	/* GL calls that drew in the last Draw() */
+	unsigned int Calls;
+
+private:
+	/* Draws of one material, for the fallback */
+	struct Material_range {
+		unsigned int material;
+		unsigned int first;
+		unsigned int count;
+	};
+
+	/* Helper functions */
+	static bool multiDrawIndirectSupported();
+private:
+	const StaticBatcher& batcher;
+	/* Indexed like the batcher's objects while building, packed to the visible draws after */
+	std::vector<Draw_elements_indirect_command> commands;
+	std::vector<unsigned int> sliceCounts;
+	std::vector<Material_range> ranges;
+	/* Fallback arrays built from the commands */
+	std::vector<GLsizei> counts;
+	std::vector<const void*> offsets;
+	std::vector<GLint> baseVertices;
+	unsigned int drawCount;
+	unsigned int VAO, indirectBuffer, materialBuffer;
+};
+
+
+IndirectDrawList::IndirectDrawList(const StaticBatcher& batcher, unsigned int materialLocation = 2)
+	: MaterialLocation(materialLocation), Indirect(multiDrawIndirectSupported()), BuildMs(0.0), Calls(0), batcher(batcher), drawCount(0), indirectBuffer(0)
+{
+	/* The material of every object, read at the command's baseInstance */
+	std::vector<GLuint> materials;
+	for (const Batched_object& object : batcher.Objects())
+		materials.push_back(object.material);
+	commands.resize(materials.size());
+
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &materialBuffer);
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, batcher.VertexBuffer());
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Static_vertex), (void*)offsetof(Static_vertex, position));
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Static_vertex), (void*)offsetof(Static_vertex, normal));
+	glEnableVertexAttribArray(1);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, batcher.IndexBuffer());
+
+	glBindBuffer(GL_ARRAY_BUFFER, materialBuffer);
+	glBufferData(GL_ARRAY_BUFFER, materials.size() * sizeof(GLuint), materials.data(), GL_STATIC_DRAW);
+	glVertexAttribIPointer(MaterialLocation, 1, GL_UNSIGNED_INT, sizeof(GLuint), (void*)0);
+	glVertexAttribDivisor(MaterialLocation, 1);
+	if (Indirect)
+		glEnableVertexAttribArray(MaterialLocation);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	if (Indirect)
+		glGenBuffers(1, &indirectBuffer);
+}
+
+IndirectDrawList::~IndirectDrawList() noexcept
+{
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteBuffers(1, &materialBuffer);
+	glDeleteBuffers(1, &indirectBuffer);
+}
+
+void IndirectDrawList::Build(ThreadPool& pool, const Frustum& frustum, bool culling)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	/* A few slices per worker, a slice's visible draws fit in its own part of the array */
+	const std::vector<Batched_object>& objects = batcher.Objects();
+	const std::vector<Static_batch>& batches = batcher.Batches();
+	unsigned int objectCount = (unsigned int)objects.size();
+	unsigned int slices = std::max(1u, std::min(objectCount, pool.ThreadCount() * 4));
+	sliceCounts.assign(slices, 0);
+	pool.ParallelFor(slices, [&](unsigned int begin, unsigned int end) {
+		for (unsigned int slice = begin; slice < end; slice++) {
+			unsigned int first = (unsigned int)((unsigned long long)objectCount * slice / slices);
+			unsigned int last = (unsigned int)((unsigned long long)objectCount * (slice + 1) / slices);
+			Draw_elements_indirect_command* command = &commands[first];
+			for (unsigned int i = first; i < last; i++) {
+				const Batched_object& object = objects[i];
+				if (culling && !frustum.IntersectsBox(object.boundsMin, object.boundsMax))
+					continue;
+				*command++ = Draw_elements_indirect_command{ (GLuint)object.indexCount, 1, (GLuint)object.firstIndex, batches[object.batch].baseVertex, i };
+			}
+			sliceCounts[slice] = (unsigned int)(command - &commands[first]);
+		}
+	});
+
+	/* Pack the slices, they stay in object order and so sorted by material */
+	drawCount = 0;
+	for (unsigned int slice = 0; slice < slices; slice++) {
+		unsigned int first = (unsigned int)((unsigned long long)objectCount * slice / slices);
+		if (first != drawCount)
+			std::memmove(&commands[drawCount], &commands[first], sliceCounts[slice] * sizeof(Draw_elements_indirect_command));
+		drawCount += sliceCounts[slice];
+	}
+
+	if (!Indirect) {
+		counts.resize(drawCount);
+		offsets.resize(drawCount);
+		baseVertices.resize(drawCount);
+		ranges.clear();
+		for (unsigned int i = 0; i < drawCount; i++) {
+			const Draw_elements_indirect_command& command = commands[i];
+			counts[i] = (GLsizei)command.count;
+			offsets[i] = (const void*)(command.firstIndex * sizeof(unsigned short));
+			baseVertices[i] = command.baseVertex;
+			unsigned int material = objects[command.baseInstance].material;
+			if (ranges.empty() || ranges.back().material != material)
+				ranges.push_back(Material_range{ material, i, 0 });
+			ranges.back().count++;
+		}
+	}
+	BuildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	if (Indirect) {
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, drawCount * sizeof(Draw_elements_indirect_command), commands.data(), GL_STREAM_DRAW);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	}
+}
+
+void IndirectDrawList::Draw()
+{
+	Calls = 0;
+	if (drawCount == 0)
+		return;
+	glBindVertexArray(VAO);
+#ifdef GL_ARB_multi_draw_indirect
+	if (Indirect) {
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, (void*)0, (GLsizei)drawCount, 0);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		Calls = 1;
+	}
+#endif
+	if (!Indirect) {
+		for (const Material_range& range : ranges) {
+			glVertexAttribI1ui(MaterialLocation, range.material);
+			glMultiDrawElementsBaseVertex(GL_TRIANGLES, &counts[range.first], GL_UNSIGNED_SHORT, &offsets[range.first],
+				(GLsizei)range.count, &baseVertices[range.first]);
+			Calls++;
+		}
+	}
+	glBindVertexArray(0);
+}
+
+inline unsigned int IndirectDrawList::DrawCount() const noexcept
+{
+	return drawCount;
+}
+
+inline bool IndirectDrawList::multiDrawIndirectSupported()
+{
+#if defined(GL_ARB_multi_draw_indirect) && defined(GL_ARB_base_instance)
+	return GLAD_GL_ARB_multi_draw_indirect && GLAD_GL_ARB_base_instance;
+#else
+	return false;
+#endif
+}
+
+#endif
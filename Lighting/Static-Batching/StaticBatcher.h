@@ -0,0 +1,292 @@
+#ifndef STATIC_BATCHER_H
+#define STATIC_BATCHER_H
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cfloat>
+
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+
+#include "ThreadPool.h"
+
+/* Vertex of a static mesh, in object space before the batching and in world space after it */
+struct Static_vertex {
+	glm::vec3 position;
+	glm::vec3 normal;
+};
+
+/* Indexed triangle mesh of at most 65536 vertices */
+struct Static_mesh {
+	std::vector<Static_vertex> vertices;
+	std::vector<unsigned short> indices;
+};
+
+/* Merged objects of one material */
+struct Static_batch {
+	unsigned int material;
+	unsigned int objectCount;
+	/* World space bounds of the merged vertices, for culling */
+	glm::vec3 boundsMin;
+	glm::vec3 boundsMax;
+	/* Range in the merged buffers, the indices count from baseVertex */
+	GLint baseVertex;
+	unsigned int vertexCount;
+	size_t firstIndex;
+	GLsizei indexCount;
+};
+
+/* Where an object ended up in the merged buffers, its indices count from the baseVertex of its batch */
+struct Batched_object {
+	unsigned int material;
+	unsigned int batch;
+	size_t firstIndex;
+	GLsizei indexCount;
+	/* World space bounds */
+	glm::vec3 boundsMin;
+	glm::vec3 boundsMax;
+};
+
+/* Static batching of objects that never move.
+Build() sorts the objects by material and along a Morton curve of their positions, then cuts
+every material into batches of up to MaxBatchVertices vertices. The vertices are transformed
+to world space on the thread pool and go into one vertex and one 16 bit index buffer, so a
+batch is drawn with a single glDrawElementsBaseVertex and an identity model matrix. Nearby
+objects end up in the same batch, which keeps the batch bounds small enough to cull. Objects()
+keeps the range of every object, for drawing them one by one from the merged buffers */
+class StaticBatcher
+{
+public:
+	/* Constructor and destructor */
+	explicit StaticBatcher(unsigned int maxBatchVertices);
+	~StaticBatcher() noexcept;
+
+	/* Store the mesh, returns its index for AddObject() or -1 when it has more vertices than a batch holds */
+	int AddMesh(const Static_mesh& mesh);
+	void AddObject(unsigned int mesh, unsigned int material, const glm::mat4& model);
+	/* Merge the objects into batches and upload them. Can be called again, e.g. with another pool */
+	void Build(ThreadPool& pool);
+
+	/* Bind the merged buffers for Draw() */
+	void Bind() const;
+	void Draw(unsigned int batch) const;
+
+	/* Get functions */
+	const std::vector<Static_batch>& Batches() const noexcept;
+	/* In batch order, the objects of a material follow each other */
+	const std::vector<Batched_object>& Objects() const noexcept;
+	unsigned int ObjectCount() const noexcept;
+	unsigned int VertexBuffer() const noexcept;
+	unsigned int IndexBuffer() const noexcept;
+
+public:
+	/* 16 bit indices address at most 65536 vertices per batch */
+	const unsigned int MaxBatchVertices;
+	/* Statistics of the last Build() */
+	double BuildMs;
+	size_t VertexBytes;
+	size_t IndexBytes;
+
+private:
+	struct Static_object {
+		unsigned int mesh;
+		unsigned int material;
+		glm::mat4 model;
+		/* Position along the Morton curve */
+		uint32_t cell;
+	};
+
+	/* Helper functions */
+	static uint32_t mortonCode(const glm::vec3& position, const glm::vec3& sceneMin, float sceneSize) noexcept;
+	static uint32_t spreadBits(uint32_t value) noexcept;
+private:
+	std::vector<Static_mesh> meshes;
+	std::vector<Static_object> objects;
+	std::vector<Static_batch> batches;
+	std::vector<Batched_object> placed;
+	unsigned int VAO, VBO, EBO;
+};
+
+
+StaticBatcher::StaticBatcher(unsigned int maxBatchVertices = 65536)
+	: MaxBatchVertices(std::min(maxBatchVertices, 65536u)), BuildMs(0.0), VertexBytes(0), IndexBytes(0), VAO(0), VBO(0), EBO(0)
+{
+}
+
+StaticBatcher::~StaticBatcher() noexcept
+{
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &EBO);
+}
+
+int StaticBatcher::AddMesh(const Static_mesh& mesh)
+{
+	/* Its 16 bit indices would wrap */
+	if (mesh.vertices.size() > MaxBatchVertices) {
+		std::cout << "ERROR::STATIC_BATCHER::MESH_TOO_LARGE\n" << mesh.vertices.size() << " vertices, a batch holds " << MaxBatchVertices << std::endl;
+		return -1;
+	}
+	meshes.push_back(mesh);
+	return (int)meshes.size() - 1;
+}
+
+inline void StaticBatcher::AddObject(unsigned int mesh, unsigned int material, const glm::mat4& model)
+{
+	/* Rejected by AddMesh() */
+	if (mesh >= meshes.size())
+		return;
+	objects.push_back(Static_object{ mesh, material, model, 0 });
+}
+
+void StaticBatcher::Build(ThreadPool& pool)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	/* Morton codes of the object origins in a cube around all origins, a flat scene uses few bits of y */
+	glm::vec3 sceneMin(FLT_MAX), sceneMax(-FLT_MAX);
+	for (const Static_object& object : objects) {
+		sceneMin = glm::min(sceneMin, glm::vec3(object.model[3]));
+		sceneMax = glm::max(sceneMax, glm::vec3(object.model[3]));
+	}
+	float sceneSize = std::max(std::max(sceneMax.x - sceneMin.x, sceneMax.y - sceneMin.y), std::max(sceneMax.z - sceneMin.z, 1e-6f));
+	pool.ParallelFor((unsigned int)objects.size(), [&](unsigned int begin, unsigned int end) {
+		for (unsigned int i = begin; i < end; i++)
+			objects[i].cell = mortonCode(glm::vec3(objects[i].model[3]), sceneMin, sceneSize);
+	});
+	std::sort(objects.begin(), objects.end(), [](const Static_object& a, const Static_object& b) {
+		return a.material != b.material ? a.material < b.material : a.cell < b.cell;
+	});
+
+	/* Cut the batches and place every object in the merged buffers */
+	batches.clear();
+	placed.resize(objects.size());
+	std::vector<unsigned int> objectVertex(objects.size()), objectBase(objects.size());
+	std::vector<size_t> objectIndex(objects.size());
+	unsigned int vertexTotal = 0;
+	size_t indexTotal = 0;
+	for (size_t i = 0; i < objects.size(); i++) {
+		const Static_mesh& mesh = meshes[objects[i].mesh];
+		bool full = !batches.empty() && batches.back().vertexCount + mesh.vertices.size() > MaxBatchVertices;
+		if (batches.empty() || batches.back().material != objects[i].material || full)
+			batches.push_back(Static_batch{ objects[i].material, 0, glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX), (GLint)vertexTotal, 0, indexTotal, 0 });
+
+		Static_batch& batch = batches.back();
+		objectVertex[i] = vertexTotal;
+		objectBase[i] = batch.vertexCount;
+		objectIndex[i] = indexTotal;
+		placed[i] = Batched_object{ batch.material, (unsigned int)batches.size() - 1, indexTotal, (GLsizei)mesh.indices.size(), glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) };
+		batch.objectCount++;
+		batch.vertexCount += (unsigned int)mesh.vertices.size();
+		batch.indexCount += (GLsizei)mesh.indices.size();
+		vertexTotal += (unsigned int)mesh.vertices.size();
+		indexTotal += mesh.indices.size();
+	}
+
+	/* Transform to world space, every object writes its own ranges */
+	std::vector<Static_vertex> vertices(vertexTotal);
+	std::vector<unsigned short> indices(indexTotal);
+	pool.ParallelFor((unsigned int)objects.size(), [&](unsigned int begin, unsigned int end) {
+		for (unsigned int i = begin; i < end; i++) {
+			const Static_object& object = objects[i];
+			const Static_mesh& mesh = meshes[object.mesh];
+			glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(object.model)));
+			Static_vertex* vertex = &vertices[objectVertex[i]];
+			for (const Static_vertex& source : mesh.vertices) {
+				vertex->position = glm::vec3(object.model * glm::vec4(source.position, 1.0f));
+				vertex->normal = glm::normalize(normalMatrix * source.normal);
+				placed[i].boundsMin = glm::min(placed[i].boundsMin, vertex->position);
+				placed[i].boundsMax = glm::max(placed[i].boundsMax, vertex->position);
+				vertex++;
+			}
+			unsigned short* index = &indices[objectIndex[i]];
+			for (unsigned short source : mesh.indices)
+				*index++ = (unsigned short)(source + objectBase[i]);
+		}
+	});
+	for (const Batched_object& object : placed) {
+		batches[object.batch].boundsMin = glm::min(batches[object.batch].boundsMin, object.boundsMin);
+		batches[object.batch].boundsMax = glm::max(batches[object.batch].boundsMax, object.boundsMax);
+	}
+	BuildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	/* Upload */
+	VertexBytes = vertices.size() * sizeof(Static_vertex);
+	IndexBytes = indices.size() * sizeof(unsigned short);
+	if (!VAO) {
+		glGenVertexArrays(1, &VAO);
+		glGenBuffers(1, &VBO);
+		glGenBuffers(1, &EBO);
+	}
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, VertexBytes, vertices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, IndexBytes, indices.data(), GL_STATIC_DRAW);
+
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Static_vertex), (void*)offsetof(Static_vertex, position));
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Static_vertex), (void*)offsetof(Static_vertex, normal));
+	glEnableVertexAttribArray(1);
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+inline void StaticBatcher::Bind() const
+{
+	glBindVertexArray(VAO);
+}
+
+inline void StaticBatcher::Draw(unsigned int batch) const
+{
+	const Static_batch& drawn = batches[batch];
+	glDrawElementsBaseVertex(GL_TRIANGLES, drawn.indexCount, GL_UNSIGNED_SHORT, (void*)(drawn.firstIndex * sizeof(unsigned short)), drawn.baseVertex);
+}
+
+inline const std::vector<Static_batch>& StaticBatcher::Batches() const noexcept
+{
+	return batches;
+}
+
+inline const std::vector<Batched_object>& StaticBatcher::Objects() const noexcept
+{
+	return placed;
+}
+
+inline unsigned int StaticBatcher::ObjectCount() const noexcept
+{
+	return (unsigned int)objects.size();
+}
+
+inline unsigned int StaticBatcher::VertexBuffer() const noexcept
+{
+	return VBO;
+}
+
+inline unsigned int StaticBatcher::IndexBuffer() const noexcept
+{
+	return EBO;
+}
+
+inline uint32_t StaticBatcher::mortonCode(const glm::vec3& position, const glm::vec3& sceneMin, float sceneSize) noexcept
+{
+	/* 10 bits per axis */
+	glm::vec3 cell = glm::clamp((position - sceneMin) / sceneSize * 1024.0f, glm::vec3(0.0f), glm::vec3(1023.0f));
+	return (spreadBits((uint32_t)cell.x) << 2) | (spreadBits((uint32_t)cell.y) << 1) | spreadBits((uint32_t)cell.z);
+}
+
+inline uint32_t StaticBatcher::spreadBits(uint32_t value) noexcept
+{
+	/* Two zero bits after each of the 10 bits */
+	value = (value | (value << 16)) & 0x030000FF;
+	value = (value | (value << 8)) & 0x0300F00F;
+	value = (value | (value << 4)) & 0x030C30C3;
+	value = (value | (value << 2)) & 0x09249249;
+	return value;
+}
+
+#endif
@@ -0,0 +1,396 @@
+#include "glad/glad.h"
+#include "GLFW/glfw3.h"
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+#include "Shader.h"
+#include "Camera.h"
+#include "GpuTimer.h"
+#include "ThreadPool.h"
+#include "Frustum.h"
+#include "StaticBatcher.h"
+#include "IndirectDrawList.h"
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <string>
+
+
+/* Ways to draw the boxes */
+enum class Draw_mode {
+	/* A glDrawElements with its own model matrix per object */
+	PER_OBJECT,
+	/* One glDrawElementsBaseVertex per merged batch */
+	BATCHED,
+	/* Every object from the merged buffers, in one multi draw call or one per material */
+	MULTI_DRAW
+};
+
+void processInput(GLFWwindow* window);
+void frameBufferResize_callback(GLFWwindow* window, int width, int height);
+void mouseMovement_callback(GLFWwindow* window, double xPos, double yPos);
+void mouseScroll_callback(GLFWwindow* window, double xOffset, double yOffset);
+void keyPress_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+
+Static_mesh boxMesh();
+const char* modeName(Draw_mode mode);
+
+
+const int winWidth = 800;
+const int winHeight = 600;
+
+/************************************ CAMERA ************************************/
+Camera camera({ 0.0f, 6.0f, 0.0f });
+
+float lastX = winWidth / 2;
+float lastY = winHeight / 2;
+bool firstMouseMove = true;
+
+/************************************ FRAMES ************************************/
+float deltaTime = 0.0f;
+float lastFrame = 0.0f;
+
+/************************************ BATCHING ************************************/
+/* Switched with the 1, 2 and 3 keys */
+Draw_mode drawMode = Draw_mode::MULTI_DRAW;
+/* C toggles the frustum culling, of the batch bounds or of the objects */
+bool culling = true;
+/* Smaller batches cull tighter but cost more draws, 16384 vertices are 682 boxes */
+const unsigned int batchVertices = 16384;
+
+/************************************ SCENE ************************************/
+/* Boxes scattered over a square field of this half size */
+const float fieldSize = 250.0f;
+const unsigned int boxCount = 50000;
+/* Box colors, the last one is the ground's */
+const glm::vec3 materialColors[] = {
+	{ 0.8f, 0.35f, 0.3f }, { 0.35f, 0.6f, 0.8f }, { 0.85f, 0.75f, 0.4f }, { 0.6f, 0.6f, 0.65f }, { 0.35f, 0.55f, 0.3f }
+};
+const unsigned int boxMaterials = 4;
+
+
+int main()
+{
+	/************************************ INITIALIZATION ************************************/
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+	GLFWwindow* window = glfwCreateWindow(winWidth, winHeight, "Static batching", NULL, NULL);
+	if (window == NULL) {
+		std::cout << "ERROR::GLFW::INITIALIZATION_FAILED" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		std::cout << "ERROR::GLAD::INITIALIZATION_FAILED" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glViewport(0, 0, winWidth, winHeight);
+	/* Measure the draws, not the display refresh */
+	glfwSwapInterval(0);
+
+	glfwSetFramebufferSizeCallback(window, frameBufferResize_callback);
+	glfwSetCursorPosCallback(window, mouseMovement_callback);
+	glfwSetScrollCallback(window, mouseScroll_callback);
+	glfwSetKeyCallback(window, keyPress_callback);
+
+	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+	/* Outdoors, walking at box speed would take forever */
+	camera.MoveSpeed = 15.0f;
+	camera.FarPlane = 400.0f;
+
+	/************************************ OBJECTS ************************************/
+	/* Model matrices, materials and bounding spheres of the objects, the ground first */
+	std::vector<glm::mat4> models;
+	std::vector<unsigned int> materials;
+	std::vector<glm::vec4> spheres;
+	models.push_back(glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -0.5f, 0.0f)), glm::vec3(fieldSize * 2.0f, 1.0f, fieldSize * 2.0f)));
+	materials.push_back(boxMaterials);
+	spheres.push_back(glm::vec4(0.0f, -0.5f, 0.0f, fieldSize * 1.5f));
+
+	std::mt19937 random(17);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	for (unsigned int i = 0; i < boxCount; i++) {
+		glm::vec3 size(0.5f + 1.5f * unit(random), 0.5f + 5.5f * unit(random) * unit(random), 0.5f + 1.5f * unit(random));
+		glm::vec3 position((unit(random) * 2.0f - 1.0f) * fieldSize, size.y / 2.0f, (unit(random) * 2.0f - 1.0f) * fieldSize);
+		glm::mat4 model = glm::translate(glm::mat4(1.0f), position);
+		model = glm::rotate(model, glm::radians(unit(random) * 90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		models.push_back(glm::scale(model, size));
+		materials.push_back(std::min((unsigned int)(unit(random) * boxMaterials), boxMaterials - 1));
+		spheres.push_back(glm::vec4(position, glm::length(size) / 2.0f));
+	}
+
+	/************************************ BATCHES ************************************/
+	Static_mesh box = boxMesh();
+	StaticBatcher batcher(batchVertices);
+	int boxIndex = batcher.AddMesh(box);
+	if (boxIndex >= 0) {
+		for (size_t i = 0; i < models.size(); i++)
+			batcher.AddObject((unsigned int)boxIndex, materials[i], models[i]);
+	}
+
+	ThreadPool pool(ThreadPool::DefaultThreadCount());
+	/* The same merge on one thread first, for the speedup of the pool */
+	{
+		ThreadPool single(1);
+		batcher.Build(single);
+		std::cout << "Merged on 1 thread in " << batcher.BuildMs << " ms" << std::endl;
+	}
+	batcher.Build(pool);
+	std::cout << "Merged on " << pool.ThreadCount() << " threads in " << batcher.BuildMs << " ms: " << batcher.ObjectCount() << " objects into "
+		<< batcher.Batches().size() << " batches, " << (batcher.VertexBytes + batcher.IndexBytes) / (1024 * 1024) << " MB" << std::endl;
+
+	/* Per object draws out of the merged buffers, the commands are written on the pool */
+	IndirectDrawList drawList(batcher, 2);
+	std::cout << (drawList.Indirect ? "glMultiDrawElementsIndirect" : "No ARB_multi_draw_indirect, glMultiDrawElementsBaseVertex per material")
+		<< " for the multi draws" << std::endl;
+
+	/************************************ BUFFERS ************************************/
+	/* One box for the per object draws */
+	unsigned int VAO, VBO, EBO;
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &VBO);
+	glGenBuffers(1, &EBO);
+
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, box.vertices.size() * sizeof(Static_vertex), box.vertices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, box.indices.size() * sizeof(unsigned short), box.indices.data(), GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Static_vertex), (void*)offsetof(Static_vertex, position));
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Static_vertex), (void*)offsetof(Static_vertex, normal));
+	glEnableVertexAttribArray(1);
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	/************************************ SHADERS ************************************/
+	Shader objectShader("shaders/shader.vs", "shaders/shader.fs");
+	objectShader.use();
+	objectShader.setVec3("sunDirection", glm::normalize(glm::vec3(0.4f, -1.0f, 0.3f)));
+	for (unsigned int i = 0; i <= boxMaterials; i++)
+		objectShader.setVec3("materialColors[" + std::to_string(i) + "]", materialColors[i]);
+
+	/************************************ RENDER LOOP ************************************/
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_CULL_FACE);
+	std::cout << boxCount << " static boxes on a " << fieldSize * 2.0f << " wide field. 1 - per object, 2 - batched, 3 - multi draw, C toggles the frustum culling" << std::endl;
+
+	GpuTimer sceneTimer;
+	std::vector<unsigned int> visible;
+	size_t drawCalls = 0, objectsDrawn = 0;
+	double cullMs = 0.0;
+	Draw_mode measuredMode = drawMode;
+	bool measuredCulling = culling;
+	unsigned int measuredFrames = 0;
+	double measureStart = glfwGetTime();
+	lastFrame = glfwGetTime();
+	while (!glfwWindowShouldClose(window)) {
+		float currentFrame = glfwGetTime();
+		deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+
+		processInput(window);
+
+		int width, height;
+		glfwGetFramebufferSize(window, &width, &height);
+		float aspect = (float)width / std::max(height, 1);
+		glm::mat4 view = camera.GetViewMatrix();
+		glm::mat4 projection = camera.GetProjectionMatrix(aspect);
+		Frustum frustum(projection * view);
+
+		glClearColor(0.5f, 0.65f, 0.8f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		objectShader.use();
+		objectShader.setMat4f("view", view);
+		objectShader.setMat4f("projection", projection);
+
+		/* Pick the visible batches or objects before drawing, the multi draws cull while writing their commands */
+		auto cullStart = std::chrono::steady_clock::now();
+		visible.clear();
+		if (drawMode == Draw_mode::MULTI_DRAW)
+			drawList.Build(pool, frustum, culling);
+		else if (drawMode == Draw_mode::BATCHED) {
+			for (unsigned int i = 0; i < batcher.Batches().size(); i++)
+				if (!culling || frustum.IntersectsBox(batcher.Batches()[i].boundsMin, batcher.Batches()[i].boundsMax))
+					visible.push_back(i);
+		}
+		else {
+			for (unsigned int i = 0; i < models.size(); i++)
+				if (!culling || frustum.IntersectsSphere(glm::vec3(spheres[i]), spheres[i].w))
+					visible.push_back(i);
+		}
+		cullMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - cullStart).count();
+
+		/* Without an array at location 2 the material is its current value */
+		sceneTimer.Begin();
+		if (drawMode == Draw_mode::MULTI_DRAW) {
+			objectShader.setMat4f("model", glm::mat4(1.0f));
+			drawList.Draw();
+			drawCalls += drawList.Calls;
+			objectsDrawn += drawList.DrawCount();
+		}
+		else if (drawMode == Draw_mode::BATCHED) {
+			/* The batches are sorted by material, the material changes once per material */
+			objectShader.setMat4f("model", glm::mat4(1.0f));
+			batcher.Bind();
+			int material = -1;
+			for (unsigned int i : visible) {
+				const Static_batch& batch = batcher.Batches()[i];
+				if ((int)batch.material != material) {
+					material = (int)batch.material;
+					glVertexAttribI1ui(2, batch.material);
+				}
+				batcher.Draw(i);
+				objectsDrawn += batch.objectCount;
+			}
+			drawCalls += visible.size();
+		}
+		else {
+			glBindVertexArray(VAO);
+			for (unsigned int i : visible) {
+				objectShader.setMat4f("model", models[i]);
+				glVertexAttribI1ui(2, materials[i]);
+				glDrawElements(GL_TRIANGLES, (GLsizei)box.indices.size(), GL_UNSIGNED_SHORT, 0);
+			}
+			drawCalls += visible.size();
+			objectsDrawn += visible.size();
+		}
+		sceneTimer.End();
+		glBindVertexArray(0);
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+
+		/* Averages over two seconds, restarted when a mode is toggled */
+		measuredFrames++;
+		double measured = glfwGetTime() - measureStart;
+		bool toggled = measuredMode != drawMode || measuredCulling != culling;
+		if (toggled || measured >= 2.0) {
+			if (!toggled)
+				std::cout << modeName(drawMode) << (culling ? ", culled: " : ": ") << measured * 1000.0 / measuredFrames << " ms per frame, "
+					<< sceneTimer.AverageMs() << " ms GPU, " << drawCalls / measuredFrames << " draw calls for " << objectsDrawn / measuredFrames
+					<< " of " << models.size() << " objects, " << cullMs / measuredFrames << " ms CPU culling" << std::endl;
+			measuredMode = drawMode;
+			measuredCulling = culling;
+			measuredFrames = 0;
+			drawCalls = 0;
+			objectsDrawn = 0;
+			cullMs = 0.0;
+			sceneTimer.Reset();
+			measureStart = glfwGetTime();
+		}
+	}
+
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &EBO);
+	glfwTerminate();
+}
+
+
+void processInput(GLFWwindow* window)
+{
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, true);
+	if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
+		deltaTime *= 2;
+	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::FORWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::BACKWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::LEFT, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::RIGHT, deltaTime);
+}
+
+void keyPress_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	if (action != GLFW_PRESS)
+		return;
+	if (key == GLFW_KEY_1)
+		drawMode = Draw_mode::PER_OBJECT;
+	else if (key == GLFW_KEY_2)
+		drawMode = Draw_mode::BATCHED;
+	else if (key == GLFW_KEY_3)
+		drawMode = Draw_mode::MULTI_DRAW;
+	else if (key == GLFW_KEY_C)
+		culling = !culling;
+}
+
+void frameBufferResize_callback(GLFWwindow* window, int width, int height)
+{
+	glViewport(0, 0, width, height);
+}
+
+void mouseMovement_callback(GLFWwindow* window, double xPos, double yPos)
+{
+	if (firstMouseMove) {
+		lastX = xPos;
+		lastY = yPos;
+		firstMouseMove = false;
+	}
+
+	float xOffset = (float)xPos - lastX;
+	float yOffset = lastY - (float)yPos;
+	lastX = xPos;
+	lastY = yPos;
+
+	camera.ProcessMouseMovement(xOffset, yOffset);
+}
+
+void mouseScroll_callback(GLFWwindow* window, double xOffset, double yOffset)
+{
+	camera.ProcessMouseScroll(yOffset);
+}
+
+Static_mesh boxMesh()
+{
+	/* Unit box with 4 vertices per face, the face spans u and v with u x v = normal */
+	const glm::vec3 faces[6][3] = {
+		{ {  1.0f,  0.0f,  0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } },
+		{ { -1.0f,  0.0f,  0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f, 0.0f } },
+		{ {  0.0f,  1.0f,  0.0f }, { 0.0f, 0.0f, 1.0f }, { 1.0f, 0.0f, 0.0f } },
+		{ {  0.0f, -1.0f,  0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } },
+		{ {  0.0f,  0.0f,  1.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f } },
+		{ {  0.0f,  0.0f, -1.0f }, { 0.0f, 1.0f, 0.0f }, { 1.0f, 0.0f, 0.0f } }
+	};
+	const float corners[4][2] = { { -1.0f, -1.0f }, { 1.0f, -1.0f }, { 1.0f, 1.0f }, { -1.0f, 1.0f } };
+
+	Static_mesh mesh;
+	for (const auto& face : faces) {
+		unsigned short first = (unsigned short)mesh.vertices.size();
+		for (const auto& corner : corners)
+			mesh.vertices.push_back(Static_vertex{ 0.5f * (face[0] + corner[0] * face[1] + corner[1] * face[2]), face[0] });
+		/* Counter clockwise seen from outside */
+		for (unsigned short index : { 0, 1, 2, 2, 3, 0 })
+			mesh.indices.push_back(first + index);
+	}
+	return mesh;
+}
+
+const char* modeName(Draw_mode mode)
+{
+	switch (mode) {
+	case Draw_mode::PER_OBJECT:
+		return "Per object";
+	case Draw_mode::BATCHED:
+		return "Batched";
+	default:
+		return "Multi draw";
+	}
+}
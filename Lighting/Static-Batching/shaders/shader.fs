@@ -0,0 +1,15 @@
+#version 330 core
+out vec4 fragColor;
+
+in vec3 Normal;
+in vec3 color;
+
+// Normalized, pointing from the sun to the scene
+uniform vec3 sunDirection;
+
+void main()
+{
+  vec3 norm = normalize(Normal);
+  float diff = max(dot(norm, -sunDirection), 0.0);
+  fragColor = vec4(color * (0.25 + 0.75 * diff), 1.0);
+}
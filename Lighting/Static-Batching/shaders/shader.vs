@@ -0,0 +1,23 @@
+#version 330 core
+layout (location = 0) in vec3 aPosition;
+layout (location = 1) in vec3 aNormal;
+// per instance with the multi draws, else the same for the whole draw
+layout (location = 2) in uint aMaterial;
+
+out vec3 Normal;
+out vec3 color;
+
+// Identity for the merged buffers, their vertices are in world space already
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+// the boxes' colors, then the ground's
+uniform vec3 materialColors[5];
+
+void main()
+{
+  gl_Position = projection * view * model * vec4(aPosition, 1.0);
+  // the boxes are scaled along their own axes, so their axis aligned normals keep the direction
+  Normal = mat3(model) * aNormal;
+  color = materialColors[aMaterial];
+}
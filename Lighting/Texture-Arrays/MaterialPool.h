@@ -0,0 +1,153 @@
+#ifndef MATERIAL_POOL_H
+#define MATERIAL_POOL_H
+
+#include <vector>
+#include <algorithm>
+
+#include "glad/glad.h"
+
+/* Place of an image in the pool - the array texture and the layer in it */
+struct Material_layer {
+	unsigned int texture;
+	int layer;
+};
+
+/* Material texture pool on GL_TEXTURE_2D_ARRAY.
+Images of the same size and channel count become layers of one array texture, so
+everything drawn with that array can go into a single instanced call with the layer
+passed per instance. Arrays hold at most GL_MAX_ARRAY_TEXTURE_LAYERS layers, a full
+group continues in a new array */
+class MaterialPool
+{
+public:
+	/* Constructor and destructor */
+	MaterialPool();
+	~MaterialPool() noexcept;
+
+	/* Queue the image (copied) as a layer and return its place. Only valid for sampling after Build() */
+	Material_layer Add(const unsigned char* pixels, int width, int height, int components);
+	/* Allocate the arrays, upload the queued layers and generate their mips */
+	void Build();
+
+	/* Get functions */
+	unsigned int ArrayCount() const noexcept;
+	/* Bytes of the layers with their mips */
+	size_t Bytes() const noexcept;
+
+private:
+	/* Layers of one array texture */
+	struct Layer_group {
+		unsigned int texture;
+		int width;
+		int height;
+		int components;
+		std::vector<std::vector<unsigned char>> layers;
+		/* Layer count once built, the pixels are freed then */
+		int layerCount;
+	};
+
+	/* Helper functions */
+	static GLenum formatOf(int components) noexcept;
+	static GLenum internalFormatOf(int components) noexcept;
+private:
+	std::vector<Layer_group> groups;
+	GLint maxLayers;
+};
+
+
+MaterialPool::MaterialPool() : maxLayers(256)
+{
+	glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+}
+
+MaterialPool::~MaterialPool() noexcept
+{
+	for (const Layer_group& group : groups)
+		glDeleteTextures(1, &group.texture);
+}
+
+Material_layer MaterialPool::Add(const unsigned char* pixels, int width, int height, int components)
+{
+	auto group = std::find_if(groups.begin(), groups.end(), [&](const Layer_group& candidate) {
+		return candidate.width == width && candidate.height == height && candidate.components == components &&
+			candidate.layerCount == 0 && (GLint)candidate.layers.size() < maxLayers;
+	});
+	if (group == groups.end()) {
+		Layer_group created{ 0, width, height, components, {}, 0 };
+		glGenTextures(1, &created.texture);
+		groups.push_back(created);
+		group = groups.end() - 1;
+	}
+
+	group->layers.emplace_back(pixels, pixels + (size_t)width * height * components);
+	return Material_layer{ group->texture, (int)group->layers.size() - 1 };
+}
+
+void MaterialPool::Build()
+{
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for (Layer_group& group : groups) {
+		if (group.layers.empty())
+			continue;
+
+		GLenum format = formatOf(group.components);
+		group.layerCount = (int)group.layers.size();
+		glBindTexture(GL_TEXTURE_2D_ARRAY, group.texture);
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, internalFormatOf(group.components), group.width, group.height, group.layerCount,
+			0, format, GL_UNSIGNED_BYTE, NULL);
+		for (int layer = 0; layer < group.layerCount; layer++)
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, group.width, group.height, 1, format, GL_UNSIGNED_BYTE,
+				group.layers[layer].data());
+		/* Mips are generated per layer, they never bleed into each other */
+		glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		if (group.components == 1) {
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_SWIZZLE_G, GL_RED);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_SWIZZLE_B, GL_RED);
+		}
+
+		std::vector<std::vector<unsigned char>>().swap(group.layers);
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+inline unsigned int MaterialPool::ArrayCount() const noexcept
+{
+	return (unsigned int)groups.size();
+}
+
+inline size_t MaterialPool::Bytes() const noexcept
+{
+	size_t bytes = 0;
+	for (const Layer_group& group : groups) {
+		/* The mip chain adds about a third */
+		size_t layerBytes = (size_t)group.width * group.height * group.components;
+		bytes += layerBytes * std::max(group.layerCount, (int)group.layers.size()) * 4 / 3;
+	}
+	return bytes;
+}
+
+inline GLenum MaterialPool::formatOf(int components) noexcept
+{
+	if (components == 1)
+		return GL_RED;
+	else if (components == 4)
+		return GL_RGBA;
+	return GL_RGB;
+}
+
+inline GLenum MaterialPool::internalFormatOf(int components) noexcept
+{
+	if (components == 1)
+		return GL_R8;
+	else if (components == 4)
+		return GL_RGBA8;
+	return GL_RGB8;
+}
+
+#endif
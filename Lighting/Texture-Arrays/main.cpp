@@ -0,0 +1,466 @@
+#include "glad/glad.h"
+#include "GLFW/glfw3.h"
+
+#include "stb_image.h"
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include "glm/gtc/type_ptr.hpp"
+
+#include "Shader.h"
+#include "Camera.h"
+#include "MaterialPool.h"
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+
+
+/* Ways to draw the objects */
+enum class Draw_mode {
+	/* Bind the textures and draw every object on its own, like the other lighting demos */
+	PER_OBJECT,
+	/* One instanced draw per material, its two GL_TEXTURE_2D bound before */
+	PER_MATERIAL,
+	/* Every material is a layer of the pool's arrays, one instanced draw for everything */
+	TEXTURE_ARRAY
+};
+
+/* Decoded image the materials are made of */
+struct Source_image {
+	std::vector<unsigned char> pixels;
+	int width;
+	int height;
+	int components;
+};
+
+/* Per instance vertex data, the layers are ignored by the GL_TEXTURE_2D shader */
+struct Instance_data {
+	glm::mat4 model;
+	int layers[2];
+};
+
+void processInput(GLFWwindow* window);
+void frameBufferResize_callback(GLFWwindow* window, int width, int height);
+void mouseMovement_callback(GLFWwindow* window, double xPos, double yPos);
+void mouseScroll_callback(GLFWwindow* window, double xOffset, double yOffset);
+
+bool loadSource(const char* path, int components, Source_image& image);
+std::vector<unsigned char> makeMaterialImage(const Source_image& source, int size, glm::vec3 tint);
+unsigned int createTexture(const std::vector<unsigned char>& pixels, int size, int components);
+void setInstanceAttributes(size_t firstInstance);
+const char* modeName(Draw_mode mode);
+
+
+const int winWidth = 800;
+const int winHeight = 600;
+
+/************************************ CAMERA ************************************/
+Camera camera({ 0.0f, 8.0f, 45.0f });
+
+float lastX = winWidth / 2;
+float lastY = winHeight / 2;
+bool firstMouseMove = true;
+
+/************************************ FRAMES ************************************/
+float deltaTime = 0.0f;
+float lastFrame = 0.0f;
+
+/************************************ BENCHMARK ************************************/
+const unsigned int materialCount = 256;
+const unsigned int objectCount = 100000;
+/* Side of every material texture, all have to match to share one array */
+const int materialSize = 128;
+/* Switched with the 1, 2 and 3 keys */
+Draw_mode drawMode = Draw_mode::TEXTURE_ARRAY;
+
+
+int main()
+{
+	/************************************ INITIALIZATION ************************************/
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+	GLFWwindow* window = glfwCreateWindow(winWidth, winHeight, "Texture arrays", NULL, NULL);
+	if (window == NULL) {
+		std::cout << "ERROR::GLFW::INITIALIZATION_FAILED" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		std::cout << "ERROR::GLAD::INITIALIZATION_FAILED" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glViewport(0, 0, winWidth, winHeight);
+	/* Measure the draws, not the display refresh */
+	glfwSwapInterval(0);
+
+	glfwSetFramebufferSizeCallback(window, frameBufferResize_callback);
+	glfwSetCursorPosCallback(window, mouseMovement_callback);
+	glfwSetScrollCallback(window, mouseScroll_callback);
+
+	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+	/************************************ POSITIONS ************************************/
+	float cubeVertices[] = {
+		/*	  Positions			Normals		  TextureCoords	*/
+		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
+
+		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
+
+		-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+		-0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
+		-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+		-0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
+		-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+
+		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+		 0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+
+		-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
+		 0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  1.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
+		 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
+		-0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  0.0f,
+		-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
+
+		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f,
+		 0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  1.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
+		 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
+		-0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  0.0f,
+		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f
+	};
+
+	/************************************ MATERIALS ************************************/
+	/* Tinted variations of the demo textures, every material has its own pair of images */
+	std::vector<Source_image> diffuseSources(3);
+	Source_image specularSource;
+	if (!loadSource("textures/container2.png", 3, diffuseSources[0]) || !loadSource("textures/container.jpg", 3, diffuseSources[1]) ||
+		!loadSource("textures/awesomeface.png", 3, diffuseSources[2]) || !loadSource("textures/container2_specular.png", 1, specularSource)) {
+		glfwTerminate();
+		return -1;
+	}
+
+	MaterialPool materialPool;
+	std::vector<Material_layer> diffuseLayers, specularLayers;
+	std::vector<unsigned int> diffuseMaps, specularMaps;
+	for (unsigned int i = 0; i < materialCount; i++) {
+		glm::vec3 tint(0.6f + 0.4f * std::sin(i * 0.7f), 0.6f + 0.4f * std::sin(i * 1.3f + 2.0f), 0.6f + 0.4f * std::sin(i * 2.1f + 4.0f));
+		std::vector<unsigned char> diffuse = makeMaterialImage(diffuseSources[i % 3], materialSize, tint);
+		std::vector<unsigned char> specular = makeMaterialImage(specularSource, materialSize, glm::vec3((i / 3 % 8 + 1) / 8.0f));
+
+		diffuseLayers.push_back(materialPool.Add(diffuse.data(), materialSize, materialSize, 3));
+		specularLayers.push_back(materialPool.Add(specular.data(), materialSize, materialSize, 1));
+		/* The same images as separate textures for the other modes */
+		diffuseMaps.push_back(createTexture(diffuse, materialSize, 3));
+		specularMaps.push_back(createTexture(specular, materialSize, 1));
+	}
+	materialPool.Build();
+	std::cout << materialCount << " materials in " << materialPool.ArrayCount() << " texture arrays ("
+		<< materialPool.Bytes() / (1024 * 1024) << " MB)" << std::endl;
+
+	/************************************ OBJECTS ************************************/
+	/* Sorted by material, the per material draws take a range each */
+	std::vector<Instance_data> instances(objectCount);
+	std::vector<unsigned int> materialFirst(materialCount + 1);
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	for (unsigned int i = 0; i < objectCount; i++) {
+		unsigned int material = (unsigned int)((unsigned long long)i * materialCount / objectCount);
+		glm::vec3 position((unit(random) - 0.5f) * 80.0f, (unit(random) - 0.5f) * 16.0f, (unit(random) - 0.5f) * 80.0f);
+		glm::mat4 model = glm::translate(glm::mat4(1.0f), position);
+		model = glm::rotate(model, unit(random) * 6.28f, glm::normalize(glm::vec3(unit(random), unit(random), unit(random)) + 0.1f));
+		model = glm::scale(model, glm::vec3(0.3f));
+
+		instances[i].model = model;
+		instances[i].layers[0] = diffuseLayers[material].layer;
+		instances[i].layers[1] = specularLayers[material].layer;
+		materialFirst[material + 1] = i + 1;
+	}
+
+	/************************************ BUFFERS ************************************/
+	unsigned int cubeVAO, VBO, instanceVBO;
+	glGenVertexArrays(1, &cubeVAO);
+	glGenBuffers(1, &VBO);
+	glGenBuffers(1, &instanceVBO);
+
+	glBindVertexArray(cubeVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), cubeVertices, GL_STATIC_DRAW);
+
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+	glEnableVertexAttribArray(2);
+
+	glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+	glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(Instance_data), instances.data(), GL_STATIC_DRAW);
+	setInstanceAttributes(0);
+	for (unsigned int location = 3; location < 8; location++) {
+		glEnableVertexAttribArray(location);
+		glVertexAttribDivisor(location, 1);
+	}
+
+	/************************************ SHADERS ************************************/
+	Shader textureShader("shaders/material.vs", "shaders/material.fs");
+	Shader arrayShader("shaders/material.vs", "shaders/materialArray.fs");
+	for (const Shader* shader : { &textureShader, &arrayShader }) {
+		shader->use();
+		shader->setVec3("light.direction", -0.3f, -1.0f, -0.5f);
+		shader->setVec3("light.ambient", 0.2f, 0.2f, 0.2f);
+		shader->setVec3("light.diffuse", 0.6f, 0.6f, 0.6f);
+		shader->setVec3("light.specular", 1.0f, 1.0f, 1.0f);
+		shader->setInt("material.diffuse", 0);
+		shader->setInt("material.specular", 1);
+		shader->setFloat("material.shininess", 32.0f);
+	}
+
+	/************************************ RENDER LOOP ************************************/
+	glEnable(GL_DEPTH_TEST);
+	std::cout << "1 - per object, 2 - per material, 3 - texture array" << std::endl;
+
+	Draw_mode measuredMode = drawMode;
+	unsigned int measuredFrames = 0;
+	double measureStart = glfwGetTime();
+	lastFrame = glfwGetTime();
+	while (!glfwWindowShouldClose(window)) {
+		float currentFrame = glfwGetTime();
+		deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+
+		processInput(window);
+
+		glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		/* View and projection transformations */
+		glm::mat4 view = camera.GetViewMatrix();
+		glm::mat4 projection =
+			glm::perspective(glm::radians(camera.Zoom), (float)winWidth / winHeight, 0.1f, 200.0f);
+
+		const Shader& shader = drawMode == Draw_mode::TEXTURE_ARRAY ? arrayShader : textureShader;
+		shader.use();
+		shader.setMat4f("view", view);
+		shader.setMat4f("projection", projection);
+		shader.setVec3("viewPos", camera.Position);
+
+		glBindVertexArray(cubeVAO);
+		unsigned int drawCalls = 0;
+		if (drawMode == Draw_mode::TEXTURE_ARRAY) {
+			/* Same size and format everywhere, so one array per map holds every material */
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, diffuseLayers[0].texture);
+			glActiveTexture(GL_TEXTURE1);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, specularLayers[0].texture);
+
+			glDrawArraysInstanced(GL_TRIANGLES, 0, 36, objectCount);
+			drawCalls = 1;
+		}
+		else if (drawMode == Draw_mode::PER_MATERIAL) {
+			glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+			for (unsigned int material = 0; material < materialCount; material++) {
+				glActiveTexture(GL_TEXTURE0);
+				glBindTexture(GL_TEXTURE_2D, diffuseMaps[material]);
+				glActiveTexture(GL_TEXTURE1);
+				glBindTexture(GL_TEXTURE_2D, specularMaps[material]);
+
+				/* No base instance in GL 3.3, point the instance attributes at the material's range instead */
+				setInstanceAttributes(materialFirst[material]);
+				glDrawArraysInstanced(GL_TRIANGLES, 0, 36, materialFirst[material + 1] - materialFirst[material]);
+			}
+			setInstanceAttributes(0);
+			drawCalls = materialCount;
+		}
+		else {
+			/* With the instance arrays disabled the attributes take the current generic value */
+			for (unsigned int location = 3; location < 8; location++)
+				glDisableVertexAttribArray(location);
+			for (unsigned int material = 0; material < materialCount; material++) {
+				for (unsigned int i = materialFirst[material]; i < materialFirst[material + 1]; i++) {
+					glActiveTexture(GL_TEXTURE0);
+					glBindTexture(GL_TEXTURE_2D, diffuseMaps[material]);
+					glActiveTexture(GL_TEXTURE1);
+					glBindTexture(GL_TEXTURE_2D, specularMaps[material]);
+
+					for (unsigned int column = 0; column < 4; column++)
+						glVertexAttrib4fv(3 + column, glm::value_ptr(instances[i].model[column]));
+					glDrawArrays(GL_TRIANGLES, 0, 36);
+				}
+			}
+			for (unsigned int location = 3; location < 8; location++)
+				glEnableVertexAttribArray(location);
+			drawCalls = objectCount;
+		}
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+
+		/* Average frame time per mode, restarted when the mode changes */
+		measuredFrames++;
+		double measured = glfwGetTime() - measureStart;
+		if (measuredMode != drawMode || measured >= 2.0) {
+			if (measuredMode == drawMode)
+				std::cout << modeName(drawMode) << ": " << measured * 1000.0 / measuredFrames << " ms per frame, "
+				<< drawCalls << " draw calls, " << objectCount << " objects, " << materialCount << " materials" << std::endl;
+			measuredMode = drawMode;
+			measuredFrames = 0;
+			measureStart = glfwGetTime();
+		}
+	}
+
+	glDeleteVertexArrays(1, &cubeVAO);
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &instanceVBO);
+	glDeleteTextures((GLsizei)diffuseMaps.size(), diffuseMaps.data());
+	glDeleteTextures((GLsizei)specularMaps.size(), specularMaps.data());
+	glfwTerminate();
+}
+
+
+void processInput(GLFWwindow* window)
+{
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, true);
+	if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
+		deltaTime *= 2;
+	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::FORWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::BACKWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::LEFT, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+		camera.ProcessKeyboard(Camera_movement::RIGHT, deltaTime);
+
+	if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS)
+		drawMode = Draw_mode::PER_OBJECT;
+	if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS)
+		drawMode = Draw_mode::PER_MATERIAL;
+	if (glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS)
+		drawMode = Draw_mode::TEXTURE_ARRAY;
+}
+
+void frameBufferResize_callback(GLFWwindow* window, int width, int height)
+{
+	glViewport(0, 0, width, height);
+}
+
+void mouseMovement_callback(GLFWwindow* window, double xPos, double yPos)
+{
+	if (firstMouseMove) {
+		lastX = xPos;
+		lastY = yPos;
+		firstMouseMove = false;
+	}
+
+	float xOffset = (float)xPos - lastX;
+	float yOffset = lastY - (float)yPos;
+	lastX = xPos;
+	lastY = yPos;
+
+	camera.ProcessMouseMovement(xOffset, yOffset);
+}
+
+void mouseScroll_callback(GLFWwindow* window, double xOffset, double yOffset)
+{
+	camera.ProcessMouseScroll(yOffset);
+}
+
+bool loadSource(const char* path, int components, Source_image& image)
+{
+	int nrComponents;
+	unsigned char* data = stbi_load(path, &image.width, &image.height, &nrComponents, components);
+	if (!data) {
+		std::cout << "Texture failed to load at path: " << path << std::endl;
+		return false;
+	}
+	image.components = components;
+	image.pixels.assign(data, data + (size_t)image.width * image.height * components);
+	stbi_image_free(data);
+	return true;
+}
+
+std::vector<unsigned char> makeMaterialImage(const Source_image& source, int size, glm::vec3 tint)
+{
+	/* Nearest resample to the common size, then tint */
+	std::vector<unsigned char> pixels((size_t)size * size * source.components);
+	for (int y = 0; y < size; y++) {
+		for (int x = 0; x < size; x++) {
+			int sx = x * source.width / size, sy = y * source.height / size;
+			const unsigned char* texel = &source.pixels[((size_t)sy * source.width + sx) * source.components];
+			unsigned char* pixel = &pixels[((size_t)y * size + x) * source.components];
+			for (int c = 0; c < source.components; c++)
+				pixel[c] = (unsigned char)(texel[c] * tint[c < 3 ? c : 0]);
+		}
+	}
+	return pixels;
+}
+
+unsigned int createTexture(const std::vector<unsigned char>& pixels, int size, int components)
+{
+	unsigned int textureID;
+	glGenTextures(1, &textureID);
+
+	GLenum format = components == 1 ? GL_RED : GL_RGB;
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glBindTexture(GL_TEXTURE_2D, textureID);
+	glTexImage2D(GL_TEXTURE_2D, 0, components == 1 ? GL_R8 : GL_RGB8, size, size, 0, format, GL_UNSIGNED_BYTE, pixels.data());
+	glGenerateMipmap(GL_TEXTURE_2D);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	/* Grey like the layers of the pool */
+	if (components == 1) {
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_RED);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
+	}
+	return textureID;
+}
+
+void setInstanceAttributes(size_t firstInstance)
+{
+	/* Model matrix as 4 column attributes, then the two layers as integers. The instance buffer has to be bound */
+	size_t base = firstInstance * sizeof(Instance_data);
+	for (unsigned int column = 0; column < 4; column++)
+		glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(Instance_data), (void*)(base + column * sizeof(glm::vec4)));
+	glVertexAttribIPointer(7, 2, GL_INT, sizeof(Instance_data), (void*)(base + sizeof(glm::mat4)));
+}
+
+const char* modeName(Draw_mode mode)
+{
+	switch (mode) {
+	case Draw_mode::PER_OBJECT:
+		return "Per object";
+	case Draw_mode::PER_MATERIAL:
+		return "Per material";
+	default:
+		return "Texture array";
+	}
+}
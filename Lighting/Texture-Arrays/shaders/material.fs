@@ -0,0 +1,48 @@
+#version 330 core
+
+struct Material {
+  sampler2D diffuse;
+  sampler2D specular;
+  float shininess;
+};
+
+struct Light {
+  vec3 direction;
+
+  vec3 ambient;
+  vec3 diffuse;
+  vec3 specular;
+};
+
+out vec4 fragColor;
+
+in vec3 Normal;
+in vec3 fragPos;
+in vec2 texCoords;
+
+uniform vec3 viewPos;
+uniform Material material;
+uniform Light light;
+
+void main()
+{
+  vec3 diffuseColor = vec3(texture(material.diffuse, texCoords));
+
+  // ambient same as diffuse
+  vec3 ambient = light.ambient * diffuseColor;
+
+  // diffuse
+  vec3 norm = normalize(Normal);
+  vec3 lightDir = normalize(-light.direction);
+  float diff = max(dot(norm, lightDir), 0.0);
+  vec3 diffuse = light.diffuse * diff * diffuseColor;
+
+  // specular
+  vec3 viewDir = normalize(viewPos - fragPos);
+  vec3 reflectDir = reflect(-lightDir, norm);
+  float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+  vec3 specular = light.specular * (spec * vec3(texture(material.specular, texCoords)));
+
+  vec3 result = ambient + diffuse + specular;
+  fragColor = vec4(result, 1.0);
+}
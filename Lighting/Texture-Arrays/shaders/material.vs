@@ -0,0 +1,25 @@
+#version 330 core
+layout (location = 0) in vec3 aPosition;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+// per instance
+layout (location = 3) in mat4 aModel;
+layout (location = 7) in ivec2 aLayers;
+
+out vec3 Normal;
+out vec3 fragPos;
+out vec2 texCoords;
+flat out ivec2 layers;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+  gl_Position = projection * view * aModel * vec4(aPosition, 1.0f);
+  // the cubes are only rotated and uniformly scaled
+  Normal = mat3(aModel) * aNormal;
+  fragPos = vec3(aModel * vec4(aPosition, 1.0));
+  texCoords = aTexCoords;
+  layers = aLayers;
+}
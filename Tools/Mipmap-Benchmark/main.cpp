@@ -0,0 +1,189 @@
+#include "glad/glad.h"
+#include "GLFW/glfw3.h"
+
+#include "ThreadPool.h"
+#include "MipGenerator.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+
+
+/* Benchmark options */
+struct Benchmark_options {
+	int size = 4096;
+	unsigned int repeats = 5;
+	unsigned int threadCount = ThreadPool::DefaultThreadCount() + 1;
+};
+
+std::vector<unsigned char> makeImage(int size);
+double driverMips(const std::vector<unsigned char>& image, int size, unsigned int texture);
+double uploadLevels(const std::vector<std::vector<unsigned char>>& levels, int size, unsigned int texture);
+double levelDifference(const std::vector<unsigned char>& cpuLevel, int width, int height, unsigned int texture);
+double elapsedMs(std::chrono::steady_clock::time_point start);
+
+
+/* Mip generation benchmark - glGenerateMipmap against MipGenerator on an RGBA8 image.
+Runs in a hidden window, e.g. on llvmpipe: LIBGL_ALWAYS_SOFTWARE=1 Mipmap-Benchmark 4096 */
+int main(int argc, char** argv)
+{
+	/************************************ ARGUMENTS ************************************/
+	Benchmark_options options;
+	for (int i = 1; i < argc; i++) {
+		std::string argument(argv[i]);
+		if (argument == "-r" && i + 1 < argc)
+			options.repeats = (unsigned int)std::max(1, atoi(argv[++i]));
+		else if (argument == "-j" && i + 1 < argc)
+			options.threadCount = (unsigned int)std::max(1, atoi(argv[++i]));
+		else if (atoi(argv[i]) > 0)
+			options.size = atoi(argv[i]);
+		else {
+			std::cout << "Usage: Mipmap-Benchmark [-r repeats] [-j threads] [size]" << std::endl;
+			return -1;
+		}
+	}
+
+	/************************************ INITIALIZATION ************************************/
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	/* Nothing is drawn, the window only carries the context */
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+	GLFWwindow* window = glfwCreateWindow(64, 64, "Mipmap benchmark", NULL, NULL);
+	if (window == NULL) {
+		std::cout << "ERROR::GLFW::INITIALIZATION_FAILED" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		std::cout << "ERROR::GLAD::INITIALIZATION_FAILED" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+
+	/************************************ BENCHMARK ************************************/
+	ThreadPool pool(options.threadCount);
+	std::vector<unsigned char> image = makeImage(options.size);
+	unsigned int texture;
+	glGenTextures(1, &texture);
+
+	std::cout << "Renderer: " << glGetString(GL_RENDERER) << "\n"
+		<< options.size << "x" << options.size << " RGBA8, " << MipGenerator::LevelCount(options.size, options.size)
+		<< " levels, best of " << options.repeats << " runs, " << pool.ThreadCount() << " threads" << std::endl;
+
+	/* Level 0 is uploaded by both, only the mips are timed. The CPU side adds the upload of the levels it built */
+	double driverMs = 1e30;
+	for (unsigned int run = 0; run < options.repeats; run++)
+		driverMs = std::min(driverMs, driverMips(image, options.size, texture));
+	std::cout << "glGenerateMipmap                      " << driverMs << " ms" << std::endl;
+
+	struct Cpu_variant {
+		const char* name;
+		Mip_filter filter;
+		bool srgb;
+		bool threaded;
+	};
+	const Cpu_variant variants[] = {
+		{ "box    linear 1 thread ", Mip_filter::BOX, false, false },
+		{ "box    linear          ", Mip_filter::BOX, false, true },
+		{ "box    sRGB            ", Mip_filter::BOX, true, true },
+		{ "kaiser linear 1 thread ", Mip_filter::KAISER, false, false },
+		{ "kaiser linear          ", Mip_filter::KAISER, false, true },
+		{ "kaiser sRGB            ", Mip_filter::KAISER, true, true },
+	};
+	for (const Cpu_variant& variant : variants) {
+		MipGenerator generator(variant.filter, variant.srgb);
+		double generateMs = 1e30, uploadMs = 1e30;
+		std::vector<std::vector<unsigned char>> levels;
+		for (unsigned int run = 0; run < options.repeats; run++) {
+			levels.assign(1, image);
+			auto start = std::chrono::steady_clock::now();
+			generator.Generate(levels, options.size, options.size, 4, variant.threaded ? &pool : nullptr);
+			generateMs = std::min(generateMs, elapsedMs(start));
+			uploadMs = std::min(uploadMs, uploadLevels(levels, options.size, texture));
+		}
+
+		std::cout << "MipGenerator " << variant.name << " " << generateMs << " ms + " << uploadMs << " ms upload";
+		/* The box filter in linear space matches what drivers usually do */
+		if (variant.filter == Mip_filter::BOX && !variant.srgb)
+			std::cout << ", level 1 differs from the driver by " << levelDifference(levels[1], options.size / 2, options.size / 2, texture) << " on average";
+		std::cout << std::endl;
+	}
+
+	glDeleteTextures(1, &texture);
+	glfwTerminate();
+	return 0;
+}
+
+
+std::vector<unsigned char> makeImage(int size)
+{
+	/* Smooth gradients with a fine checker on top, so the filters have edges to work on */
+	std::vector<unsigned char> image((size_t)size * size * 4);
+	for (int y = 0; y < size; y++) {
+		for (int x = 0; x < size; x++) {
+			unsigned char* pixel = &image[((size_t)y * size + x) * 4];
+			int checker = ((x >> 2) ^ (y >> 2)) & 1 ? 48 : 0;
+			pixel[0] = (unsigned char)std::min(255, x * 200 / size + checker);
+			pixel[1] = (unsigned char)std::min(255, y * 200 / size + checker);
+			pixel[2] = (unsigned char)((x * 7 + y * 13) & 255);
+			pixel[3] = 255;
+		}
+	}
+	return image;
+}
+
+double driverMips(const std::vector<unsigned char>& image, int size, unsigned int texture)
+{
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.data());
+	glFinish();
+
+	auto start = std::chrono::steady_clock::now();
+	glGenerateMipmap(GL_TEXTURE_2D);
+	/* The call only queues the work */
+	glFinish();
+	return elapsedMs(start);
+}
+
+double uploadLevels(const std::vector<std::vector<unsigned char>>& levels, int size, unsigned int texture)
+{
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, levels[0].data());
+	glFinish();
+
+	auto start = std::chrono::steady_clock::now();
+	for (unsigned int level = 1; level < levels.size(); level++) {
+		int levelSize = std::max(size >> level, 1);
+		glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, levelSize, levelSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, levels[level].data());
+	}
+	glFinish();
+	return elapsedMs(start);
+}
+
+double levelDifference(const std::vector<unsigned char>& cpuLevel, int width, int height, unsigned int texture)
+{
+	/* Let the driver replace the levels the CPU uploaded and read its level 1 back */
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glGenerateMipmap(GL_TEXTURE_2D);
+
+	std::vector<unsigned char> driverLevel((size_t)width * height * 4);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glGetTexImage(GL_TEXTURE_2D, 1, GL_RGBA, GL_UNSIGNED_BYTE, driverLevel.data());
+
+	double difference = 0.0;
+	for (size_t i = 0; i < driverLevel.size(); i++)
+		difference += std::abs((int)driverLevel[i] - (int)cpuLevel[i]);
+	return difference / driverLevel.size();
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
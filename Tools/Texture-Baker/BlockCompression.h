@@ -0,0 +1,311 @@
+#ifndef BLOCK_COMPRESSION_H
+#define BLOCK_COMPRESSION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BLOCK_COMPRESSION_SSE2
+#endif
+
+/* Supported block compression formats */
+enum class Block_format {
+	/* RGB, 4 bits per pixel */
+	BC1,
+	/* RGBA with interpolated alpha, 8 bits per pixel */
+	BC3,
+	/* Single channel, 4 bits per pixel */
+	BC4,
+	/* Two channels (normal maps), 8 bits per pixel */
+	BC5
+};
+
+/* Encoders of 4x4 pixel blocks.
+Color endpoints come from the principal axis of the block, indices are picked by the
+nearest palette entry. The per-pixel loops process 4 pixels at once with SSE2 */
+namespace BlockCompression {
+	/* Bytes of one compressed block */
+	unsigned int BlockSize(Block_format format) noexcept;
+	/* Bytes of a whole compressed image */
+	size_t ImageSize(Block_format format, int width, int height) noexcept;
+	/* Compress the block rows [firstRow, lastRow) of an RGBA8 image into out (whole image) */
+	void EncodeRows(Block_format format, const unsigned char* rgba, int width, int height,
+		int firstRow, int lastRow, unsigned char* out);
+
+	/* Block encoders, pixels are 16 values per channel in row major order */
+	void EncodeColorBlock(const float* r, const float* g, const float* b, unsigned char* out);
+	void EncodeAlphaBlock(const float* a, unsigned char* out);
+}
+
+
+namespace BlockCompression {
+
+	inline unsigned int BlockSize(Block_format format) noexcept
+	{
+		return format == Block_format::BC1 || format == Block_format::BC4 ? 8 : 16;
+	}
+
+	inline size_t ImageSize(Block_format format, int width, int height) noexcept
+	{
+		size_t blocksX = (width + 3) / 4;
+		size_t blocksY = (height + 3) / 4;
+		return blocksX * blocksY * BlockSize(format);
+	}
+
+	/* Quantize a 0-255 color to 5:6:5 */
+	inline uint16_t packColor(float r, float g, float b) noexcept
+	{
+		int r5 = (int)std::lround(std::min(std::max(r, 0.0f), 255.0f) * 31.0f / 255.0f);
+		int g6 = (int)std::lround(std::min(std::max(g, 0.0f), 255.0f) * 63.0f / 255.0f);
+		int b5 = (int)std::lround(std::min(std::max(b, 0.0f), 255.0f) * 31.0f / 255.0f);
+		return (uint16_t)((r5 << 11) | (g6 << 5) | b5);
+	}
+
+	/* Expand 5:6:5 back to 0-255 the way the hardware does */
+	inline void unpackColor(uint16_t color, float* rgb) noexcept
+	{
+		int r5 = (color >> 11) & 31;
+		int g6 = (color >> 5) & 63;
+		int b5 = color & 31;
+		rgb[0] = (float)((r5 << 3) | (r5 >> 2));
+		rgb[1] = (float)((g6 << 2) | (g6 >> 4));
+		rgb[2] = (float)((b5 << 3) | (b5 >> 2));
+	}
+
+	/* Write the nearest palette index of every pixel */
+	inline void nearestIndices(const float* r, const float* g, const float* b, const float palette[4][3],
+		int* indices) noexcept
+	{
+#ifdef BLOCK_COMPRESSION_SSE2
+		for (int i = 0; i < 16; i += 4) {
+			__m128 pr = _mm_loadu_ps(r + i);
+			__m128 pg = _mm_loadu_ps(g + i);
+			__m128 pb = _mm_loadu_ps(b + i);
+			__m128 bestDistance = _mm_set1_ps(1e30f);
+			__m128 bestIndex = _mm_setzero_ps();
+			for (int k = 0; k < 4; k++) {
+				__m128 dr = _mm_sub_ps(pr, _mm_set1_ps(palette[k][0]));
+				__m128 dg = _mm_sub_ps(pg, _mm_set1_ps(palette[k][1]));
+				__m128 db = _mm_sub_ps(pb, _mm_set1_ps(palette[k][2]));
+				__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(dg, dg)), _mm_mul_ps(db, db));
+				__m128 closer = _mm_cmplt_ps(distance, bestDistance);
+				bestDistance = _mm_min_ps(distance, bestDistance);
+				bestIndex = _mm_or_ps(_mm_and_ps(closer, _mm_set1_ps((float)k)), _mm_andnot_ps(closer, bestIndex));
+			}
+			_mm_storeu_si128((__m128i*)(indices + i), _mm_cvttps_epi32(bestIndex));
+		}
+#else
+		for (int i = 0; i < 16; i++) {
+			float bestDistance = 1e30f;
+			indices[i] = 0;
+			for (int k = 0; k < 4; k++) {
+				float dr = r[i] - palette[k][0];
+				float dg = g[i] - palette[k][1];
+				float db = b[i] - palette[k][2];
+				float distance = dr * dr + dg * dg + db * db;
+				if (distance < bestDistance) {
+					bestDistance = distance;
+					indices[i] = k;
+				}
+			}
+		}
+#endif
+	}
+
+	/* Find the pixels with the lowest and the highest projection onto the axis */
+	inline void axisExtremes(const float* r, const float* g, const float* b, const float axis[3],
+		int& minPixel, int& maxPixel) noexcept
+	{
+		float projection[16];
+#ifdef BLOCK_COMPRESSION_SSE2
+		__m128 ar = _mm_set1_ps(axis[0]);
+		__m128 ag = _mm_set1_ps(axis[1]);
+		__m128 ab = _mm_set1_ps(axis[2]);
+		for (int i = 0; i < 16; i += 4) {
+			__m128 p = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(r + i), ar), _mm_mul_ps(_mm_loadu_ps(g + i), ag)),
+				_mm_mul_ps(_mm_loadu_ps(b + i), ab));
+			_mm_storeu_ps(projection + i, p);
+		}
+#else
+		for (int i = 0; i < 16; i++)
+			projection[i] = r[i] * axis[0] + g[i] * axis[1] + b[i] * axis[2];
+#endif
+		minPixel = 0;
+		maxPixel = 0;
+		for (int i = 1; i < 16; i++) {
+			if (projection[i] < projection[minPixel])
+				minPixel = i;
+			if (projection[i] > projection[maxPixel])
+				maxPixel = i;
+		}
+	}
+
+	inline void EncodeColorBlock(const float* r, const float* g, const float* b, unsigned char* out)
+	{
+		/* Covariance of the block colors */
+		float mean[3] = { 0.0f, 0.0f, 0.0f };
+		for (int i = 0; i < 16; i++) {
+			mean[0] += r[i];
+			mean[1] += g[i];
+			mean[2] += b[i];
+		}
+		for (float& m : mean)
+			m /= 16.0f;
+
+		float covariance[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+		for (int i = 0; i < 16; i++) {
+			float dr = r[i] - mean[0], dg = g[i] - mean[1], db = b[i] - mean[2];
+			covariance[0] += dr * dr;
+			covariance[1] += dr * dg;
+			covariance[2] += dr * db;
+			covariance[3] += dg * dg;
+			covariance[4] += dg * db;
+			covariance[5] += db * db;
+		}
+
+		/* Principal axis by power iteration */
+		float axis[3] = { 1.0f, 1.0f, 1.0f };
+		for (int iteration = 0; iteration < 8; iteration++) {
+			float x = covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2];
+			float y = covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2];
+			float z = covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2];
+			float length = std::max(std::max(std::fabs(x), std::fabs(y)), std::fabs(z));
+			if (length < 1e-6f)
+				break;
+			axis[0] = x / length;
+			axis[1] = y / length;
+			axis[2] = z / length;
+		}
+
+		int minPixel, maxPixel;
+		axisExtremes(r, g, b, axis, minPixel, maxPixel);
+
+		/* Inset the endpoints a bit, the extremes are rarely hit exactly */
+		float high[3] = { r[maxPixel], g[maxPixel], b[maxPixel] };
+		float low[3] = { r[minPixel], g[minPixel], b[minPixel] };
+		for (int c = 0; c < 3; c++) {
+			float inset = (high[c] - low[c]) / 16.0f;
+			high[c] -= inset;
+			low[c] += inset;
+		}
+
+		uint16_t color0 = packColor(high[0], high[1], high[2]);
+		uint16_t color1 = packColor(low[0], low[1], low[2]);
+		/* color0 > color1 selects the 4 color mode */
+		if (color0 < color1)
+			std::swap(color0, color1);
+
+		uint32_t indexBits = 0;
+		if (color0 != color1) {
+			float palette[4][3];
+			unpackColor(color0, palette[0]);
+			unpackColor(color1, palette[1]);
+			for (int c = 0; c < 3; c++) {
+				palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+				palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+			}
+
+			int indices[16];
+			nearestIndices(r, g, b, palette, indices);
+			for (int i = 0; i < 16; i++)
+				indexBits |= (uint32_t)indices[i] << (2 * i);
+		}
+		/* Equal endpoints are a solid block in both BC1 and BC3, all indices stay 0 */
+
+		out[0] = (unsigned char)(color0 & 0xFF);
+		out[1] = (unsigned char)(color0 >> 8);
+		out[2] = (unsigned char)(color1 & 0xFF);
+		out[3] = (unsigned char)(color1 >> 8);
+		for (int i = 0; i < 4; i++)
+			out[4 + i] = (unsigned char)(indexBits >> (8 * i));
+	}
+
+	inline void EncodeAlphaBlock(const float* a, unsigned char* out)
+	{
+		float low = a[0], high = a[0];
+		for (int i = 1; i < 16; i++) {
+			low = std::min(low, a[i]);
+			high = std::max(high, a[i]);
+		}
+
+		int alpha0 = (int)std::lround(high);
+		int alpha1 = (int)std::lround(low);
+		uint64_t indexBits = 0;
+		/* alpha0 > alpha1 selects the 8 value mode, equal values are a solid block */
+		if (alpha0 > alpha1) {
+			int steps[16];
+			float scale = 7.0f / (float)(alpha0 - alpha1);
+#ifdef BLOCK_COMPRESSION_SSE2
+			__m128 offset = _mm_set1_ps((float)alpha1);
+			__m128 factor = _mm_set1_ps(scale);
+			for (int i = 0; i < 16; i += 4) {
+				__m128 step = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(a + i), offset), factor);
+				step = _mm_min_ps(_mm_max_ps(step, _mm_setzero_ps()), _mm_set1_ps(7.0f));
+				_mm_storeu_si128((__m128i*)(steps + i), _mm_cvtps_epi32(step));
+			}
+#else
+			for (int i = 0; i < 16; i++)
+				steps[i] = (int)std::lround(std::min(std::max((a[i] - alpha1) * scale, 0.0f), 7.0f));
+#endif
+			/* Step 7 is alpha0 (index 0), step 0 is alpha1 (index 1), the rest is interpolated */
+			for (int i = 0; i < 16; i++) {
+				int step = steps[i];
+				uint64_t index = step == 7 ? 0 : step == 0 ? 1 : (uint64_t)(8 - step);
+				indexBits |= index << (3 * i);
+			}
+		}
+
+		out[0] = (unsigned char)alpha0;
+		out[1] = (unsigned char)alpha1;
+		for (int i = 0; i < 6; i++)
+			out[2 + i] = (unsigned char)(indexBits >> (8 * i));
+	}
+
+	inline void EncodeRows(Block_format format, const unsigned char* rgba, int width, int height,
+		int firstRow, int lastRow, unsigned char* out)
+	{
+		int blocksX = (width + 3) / 4;
+		unsigned int blockSize = BlockSize(format);
+
+		float r[16], g[16], b[16], a[16];
+		for (int blockY = firstRow; blockY < lastRow; blockY++) {
+			for (int blockX = 0; blockX < blocksX; blockX++) {
+				/* Gather the block, clamp the edge blocks of images not divisible by 4 */
+				for (int y = 0; y < 4; y++) {
+					int pixelY = std::min(blockY * 4 + y, height - 1);
+					for (int x = 0; x < 4; x++) {
+						int pixelX = std::min(blockX * 4 + x, width - 1);
+						const unsigned char* pixel = rgba + ((size_t)pixelY * width + pixelX) * 4;
+						r[y * 4 + x] = pixel[0];
+						g[y * 4 + x] = pixel[1];
+						b[y * 4 + x] = pixel[2];
+						a[y * 4 + x] = pixel[3];
+					}
+				}
+
+				unsigned char* block = out + ((size_t)blockY * blocksX + blockX) * blockSize;
+				switch (format) {
+				case Block_format::BC1:
+					EncodeColorBlock(r, g, b, block);
+					break;
+				case Block_format::BC3:
+					EncodeAlphaBlock(a, block);
+					EncodeColorBlock(r, g, b, block + 8);
+					break;
+				case Block_format::BC4:
+					EncodeAlphaBlock(r, block);
+					break;
+				case Block_format::BC5:
+					EncodeAlphaBlock(r, block);
+					EncodeAlphaBlock(g, block + 8);
+					break;
+				}
+			}
+		}
+	}
+}
+
+#endif
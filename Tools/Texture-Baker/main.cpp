@@ -0,0 +1,261 @@
+#include "stb_image.h"
+
+#include "ThreadPool.h"
+#include "BlockCompression.h"
+#include "KtxTexture.h"
+#include "MipGenerator.h"
+#include "ChannelPacking.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+
+
+/* Baking options */
+struct Bake_options {
+	/* Chosen from the channel count of the image when not given */
+	bool formatGiven = false;
+	Block_format format = Block_format::BC1;
+	/* -f rgba8, keep the levels as they are */
+	bool uncompressed = false;
+	bool srgb = false;
+	/* bc1/bc3 images hold color, their mips are averaged in linear space */
+	bool linearData = false;
+	Mip_filter mipFilter = Mip_filter::KAISER;
+	/* Mask whose intensity goes into the alpha of the image, baked to image_packed.ktx */
+	std::string packMask;
+	std::string outputDirectory;
+	unsigned int threadCount = ThreadPool::DefaultThreadCount() + 1;
+};
+
+void printUsage();
+bool parseFormat(const std::string& name, Block_format& format);
+std::string outputPath(const std::string& input, const std::string& outputDirectory);
+bool bake(const std::string& input, const Bake_options& options, ThreadPool& pool);
+/* Encode the RGBA levels in the block format, the texture has its size set */
+void compress(Block_format format, bool srgb, const std::vector<std::vector<unsigned char>>& mips, KtxTexture& texture, ThreadPool& pool);
+
+
+/* Offline texture baker - compresses images to BC1/BC3/BC4/BC5 with a full mip chain
+and writes them as KTX files next to the source, e.g. textures/container2.png -> textures/container2.ktx */
+int main(int argc, char** argv)
+{
+	/************************************ ARGUMENTS ************************************/
+	Bake_options options;
+	std::vector<std::string> inputs;
+	for (int i = 1; i < argc; i++) {
+		std::string argument(argv[i]);
+		if (argument == "-f" && i + 1 < argc) {
+			options.uncompressed = std::string(argv[++i]) == "rgba8";
+			if (!options.uncompressed && !parseFormat(argv[i], options.format)) {
+				std::cout << "ERROR::BAKER::UNKNOWN_FORMAT " << argv[i] << std::endl;
+				return -1;
+			}
+			options.formatGiven = true;
+		}
+		else if (argument == "-j" && i + 1 < argc)
+			options.threadCount = (unsigned int)std::max(1, atoi(argv[++i]));
+		else if (argument == "-o" && i + 1 < argc)
+			options.outputDirectory = argv[++i];
+		else if (argument == "-m" && i + 1 < argc) {
+			std::string filter(argv[++i]);
+			if (filter != "box" && filter != "kaiser") {
+				std::cout << "ERROR::BAKER::UNKNOWN_MIP_FILTER " << filter << std::endl;
+				return -1;
+			}
+			options.mipFilter = filter == "box" ? Mip_filter::BOX : Mip_filter::KAISER;
+		}
+		else if (argument == "--srgb")
+			options.srgb = true;
+		else if (argument == "--linear")
+			options.linearData = true;
+		else if (argument == "--pack" && i + 1 < argc)
+			options.packMask = argv[++i];
+		else if (argument == "-h" || argument == "--help") {
+			printUsage();
+			return 0;
+		}
+		else
+			inputs.push_back(argument);
+	}
+	if (inputs.empty() || (!options.packMask.empty() && inputs.size() != 1)) {
+		printUsage();
+		return -1;
+	}
+
+	/************************************ BAKING ************************************/
+	ThreadPool pool(options.threadCount);
+	std::cout << "Baking " << inputs.size() << " textures on " << pool.ThreadCount() << " threads" << std::endl;
+
+	int failed = 0;
+	for (const std::string& input : inputs) {
+		if (!bake(input, options, pool))
+			failed++;
+	}
+	return failed ? -1 : 0;
+}
+
+
+void printUsage()
+{
+	std::cout << "Usage: Texture-Baker [-f bc1|bc3|bc4|bc5|rgba8] [-m box|kaiser] [--srgb] [--linear] [-j threads] [-o directory] images...\n"
+		"       Texture-Baker --pack mask [options] image\n"
+		"  -f        block format, by default bc4 for 1, bc5 for 2, bc1 for 3 and bc3 for 4 channel images. rgba8 is uncompressed\n"
+		"  -m        mip filter, kaiser by default\n"
+		"  --srgb    store bc1/bc3 color as sRGB\n"
+		"  --linear  bc1/bc3 image holds data, not color - don't average its mips in linear space\n"
+		"  -j        number of encoder threads\n"
+		"  -o        output directory, the .ktx file is written next to the image otherwise\n"
+		"  --pack    store the intensity of the mask (e.g. a specular map) in the alpha of the image, written to image_packed.ktx" << std::endl;
+}
+
+bool parseFormat(const std::string& name, Block_format& format)
+{
+	if (name == "bc1")
+		format = Block_format::BC1;
+	else if (name == "bc3")
+		format = Block_format::BC3;
+	else if (name == "bc4")
+		format = Block_format::BC4;
+	else if (name == "bc5")
+		format = Block_format::BC5;
+	else
+		return false;
+	return true;
+}
+
+std::string outputPath(const std::string& input, const std::string& outputDirectory)
+{
+	std::string path = input.substr(0, input.find_last_of('.')) + ".ktx";
+	if (outputDirectory.empty())
+		return path;
+
+	size_t slash = path.find_last_of("/\\");
+	std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+	return outputDirectory + "/" + name;
+}
+
+bool bake(const std::string& input, const Bake_options& options, ThreadPool& pool)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	int width, height, nrComponents;
+	unsigned char* data = stbi_load(input.c_str(), &width, &height, &nrComponents, 4);
+	if (!data) {
+		std::cout << "ERROR::BAKER::IMAGE_NOT_LOADED " << input << std::endl;
+		return false;
+	}
+
+	std::string output = outputPath(input, options.outputDirectory);
+	if (!options.packMask.empty()) {
+		int maskWidth, maskHeight, maskComponents;
+		unsigned char* mask = stbi_load(options.packMask.c_str(), &maskWidth, &maskHeight, &maskComponents, 0);
+		if (!mask || maskWidth != width || maskHeight != height) {
+			std::cout << "ERROR::BAKER::MASK_NOT_LOADED " << options.packMask << (mask ? " (size differs from the image)" : "") << std::endl;
+			stbi_image_free(mask);
+			stbi_image_free(data);
+			return false;
+		}
+		if (!ChannelPacking::IsGrey(mask, maskComponents, (size_t)width * height))
+			std::cout << "Mask " << options.packMask << " isn't grey, its channels are averaged into one" << std::endl;
+
+		ChannelPacking::PackIntensity(data, mask, maskComponents, (size_t)width * height);
+		stbi_image_free(mask);
+		nrComponents = 4;
+		output = outputPath(ChannelPacking::PackedPath(input), options.outputDirectory);
+	}
+
+	/* See which format suits the channels of the image */
+	Block_format format = options.format;
+	if (!options.formatGiven) {
+		if (nrComponents == 1)
+			format = Block_format::BC4;
+		else if (nrComponents == 2)
+			format = Block_format::BC5;
+		else if (nrComponents == 3)
+			format = Block_format::BC1;
+		else
+			format = Block_format::BC3;
+	}
+
+	/* stbi expands grey and alpha to L,L,L,A while BC5 encodes red and green, move the alpha into green */
+	if (nrComponents == 2 && format == Block_format::BC5 && !options.uncompressed)
+		for (size_t pixel = 0; pixel < (size_t)width * height; pixel++)
+			data[pixel * 4 + 1] = data[pixel * 4 + 3];
+
+	std::vector<std::vector<unsigned char>> mips;
+	mips.emplace_back(data, data + (size_t)width * height * 4);
+	stbi_image_free(data);
+	bool color = (format == Block_format::BC1 || format == Block_format::BC3) && !options.linearData;
+	MipGenerator(options.mipFilter, color).Generate(mips, width, height, 4, &pool);
+
+	KtxTexture texture;
+	texture.Width = width;
+	texture.Height = height;
+	if (options.uncompressed) {
+		texture.GlType = Ktx_consts::UNSIGNED_BYTE;
+		texture.GlFormat = Ktx_consts::RGBA;
+		texture.GlInternalFormat = options.srgb ? Ktx_consts::SRGB8_ALPHA8 : Ktx_consts::RGBA8;
+		texture.GlBaseInternalFormat = Ktx_consts::RGBA;
+		texture.Levels = mips;
+	}
+	else
+		compress(format, options.srgb, mips, texture, pool);
+
+	if (!texture.Save(output)) {
+		std::cout << "ERROR::BAKER::FILE_NOT_WRITTEN " << output << std::endl;
+		return false;
+	}
+
+	size_t rawSize = 0;
+	for (const std::vector<unsigned char>& level : mips)
+		rawSize += level.size() / 4 * std::max(nrComponents, 3);
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	std::cout << input << " -> " << output << ": " << width << "x" << height << ", " << mips.size() << " levels, "
+		<< rawSize / 1024 << " KB -> " << texture.DataSize() / 1024 << " KB (" << (double)rawSize / texture.DataSize()
+		<< "x smaller) in " << ms << " ms" << std::endl;
+	return true;
+}
+
+void compress(Block_format format, bool srgb, const std::vector<std::vector<unsigned char>>& mips, KtxTexture& texture, ThreadPool& pool)
+{
+	switch (format) {
+	case Block_format::BC1:
+		texture.GlInternalFormat = srgb ? Ktx_consts::COMPRESSED_SRGB_S3TC_DXT1 : Ktx_consts::COMPRESSED_RGB_S3TC_DXT1;
+		texture.GlBaseInternalFormat = Ktx_consts::RGB;
+		break;
+	case Block_format::BC3:
+		texture.GlInternalFormat = srgb ? Ktx_consts::COMPRESSED_SRGB_ALPHA_S3TC_DXT5 : Ktx_consts::COMPRESSED_RGBA_S3TC_DXT5;
+		texture.GlBaseInternalFormat = Ktx_consts::RGBA;
+		break;
+	case Block_format::BC4:
+		texture.GlInternalFormat = Ktx_consts::COMPRESSED_RED_RGTC1;
+		texture.GlBaseInternalFormat = Ktx_consts::RED;
+		break;
+	case Block_format::BC5:
+		texture.GlInternalFormat = Ktx_consts::COMPRESSED_RG_RGTC2;
+		texture.GlBaseInternalFormat = Ktx_consts::RG;
+		break;
+	}
+
+	/* Every block row of every level is an independent job */
+	std::vector<unsigned int> firstRowOfLevel;
+	unsigned int totalRows = 0;
+	texture.Levels.resize(mips.size());
+	for (unsigned int level = 0; level < mips.size(); level++) {
+		texture.Levels[level].resize(BlockCompression::ImageSize(format, texture.LevelWidth(level), texture.LevelHeight(level)));
+		firstRowOfLevel.push_back(totalRows);
+		totalRows += (texture.LevelHeight(level) + 3) / 4;
+	}
+
+	pool.ParallelFor(totalRows, [&](unsigned int begin, unsigned int end) {
+		for (unsigned int row = begin; row < end; row++) {
+			unsigned int level = (unsigned int)(std::upper_bound(firstRowOfLevel.begin(), firstRowOfLevel.end(), row) - firstRowOfLevel.begin()) - 1;
+			int levelRow = (int)(row - firstRowOfLevel[level]);
+			BlockCompression::EncodeRows(format, mips[level].data(), texture.LevelWidth(level), texture.LevelHeight(level),
+				levelRow, levelRow + 1, texture.Levels[level].data());
+		}
+	});
+}